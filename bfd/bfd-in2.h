@@ -337,12 +337,30 @@ struct bfd_hash_entry
   unsigned long hash;
 };
 
+/* A slot of a hash table created by bfd_hash_table_init_open.  */
+
+struct bfd_hash_slot
+{
+  /* Hash code of the entry.  */
+  unsigned long hash;
+  /* The entry, if the slot is in use.  */
+  struct bfd_hash_entry *entry;
+};
+
 /* A hash table.  */
 
 struct bfd_hash_table
 {
   /* The hash array.  */
   struct bfd_hash_entry **table;
+  /* For a table created by bfd_hash_table_init_open, the slots and
+     a control byte for each of them, which says whether the slot is
+     in use, and if so holds seven bits of the hash code of its
+     entry.  They are malloc'd rather than on the objalloc, so that
+     they can be freed when the table grows.  NULL for other
+     tables.  */
+  struct bfd_hash_slot *slots;
+  unsigned char *ctrl;
   /* A function used to create new elements in the hash table.  The
      first entry is itself a pointer to an element.  When this
      function is first invoked, this pointer will be NULL.  However,
@@ -361,6 +379,9 @@ struct bfd_hash_table
   unsigned int count;
   /* The size of elements.  */
   unsigned int entsize;
+  /* The number of slots of an open addressing table which have had
+     their entry renamed away from them.  */
+  unsigned int deleted;
   /* If non-zero, don't grow the hash table.  */
   unsigned int frozen:1;
 };
@@ -377,6 +398,12 @@ bool bfd_hash_table_init
        (struct bfd_hash_entry *, struct bfd_hash_table *, const char *),
     unsigned int /*entsize*/);
 
+bool bfd_hash_table_init_open
+   (struct bfd_hash_table *,
+    struct bfd_hash_entry *(* /*newfunc*/)
+       (struct bfd_hash_entry *, struct bfd_hash_table *, const char *),
+    unsigned int /*entsize*/, unsigned int /*size*/);
+
 void bfd_hash_table_free (struct bfd_hash_table *);
 
 struct bfd_hash_entry *bfd_hash_lookup
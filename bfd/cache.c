@@ -845,3 +845,79 @@ bfd_open_file (bfd *abfd)
     return NULL;
   return result;
 }
+
+/*
+INTERNAL_FUNCTION
+	_bfd_mmap_output
+
+SYNOPSIS
+	void *_bfd_mmap_output
+	  (bfd *abfd, ufile_ptr size, size_t *map_size);
+
+DESCRIPTION
+	Make the output file @var{abfd} at least @var{size} bytes long
+	and map its first @var{size} bytes for writing, so that section
+	contents can be written in place rather than with <<bfd_write>>.
+	Anything already written with <<bfd_write>> is flushed first.
+	Return the address of the mapping and write its size to
+	@var{map_size}, for <<munmap>>.  Return NULL if the file cannot
+	be mapped, or if disk space for all of it cannot be reserved, in
+	which case the caller should write the file as usual.
+*/
+
+void *
+_bfd_mmap_output (bfd *abfd ATTRIBUTE_UNUSED,
+		  ufile_ptr size ATTRIBUTE_UNUSED,
+		  size_t *map_size ATTRIBUTE_UNUSED)
+{
+  void *ret = NULL;
+
+#ifdef HAVE_MMAP
+  FILE *f;
+  int fd;
+
+  if (abfd->iovec != &cache_iovec
+      || abfd->my_archive != NULL
+      || abfd->direction == read_direction
+      || size == 0
+      || (size_t) size != size)
+    return NULL;
+
+  if (!bfd_lock ())
+    return NULL;
+
+  f = bfd_cache_lookup (abfd, CACHE_NO_SEEK_ERROR);
+  fd = f != NULL && fflush (f) == 0 ? fileno (f) : -1;
+  /* Allocate the disk space for the whole mapping now, including any
+     holes left by earlier writes.  A store into a part of the mapping
+     with no disk space behind it would raise SIGBUS on a full disk,
+     where bfd_write reports an error, so without posix_fallocate, or
+     if it fails, the file is not mapped.  */
+#ifdef HAVE_POSIX_FALLOCATE
+  struct stat st;
+
+  if (fd >= 0
+      && fstat (fd, &st) == 0
+      && S_ISREG (st.st_mode)
+      && posix_fallocate (fd, 0, size) == 0)
+    {
+      ret = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (ret == MAP_FAILED)
+	ret = NULL;
+      else
+	*map_size = size;
+    }
+#else
+  (void) fd;
+#endif
+
+  if (!bfd_unlock ())
+    {
+      if (ret != NULL)
+	munmap (ret, size);
+      return NULL;
+    }
+#endif
+
+  return ret;
+}
@@ -1272,6 +1272,20 @@ struct elf_backend_data
      asection *input_section, bfd_byte *contents, Elf_Internal_Rela *relocs,
      Elf_Internal_Sym *local_syms, asection **local_sections);
 
+  /* The PARALLEL_RELOCATE_P function is called by the ELF backend
+     linker when it may relocate input files in parallel.  It returns
+     TRUE if RELOCATE_SECTION may be called for INPUT_SECTION with
+     RELOCS at the same time as for sections of other input files,
+     which means that it must not change any data shared with them,
+     such as the GOT, the dynamic relocations or the global hash table
+     entries.  Any such data which RELOCATE_SECTION reads must not be
+     changed by other sections either, since it may be called for
+     INPUT_SECTION after those of input files which follow it.  */
+  bool (*elf_backend_parallel_relocate_p)
+    (bfd *output_bfd, struct bfd_link_info *info, bfd *input_bfd,
+     asection *input_section, const Elf_Internal_Rela *relocs,
+     const Elf_Internal_Sym *local_syms, asection **local_sections);
+
   /* The FINISH_DYNAMIC_SYMBOL function is called by the ELF backend
      linker just before it writes a symbol out to the .dynsym section.
      The processor backend may make any required adjustment to the
@@ -101,8 +101,8 @@ _bfd_elf_strtab_init (void)
   if (table == NULL)
     return NULL;
 
-  if (!bfd_hash_table_init (&table->table, elf_strtab_hash_newfunc,
-			    sizeof (struct elf_strtab_hash_entry)))
+  if (!bfd_hash_table_init_open (&table->table, elf_strtab_hash_newfunc,
+				 sizeof (struct elf_strtab_hash_entry), 0))
     {
       free (table);
       return NULL;
@@ -340,22 +340,25 @@ _bfd_elf_strtab_emit (register bfd *abfd, struct elf_strtab_hash *tab)
   return true;
 }
 
-/* Compare two elf_strtab_hash_entry structures.  Called via qsort.
-   Won't ever return zero as all entries differ, so there is no issue
-   with qsort stability here.  */
+/* Compare the strings of two elf_strtab_hash_entry structures from the
+   end, knowing that their last DEPTH characters are the same.  Won't
+   ever return zero as all entries differ.  */
 
 static int
-strrevcmp (const void *a, const void *b)
+strrevcmp (const struct elf_strtab_hash_entry *A,
+	   const struct elf_strtab_hash_entry *B,
+	   unsigned int depth)
 {
-  struct elf_strtab_hash_entry *A = *(struct elf_strtab_hash_entry **) a;
-  struct elf_strtab_hash_entry *B = *(struct elf_strtab_hash_entry **) b;
   unsigned int lenA = A->len;
   unsigned int lenB = B->len;
   const unsigned char *s = (const unsigned char *) A->root.string + lenA - 1;
   const unsigned char *t = (const unsigned char *) B->root.string + lenB - 1;
   int l = lenA < lenB ? lenA : lenB;
 
-  while (l)
+  s -= depth;
+  t -= depth;
+  l -= depth;
+  while (l > 0)
     {
       if (*s != *t)
 	return (int) *s - (int) *t;
@@ -366,6 +369,120 @@ strrevcmp (const void *a, const void *b)
   return lenA - lenB;
 }
 
+/* Return the character DEPTH places from the end of the string of E,
+   plus one, or zero if the string is not that long.  */
+
+static inline unsigned int
+strrev_char (const struct elf_strtab_hash_entry *e, unsigned int depth)
+{
+  if (depth >= (unsigned int) e->len)
+    return 0;
+  return 1 + (unsigned char) e->root.string[e->len - 1 - depth];
+}
+
+/* Sort the N entries of ARRAY, whose strings all end in the same DEPTH
+   characters, by their strings read backwards, shorter strings before
+   longer ones they are a suffix of.  This is a multikey quicksort:
+   the entries are split three ways on the character DEPTH places from
+   the end, so that characters already known to be equal are not
+   compared again.  */
+
+static void
+strrev_sort (struct elf_strtab_hash_entry **array, size_t n,
+	     unsigned int depth)
+{
+  while (n > 1)
+    {
+      struct elf_strtab_hash_entry *tmp;
+      size_t lt, gt, i, largest;
+      unsigned int c0, c1, c2, pivot;
+      struct
+      {
+	struct elf_strtab_hash_entry **array;
+	size_t n;
+	unsigned int depth;
+      } part[3];
+
+      if (n < 16)
+	{
+	  /* Insertion sort small arrays.  */
+	  for (i = 1; i < n; i++)
+	    {
+	      size_t j = i;
+
+	      tmp = array[i];
+	      while (j > 0 && strrevcmp (array[j - 1], tmp, depth) > 0)
+		{
+		  array[j] = array[j - 1];
+		  j--;
+		}
+	      array[j] = tmp;
+	    }
+	  return;
+	}
+
+      /* Pick the median of three characters as the pivot.  */
+      c0 = strrev_char (array[0], depth);
+      c1 = strrev_char (array[n / 2], depth);
+      c2 = strrev_char (array[n - 1], depth);
+      if (c0 > c1)
+	{
+	  pivot = c0;
+	  c0 = c1;
+	  c1 = pivot;
+	}
+      pivot = c2 < c0 ? c0 : c2 > c1 ? c1 : c2;
+
+      /* Partition into characters less than, equal to and greater
+	 than the pivot.  */
+      lt = 0;
+      gt = n;
+      i = 0;
+      while (i < gt)
+	{
+	  unsigned int c = strrev_char (array[i], depth);
+
+	  tmp = array[i];
+	  if (c < pivot)
+	    {
+	      array[i++] = array[lt];
+	      array[lt++] = tmp;
+	    }
+	  else if (c > pivot)
+	    {
+	      array[i] = array[--gt];
+	      array[gt] = tmp;
+	    }
+	  else
+	    i++;
+	}
+
+      part[0].array = array;
+      part[0].n = lt;
+      part[0].depth = depth;
+      part[1].array = array + lt;
+      /* Strings which have all ended are equal, so there is only one.  */
+      part[1].n = pivot != 0 ? gt - lt : 0;
+      part[1].depth = depth + 1;
+      part[2].array = array + gt;
+      part[2].n = n - gt;
+      part[2].depth = depth;
+
+      /* Recurse on the smaller parts, which keeps the recursion depth
+	 logarithmic, and loop on the largest.  */
+      largest = 0;
+      for (i = 1; i < 3; i++)
+	if (part[i].n > part[largest].n)
+	  largest = i;
+      for (i = 0; i < 3; i++)
+	if (i != largest)
+	  strrev_sort (part[i].array, part[i].n, part[i].depth);
+      array = part[largest].array;
+      n = part[largest].n;
+      depth = part[largest].depth;
+    }
+}
+
 static inline int
 is_suffix (const struct elf_strtab_hash_entry *A,
 	   const struct elf_strtab_hash_entry *B)
@@ -412,7 +529,7 @@ _bfd_elf_strtab_finalize (struct elf_strtab_hash *tab)
   size = a - array;
   if (size != 0)
     {
-      qsort (array, size, sizeof (struct elf_strtab_hash_entry *), strrevcmp);
+      strrev_sort (array, size, 0);
 
       /* Loop over the sorted array and merge suffixes.  Start from the
 	 end because we want eg.
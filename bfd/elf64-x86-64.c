@@ -2650,6 +2650,152 @@ elf_x86_64_tpoff (struct bfd_link_info *info, bfd_vma address)
   return address - static_tls_size - htab->tls_sec->vma;
 }
 
+/* Return TRUE if INPUT_SECTION may be relocated in parallel with the
+   sections of other input files: none of its relocations uses the GOT,
+   an IFUNC symbol or a dynamic relocation, or calls back into the
+   linker for an undefined symbol.  */
+
+static bool
+elf_x86_64_parallel_relocate_p (bfd *output_bfd,
+				struct bfd_link_info *info,
+				bfd *input_bfd,
+				asection *input_section,
+				const Elf_Internal_Rela *relocs,
+				const Elf_Internal_Sym *local_syms,
+				asection **local_sections)
+{
+  struct elf_x86_link_hash_table *htab;
+  Elf_Internal_Shdr *symtab_hdr;
+  struct elf_link_hash_entry **sym_hashes;
+  const Elf_Internal_Rela *rel, *relend;
+
+  if (input_section->check_relocs_failed)
+    return false;
+
+  htab = elf_x86_hash_table (info, X86_64_ELF_DATA);
+  if (htab == NULL || !is_x86_elf (input_bfd, htab))
+    return false;
+
+  if (info->wrap_hash != NULL
+      && (input_section->flags & SEC_DEBUGGING) != 0)
+    return false;
+
+  /* elf_x86_64_relocate_section sets the TLS module base each time it
+     is called.  Do it now, so that it is only read from then on.  */
+  _bfd_x86_elf_set_tls_module_base (info);
+
+  symtab_hdr = &elf_symtab_hdr (input_bfd);
+  sym_hashes = elf_sym_hashes (input_bfd);
+
+  relend = relocs + input_section->reloc_count;
+  for (rel = relocs; rel < relend; rel++)
+    {
+      unsigned int r_type;
+      unsigned long r_symndx;
+      struct elf_link_hash_entry *h;
+      struct elf_x86_link_hash_entry *eh;
+      asection *sec;
+      bool need_copy_reloc_in_pie;
+      bool resolved_to_zero;
+
+      r_type = ELF32_R_TYPE (rel->r_info) & ~R_X86_64_converted_reloc_bit;
+      if (r_type == (int) R_X86_64_GNU_VTINHERIT
+	  || r_type == (int) R_X86_64_GNU_VTENTRY
+	  || r_type == (int) R_X86_64_NONE)
+	continue;
+
+      r_symndx = htab->r_sym (rel->r_info);
+      if (r_symndx < symtab_hdr->sh_info)
+	{
+	  if (ELF_ST_TYPE (local_syms[r_symndx].st_info) == STT_GNU_IFUNC)
+	    return false;
+	  h = NULL;
+	  sec = local_sections[r_symndx];
+	}
+      else
+	{
+	  if (sym_hashes == NULL)
+	    return false;
+	  h = sym_hashes[r_symndx - symtab_hdr->sh_info];
+	  if (h == NULL)
+	    return false;
+	  while (h->root.type == bfd_link_hash_indirect
+		 || h->root.type == bfd_link_hash_warning)
+	    h = (struct elf_link_hash_entry *) h->root.u.i.link;
+	  if (h->type == STT_GNU_IFUNC)
+	    return false;
+	  if (h->root.type == bfd_link_hash_defined
+	      || h->root.type == bfd_link_hash_defweak)
+	    sec = h->root.u.def.section;
+	  else if (h->root.type == bfd_link_hash_undefweak)
+	    sec = NULL;
+	  else
+	    return false;
+	}
+
+      if (rel->r_addend == 0 && !ABI_64_P (output_bfd))
+	{
+	  if (r_type == R_X86_64_64)
+	    r_type = R_X86_64_32;
+	  else if (r_type == R_X86_64_SIZE64)
+	    r_type = R_X86_64_SIZE32;
+	}
+
+      switch (r_type)
+	{
+	case R_X86_64_PLT32:
+	case R_X86_64_32S:
+	case R_X86_64_GOTOFF64:
+	case R_X86_64_GOTPC32:
+	case R_X86_64_GOTPC64:
+	case R_X86_64_PLTOFF64:
+	case R_X86_64_DTPOFF32:
+	case R_X86_64_DTPOFF64:
+	case R_X86_64_TPOFF32:
+	case R_X86_64_TPOFF64:
+	  break;
+
+	case R_X86_64_8:
+	case R_X86_64_16:
+	case R_X86_64_32:
+	case R_X86_64_64:
+	case R_X86_64_PC8:
+	case R_X86_64_PC16:
+	case R_X86_64_PC32:
+	case R_X86_64_PC64:
+	case R_X86_64_SIZE32:
+	case R_X86_64_SIZE64:
+	  if ((input_section->flags & SEC_ALLOC) == 0)
+	    break;
+
+	  /* Reject the relocations for which elf_x86_64_relocate_section
+	     would emit a dynamic relocation.  */
+	  eh = (struct elf_x86_link_hash_entry *) h;
+	  resolved_to_zero = (eh != NULL
+			      && UNDEFINED_WEAK_RESOLVED_TO_ZERO (info, eh));
+	  need_copy_reloc_in_pie = (bfd_link_pie (info)
+				    && h != NULL
+				    && (h->needs_copy
+					|| eh->needs_copy
+					|| (h->root.type
+					    == bfd_link_hash_undefined))
+				    && (X86_PCREL_TYPE_P (true, r_type)
+					|| X86_SIZE_TYPE_P (true,
+							    r_type)));
+	  if (GENERATE_DYNAMIC_RELOCATION_P (true, info, eh, r_type, sec,
+					     need_copy_reloc_in_pie,
+					     resolved_to_zero, false))
+	    return false;
+	  break;
+
+	default:
+	  return false;
+	}
+    }
+
+  return true;
+}
+
 /* Relocate an x86_64 ELF section.  */
 
 static int
@@ -5758,6 +5904,7 @@ elf_x86_64_special_sections[]=
 #endif
 #define elf_backend_reloc_type_class	    elf_x86_64_reloc_type_class
 #define elf_backend_relocate_section	    elf_x86_64_relocate_section
+#define elf_backend_parallel_relocate_p	    elf_x86_64_parallel_relocate_p
 #define elf_backend_init_index_section	    _bfd_elf_init_1_index_section
 #define elf_backend_object_p		    elf64_x86_64_elf_object_p
 #define bfd_elf64_get_synthetic_symtab	    elf_x86_64_get_synthetic_symtab
@@ -8928,6 +8928,50 @@ _bfd_elf_match_sections_by_type (bfd *abfd, const asection *asec,
 
 /* Final phase of ELF linker.  */
 
+/* An input section whose relocation has been deferred, so that it can
+   be relocated in parallel with the sections of other input files.  */
+
+struct elf_deferred_section
+{
+  /* The input section.  */
+  asection *sec;
+  /* Its contents, and whether they were read just for this section.  */
+  bfd_byte *contents;
+  bool free_contents;
+  /* Its relocs, and whether they were read just for this section.  */
+  Elf_Internal_Rela *relocs;
+  bool free_relocs;
+  /* If not NULL, the sections of local symbols as they were when this
+     section was deferred, used instead of those of the input file.
+     Set if this section is the last user of the copy.  */
+  asection **sections;
+  bool free_sections;
+};
+
+/* The deferred sections of an input file.  */
+
+struct elf_deferred_input
+{
+  /* The input file.  */
+  bfd *input_bfd;
+  /* Its local symbols and their sections, copied out of the buffers in
+     elf_final_link_info once the input file has been processed.  */
+  Elf_Internal_Sym *isymbuf;
+  asection **sections;
+  bool free_isymbuf;
+  /* The deferred sections, in the order in which they were seen.  */
+  struct elf_deferred_section *secs;
+  size_t count;
+  size_t alloc;
+  /* Set if relocating a section failed, along with the BFD error.  */
+  bool failed;
+  bfd_error_type error;
+};
+
+/* Relocate the deferred sections once they hold this many bytes of
+   section contents and relocs.  */
+#define ELF_DEFERRED_RELOC_SIZE (64 * 1024 * 1024)
+
 /* A structure we use to avoid passing large numbers of arguments.  */
 
 struct elf_final_link_info
@@ -8968,6 +9012,17 @@ struct elf_final_link_info
   size_t filesym_count;
   /* Local symbol hash table.  */
   struct bfd_hash_table local_hash_table;
+  /* Input files with deferred sections, and the number of bytes of
+     section contents and relocs held for them.  */
+  struct elf_deferred_input *deferred;
+  size_t deferred_count;
+  size_t deferred_alloc;
+  bfd_size_type deferred_size;
+  /* The start of the output file mapped into memory, or NULL, and the
+     size of the mapping.  Input sections which are simply copied to
+     the output are relocated in place there.  */
+  bfd_byte *output_map;
+  size_t output_map_size;
 };
 
 struct local_hash_entry
@@ -11285,6 +11340,424 @@ _bfd_elf_check_kept_section (asection *sec, struct bfd_link_info *info)
   return kept;
 }
 
+/* Map the part of the output file holding the contents of output
+   sections, if possible and not disabled by --no-mmap-output.  */
+
+static void
+elf_link_map_output (struct elf_final_link_info *flinfo)
+{
+#ifdef USE_MMAP
+  bfd *output_bfd = flinfo->output_bfd;
+  ufile_ptr end = 0;
+  asection *o;
+
+  if (!flinfo->info->mmap_output)
+    return;
+
+  for (o = output_bfd->sections; o != NULL; o = o->next)
+    {
+      Elf_Internal_Shdr *hdr = &elf_section_data (o)->this_hdr;
+
+      if ((o->flags & SEC_HAS_CONTENTS) != 0
+	  && hdr->sh_type != SHT_NOBITS
+	  && hdr->sh_offset != (file_ptr) -1
+	  && end < (ufile_ptr) o->filepos + o->size)
+	end = o->filepos + o->size;
+    }
+
+  if (end != 0)
+    flinfo->output_map = _bfd_mmap_output (output_bfd, end,
+					   &flinfo->output_map_size);
+#else
+  (void) flinfo;
+#endif
+}
+
+/* Unmap the output file.  Everything written through the mapping
+   stays in the file.  */
+
+static void
+elf_link_unmap_output (struct elf_final_link_info *flinfo)
+{
+#ifdef USE_MMAP
+  if (flinfo->output_map != NULL)
+    munmap (flinfo->output_map, flinfo->output_map_size);
+#endif
+  flinfo->output_map = NULL;
+  flinfo->output_map_size = 0;
+}
+
+/* Return where the contents of input section O go in the mapped
+   output file, if they may be read and relocated there in place, or
+   NULL if they must be written out once relocated.  */
+
+static bfd_byte *
+elf_link_output_contents (struct elf_final_link_info *flinfo, asection *o)
+{
+  bfd *output_bfd = flinfo->output_bfd;
+  asection *osec = o->output_section;
+  Elf_Internal_Shdr *hdr;
+  bfd_size_type offset;
+
+  if (flinfo->output_map == NULL
+      || (o->flags & (SEC_EXCLUDE | SEC_ELF_REVERSE_COPY)) != 0
+      || o->sec_info_type != SEC_INFO_TYPE_NONE
+      || (o->rawsize != 0 && o->rawsize != o->size)
+      || osec == NULL
+      || osec->owner != output_bfd
+      || get_elf_backend_data (output_bfd)->elf_backend_write_section)
+    return NULL;
+
+  hdr = &elf_section_data (osec)->this_hdr;
+  if (hdr->sh_type == SHT_NOBITS || hdr->sh_offset == (file_ptr) -1)
+    return NULL;
+
+  offset = (osec->filepos
+	    + o->output_offset * bfd_octets_per_byte (output_bfd, o));
+  if (offset > flinfo->output_map_size
+      || flinfo->output_map_size - offset < o->size)
+    return NULL;
+  return flinfo->output_map + offset;
+}
+
+/* Write out the contents of input section O, which do not need any
+   special treatment, to the output file.  */
+
+static bool
+elf_link_write_section_contents (struct elf_final_link_info *flinfo,
+				 bfd *input_bfd, asection *o,
+				 bfd_byte *contents)
+{
+  bfd *output_bfd = flinfo->output_bfd;
+  const struct elf_backend_data *bed = get_elf_backend_data (output_bfd);
+  bfd_size_type address_size = bed->s->arch_size / 8;
+  file_ptr offset = (file_ptr) o->output_offset;
+  bfd_size_type todo = o->size;
+
+  if ((o->flags & SEC_EXCLUDE) != 0)
+    return true;
+
+  /* Contents relocated in the mapped output file are already there.  */
+  if (flinfo->output_map != NULL
+      && contents >= flinfo->output_map
+      && contents < flinfo->output_map + flinfo->output_map_size)
+    return true;
+
+  offset *= bfd_octets_per_byte (output_bfd, o);
+
+  if ((o->flags & SEC_ELF_REVERSE_COPY)
+      && o->size > address_size)
+    {
+      /* Reverse-copy input section to output.  */
+
+      if ((o->size & (address_size - 1)) != 0
+	  || (o->reloc_count != 0
+	      && (o->size * bed->s->int_rels_per_ext_rel
+		  != o->reloc_count * address_size)))
+	{
+	  _bfd_error_handler
+	    /* xgettext:c-format */
+	    (_("error: %pB: size of section %pA is not "
+	       "multiple of address size"),
+	     input_bfd, o);
+	  bfd_set_error (bfd_error_bad_value);
+	  return false;
+	}
+
+      do
+	{
+	  todo -= address_size;
+	  if (! bfd_set_section_contents (output_bfd,
+					  o->output_section,
+					  contents + todo,
+					  offset,
+					  address_size))
+	    return false;
+	  if (todo == 0)
+	    break;
+	  offset += address_size;
+	}
+      while (1);
+    }
+  else if (! bfd_set_section_contents (output_bfd,
+				       o->output_section,
+				       contents,
+				       offset, todo))
+    return false;
+
+  return true;
+}
+
+/* Release the contents of input section O once they have been written
+   out.  FREE_CONTENTS is true if CONTENTS were read just for O.  */
+
+static void
+elf_link_release_section_contents (asection *o, bfd_byte *contents,
+				   bool free_contents)
+{
+  if (free_contents)
+    _bfd_elf_munmap_section_contents (o, contents);
+  else
+    _bfd_elf_link_munmap_section_contents (o);
+}
+
+/* Return TRUE if the sections of input files may be relocated in
+   parallel.  */
+
+static bool
+elf_link_parallel_relocate_p (struct elf_final_link_info *flinfo)
+{
+  struct bfd_link_info *info = flinfo->info;
+  const struct elf_backend_data *bed;
+
+  bed = get_elf_backend_data (flinfo->output_bfd);
+  return (info->threads > 1
+	  && info->callbacks->parallel_run != NULL
+	  && bed->elf_backend_parallel_relocate_p != NULL
+	  && !bfd_link_relocatable (info)
+	  && !info->emitrelocations);
+}
+
+/* Defer the relocation of input section O of INPUT_BFD.  */
+
+static bool
+elf_link_defer_section (struct elf_final_link_info *flinfo,
+			bfd *input_bfd, Elf_Internal_Sym *isymbuf,
+			asection *o, bfd_byte *contents, bool free_contents,
+			Elf_Internal_Rela *relocs, bool free_relocs)
+{
+  struct elf_deferred_input *d;
+  struct elf_deferred_section *ds;
+
+  d = NULL;
+  if (flinfo->deferred_count != 0
+      && flinfo->deferred[flinfo->deferred_count - 1].input_bfd == input_bfd)
+    d = &flinfo->deferred[flinfo->deferred_count - 1];
+  else
+    {
+      if (flinfo->deferred_count == flinfo->deferred_alloc)
+	{
+	  size_t alloc = flinfo->deferred_alloc * 2 + 16;
+	  d = bfd_realloc (flinfo->deferred, alloc * sizeof (*d));
+	  if (d == NULL)
+	    return false;
+	  flinfo->deferred = d;
+	  flinfo->deferred_alloc = alloc;
+	}
+      d = &flinfo->deferred[flinfo->deferred_count++];
+      memset (d, 0, sizeof (*d));
+      d->input_bfd = input_bfd;
+      d->isymbuf = isymbuf;
+      d->sections = flinfo->sections;
+    }
+
+  if (d->count == d->alloc)
+    {
+      size_t alloc = d->alloc * 2 + 4;
+      ds = bfd_realloc (d->secs, alloc * sizeof (*ds));
+      if (ds == NULL)
+	return false;
+      d->secs = ds;
+      d->alloc = alloc;
+    }
+  ds = &d->secs[d->count++];
+  ds->sec = o;
+  ds->contents = contents;
+  ds->free_contents = free_contents;
+  ds->relocs = relocs;
+  ds->free_relocs = free_relocs;
+  ds->sections = NULL;
+  ds->free_sections = false;
+
+  flinfo->deferred_size += (o->size
+			    + o->reloc_count * sizeof (Elf_Internal_Rela));
+  return true;
+}
+
+/* Called once all of the sections of INPUT_BFD have been seen.  Copy
+   out the local symbols and their sections if any section of
+   INPUT_BFD was deferred, since the buffers holding them are about to
+   be reused.  */
+
+static bool
+elf_link_finish_deferred_input (struct elf_final_link_info *flinfo,
+				bfd *input_bfd, size_t locsymcount)
+{
+  struct elf_deferred_input *d;
+
+  if (flinfo->deferred_count == 0)
+    return true;
+
+  d = &flinfo->deferred[flinfo->deferred_count - 1];
+  if (d->input_bfd == input_bfd && locsymcount != 0)
+    {
+      asection **sections;
+
+      if (d->isymbuf == flinfo->internal_syms)
+	{
+	  Elf_Internal_Sym *isymbuf;
+
+	  isymbuf = bfd_malloc (locsymcount * sizeof (*isymbuf));
+	  if (isymbuf == NULL)
+	    return false;
+	  memcpy (isymbuf, d->isymbuf, locsymcount * sizeof (*isymbuf));
+	  d->isymbuf = isymbuf;
+	  d->free_isymbuf = true;
+	}
+
+      sections = bfd_malloc (locsymcount * sizeof (*sections));
+      if (sections == NULL)
+	return false;
+      memcpy (sections, d->sections, locsymcount * sizeof (*sections));
+      d->sections = sections;
+    }
+
+  return true;
+}
+
+/* Called before the section of a local symbol of INPUT_BFD is changed.
+   Give the sections of INPUT_BFD deferred since the last such change
+   a copy of the local symbol sections as they were.  */
+
+static bool
+elf_link_copy_deferred_sections (struct elf_final_link_info *flinfo,
+				 bfd *input_bfd, size_t locsymcount)
+{
+  struct elf_deferred_input *d;
+  asection **sections;
+  size_t i;
+
+  if (flinfo->deferred_count == 0)
+    return true;
+
+  d = &flinfo->deferred[flinfo->deferred_count - 1];
+  if (d->input_bfd != input_bfd)
+    return true;
+
+  i = d->count;
+  while (i > 0 && d->secs[i - 1].sections == NULL)
+    i--;
+  if (i == d->count)
+    return true;
+
+  sections = bfd_malloc (locsymcount * sizeof (*sections));
+  if (sections == NULL)
+    return false;
+  memcpy (sections, flinfo->sections, locsymcount * sizeof (*sections));
+  for (; i < d->count; i++)
+    d->secs[i].sections = sections;
+  d->secs[d->count - 1].free_sections = true;
+  return true;
+}
+
+/* Free the buffers held for the deferred sections of D.  */
+
+static void
+elf_link_release_deferred_input (struct elf_final_link_info *flinfo,
+				 struct elf_deferred_input *d)
+{
+  size_t i;
+
+  for (i = 0; i < d->count; i++)
+    {
+      struct elf_deferred_section *ds = &d->secs[i];
+
+      elf_link_release_section_contents (ds->sec, ds->contents,
+					 ds->free_contents);
+      if (ds->free_relocs)
+	free (ds->relocs);
+      if (ds->free_sections)
+	free (ds->sections);
+    }
+  free (d->secs);
+  if (d->free_isymbuf)
+    free (d->isymbuf);
+  if (d->sections != flinfo->sections)
+    free (d->sections);
+}
+
+/* Relocate the deferred sections of the Ith input file.  This may be
+   called from several threads at once, for different input files.  */
+
+static void
+elf_link_relocate_deferred (void *data, size_t i)
+{
+  struct elf_final_link_info *flinfo = (struct elf_final_link_info *) data;
+  struct elf_deferred_input *d = &flinfo->deferred[i];
+  const struct elf_backend_data *bed;
+  size_t j;
+
+  bed = get_elf_backend_data (flinfo->output_bfd);
+  for (j = 0; j < d->count; j++)
+    {
+      struct elf_deferred_section *ds = &d->secs[j];
+      asection **sections;
+
+      sections = ds->sections != NULL ? ds->sections : d->sections;
+      if (! (*bed->elf_backend_relocate_section) (flinfo->output_bfd,
+						  flinfo->info,
+						  d->input_bfd, ds->sec,
+						  ds->contents, ds->relocs,
+						  d->isymbuf, sections))
+	{
+	  d->failed = true;
+	  d->error = bfd_get_error ();
+	  return;
+	}
+    }
+}
+
+/* Relocate the deferred sections, with the input files shared out
+   among threads, then write them out in the order in which they were
+   deferred.  */
+
+static bool
+elf_link_flush_deferred (struct elf_final_link_info *flinfo)
+{
+  bool ret = true;
+  size_t i, j;
+
+  if (flinfo->deferred_count == 0)
+    return true;
+
+  (*flinfo->info->callbacks->parallel_run) (flinfo->info,
+					    elf_link_relocate_deferred,
+					    flinfo, flinfo->deferred_count);
+
+  for (i = 0; i < flinfo->deferred_count; i++)
+    {
+      struct elf_deferred_input *d = &flinfo->deferred[i];
+
+      if (ret && d->failed)
+	{
+	  bfd_set_error (d->error);
+	  ret = false;
+	}
+      for (j = 0; ret && j < d->count; j++)
+	if (!elf_link_write_section_contents (flinfo, d->input_bfd,
+					      d->secs[j].sec,
+					      d->secs[j].contents))
+	  ret = false;
+      elf_link_release_deferred_input (flinfo, d);
+    }
+
+  flinfo->deferred_count = 0;
+  flinfo->deferred_size = 0;
+  return ret;
+}
+
+/* Stop deferring the sections of the current input file, because it
+   is about to change data that the deferred sections may use.  */
+
+static bool
+elf_link_stop_deferring (struct elf_final_link_info *flinfo, bool *defer)
+{
+  if (!*defer)
+    return true;
+  *defer = false;
+  return elf_link_flush_deferred (flinfo);
+}
+
 /* Link an input file into the linker output file.  This function
    handles all the sections and relocations of the input file at once.
    This is so that we only have to read the local symbols once, and
@@ -11308,10 +11781,10 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
   asection *o;
   const struct elf_backend_data *bed;
   struct elf_link_hash_entry **sym_hashes;
-  bfd_size_type address_size;
   bfd_vma r_type_mask;
   int r_sym_shift;
   bool have_file_sym = false;
+  bool defer;
 
   output_bfd = flinfo->output_bfd;
   bed = get_elf_backend_data (output_bfd);
@@ -11357,6 +11830,15 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 	return false;
     }
 
+  /* Sections may be relocated in parallel with those of other input
+     files.  Their relocation may need the names of the local symbols,
+     so read those in now.  */
+  defer = (elf_link_parallel_relocate_p (flinfo)
+	   && !elf_bad_symtab (input_bfd)
+	   && (locsymcount == 0
+	       || bfd_elf_get_str_section (input_bfd,
+					   symtab_hdr->sh_link) != NULL));
+
   /* Find local symbol sections and adjust values of symbols in
      SEC_MERGE sections.  Write out those local symbols we know are
      going into the output file.  */
@@ -11532,13 +12014,11 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
     {
       r_type_mask = 0xff;
       r_sym_shift = 8;
-      address_size = 4;
     }
   else
     {
       r_type_mask = 0xffffffff;
       r_sym_shift = 32;
-      address_size = 8;
     }
 
   /* Relocate the contents of each section.  */
@@ -11546,6 +12026,10 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
   for (o = input_bfd->sections; o != NULL; o = o->next)
     {
       bfd_byte *contents;
+      bfd_byte *output_contents;
+      bool free_contents = false;
+      Elf_Internal_Rela *free_relocs = NULL;
+      bool deferrable;
 
       if (! o->linker_mark)
 	{
@@ -11630,6 +12114,18 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 	  continue;
 	}
 
+      /* Only sections which are simply copied to the output once
+	 relocated may be deferred.  */
+      deferrable = (defer
+		    && (o->flags & SEC_RELOC) != 0
+		    && o->reloc_count != 0
+		    && o->sec_info_type == SEC_INFO_TYPE_NONE
+		    && !bed->elf_backend_write_section);
+
+      /* If the output file is mapped, the section is read and
+	 relocated right where it goes in the output.  */
+      output_contents = elf_link_output_contents (flinfo, o);
+
       /* Get the contents of the section.  They have been cached by a
 	 relaxation routine.  Note that o is a section in an input
 	 file, so the contents field will not have been set by any of
@@ -11637,12 +12133,18 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
       if (elf_section_data (o)->this_hdr.contents != NULL)
 	{
 	  contents = elf_section_data (o)->this_hdr.contents;
-	  if (bed->caches_rawsize
-	      && o->rawsize != 0
-	      && o->rawsize < o->size)
+	  if (output_contents != NULL)
+	    {
+	      memcpy (output_contents, contents, o->size);
+	      contents = output_contents;
+	    }
+	  else if (bed->caches_rawsize
+		   && o->rawsize != 0
+		   && o->rawsize < o->size)
 	    {
 	      memcpy (flinfo->contents, contents, o->rawsize);
 	      contents = flinfo->contents;
+	      deferrable = false;
 	    }
 	}
       else if (!(o->flags & SEC_RELOC)
@@ -11652,6 +12154,21 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 	   contents anymore, they have been recorded earlier.  Except
 	   if the backend has special provisions for writing sections.  */
 	contents = NULL;
+      else if (output_contents != NULL)
+	{
+	  contents = output_contents;
+	  if (! bfd_get_full_section_contents (input_bfd, o, &contents))
+	    return false;
+	}
+      else if (deferrable)
+	{
+	  /* A deferred section is relocated after flinfo->contents has
+	     been reused, so it needs a buffer of its own.  */
+	  contents = NULL;
+	  if (! _bfd_elf_mmap_section_contents (input_bfd, o, &contents))
+	    return false;
+	  free_contents = true;
+	}
       else
 	{
 	  contents = flinfo->contents;
@@ -11671,11 +12188,16 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 	  internal_relocs
 	    = _bfd_elf_link_info_read_relocs (input_bfd, flinfo->info, o,
 					      flinfo->external_relocs,
-					      flinfo->internal_relocs,
+					      (deferrable
+					       ? NULL
+					       : flinfo->internal_relocs),
 					      false);
 	  if (internal_relocs == NULL
 	      && o->reloc_count > 0)
 	    return false;
+	  if (deferrable
+	      && internal_relocs != elf_section_data (o)->relocs)
+	    free_relocs = internal_relocs;
 
 	  action_discarded = -1;
 	  if (!elf_section_ignore_discarded_relocs (o))
@@ -11741,6 +12263,8 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 		      && (h->root.u.def.section->owner->flags
 			  & BFD_PLUGIN) != 0)
 		    {
+		      if (!elf_link_stop_deferring (flinfo, &defer))
+			return false;
 		      h->root.type = bfd_link_hash_undefined;
 		      h->root.u.undef.abfd = h->root.u.def.section->owner;
 		    }
@@ -11784,6 +12308,8 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 		    return false;
 
 		  /* Symbol evaluated OK.  Update to absolute value.  */
+		  if (!elf_link_stop_deferring (flinfo, &defer))
+		    return false;
 		  set_symbol_value (input_bfd, isymbuf, locsymcount,
 				    r_symndx, val);
 		  continue;
@@ -11817,6 +12343,18 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 							      flinfo->info);
 			  if (kept != NULL)
 			    {
+			      /* Changing the section of a local symbol
+				 only affects this input file.  */
+			      if (h == NULL)
+				{
+				  if (defer
+				      && !elf_link_copy_deferred_sections
+					   (flinfo, input_bfd, locsymcount))
+				    return false;
+				}
+			      else if (!elf_link_stop_deferring (flinfo,
+								 &defer))
+				return false;
 			      *ps = kept;
 			      continue;
 			    }
@@ -11843,7 +12381,28 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 	     must handle STB_LOCAL/STT_SECTION symbols specially.  The
 	     output symbol is going to be a section symbol
 	     corresponding to the output section, which will require
-	     the addend to be adjusted.  */
+	     the addend to be adjusted.
+
+	     If the back end allows it, the section is instead deferred
+	     to be relocated in parallel with the sections of other
+	     input files, and written out afterwards.  */
+
+	  if (deferrable
+	      && defer
+	      && (*bed->elf_backend_parallel_relocate_p) (output_bfd,
+							  flinfo->info,
+							  input_bfd, o,
+							  internal_relocs,
+							  isymbuf,
+							  flinfo->sections))
+	    {
+	      if (!elf_link_defer_section (flinfo, input_bfd, isymbuf, o,
+					   contents, free_contents,
+					   internal_relocs,
+					   free_relocs != NULL))
+		return false;
+	      continue;
+	    }
 
 	  ret = (*relocate_section) (output_bfd, flinfo->info,
 				     input_bfd, o, contents,
@@ -12163,62 +12722,24 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 	    }
 	    break;
 	default:
-	  {
-	    if (! (o->flags & SEC_EXCLUDE))
-	      {
-		file_ptr offset = (file_ptr) o->output_offset;
-		bfd_size_type todo = o->size;
-
-		offset *= bfd_octets_per_byte (output_bfd, o);
-
-		if ((o->flags & SEC_ELF_REVERSE_COPY)
-		    && o->size > address_size)
-		  {
-		    /* Reverse-copy input section to output.  */
-
-		    if ((o->size & (address_size - 1)) != 0
-			|| (o->reloc_count != 0
-			    && (o->size * bed->s->int_rels_per_ext_rel
-				!= o->reloc_count * address_size)))
-		      {
-			_bfd_error_handler
-			  /* xgettext:c-format */
-			  (_("error: %pB: size of section %pA is not "
-			     "multiple of address size"),
-			   input_bfd, o);
-			bfd_set_error (bfd_error_bad_value);
-			return false;
-		      }
-
-		    do
-		      {
-			todo -= address_size;
-			if (! bfd_set_section_contents (output_bfd,
-							o->output_section,
-							contents + todo,
-							offset,
-							address_size))
-			  return false;
-			if (todo == 0)
-			  break;
-			offset += address_size;
-		      }
-		    while (1);
-		  }
-		else if (! bfd_set_section_contents (output_bfd,
-						     o->output_section,
-						     contents,
-						     offset, todo))
-		  return false;
-	      }
-	  }
+	  if (! elf_link_write_section_contents (flinfo, input_bfd, o,
+						 contents))
+	    return false;
 	  break;
 	}
 
       /* Munmap the section contents for each input section.  */
-      _bfd_elf_link_munmap_section_contents (o);
+      elf_link_release_section_contents (o, contents, free_contents);
+      free (free_relocs);
     }
 
+  if (!elf_link_finish_deferred_input (flinfo, input_bfd, locsymcount))
+    return false;
+
+  /* Relocate the deferred sections once they hold enough memory.  */
+  if (flinfo->deferred_size >= ELF_DEFERRED_RELOC_SIZE)
+    return elf_link_flush_deferred (flinfo);
+
   return true;
 }
 
@@ -12509,9 +13030,14 @@ static void
 elf_final_link_free (bfd *obfd, struct elf_final_link_info *flinfo)
 {
   asection *o;
+  size_t i;
 
   if (flinfo->symstrtab != NULL)
     _bfd_elf_strtab_free (flinfo->symstrtab);
+  for (i = 0; i < flinfo->deferred_count; i++)
+    elf_link_release_deferred_input (flinfo, &flinfo->deferred[i]);
+  free (flinfo->deferred);
+  elf_link_unmap_output (flinfo);
   free (flinfo->contents);
   free (flinfo->external_relocs);
   free (flinfo->internal_relocs);
@@ -13091,6 +13617,8 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
      we could write the relocs out and then read them again; I don't
      know how bad the memory loss will be.  */
 
+  elf_link_map_output (&flinfo);
+
   for (sub = info->input_bfds; sub != NULL; sub = sub->link.next)
     sub->output_has_begun = false;
   for (o = abfd->sections; o != NULL; o = o->next)
@@ -13156,6 +13684,12 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
 	}
     }
 
+  /* Relocate and write out the sections which are still deferred.  */
+  if (! elf_link_flush_deferred (&flinfo))
+    goto error_return;
+
+  elf_link_unmap_output (&flinfo);
+
   /* Free symbol buffer if needed.  */
   if (!info->reduce_memory_overheads)
     {
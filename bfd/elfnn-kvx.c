@@ -332,6 +332,25 @@ kvx_valid_call_p (bfd_vma value, bfd_vma place)
 	  && offset >= KVX_MAX_BWD_CALL_OFFSET);
 }
 
+/* Return how far the branch REL of INPUT_SEC to DESTINATION is from
+   the limits of the PCREL27 range, negative if it is out of range.  */
+static bfd_signed_vma
+kvx_branch_slack (asection *input_sec, const Elf_Internal_Rela *rel,
+		  bfd_vma destination)
+{
+  bfd_vma location = (input_sec->output_offset
+		      + input_sec->output_section->vma + rel->r_offset);
+  bfd_signed_vma offset = (bfd_signed_vma) (destination - location);
+
+  if (offset >= 0)
+    return KVX_MAX_FWD_CALL_OFFSET - offset;
+  return offset - KVX_MAX_BWD_CALL_OFFSET;
+}
+
+/* After a layout change, only the branches whose slack was below this
+   when the relocations were last scanned are checked again.  */
+#define KVX_NEAR_BRANCH_MARGIN (1 << 20)
+
 /* Section name for stubs is the associated section name plus this
    string.  */
 #define STUB_SUFFIX ".stub"
@@ -342,11 +361,31 @@ enum elf_kvx_stub_type
   kvx_stub_long_branch,
 };
 
+/* What identifies a stub: the stub group it belongs to and the branch
+   destination, either a global symbol or a local symbol of a section, plus
+   the addend.  This is what the name of the stub in the stub hash table
+   encodes, but it is compared without formatting the name.  */
+
+struct elf_kvx_stub_key
+{
+  /* The id of the first section of the stub group.  */
+  unsigned int id_sec_id;
+  /* For a local symbol, the id of its section and its index.  */
+  unsigned int sym_sec_id;
+  unsigned int r_indx;
+  /* For a global symbol, its hash entry.  */
+  const struct elf_kvx_link_hash_entry *h;
+  bfd_vma addend;
+};
+
 struct elf_kvx_stub_hash_entry
 {
   /* Base hash table entry structure.  */
   struct bfd_hash_entry root;
 
+  /* The key of this stub in the stub index.  */
+  struct elf_kvx_stub_key key;
+
   /* The stub section.  */
   asection *stub_sec;
 
@@ -503,9 +542,12 @@ struct elf_kvx_link_hash_table
      section, plus whatever space is used by the jump slots.  */
   bfd_vma sgotplt_jump_table_size;
 
-  /* The stub hash table.  */
+  /* The stub hash table.  Stubs are sized and built in its order.  */
   struct bfd_hash_table stub_hash_table;
 
+  /* The stubs of STUB_HASH_TABLE indexed by their elf_kvx_stub_key.  */
+  htab_t stub_index;
+
   /* Linker stub bfd.  */
   bfd *stub_bfd;
 
@@ -522,6 +564,8 @@ struct elf_kvx_link_hash_table
     asection *link_sec;
     /* The stub section.  */
     asection *stub_sec;
+    /* Whether a stub group must end with this section.  */
+    bool group_end;
   } *stub_group;
 
   /* Assorted information used by elfNN_kvx_size_stubs.  */
@@ -599,6 +643,43 @@ stub_hash_newfunc (struct bfd_hash_entry *entry,
   return entry;
 }
 
+/* Hash and compare stub keys for the stub index.  Entries of the index
+   are stub hash entries, looked up by key.  */
+
+static hashval_t
+kvx_stub_key_hash (const struct elf_kvx_stub_key *key)
+{
+  hashval_t h = key->id_sec_id;
+
+  h = h * 31 + key->sym_sec_id;
+  h = h * 31 + key->r_indx;
+  h = h * 31 + htab_hash_pointer (key->h);
+  h = h * 31 + (hashval_t) key->addend;
+  h = h * 31 + (hashval_t) ((uint64_t) key->addend >> 32);
+  return h;
+}
+
+static hashval_t
+kvx_stub_index_hash (const void *entry)
+{
+  return kvx_stub_key_hash (&((const struct elf_kvx_stub_hash_entry *)
+			      entry)->key);
+}
+
+static int
+kvx_stub_index_eq (const void *entry, const void *key_ptr)
+{
+  const struct elf_kvx_stub_key *a
+    = &((const struct elf_kvx_stub_hash_entry *) entry)->key;
+  const struct elf_kvx_stub_key *b = key_ptr;
+
+  return (a->id_sec_id == b->id_sec_id
+	  && a->sym_sec_id == b->sym_sec_id
+	  && a->r_indx == b->r_indx
+	  && a->h == b->h
+	  && a->addend == b->addend);
+}
+
 /* Copy the extra info we tack onto an elf_link_hash_entry.  */
 
 static void
@@ -632,6 +713,8 @@ elfNN_kvx_link_hash_table_free (bfd *obfd)
   struct elf_kvx_link_hash_table *ret
     = (struct elf_kvx_link_hash_table *) obfd->link.hash;
 
+  if (ret->stub_index)
+    htab_delete (ret->stub_index);
   bfd_hash_table_free (&ret->stub_hash_table);
   _bfd_elf_link_hash_table_free (obfd);
 }
@@ -668,6 +751,15 @@ elfNN_kvx_link_hash_table_create (bfd *abfd)
       return NULL;
     }
 
+  ret->stub_index = htab_try_create (64, kvx_stub_index_hash,
+				     kvx_stub_index_eq, NULL);
+  if (ret->stub_index == NULL)
+    {
+      bfd_hash_table_free (&ret->stub_hash_table);
+      _bfd_elf_link_hash_table_free (abfd);
+      return NULL;
+    }
+
   ret->root.root.hash_table_free = elfNN_kvx_link_hash_table_free;
 
   return &ret->root.root;
@@ -725,26 +817,40 @@ kvx_type_of_stub (asection *input_sec,
   return stub_type;
 }
 
+/* Fill KEY for a branch from INPUT_SECTION, which is in the stub group
+   starting at ID_SEC, to its destination.  */
+
+static void
+elfNN_kvx_stub_key (struct elf_kvx_stub_key *key,
+		    const asection *id_sec,
+		    const asection *sym_sec,
+		    const struct elf_kvx_link_hash_entry *hash,
+		    const Elf_Internal_Rela *rel)
+{
+  key->id_sec_id = id_sec->id;
+  key->h = hash;
+  key->sym_sec_id = hash ? 0 : sym_sec->id;
+  key->r_indx = hash ? 0 : ELFNN_R_SYM (rel->r_info);
+  key->addend = rel->r_addend;
+}
+
 /* Build a name for an entry in the stub hash table.  */
 
 static char *
-elfNN_kvx_stub_name (const asection *input_section,
-		     const asection *sym_sec,
-		     const struct elf_kvx_link_hash_entry *hash,
-		     const Elf_Internal_Rela *rel)
+elfNN_kvx_stub_name (const struct elf_kvx_stub_key *key)
 {
   char *stub_name;
   bfd_size_type len;
 
-  if (hash)
+  if (key->h)
     {
-      len = 8 + 1 + strlen (hash->root.root.root.string) + 1 + 16 + 1;
+      len = 8 + 1 + strlen (key->h->root.root.root.string) + 1 + 16 + 1;
       stub_name = bfd_malloc (len);
       if (stub_name != NULL)
 	snprintf (stub_name, len, "%08x_%s+%" PRIx64 "x",
-		  (unsigned int) input_section->id,
-		  hash->root.root.root.string,
-		  (uint64_t) rel->r_addend);
+		  key->id_sec_id,
+		  key->h->root.root.root.string,
+		  (uint64_t) key->addend);
     }
   else
     {
@@ -752,15 +858,24 @@ elfNN_kvx_stub_name (const asection *input_section,
       stub_name = bfd_malloc (len);
       if (stub_name != NULL)
 	snprintf (stub_name, len, "%08x_%x:%x+%" PRIx64 "x",
-		  (unsigned int) input_section->id,
-		  (unsigned int) sym_sec->id,
-		  (unsigned int) ELFNN_R_SYM (rel->r_info),
-		  (uint64_t) rel->r_addend);
+		  key->id_sec_id,
+		  key->sym_sec_id,
+		  key->r_indx,
+		  (uint64_t) key->addend);
     }
 
   return stub_name;
 }
 
+/* Look up the stub identified by KEY.  */
+
+static struct elf_kvx_stub_hash_entry *
+kvx_stub_index_lookup (struct elf_kvx_link_hash_table *htab,
+		       const struct elf_kvx_stub_key *key)
+{
+  return htab_find_with_hash (htab->stub_index, key, kvx_stub_key_hash (key));
+}
+
 /* Return true if symbol H should be hashed in the `.gnu.hash' section.  For
    executable PLT slots where the executable never takes the address of those
    functions, the function symbols are not added to the hash table.  */
@@ -777,8 +892,7 @@ elf_kvx_hash_symbol (struct elf_link_hash_entry *h)
 }
 
 
-/* Look up an entry in the stub hash.  Stub entries are cached because
-   creating the stub name takes a bit of time.  */
+/* Look up an entry in the stub hash.  */
 
 static struct elf_kvx_stub_hash_entry *
 elfNN_kvx_get_stub_entry (const asection *input_section,
@@ -809,18 +923,12 @@ elfNN_kvx_get_stub_entry (const asection *input_section,
     }
   else
     {
-      char *stub_name;
-
-      stub_name = elfNN_kvx_stub_name (id_sec, sym_sec, h, rel);
-      if (stub_name == NULL)
-	return NULL;
+      struct elf_kvx_stub_key key;
 
-      stub_entry = kvx_stub_hash_lookup (&htab->stub_hash_table,
-					 stub_name, false, false);
+      elfNN_kvx_stub_key (&key, id_sec, sym_sec, h, rel);
+      stub_entry = kvx_stub_index_lookup (htab, &key);
       if (h != NULL)
 	h->stub_cache = stub_entry;
-
-      free (stub_name);
     }
 
   return stub_entry;
@@ -878,18 +986,20 @@ _bfd_kvx_create_or_find_stub_sec (asection *section,
 }
 
 
-/* Add a new stub entry in the stub group associated with an input
-   section to the stub hash.  Not all fields of the new stub entry are
-   initialised.  */
+/* Add a new stub entry identified by KEY in the stub group associated
+   with an input section to the stub hash.  Not all fields of the new stub
+   entry are initialised.  */
 
 static struct elf_kvx_stub_hash_entry *
-_bfd_kvx_add_stub_entry_in_group (const char *stub_name,
+_bfd_kvx_add_stub_entry_in_group (const struct elf_kvx_stub_key *key,
+				  const char *stub_name,
 				  asection *section,
 				  struct elf_kvx_link_hash_table *htab)
 {
   asection *link_sec;
   asection *stub_sec;
   struct elf_kvx_stub_hash_entry *stub_entry;
+  void **slot;
 
   link_sec = htab->stub_group[section->id].link_sec;
   stub_sec = _bfd_kvx_create_or_find_stub_sec (section, htab);
@@ -908,6 +1018,13 @@ _bfd_kvx_add_stub_entry_in_group (const char *stub_name,
   stub_entry->stub_sec = stub_sec;
   stub_entry->stub_offset = 0;
   stub_entry->id_sec = link_sec;
+  stub_entry->key = *key;
+
+  slot = htab_find_slot_with_hash (htab->stub_index, key,
+				   kvx_stub_key_hash (key), INSERT);
+  if (slot == NULL)
+    return NULL;
+  *slot = stub_entry;
 
   return stub_entry;
 }
@@ -1126,6 +1243,23 @@ elfNN_kvx_next_input_section (struct bfd_link_info *info, asection *isec)
     }
 }
 
+/* Force the stub group containing ISEC to end with ISEC, so that the
+   stubs for the group are placed right after it.  The linker calls
+   this after elfNN_kvx_setup_section_lists for the last section of
+   each cluster of functions it laid out together, which keeps the
+   long-branch stubs of hot code out of the cache lines of cold
+   code.  */
+
+void
+elfNN_kvx_end_stub_group (struct bfd_link_info *info, asection *isec)
+{
+  struct elf_kvx_link_hash_table *htab =
+    elf_kvx_hash_table (info);
+
+  if (htab->stub_group != NULL)
+    htab->stub_group[isec->id].group_end = true;
+}
+
 /* See whether we can group stub sections together.  Grouping stub
    sections may result in fewer stubs.  More importantly, we need to
    put all .init* and .fini* stubs at the beginning of the .init or
@@ -1173,7 +1307,8 @@ group_sections (struct elf_kvx_link_hash_table *htab,
 	  bfd_vma end_of_next;
 
 	  curr = head;
-	  while (NEXT_SEC (curr) != NULL)
+	  while (NEXT_SEC (curr) != NULL
+		 && !htab->stub_group[curr->id].group_end)
 	    {
 	      next = NEXT_SEC (curr);
 	      end_of_next = next->output_offset + next->size;
@@ -1201,7 +1336,8 @@ group_sections (struct elf_kvx_link_hash_table *htab,
 
 	  /* But wait, there's more!  Input sections up to stub_group_size
 	     bytes after the stub section can be handled by it too.  */
-	  if (!stubs_always_after_branch)
+	  if (!stubs_always_after_branch
+	      && !htab->stub_group[curr->id].group_end)
 	    {
 	      stub_group_start = curr->output_offset + curr->size;
 
@@ -1264,383 +1400,647 @@ kvx_elfNN_init_stub_bfd (struct bfd_link_info *info,
   return true;
 }
 
-/* Determine and set the size of the stub section for a final link.
+/* A branch found by kvx_scan_stub_candidates that needs a stub, with
+   what is needed to create the stub.  */
 
-   The basic idea here is to examine all the relocations looking for
-   PC-relative calls to a target that is unreachable with a 27bits
-   immediate (found in call and goto).  */
+struct kvx_stub_candidate
+{
+  struct elf_kvx_stub_key key;
+  enum elf_kvx_stub_type stub_type;
+  asection *sym_sec;
+  bfd_vma target_value;
+  struct elf_kvx_link_hash_entry *h;
+  unsigned char st_type;
+  const char *sym_name;
+};
 
-bool
-elfNN_kvx_size_stubs (bfd *output_bfd,
-		     bfd *stub_bfd,
-		     struct bfd_link_info *info,
-		     bfd_signed_vma group_size,
-		     asection * (*add_stub_section) (const char *,
-						     asection *),
-		     void (*layout_sections_again) (void))
+struct kvx_stub_candidates
 {
-  bfd_size_type stub_group_size;
-  bool stubs_always_before_branch;
-  bool stub_changed = false;
-  struct elf_kvx_link_hash_table *htab = elf_kvx_hash_table (info);
+  struct kvx_stub_candidate *list;
+  size_t count;
+  size_t size;
+};
 
-  /* Propagate mach to stub bfd, because it may not have been
-     finalized when we created stub_bfd.  */
-  bfd_set_arch_mach (stub_bfd, bfd_get_arch (output_bfd),
-		     bfd_get_mach (output_bfd));
+/* A branch that was within KVX_NEAR_BRANCH_MARGIN of the end of its
+   range when the relocations were last scanned.  Its destination is
+   DEST_OFFSET from the start of DEST_SEC.  */
 
-  /* Stash our params away.  */
-  htab->stub_bfd = stub_bfd;
-  htab->add_stub_section = add_stub_section;
-  htab->layout_sections_again = layout_sections_again;
-  stubs_always_before_branch = group_size < 0;
-  if (group_size < 0)
-    stub_group_size = -group_size;
-  else
-    stub_group_size = group_size;
+struct kvx_near_branch
+{
+  asection *section;
+  Elf_Internal_Rela rel;
+  asection *dest_sec;
+  bfd_vma dest_offset;
+  struct kvx_stub_candidate cand;
+};
 
-  if (stub_group_size == 1)
-    {
-      /* Default values.  */
-      /* KVX branch range is +-256MB. The value used is 1MB less.  */
-      stub_group_size = 255 * 1024 * 1024;
-    }
+struct kvx_near_branches
+{
+  struct kvx_near_branch *list;
+  size_t count;
+  size_t size;
+};
 
-  group_sections (htab, stub_group_size, stubs_always_before_branch);
+/* Append the branches of SECTION of INPUT_BFD that need a stub to
+   CANDIDATES, and those that are close to needing one to NEAR, in
+   relocation order.  This only reads the link hash table, the stub
+   table is updated by kvx_add_stub_candidate.  *LOCAL_SYMS caches the
+   local symbols of INPUT_BFD.  */
 
-  (*htab->layout_sections_again) ();
+static bool
+kvx_scan_stub_candidates (struct bfd_link_info *info,
+			  bfd *input_bfd,
+			  asection *section,
+			  Elf_Internal_Sym **local_syms,
+			  struct kvx_stub_candidates *candidates,
+			  struct kvx_near_branches *near)
+{
+  struct elf_kvx_link_hash_table *htab = elf_kvx_hash_table (info);
+  Elf_Internal_Shdr *symtab_hdr = &elf_tdata (input_bfd)->symtab_hdr;
+  Elf_Internal_Rela *internal_relocs, *irelaend, *irela;
+  const asection *id_sec;
 
-  while (1)
+  /* Get the relocs.  */
+  internal_relocs
+    = _bfd_elf_link_read_relocs (input_bfd, section, NULL,
+				 NULL, info->keep_memory);
+  if (internal_relocs == NULL)
+    return false;
+
+  /* Support for grouping stub sections.  */
+  id_sec = htab->stub_group[section->id].link_sec;
+
+  /* Now examine each relocation.  */
+  irela = internal_relocs;
+  irelaend = irela + section->reloc_count;
+  for (; irela < irelaend; irela++)
     {
-      bfd *input_bfd;
+      unsigned int r_type, r_indx;
+      enum elf_kvx_stub_type stub_type;
+      asection *sym_sec;
+      bfd_vma sym_value;
+      bfd_vma destination;
+      struct elf_kvx_link_hash_entry *hash;
+      const char *sym_name;
+      unsigned char st_type;
+      struct kvx_stub_candidate *cand;
+      asection *dest_sec;
+      bfd_vma dest_offset;
+
+      r_type = ELFNN_R_TYPE (irela->r_info);
+      r_indx = ELFNN_R_SYM (irela->r_info);
+
+      if (r_type >= (unsigned int) R_KVX_end)
+	{
+	  bfd_set_error (bfd_error_bad_value);
+	error_ret_free_internal:
+	  if (elf_section_data (section)->relocs == NULL)
+	    free (internal_relocs);
+	  return false;
+	}
+
+      /* Only look for stubs on unconditional branch and
+	 branch and link instructions.  */
+      /* This catches CALL and GOTO insn */
+      if (r_type != (unsigned int) R_KVX_PCREL27)
+	continue;
 
-      for (input_bfd = info->input_bfds;
-	   input_bfd != NULL; input_bfd = input_bfd->link.next)
+      /* Now determine the call target, its name, value,
+	 section.  */
+      sym_sec = NULL;
+      sym_value = 0;
+      destination = 0;
+      hash = NULL;
+      sym_name = NULL;
+      dest_sec = NULL;
+      dest_offset = 0;
+      if (r_indx < symtab_hdr->sh_info)
 	{
-	  Elf_Internal_Shdr *symtab_hdr;
-	  asection *section;
-	  Elf_Internal_Sym *local_syms = NULL;
+	  /* It's a local symbol.  */
+	  Elf_Internal_Sym *sym;
+	  Elf_Internal_Shdr *hdr;
 
-	  if (!is_kvx_elf (input_bfd)
-	      || (input_bfd->flags & BFD_LINKER_CREATED) != 0)
-	    continue;
+	  if (*local_syms == NULL)
+	    {
+	      *local_syms
+		= (Elf_Internal_Sym *) symtab_hdr->contents;
+	      if (*local_syms == NULL)
+		*local_syms
+		  = bfd_elf_get_elf_syms (input_bfd, symtab_hdr,
+					  symtab_hdr->sh_info, 0,
+					  NULL, NULL, NULL);
+	      if (*local_syms == NULL)
+		goto error_ret_free_internal;
+	    }
 
-	  /* We'll need the symbol table in a second.  */
-	  symtab_hdr = &elf_tdata (input_bfd)->symtab_hdr;
-	  if (symtab_hdr->sh_info == 0)
+	  sym = *local_syms + r_indx;
+	  hdr = elf_elfsections (input_bfd)[sym->st_shndx];
+	  sym_sec = hdr->bfd_section;
+	  if (!sym_sec)
+	    /* This is an undefined symbol.  It can never
+	       be resolved.  */
 	    continue;
 
-	  /* Walk over each section attached to the input bfd.  */
-	  for (section = input_bfd->sections;
-	       section != NULL; section = section->next)
-	    {
-	      Elf_Internal_Rela *internal_relocs, *irelaend, *irela;
+	  if (ELF_ST_TYPE (sym->st_info) != STT_SECTION)
+	    sym_value = sym->st_value;
+	  dest_sec = sym_sec;
+	  dest_offset = sym_value + irela->r_addend;
+	  destination = (dest_offset
+			 + sym_sec->output_offset
+			 + sym_sec->output_section->vma);
+	  st_type = ELF_ST_TYPE (sym->st_info);
+	  sym_name
+	    = bfd_elf_string_from_elf_section (input_bfd,
+					       symtab_hdr->sh_link,
+					       sym->st_name);
+	}
+      else
+	{
+	  int e_indx;
 
-	      /* If there aren't any relocs, then there's nothing more
-		 to do.  */
-	      if ((section->flags & SEC_RELOC) == 0
-		  || section->reloc_count == 0
-		  || (section->flags & SEC_CODE) == 0)
-		continue;
+	  e_indx = r_indx - symtab_hdr->sh_info;
+	  hash = ((struct elf_kvx_link_hash_entry *)
+		  elf_sym_hashes (input_bfd)[e_indx]);
 
-	      /* If this section is a link-once section that will be
-		 discarded, then don't create any stubs.  */
-	      if (section->output_section == NULL
-		  || section->output_section->owner != output_bfd)
-		continue;
+	  while (hash->root.root.type == bfd_link_hash_indirect
+		 || hash->root.root.type == bfd_link_hash_warning)
+	    hash = ((struct elf_kvx_link_hash_entry *)
+		    hash->root.root.u.i.link);
 
-	      /* Get the relocs.  */
-	      internal_relocs
-		= _bfd_elf_link_read_relocs (input_bfd, section, NULL,
-					     NULL, info->keep_memory);
-	      if (internal_relocs == NULL)
-		goto error_ret_free_local;
-
-	      /* Now examine each relocation.  */
-	      irela = internal_relocs;
-	      irelaend = irela + section->reloc_count;
-	      for (; irela < irelaend; irela++)
+	  if (hash->root.root.type == bfd_link_hash_defined
+	      || hash->root.root.type == bfd_link_hash_defweak)
+	    {
+	      sym_sec = hash->root.root.u.def.section;
+	      sym_value = hash->root.root.u.def.value;
+	      /* For a destination in a shared library,
+		 use the PLT stub as target address to
+		 decide whether a branch stub is
+		 needed.  */
+	      if (htab->root.splt != NULL && hash != NULL
+		  && hash->root.plt.offset != (bfd_vma) - 1)
 		{
-		  unsigned int r_type, r_indx;
-		  enum elf_kvx_stub_type stub_type;
-		  struct elf_kvx_stub_hash_entry *stub_entry;
-		  asection *sym_sec;
-		  bfd_vma sym_value;
-		  bfd_vma destination;
-		  struct elf_kvx_link_hash_entry *hash;
-		  const char *sym_name;
-		  char *stub_name;
-		  const asection *id_sec;
-		  unsigned char st_type;
-		  bfd_size_type len;
-
-		  r_type = ELFNN_R_TYPE (irela->r_info);
-		  r_indx = ELFNN_R_SYM (irela->r_info);
-
-		  if (r_type >= (unsigned int) R_KVX_end)
-		    {
-		      bfd_set_error (bfd_error_bad_value);
-		    error_ret_free_internal:
-		      if (elf_section_data (section)->relocs == NULL)
-			free (internal_relocs);
-		      goto error_ret_free_local;
-		    }
-
-		  /* Only look for stubs on unconditional branch and
-		     branch and link instructions.  */
-		  /* This catches CALL and GOTO insn */
-		  if (r_type != (unsigned int) R_KVX_PCREL27)
-		    continue;
-
-		  /* Now determine the call target, its name, value,
-		     section.  */
-		  sym_sec = NULL;
-		  sym_value = 0;
-		  destination = 0;
-		  hash = NULL;
-		  sym_name = NULL;
-		  if (r_indx < symtab_hdr->sh_info)
+		  sym_sec = htab->root.splt;
+		  sym_value = hash->root.plt.offset;
+		  if (sym_sec->output_section != NULL)
 		    {
-		      /* It's a local symbol.  */
-		      Elf_Internal_Sym *sym;
-		      Elf_Internal_Shdr *hdr;
-
-		      if (local_syms == NULL)
-			{
-			  local_syms
-			    = (Elf_Internal_Sym *) symtab_hdr->contents;
-			  if (local_syms == NULL)
-			    local_syms
-			      = bfd_elf_get_elf_syms (input_bfd, symtab_hdr,
-						      symtab_hdr->sh_info, 0,
-						      NULL, NULL, NULL);
-			  if (local_syms == NULL)
-			    goto error_ret_free_internal;
-			}
-
-		      sym = local_syms + r_indx;
-		      hdr = elf_elfsections (input_bfd)[sym->st_shndx];
-		      sym_sec = hdr->bfd_section;
-		      if (!sym_sec)
-			/* This is an undefined symbol.  It can never
-			   be resolved.  */
-			continue;
-
-		      if (ELF_ST_TYPE (sym->st_info) != STT_SECTION)
-			sym_value = sym->st_value;
-		      destination = (sym_value + irela->r_addend
+		      dest_sec = sym_sec;
+		      dest_offset = sym_value;
+		      destination = (sym_value
 				     + sym_sec->output_offset
 				     + sym_sec->output_section->vma);
-		      st_type = ELF_ST_TYPE (sym->st_info);
-		      sym_name
-			= bfd_elf_string_from_elf_section (input_bfd,
-							   symtab_hdr->sh_link,
-							   sym->st_name);
 		    }
-		  else
+		}
+	      else if (sym_sec->output_section != NULL)
+		{
+		  dest_sec = sym_sec;
+		  dest_offset = sym_value + irela->r_addend;
+		  destination = (dest_offset
+				 + sym_sec->output_offset
+				 + sym_sec->output_section->vma);
+		}
+	    }
+	  else if (hash->root.root.type == bfd_link_hash_undefined
+		   || (hash->root.root.type
+		       == bfd_link_hash_undefweak))
+	    {
+	      /* For a shared library, use the PLT stub as
+		 target address to decide whether a long
+		 branch stub is needed.
+		 For absolute code, they cannot be handled.  */
+	      if (htab->root.splt != NULL && hash != NULL
+		  && hash->root.plt.offset != (bfd_vma) - 1)
+		{
+		  sym_sec = htab->root.splt;
+		  sym_value = hash->root.plt.offset;
+		  if (sym_sec->output_section != NULL)
 		    {
-		      int e_indx;
-
-		      e_indx = r_indx - symtab_hdr->sh_info;
-		      hash = ((struct elf_kvx_link_hash_entry *)
-			      elf_sym_hashes (input_bfd)[e_indx]);
-
-		      while (hash->root.root.type == bfd_link_hash_indirect
-			     || hash->root.root.type == bfd_link_hash_warning)
-			hash = ((struct elf_kvx_link_hash_entry *)
-				hash->root.root.u.i.link);
-
-		      if (hash->root.root.type == bfd_link_hash_defined
-			  || hash->root.root.type == bfd_link_hash_defweak)
-			{
-			  struct elf_kvx_link_hash_table *globals =
-			    elf_kvx_hash_table (info);
-			  sym_sec = hash->root.root.u.def.section;
-			  sym_value = hash->root.root.u.def.value;
-			  /* For a destination in a shared library,
-			     use the PLT stub as target address to
-			     decide whether a branch stub is
-			     needed.  */
-			  if (globals->root.splt != NULL && hash != NULL
-			      && hash->root.plt.offset != (bfd_vma) - 1)
-			    {
-			      sym_sec = globals->root.splt;
-			      sym_value = hash->root.plt.offset;
-			      if (sym_sec->output_section != NULL)
-				destination = (sym_value
-					       + sym_sec->output_offset
-					       + sym_sec->output_section->vma);
-			    }
-			  else if (sym_sec->output_section != NULL)
-			    destination = (sym_value + irela->r_addend
-					   + sym_sec->output_offset
-					   + sym_sec->output_section->vma);
-			}
-		      else if (hash->root.root.type == bfd_link_hash_undefined
-			       || (hash->root.root.type
-				   == bfd_link_hash_undefweak))
-			{
-			  /* For a shared library, use the PLT stub as
-			     target address to decide whether a long
-			     branch stub is needed.
-			     For absolute code, they cannot be handled.  */
-			  struct elf_kvx_link_hash_table *globals =
-			    elf_kvx_hash_table (info);
-
-			  if (globals->root.splt != NULL && hash != NULL
-			      && hash->root.plt.offset != (bfd_vma) - 1)
-			    {
-			      sym_sec = globals->root.splt;
-			      sym_value = hash->root.plt.offset;
-			      if (sym_sec->output_section != NULL)
-				destination = (sym_value
-					       + sym_sec->output_offset
-					       + sym_sec->output_section->vma);
-			    }
-			  else
-			    continue;
-			}
-		      else
-			{
-			  bfd_set_error (bfd_error_bad_value);
-			  goto error_ret_free_internal;
-			}
-		      st_type = ELF_ST_TYPE (hash->root.type);
-		      sym_name = hash->root.root.root.string;
+		      dest_sec = sym_sec;
+		      dest_offset = sym_value;
+		      destination = (sym_value
+				     + sym_sec->output_offset
+				     + sym_sec->output_section->vma);
 		    }
+		}
+	      else
+		continue;
+	    }
+	  else
+	    {
+	      bfd_set_error (bfd_error_bad_value);
+	      goto error_ret_free_internal;
+	    }
+	  st_type = ELF_ST_TYPE (hash->root.type);
+	  sym_name = hash->root.root.root.string;
+	}
 
-		  /* Determine what (if any) linker stub is needed.  */
-		  stub_type = kvx_type_of_stub (section, irela, sym_sec,
-						st_type, destination);
-		  if (stub_type == kvx_stub_none)
-		    continue;
-
-		  /* Support for grouping stub sections.  */
-		  id_sec = htab->stub_group[section->id].link_sec;
-
-		  /* Get the name of this stub.  */
-		  stub_name = elfNN_kvx_stub_name (id_sec, sym_sec, hash,
-						  irela);
-		  if (!stub_name)
-		    goto error_ret_free_internal;
-
-		  stub_entry =
-		    kvx_stub_hash_lookup (&htab->stub_hash_table,
-					 stub_name, false, false);
-		  if (stub_entry != NULL)
-		    {
-		      /* The proper stub has already been created.  */
-		      free (stub_name);
-		      /* Always update this stub's target since it may have
-			 changed after layout.  */
-		      stub_entry->target_value = sym_value + irela->r_addend;
-		      continue;
-		    }
+      /* Determine what (if any) linker stub is needed.  */
+      stub_type = kvx_type_of_stub (section, irela, sym_sec,
+				    st_type, destination);
+      if (stub_type == kvx_stub_none)
+	{
+	  struct kvx_near_branch *branch;
+
+	  /* Remember the branches that may go out of range when stubs
+	     are added, unless their distance cannot change.  */
+	  if (dest_sec == NULL
+	      || (st_type != STT_FUNC && sym_sec == section)
+	      || (kvx_branch_slack (section, irela, destination)
+		  >= KVX_NEAR_BRANCH_MARGIN))
+	    continue;
 
-		  stub_entry = _bfd_kvx_add_stub_entry_in_group
-		    (stub_name, section, htab);
-		  if (stub_entry == NULL)
-		    {
-		      free (stub_name);
-		      goto error_ret_free_internal;
-		    }
+	  if (near->count == near->size)
+	    {
+	      size_t size = near->size ? 2 * near->size : 64;
+	      struct kvx_near_branch *list
+		= bfd_realloc (near->list, size * sizeof (*list));
+	      if (list == NULL)
+		goto error_ret_free_internal;
+	      near->list = list;
+	      near->size = size;
+	    }
 
-		  stub_entry->target_value = sym_value + irela->r_addend;
-		  stub_entry->target_section = sym_sec;
-		  stub_entry->stub_type = stub_type;
-		  stub_entry->h = hash;
-		  stub_entry->st_type = st_type;
-
-		  if (sym_name == NULL)
-		    sym_name = "unnamed";
-		  len = sizeof (STUB_ENTRY_NAME) + strlen (sym_name);
-		  stub_entry->output_name = bfd_alloc (htab->stub_bfd, len);
-		  if (stub_entry->output_name == NULL)
-		    {
-		      free (stub_name);
-		      goto error_ret_free_internal;
-		    }
+	  branch = &near->list[near->count++];
+	  branch->section = section;
+	  branch->rel = *irela;
+	  branch->dest_sec = dest_sec;
+	  branch->dest_offset = dest_offset;
+	  cand = &branch->cand;
+	  stub_type = kvx_stub_long_branch;
+	}
+      else
+	{
+	  if (candidates->count == candidates->size)
+	    {
+	      size_t size = candidates->size ? 2 * candidates->size : 64;
+	      struct kvx_stub_candidate *list
+		= bfd_realloc (candidates->list, size * sizeof (*list));
+	      if (list == NULL)
+		goto error_ret_free_internal;
+	      candidates->list = list;
+	      candidates->size = size;
+	    }
 
-		  snprintf (stub_entry->output_name, len, STUB_ENTRY_NAME,
-			    sym_name);
+	  cand = &candidates->list[candidates->count++];
+	}
 
-		  stub_changed = true;
-		}
+      elfNN_kvx_stub_key (&cand->key, id_sec, sym_sec, hash, irela);
+      cand->stub_type = stub_type;
+      cand->sym_sec = sym_sec;
+      cand->target_value = sym_value + irela->r_addend;
+      cand->h = hash;
+      cand->st_type = st_type;
+      cand->sym_name = sym_name;
+    }
 
-	      /* We're done with the internal relocs, free them.  */
-	      if (elf_section_data (section)->relocs == NULL)
-		free (internal_relocs);
-	    }
-	}
+  /* We're done with the internal relocs, free them.  */
+  if (elf_section_data (section)->relocs == NULL)
+    free (internal_relocs);
 
-      if (!stub_changed)
-	break;
+  return true;
+}
 
-      _bfd_kvx_resize_stubs (htab);
+/* Create the stub needed by CAND, found in SECTION, if it does not
+   exist yet, or else update its target.  Set *STUB_CHANGED if a stub
+   is created.  */
 
-      /* Ask the linker to do its stuff.  */
-      (*htab->layout_sections_again) ();
-      stub_changed = false;
+static bool
+kvx_add_stub_candidate (struct elf_kvx_link_hash_table *htab,
+			asection *section,
+			const struct kvx_stub_candidate *cand,
+			bool *stub_changed)
+{
+  struct elf_kvx_stub_hash_entry *stub_entry;
+  const char *sym_name;
+  char *stub_name;
+  bfd_size_type len;
+
+  stub_entry = kvx_stub_index_lookup (htab, &cand->key);
+  if (stub_entry != NULL)
+    {
+      /* The proper stub has already been created.  Always update
+	 this stub's target since it may have changed after
+	 layout.  */
+      stub_entry->target_value = cand->target_value;
+      return true;
     }
 
-  return true;
+  /* Get the name of this stub.  */
+  stub_name = elfNN_kvx_stub_name (&cand->key);
+  if (!stub_name)
+    return false;
 
-error_ret_free_local:
-  return false;
+  stub_entry = _bfd_kvx_add_stub_entry_in_group (&cand->key, stub_name,
+						 section, htab);
+  free (stub_name);
+  if (stub_entry == NULL)
+    return false;
+
+  stub_entry->target_value = cand->target_value;
+  stub_entry->target_section = cand->sym_sec;
+  stub_entry->stub_type = cand->stub_type;
+  stub_entry->h = cand->h;
+  stub_entry->st_type = cand->st_type;
+
+  sym_name = cand->sym_name;
+  if (sym_name == NULL)
+    sym_name = "unnamed";
+  len = sizeof (STUB_ENTRY_NAME) + strlen (sym_name);
+  stub_entry->output_name = bfd_alloc (htab->stub_bfd, len);
+  if (stub_entry->output_name == NULL)
+    return false;
+
+  snprintf (stub_entry->output_name, len, STUB_ENTRY_NAME,
+	    sym_name);
 
+  *stub_changed = true;
+  return true;
 }
 
-/* Build all the stubs associated with the current output file.  The
-   stubs are kept in a hash table attached to the main linker hash
-   table.  We also set up the .plt entries for statically linked PIC
-   functions here.  This function is called via kvx_elf_finish in the
-   linker.  */
+/* Examine the relocations of all the input sections, create the stubs
+   that they need and fill NEAR.  CANDIDATES is scratch space.  Set
+   *STUB_CHANGED if a stub is created.
 
-bool
-elfNN_kvx_build_stubs (struct bfd_link_info *info)
-{
-  asection *stub_sec;
-  struct bfd_hash_table *table;
-  struct elf_kvx_link_hash_table *htab;
+   Unlike the relocation of input sections, this is not shared out among
+   threads through the parallel_run callback.  Classifying a relocation
+   only takes a few comparisons; the rest of the time goes into reading
+   the relocations and local symbols.  Input files are only read on the
+   main thread: the members of an archive share its file, and
+   bfd_thread_init only locks each seek or read on its own, so threads
+   reading two members at once would read at each other's offsets.  */
 
-  htab = elf_kvx_hash_table (info);
+static bool
+kvx_scan_all_stub_candidates (bfd *output_bfd,
+			      struct bfd_link_info *info,
+			      struct kvx_stub_candidates *candidates,
+			      struct kvx_near_branches *near,
+			      bool *stub_changed)
+{
+  struct elf_kvx_link_hash_table *htab = elf_kvx_hash_table (info);
+  bfd *input_bfd;
 
-  for (stub_sec = htab->stub_bfd->sections;
-       stub_sec != NULL; stub_sec = stub_sec->next)
+  for (input_bfd = info->input_bfds;
+       input_bfd != NULL; input_bfd = input_bfd->link.next)
     {
-      bfd_size_type size;
+      Elf_Internal_Shdr *symtab_hdr;
+      asection *section;
+      Elf_Internal_Sym *local_syms = NULL;
 
-      /* Ignore non-stub sections.  */
-      if (!strstr (stub_sec->name, STUB_SUFFIX))
+      if (!is_kvx_elf (input_bfd)
+	  || (input_bfd->flags & BFD_LINKER_CREATED) != 0)
 	continue;
 
-      /* Allocate memory to hold the linker stubs.  */
-      size = stub_sec->size;
-      stub_sec->contents = bfd_zalloc (htab->stub_bfd, size);
-      if (stub_sec->contents == NULL && size != 0)
-	return false;
-      stub_sec->size = 0;
+      /* We'll need the symbol table in a second.  */
+      symtab_hdr = &elf_tdata (input_bfd)->symtab_hdr;
+      if (symtab_hdr->sh_info == 0)
+	continue;
+
+      /* Walk over each section attached to the input bfd.  */
+      for (section = input_bfd->sections;
+	   section != NULL; section = section->next)
+	{
+	  /* If there aren't any relocs, then there's nothing more
+	     to do.  */
+	  if ((section->flags & SEC_RELOC) == 0
+	      || section->reloc_count == 0
+	      || (section->flags & SEC_CODE) == 0)
+	    continue;
+
+	  /* If this section is a link-once section that will be
+	     discarded, then don't create any stubs.  */
+	  if (section->output_section == NULL
+	      || section->output_section->owner != output_bfd)
+	    continue;
+
+	  candidates->count = 0;
+	  if (!kvx_scan_stub_candidates (info, input_bfd, section,
+					 &local_syms, candidates, near))
+	    return false;
+	  for (size_t i = 0; i < candidates->count; i++)
+	    if (!kvx_add_stub_candidate (htab, section,
+					 &candidates->list[i],
+					 stub_changed))
+	      return false;
+	}
     }
 
-  /* Build the stubs as directed by the stub hash table.  */
-  table = &htab->stub_hash_table;
-  bfd_hash_traverse (table, kvx_build_one_stub, info);
+  return true;
+}
+
+/* Check the branches of NEAR again after a layout change, and create
+   the stubs that they now need.  */
+
+static bool
+kvx_check_near_branches (struct elf_kvx_link_hash_table *htab,
+			 const struct kvx_near_branches *near,
+			 bool *stub_changed)
+{
+  for (size_t i = 0; i < near->count; i++)
+    {
+      const struct kvx_near_branch *branch = &near->list[i];
+      bfd_vma destination = (branch->dest_offset
+			     + branch->dest_sec->output_offset
+			     + branch->dest_sec->output_section->vma);
+
+      if (kvx_type_of_stub (branch->section, &branch->rel,
+			    branch->cand.sym_sec, branch->cand.st_type,
+			    destination) == kvx_stub_none)
+	continue;
+
+      if (!kvx_add_stub_candidate (htab, branch->section, &branch->cand,
+				   stub_changed))
+	return false;
+    }
 
   return true;
 }
 
-static bfd_vma
-kvx_calculate_got_entry_vma (struct elf_link_hash_entry *h,
-				 struct elf_kvx_link_hash_table
-				 *globals, struct bfd_link_info *info,
-				 bfd_vma value, bfd *output_bfd,
-				 bool *unresolved_reloc_p)
+/* Return the total size of the stub sections.  */
+
+static bfd_size_type
+kvx_stub_sections_size (struct elf_kvx_link_hash_table *htab)
 {
-  bfd_vma off = (bfd_vma) - 1;
-  asection *basegot = globals->root.sgot;
-  bool dyn = globals->root.dynamic_sections_created;
+  bfd_size_type size = 0;
+  asection *section;
 
-  if (h != NULL)
+  for (section = htab->stub_bfd->sections;
+       section != NULL; section = section->next)
+    if (strstr (section->name, STUB_SUFFIX))
+      size += section->size;
+
+  return size;
+}
+
+/* Return the largest alignment that a layout change may have to
+   preserve: an address moves by at most the growth of the stub sections
+   laid out before it, rounded up to this.  */
+
+static bfd_vma
+kvx_layout_max_align (bfd *output_bfd, struct bfd_link_info *info,
+		      struct elf_kvx_link_hash_table *htab)
+{
+  bfd_vma align = info->maxpagesize;
+  asection *section;
+
+  for (section = output_bfd->sections;
+       section != NULL; section = section->next)
+    if (((bfd_vma) 1 << section->alignment_power) > align)
+      align = (bfd_vma) 1 << section->alignment_power;
+
+  for (section = htab->stub_bfd->sections;
+       section != NULL; section = section->next)
+    if (((bfd_vma) 1 << section->alignment_power) > align)
+      align = (bfd_vma) 1 << section->alignment_power;
+
+  return align;
+}
+
+/* Determine and set the size of the stub section for a final link.
+
+   The basic idea here is to examine all the relocations looking for
+   PC-relative calls to a target that is unreachable with a 27bits
+   immediate (found in call and goto).
+
+   Adding stubs moves the sections, so this is repeated until no new
+   stub is needed.  Stubs are never removed, and a layout change moves
+   the branches relative to their destination by no more than the
+   growth of the stub sections (rounded up to the largest alignment).
+   So as long as this growth is below KVX_NEAR_BRANCH_MARGIN, only the
+   branches that were that close to the end of their range need to be
+   checked again, and the relocations are not read again.  */
+
+bool
+elfNN_kvx_size_stubs (bfd *output_bfd,
+		     bfd *stub_bfd,
+		     struct bfd_link_info *info,
+		     bfd_signed_vma group_size,
+		     asection * (*add_stub_section) (const char *,
+						     asection *),
+		     void (*layout_sections_again) (void))
+{
+  bfd_size_type stub_group_size;
+  bool stubs_always_before_branch;
+  bool stub_changed = false;
+  struct elf_kvx_link_hash_table *htab = elf_kvx_hash_table (info);
+  struct kvx_stub_candidates candidates = { NULL, 0, 0 };
+  struct kvx_near_branches near = { NULL, 0, 0 };
+  bool rescan = true;
+  bfd_size_type scanned_stubs_size = 0;
+
+  /* Propagate mach to stub bfd, because it may not have been
+     finalized when we created stub_bfd.  */
+  bfd_set_arch_mach (stub_bfd, bfd_get_arch (output_bfd),
+		     bfd_get_mach (output_bfd));
+
+  /* Stash our params away.  */
+  htab->stub_bfd = stub_bfd;
+  htab->add_stub_section = add_stub_section;
+  htab->layout_sections_again = layout_sections_again;
+  stubs_always_before_branch = group_size < 0;
+  if (group_size < 0)
+    stub_group_size = -group_size;
+  else
+    stub_group_size = group_size;
+
+  if (stub_group_size == 1)
+    {
+      /* Default values.  */
+      /* KVX branch range is +-256MB. The value used is 1MB less.  */
+      stub_group_size = 255 * 1024 * 1024;
+    }
+
+  group_sections (htab, stub_group_size, stubs_always_before_branch);
+
+  (*htab->layout_sections_again) ();
+
+  while (1)
+    {
+      if (rescan)
+	{
+	  near.count = 0;
+	  scanned_stubs_size = kvx_stub_sections_size (htab);
+	  if (!kvx_scan_all_stub_candidates (output_bfd, info, &candidates,
+					     &near, &stub_changed))
+	    goto error_ret_free_local;
+	}
+      else if (!kvx_check_near_branches (htab, &near, &stub_changed))
+	goto error_ret_free_local;
+
+      if (!stub_changed)
+	break;
+
+      _bfd_kvx_resize_stubs (htab);
+
+      /* Ask the linker to do its stuff.  */
+      (*htab->layout_sections_again) ();
+      stub_changed = false;
+
+      rescan = (kvx_stub_sections_size (htab) - scanned_stubs_size
+		+ kvx_layout_max_align (output_bfd, info, htab)
+		>= KVX_NEAR_BRANCH_MARGIN);
+    }
+
+  free (candidates.list);
+  free (near.list);
+  return true;
+
+error_ret_free_local:
+  free (candidates.list);
+  free (near.list);
+  return false;
+
+}
+
+/* Build all the stubs associated with the current output file.  The
+   stubs are kept in a hash table attached to the main linker hash
+   table.  We also set up the .plt entries for statically linked PIC
+   functions here.  This function is called via kvx_elf_finish in the
+   linker.  */
+
+bool
+elfNN_kvx_build_stubs (struct bfd_link_info *info)
+{
+  asection *stub_sec;
+  struct bfd_hash_table *table;
+  struct elf_kvx_link_hash_table *htab;
+
+  htab = elf_kvx_hash_table (info);
+
+  for (stub_sec = htab->stub_bfd->sections;
+       stub_sec != NULL; stub_sec = stub_sec->next)
+    {
+      bfd_size_type size;
+
+      /* Ignore non-stub sections.  */
+      if (!strstr (stub_sec->name, STUB_SUFFIX))
+	continue;
+
+      /* Allocate memory to hold the linker stubs.  */
+      size = stub_sec->size;
+      stub_sec->contents = bfd_zalloc (htab->stub_bfd, size);
+      if (stub_sec->contents == NULL && size != 0)
+	return false;
+      stub_sec->size = 0;
+    }
+
+  /* Build the stubs as directed by the stub hash table.  */
+  table = &htab->stub_hash_table;
+  bfd_hash_traverse (table, kvx_build_one_stub, info);
+
+  return true;
+}
+
+static bfd_vma
+kvx_calculate_got_entry_vma (struct elf_link_hash_entry *h,
+				 struct elf_kvx_link_hash_table
+				 *globals, struct bfd_link_info *info,
+				 bfd_vma value, bfd *output_bfd,
+				 bool *unresolved_reloc_p)
+{
+  bfd_vma off = (bfd_vma) - 1;
+  asection *basegot = globals->root.sgot;
+  bool dyn = globals->root.dynamic_sections_created;
+
+  if (h != NULL)
     {
       BFD_ASSERT (basegot != NULL);
       off = h->got.offset;
@@ -2278,177 +2678,820 @@ elfNN_kvx_final_link_relocate (reloc_howto_type *howto,
     case BFD_RELOC_KVX_S37_TLS_GD_UP27:
     case BFD_RELOC_KVX_S37_TLS_GD_LO10:
 
-    case BFD_RELOC_KVX_S43_TLS_GD_UP27:
-    case BFD_RELOC_KVX_S43_TLS_GD_EX6:
-    case BFD_RELOC_KVX_S43_TLS_GD_LO10:
+    case BFD_RELOC_KVX_S43_TLS_GD_UP27:
+    case BFD_RELOC_KVX_S43_TLS_GD_EX6:
+    case BFD_RELOC_KVX_S43_TLS_GD_LO10:
+
+    case BFD_RELOC_KVX_S37_TLS_IE_UP27:
+    case BFD_RELOC_KVX_S37_TLS_IE_LO10:
+
+    case BFD_RELOC_KVX_S43_TLS_IE_UP27:
+    case BFD_RELOC_KVX_S43_TLS_IE_EX6:
+    case BFD_RELOC_KVX_S43_TLS_IE_LO10:
+
+    case BFD_RELOC_KVX_S37_TLS_LD_UP27:
+    case BFD_RELOC_KVX_S37_TLS_LD_LO10:
+
+    case BFD_RELOC_KVX_S43_TLS_LD_UP27:
+    case BFD_RELOC_KVX_S43_TLS_LD_EX6:
+    case BFD_RELOC_KVX_S43_TLS_LD_LO10:
+
+      if (globals->root.sgot == NULL)
+	return bfd_reloc_notsupported;
+      value = symbol_got_offset (input_bfd, h, r_symndx);
+
+      _bfd_final_link_relocate (howto, input_bfd, input_section,
+				contents, rel->r_offset, value, addend);
+      *unresolved_reloc_p = false;
+      break;
+
+    case BFD_RELOC_KVX_S37_GOTADDR_UP27:
+    case BFD_RELOC_KVX_S37_GOTADDR_LO10:
+
+    case BFD_RELOC_KVX_S43_GOTADDR_UP27:
+    case BFD_RELOC_KVX_S43_GOTADDR_EX6:
+    case BFD_RELOC_KVX_S43_GOTADDR_LO10:
+
+    case BFD_RELOC_KVX_S64_GOTADDR_UP27:
+    case BFD_RELOC_KVX_S64_GOTADDR_EX27:
+    case BFD_RELOC_KVX_S64_GOTADDR_LO10:
+      {
+	if (globals->root.sgot == NULL)
+	  BFD_ASSERT (h != NULL);
+
+	value = globals->root.sgot->output_section->vma
+	  + globals->root.sgot->output_offset;
+
+	return _bfd_final_link_relocate (howto, input_bfd, input_section,
+					 contents, rel->r_offset, value,
+					 addend);
+      }
+      break;
+
+    case BFD_RELOC_KVX_S37_GOTOFF_LO10:
+    case BFD_RELOC_KVX_S37_GOTOFF_UP27:
+
+    case BFD_RELOC_KVX_32_GOTOFF:
+    case BFD_RELOC_KVX_64_GOTOFF:
+
+    case BFD_RELOC_KVX_S43_GOTOFF_LO10:
+    case BFD_RELOC_KVX_S43_GOTOFF_UP27:
+    case BFD_RELOC_KVX_S43_GOTOFF_EX6:
+
+      {
+	asection *basegot = globals->root.sgot;
+	/* BFD_ASSERT(h == NULL); */
+	BFD_ASSERT(globals->root.sgot != NULL);
+	value -= basegot->output_section->vma + basegot->output_offset;
+	return _bfd_final_link_relocate (howto, input_bfd, input_section,
+					 contents, rel->r_offset, value,
+					 addend);
+      }
+      break;
+
+    case BFD_RELOC_KVX_S37_GOT_LO10:
+    case BFD_RELOC_KVX_S37_GOT_UP27:
+
+    case BFD_RELOC_KVX_32_GOT:
+    case BFD_RELOC_KVX_64_GOT:
+
+    case BFD_RELOC_KVX_S43_GOT_LO10:
+    case BFD_RELOC_KVX_S43_GOT_UP27:
+    case BFD_RELOC_KVX_S43_GOT_EX6:
+
+      if (globals->root.sgot == NULL)
+	BFD_ASSERT (h != NULL);
+
+      if (h != NULL)
+	{
+	  value = kvx_calculate_got_entry_vma (h, globals, info, value,
+					       output_bfd,
+					       unresolved_reloc_p);
+#ifdef UGLY_DEBUG
+	  printf("GOT_LO/HI for %s, value %x\n", h->root.root.string, value);
+#endif
+
+	  return _bfd_final_link_relocate (howto, input_bfd, input_section,
+					   contents, rel->r_offset, value,
+					   addend);
+	}
+      else
+	{
+#ifdef UGLY_DEBUG
+	  printf("GOT_LO/HI with h NULL, initial value %x\n", value);
+#endif
+	  struct elf_kvx_local_symbol *locals = elf_kvx_locals (input_bfd);
+
+	  if (locals == NULL)
+	    {
+	      int howto_index = bfd_r_type - BFD_RELOC_KVX_RELOC_START;
+	      _bfd_error_handler
+		/* xgettext:c-format */
+		(_("%pB: local symbol descriptor table be NULL when applying "
+		   "relocation %s against local symbol"),
+		 input_bfd, elf_kvx_howto_table[howto_index].name);
+	      abort ();
+	    }
+
+	  off = symbol_got_offset (input_bfd, h, r_symndx);
+	  base_got = globals->root.sgot;
+	  bfd_vma got_entry_addr = (base_got->output_section->vma
+				    + base_got->output_offset + off);
+
+	  if (!symbol_got_offset_mark_p (input_bfd, h, r_symndx))
+	    {
+	      bfd_put_64 (output_bfd, value, base_got->contents + off);
+
+	      if (bfd_link_pic (info))
+		{
+		  asection *s;
+		  Elf_Internal_Rela outrel;
+
+		  /* For PIC executables and shared libraries we need
+		     to relocate the GOT entry at run time.  */
+		  s = globals->root.srelgot;
+		  if (s == NULL)
+		    abort ();
+
+		  outrel.r_offset = got_entry_addr;
+		  outrel.r_info = ELFNN_R_INFO (0, R_KVX_RELATIVE);
+		  outrel.r_addend = value;
+		  elf_append_rela (output_bfd, s, &outrel);
+		}
+
+	      symbol_got_offset_mark (input_bfd, h, r_symndx);
+	    }
+
+	  /* Update the relocation value to GOT entry addr as we have
+	     transformed the direct data access into an indirect data
+	     access through GOT.  */
+	  value = got_entry_addr;
+
+	  return _bfd_final_link_relocate (howto, input_bfd, input_section,
+					   contents, rel->r_offset, off, 0);
+	}
+      break;
+
+    default:
+      return bfd_reloc_notsupported;
+    }
+
+  if (saved_addend)
+    *saved_addend = value;
+
+  /* Only apply the final relocation in a sequence.  */
+  if (save_addend)
+    return bfd_reloc_continue;
+
+  return _bfd_kvx_elf_put_addend (input_bfd, hit_data, bfd_r_type,
+				  howto, value);
+}
+
+/* With --relax, elfNN_kvx_relocate_section rewrites some instruction
+   sequences once the final addresses are known:
+
+   - "make $rN = SYM" followed, in the next bundle, by "icall $rN" or
+     "igoto $rN" keeps the make but branches with "call SYM" or
+     "goto SYM" when SYM is in range of a PCREL27 branch;
+
+   - "ld $rN = SYM@got[$rB]" becomes "addd $rN = $rB, SYM@gotoff" when
+     SYM resolves locally.
+
+   The rewrites are done in place: no code is deleted, so no symbol,
+   relocation or stub has to be moved.  */
+
+#define KVX_RELAX_P(info)					\
+  ((info)->disable_target_specific_optimizations == 0		\
+   || (info)->disable_target_specific_optimizations == 1)
+
+/* Syllable fields.  */
+#define KVX_PARALLEL_BIT	0x80000000
+#define KVX_STEERING(x)		(((x) >> 29) & 3)
+#define KVX_STEERING_BCU	0
+#define KVX_STEERING_LSU	1
+#define KVX_STEERING_MAU	2
+#define KVX_STEERING_ALU	3
+#define KVX_IMMX_TAG_MASK	0x18000000
+#define KVX_IMMX_TAG_SHIFT	27
+#define KVX_REG_W(x)		(((x) >> 18) & 0x3f)
+#define KVX_REG_Z(x)		((x) & 0x3f)
+
+/* Opcodes used by the rewrites, the same for all cores unless noted.
+   The masks include the parallel bit for the multi-syllable insns.  */
+#define KVX_MAKE_OPCODE		0xe0000000	/* make $rW = s043/w064 */
+#define KVX_MAKE_MASK		0xff030000
+#define KVX_ICALL_OPCODE	0x0fdc0000	/* icall $rZ */
+#define KVX_IGOTO_OPCODE	0x0fd80000	/* igoto $rZ */
+#define KVX_IBRANCH_MASK	0x7ffc0000
+#define KVX_CALL_OPCODE		0x18000000	/* call s027 */
+#define KVX_GOTO_OPCODE		0x10000000	/* goto s027 */
+#define KVX_CB_OPCODE		0x08000000	/* cb, loopdo... s017 */
+#define KVX_BRANCH_MASK		0x78000000
+#define KVX_LD_OPCODE		0xb8000000	/* ld $rW = s037[$rZ] */
+#define KVX_LD_MASK		0xfc030000
+#define KVX_ADDD_KV3_1_OPCODE	0xe1000000	/* addd $rW = $rZ, s037 */
+#define KVX_ADDD_KV3_2_OPCODE	0xe2000000
+
+/* Maximum number of syllables in a kv3 bundle.  */
+#define KVX_KV3_BUNDLE_SIZE	8
+
+/* Return the offset of the first syllable of the bundle that holds the
+   syllable at OFFSET of CONTENTS.  */
+
+static bfd_vma
+kvx_bundle_start (const bfd_byte *contents, bfd_vma offset)
+{
+  while (offset >= 4
+	 && (bfd_getl32 (contents + offset - 4) & KVX_PARALLEL_BIT) != 0)
+    offset -= 4;
+  return offset;
+}
+
+/* Return the offset past the last syllable of the bundle that holds the
+   syllable at OFFSET of CONTENTS, or -1 if the bundle does not end
+   before SIZE.  */
+
+static bfd_vma
+kvx_bundle_end (const bfd_byte *contents, bfd_size_type size,
+		bfd_vma offset)
+{
+  while (offset + 4 <= size)
+    {
+      uint32_t syllable = bfd_getl32 (contents + offset);
+
+      offset += 4;
+      if ((syllable & KVX_PARALLEL_BIT) == 0)
+	return offset;
+    }
+  return (bfd_vma) -1;
+}
+
+/* Sorted offsets of the bundles of a section that control may reach
+   other than by falling through from the previous bundle.  */
+
+struct kvx_branch_targets
+{
+  bfd_vma *list;
+  size_t count;
+  size_t size;
+  bool valid;
+};
+
+static bool
+kvx_add_branch_target (struct kvx_branch_targets *targets, bfd_vma offset)
+{
+  if (targets->count == targets->size)
+    {
+      size_t size = targets->size ? 2 * targets->size : 64;
+      bfd_vma *list = bfd_realloc (targets->list, size * sizeof (*list));
+
+      if (list == NULL)
+	return false;
+      targets->list = list;
+      targets->size = size;
+    }
+
+  targets->list[targets->count++] = offset;
+  return true;
+}
+
+static int
+kvx_compare_vma (const void *a, const void *b)
+{
+  bfd_vma va = *(const bfd_vma *) a;
+  bfd_vma vb = *(const bfd_vma *) b;
+
+  return va < vb ? -1 : va > vb;
+}
+
+/* Fill TARGETS for SECTION of INPUT_BFD, whose relocations are RELOCS.
+   As far as the linker can tell, the targets are the symbols defined in
+   SECTION, the addresses in SECTION used by the relocations of the
+   allocated sections of INPUT_BFD, and the destinations of the
+   PC-relative branches of SECTION.  Extra targets only prevent some
+   relaxations.  */
+
+static bool
+kvx_collect_branch_targets (struct bfd_link_info *info,
+			    bfd *input_bfd,
+			    asection *section,
+			    const bfd_byte *contents,
+			    const Elf_Internal_Rela *relocs,
+			    const Elf_Internal_Sym *local_syms,
+			    asection **local_sections,
+			    struct kvx_branch_targets *targets)
+{
+  Elf_Internal_Shdr *symtab_hdr = &elf_symtab_hdr (input_bfd);
+  struct elf_link_hash_entry **sym_hashes = elf_sym_hashes (input_bfd);
+  bfd_size_type nsyms = NUM_SHDR_ENTRIES (symtab_hdr);
+  asection *sec;
+  bfd_vma offset;
+  bfd_size_type i;
+
+  targets->valid = true;
+
+  for (i = 1; i < symtab_hdr->sh_info; i++)
+    if (local_sections[i] == section
+	&& ELF_ST_TYPE (local_syms[i].st_info) != STT_SECTION
+	&& !kvx_add_branch_target (targets, local_syms[i].st_value))
+      return false;
+
+  for (i = symtab_hdr->sh_info; i < nsyms; i++)
+    {
+      struct elf_link_hash_entry *h = sym_hashes[i - symtab_hdr->sh_info];
+
+      if (h == NULL)
+	continue;
+      while (h->root.type == bfd_link_hash_indirect
+	     || h->root.type == bfd_link_hash_warning)
+	h = (struct elf_link_hash_entry *) h->root.u.i.link;
+      if ((h->root.type == bfd_link_hash_defined
+	   || h->root.type == bfd_link_hash_defweak)
+	  && h->root.u.def.section == section
+	  && !kvx_add_branch_target (targets, h->root.u.def.value))
+	return false;
+    }
+
+  for (sec = input_bfd->sections; sec != NULL; sec = sec->next)
+    {
+      const Elf_Internal_Rela *internal_relocs;
+      const Elf_Internal_Rela *irela, *irelaend;
+      bool ok = true;
+
+      if ((sec->flags & SEC_ALLOC) == 0
+	  || (sec->flags & SEC_RELOC) == 0
+	  || sec->reloc_count == 0)
+	continue;
+
+      if (sec == section)
+	internal_relocs = relocs;
+      else
+	internal_relocs = _bfd_elf_link_read_relocs (input_bfd, sec, NULL,
+						     NULL, info->keep_memory);
+      if (internal_relocs == NULL)
+	return false;
+
+      irelaend = internal_relocs + sec->reloc_count;
+      for (irela = internal_relocs; ok && irela < irelaend; irela++)
+	{
+	  unsigned long r_indx = ELFNN_R_SYM (irela->r_info);
+
+	  if (r_indx != 0
+	      && r_indx < symtab_hdr->sh_info
+	      && local_sections[r_indx] == section)
+	    ok = kvx_add_branch_target (targets,
+					(local_syms[r_indx].st_value
+					 + irela->r_addend));
+	}
+
+      if (internal_relocs != relocs
+	  && elf_section_data (sec)->relocs != internal_relocs)
+	free ((void *) internal_relocs);
+      if (!ok)
+	return false;
+    }
+
+  offset = 0;
+  while (offset + 4 <= section->size)
+    {
+      bfd_vma start = offset;
+
+      for (i = 0; offset + 4 <= section->size; i++)
+	{
+	  uint32_t syllable = bfd_getl32 (contents + offset);
+	  bfd_signed_vma disp;
+
+	  offset += 4;
+	  /* The branches are in the first (kv3) or two first (kv4)
+	     syllables.  An IMMX syllable may be mistaken for one.  */
+	  if (i < 2 && KVX_STEERING (syllable) == KVX_STEERING_BCU)
+	    {
+	      switch (syllable & KVX_BRANCH_MASK)
+		{
+		case KVX_CALL_OPCODE:
+		case KVX_GOTO_OPCODE:
+		  disp = ((syllable & 0x7ffffff) ^ 0x4000000) - 0x4000000;
+		  break;
+		case KVX_CB_OPCODE:
+		  disp = (((syllable >> 6) & 0x1ffff) ^ 0x10000) - 0x10000;
+		  break;
+		default:
+		  disp = 0;
+		  break;
+		}
+	      if (disp != 0
+		  && start + disp * 4 < section->size
+		  && !kvx_add_branch_target (targets, start + disp * 4))
+		return false;
+	    }
+	  if ((syllable & KVX_PARALLEL_BIT) == 0)
+	    break;
+	}
+    }
+
+  qsort (targets->list, targets->count, sizeof (*targets->list),
+	 kvx_compare_vma);
+  return true;
+}
+
+static bool
+kvx_branch_target_p (const struct kvx_branch_targets *targets,
+		     bfd_vma offset)
+{
+  return bsearch (&offset, targets->list, targets->count,
+		  sizeof (*targets->list), kvx_compare_vma) != NULL;
+}
+
+/* If the syllable at OFFSET of CONTENTS, which is SIZE bytes long, is a
+   "make $rN" in a bundle that falls through to a bundle starting with
+   "icall $rN" or "igoto $rN", return the offset of the latter.  Return
+   -1 otherwise.  */
+
+static bfd_vma
+kvx_indirect_branch_after_make (const bfd_byte *contents,
+				bfd_size_type size, bfd_vma offset)
+{
+  uint32_t make = bfd_getl32 (contents + offset);
+  uint32_t branch;
+  bfd_vma next;
+
+  if ((make & KVX_MAKE_MASK) != KVX_MAKE_OPCODE)
+    return (bfd_vma) -1;
+
+  /* A bundle with a BCU insn may not fall through.  */
+  if (KVX_STEERING (bfd_getl32 (contents + kvx_bundle_start (contents,
+							      offset)))
+      == KVX_STEERING_BCU)
+    return (bfd_vma) -1;
+
+  next = kvx_bundle_end (contents, size, offset);
+  if (next == (bfd_vma) -1 || next + 4 > size)
+    return (bfd_vma) -1;
+
+  branch = bfd_getl32 (contents + next);
+  if (((branch & KVX_IBRANCH_MASK) != KVX_ICALL_OPCODE
+       && (branch & KVX_IBRANCH_MASK) != KVX_IGOTO_OPCODE)
+      || KVX_REG_Z (branch) != KVX_REG_W (make))
+    return (bfd_vma) -1;
+
+  return next;
+}
+
+/* Return the opcode of "addd $rW = $rZ, s037" for the core of ABFD, or
+   0 if GOT loads are not relaxed for this core.  */
+
+static uint32_t
+kvx_addd_s037_opcode (bfd *abfd)
+{
+  switch (bfd_get_mach (abfd))
+    {
+    case bfd_mach_kv3_1:
+    case bfd_mach_kv3_1_64:
+    case bfd_mach_kv3_1_usr:
+      return KVX_ADDD_KV3_1_OPCODE;
+    case bfd_mach_kv3_2:
+    case bfd_mach_kv3_2_64:
+    case bfd_mach_kv3_2_usr:
+      return KVX_ADDD_KV3_2_OPCODE;
+    default:
+      return 0;
+    }
+}
+
+/* Issue lanes of a kv3 bundle, numbered like the IMMX tags.  */
+
+enum kvx_kv3_lane
+{
+  KVX_KV3_LANE_ALU0,
+  KVX_KV3_LANE_ALU1,
+  KVX_KV3_LANE_MAU,
+  KVX_KV3_LANE_LSU,
+  KVX_KV3_LANE_NONE
+};
+
+/* Set LANES to the issue lanes of the NWORDS syllables of the kv3 bundle
+   WORDS, as the decoder assigns them, with KVX_KV3_LANE_NONE for the
+   BCU, TCA and IMMX syllables.  Return false if a lane is used twice.  */
+
+static bool
+kvx_kv3_bundle_lanes (const uint32_t *words, int nwords, int *lanes)
+{
+  bool taken[KVX_KV3_LANE_NONE] = { false, false, false, false };
+  int i;
+
+  for (i = 0; i < nwords; i++)
+    {
+      int lane = KVX_KV3_LANE_NONE;
+
+      switch (KVX_STEERING (words[i]))
+	{
+	case KVX_STEERING_ALU:
+	  /* ALU insns take the first free lane, down to the LSU.  */
+	  lane = KVX_KV3_LANE_ALU0;
+	  while (lane < KVX_KV3_LANE_NONE && taken[lane])
+	    lane++;
+	  if (lane == KVX_KV3_LANE_NONE)
+	    return false;
+	  break;
+	case KVX_STEERING_MAU:
+	  lane = KVX_KV3_LANE_MAU;
+	  break;
+	case KVX_STEERING_LSU:
+	  lane = KVX_KV3_LANE_LSU;
+	  break;
+	default:
+	  break;
+	}
+
+      if (lane != KVX_KV3_LANE_NONE)
+	{
+	  if (taken[lane])
+	    return false;
+	  taken[lane] = true;
+	}
+      lanes[i] = lane;
+    }
 
-    case BFD_RELOC_KVX_S37_TLS_IE_UP27:
-    case BFD_RELOC_KVX_S37_TLS_IE_LO10:
+  return true;
+}
 
-    case BFD_RELOC_KVX_S43_TLS_IE_UP27:
-    case BFD_RELOC_KVX_S43_TLS_IE_EX6:
-    case BFD_RELOC_KVX_S43_TLS_IE_LO10:
+/* REL, one of the relocations of INPUT_SECTION that end at RELEND, is an
+   R_KVX_S37_GOT_LO10 against a symbol that resolves locally.  If it is
+   on "ld $rN = SYM@got[$rB]" and the R_KVX_S37_GOT_UP27 of the load
+   comes later, turn the load into "addd $rN = $rB, SYM@gotoff" and
+   update both relocations.  The add must not change the issue lanes of
+   the rest of the bundle.  The GOT entry of SYM is kept.  */
 
-    case BFD_RELOC_KVX_S37_TLS_LD_UP27:
-    case BFD_RELOC_KVX_S37_TLS_LD_LO10:
+static bool
+kvx_relax_got_load (bfd *input_bfd,
+		    asection *input_section,
+		    bfd_byte *contents,
+		    Elf_Internal_Rela *rel,
+		    Elf_Internal_Rela *relend)
+{
+  uint32_t words[KVX_KV3_BUNDLE_SIZE];
+  int lanes[KVX_KV3_BUNDLE_SIZE];
+  int new_lanes[KVX_KV3_BUNDLE_SIZE];
+  uint32_t addd = kvx_addd_s037_opcode (input_bfd);
+  uint32_t ld;
+  Elf_Internal_Rela *up27;
+  bfd_vma start, end;
+  int nwords, ld_index, immx_index, i;
+
+  if (addd == 0)
+    return false;
 
-    case BFD_RELOC_KVX_S43_TLS_LD_UP27:
-    case BFD_RELOC_KVX_S43_TLS_LD_EX6:
-    case BFD_RELOC_KVX_S43_TLS_LD_LO10:
+  ld = bfd_getl32 (contents + rel->r_offset);
+  if ((ld & KVX_LD_MASK) != KVX_LD_OPCODE)
+    return false;
 
-      if (globals->root.sgot == NULL)
-	return bfd_reloc_notsupported;
-      value = symbol_got_offset (input_bfd, h, r_symndx);
+  start = kvx_bundle_start (contents, rel->r_offset);
+  end = kvx_bundle_end (contents, input_section->size, rel->r_offset);
+  if (end == (bfd_vma) -1 || end - start > sizeof (words))
+    return false;
 
-      _bfd_final_link_relocate (howto, input_bfd, input_section,
-				contents, rel->r_offset, value, addend);
-      *unresolved_reloc_p = false;
+  for (up27 = rel + 1; up27 < relend; up27++)
+    if (ELFNN_R_TYPE (up27->r_info) == R_KVX_S37_GOT_UP27
+	&& ELFNN_R_SYM (up27->r_info) == ELFNN_R_SYM (rel->r_info)
+	&& up27->r_addend == rel->r_addend
+	&& up27->r_offset > rel->r_offset
+	&& up27->r_offset < end)
       break;
+  if (up27 == relend)
+    return false;
 
-    case BFD_RELOC_KVX_S37_GOTADDR_UP27:
-    case BFD_RELOC_KVX_S37_GOTADDR_LO10:
+  nwords = (end - start) / 4;
+  for (i = 0; i < nwords; i++)
+    words[i] = bfd_getl32 (contents + start + 4 * i);
+  ld_index = (rel->r_offset - start) / 4;
+  immx_index = (up27->r_offset - start) / 4;
 
-    case BFD_RELOC_KVX_S43_GOTADDR_UP27:
-    case BFD_RELOC_KVX_S43_GOTADDR_EX6:
-    case BFD_RELOC_KVX_S43_GOTADDR_LO10:
+  if (!kvx_kv3_bundle_lanes (words, nwords, lanes)
+      || lanes[ld_index] != KVX_KV3_LANE_LSU
+      || ((words[immx_index] & KVX_IMMX_TAG_MASK) >> KVX_IMMX_TAG_SHIFT
+	  != KVX_KV3_LANE_LSU))
+    return false;
 
-    case BFD_RELOC_KVX_S64_GOTADDR_UP27:
-    case BFD_RELOC_KVX_S64_GOTADDR_EX27:
-    case BFD_RELOC_KVX_S64_GOTADDR_LO10:
-      {
-	if (globals->root.sgot == NULL)
-	  BFD_ASSERT (h != NULL);
+  /* Keep the registers and the low bits of the offset.  */
+  words[ld_index] = addd | (ld & 0x00fcffff);
+  if (!kvx_kv3_bundle_lanes (words, nwords, new_lanes))
+    return false;
+  for (i = 0; i < nwords; i++)
+    if (i != ld_index && new_lanes[i] != lanes[i])
+      return false;
 
-	value = globals->root.sgot->output_section->vma
-	  + globals->root.sgot->output_offset;
+  words[immx_index] = ((words[immx_index] & ~KVX_IMMX_TAG_MASK)
+		       | (new_lanes[ld_index] << KVX_IMMX_TAG_SHIFT));
+  bfd_putl32 (words[ld_index], contents + rel->r_offset);
+  bfd_putl32 (words[immx_index], contents + up27->r_offset);
 
-	return _bfd_final_link_relocate (howto, input_bfd, input_section,
-					 contents, rel->r_offset, value,
-					 addend);
-      }
-      break;
+  rel->r_info = ELFNN_R_INFO (ELFNN_R_SYM (rel->r_info),
+			      R_KVX_S37_GOTOFF_LO10);
+  up27->r_info = ELFNN_R_INFO (ELFNN_R_SYM (up27->r_info),
+			       R_KVX_S37_GOTOFF_UP27);
+  return true;
+}
 
-    case BFD_RELOC_KVX_S37_GOTOFF_LO10:
-    case BFD_RELOC_KVX_S37_GOTOFF_UP27:
+/* Return TRUE if INPUT_SECTION may be relocated in parallel with the
+   sections of other input files: none of its relocations uses the GOT,
+   a stub or a dynamic relocation, or refers to an undefined symbol.  */
 
-    case BFD_RELOC_KVX_32_GOTOFF:
-    case BFD_RELOC_KVX_64_GOTOFF:
+static bool
+elfNN_kvx_parallel_relocate_p (bfd *output_bfd ATTRIBUTE_UNUSED,
+			       struct bfd_link_info *info,
+			       bfd *input_bfd,
+			       asection *input_section,
+			       const Elf_Internal_Rela *relocs,
+			       const Elf_Internal_Sym *local_syms,
+			       asection **local_sections)
+{
+  struct elf_kvx_link_hash_table *globals;
+  Elf_Internal_Shdr *symtab_hdr;
+  struct elf_link_hash_entry **sym_hashes;
+  const Elf_Internal_Rela *rel, *relend;
+  bool may_relax = false;
 
-    case BFD_RELOC_KVX_S43_GOTOFF_LO10:
-    case BFD_RELOC_KVX_S43_GOTOFF_UP27:
-    case BFD_RELOC_KVX_S43_GOTOFF_EX6:
+  if (!is_kvx_elf (input_bfd))
+    return false;
 
-      {
-	asection *basegot = globals->root.sgot;
-	/* BFD_ASSERT(h == NULL); */
-	BFD_ASSERT(globals->root.sgot != NULL);
-	value -= basegot->output_section->vma + basegot->output_offset;
-	return _bfd_final_link_relocate (howto, input_bfd, input_section,
-					 contents, rel->r_offset, value,
-					 addend);
-      }
-      break;
+  if (info->wrap_hash != NULL
+      && (input_section->flags & SEC_DEBUGGING) != 0)
+    return false;
 
-    case BFD_RELOC_KVX_S37_GOT_LO10:
-    case BFD_RELOC_KVX_S37_GOT_UP27:
+  globals = elf_kvx_hash_table (info);
+  symtab_hdr = &elf_symtab_hdr (input_bfd);
+  sym_hashes = elf_sym_hashes (input_bfd);
 
-    case BFD_RELOC_KVX_32_GOT:
-    case BFD_RELOC_KVX_64_GOT:
+  relend = relocs + input_section->reloc_count;
+  for (rel = relocs; rel < relend; rel++)
+    {
+      unsigned int r_type = ELFNN_R_TYPE (rel->r_info);
+      unsigned long r_symndx = ELFNN_R_SYM (rel->r_info);
+      bfd_reloc_code_real_type bfd_r_type;
+      reloc_howto_type *howto;
+      struct elf_link_hash_entry *h;
+      asection *sec;
+      bfd_vma value, place;
 
-    case BFD_RELOC_KVX_S43_GOT_LO10:
-    case BFD_RELOC_KVX_S43_GOT_UP27:
-    case BFD_RELOC_KVX_S43_GOT_EX6:
+      if (r_type == R_KVX_NONE)
+	continue;
 
-      if (globals->root.sgot == NULL)
-	BFD_ASSERT (h != NULL);
+      howto = elfNN_kvx_howto_from_type (input_bfd, r_type);
+      if (howto == NULL)
+	return false;
+      bfd_r_type = elfNN_kvx_bfd_reloc_from_howto (howto);
 
-      if (h != NULL)
+      if (r_symndx < symtab_hdr->sh_info)
 	{
-	  value = kvx_calculate_got_entry_vma (h, globals, info, value,
-					       output_bfd,
-					       unresolved_reloc_p);
-#ifdef UGLY_DEBUG
-	  printf("GOT_LO/HI for %s, value %x\n", h->root.root.string, value);
-#endif
-
-	  return _bfd_final_link_relocate (howto, input_bfd, input_section,
-					   contents, rel->r_offset, value,
-					   addend);
+	  h = NULL;
+	  sec = local_sections[r_symndx];
+	  if (sec == NULL
+	      || bfd_is_und_section (sec)
+	      || sec->output_section == NULL)
+	    return false;
 	}
       else
 	{
-#ifdef UGLY_DEBUG
-	  printf("GOT_LO/HI with h NULL, initial value %x\n", value);
-#endif
-	  struct elf_kvx_local_symbol *locals = elf_kvx_locals (input_bfd);
-
-	  if (locals == NULL)
+	  if (sym_hashes == NULL)
+	    return false;
+	  h = sym_hashes[r_symndx - symtab_hdr->sh_info];
+	  if (h == NULL)
+	    return false;
+	  while (h->root.type == bfd_link_hash_indirect
+		 || h->root.type == bfd_link_hash_warning)
+	    h = (struct elf_link_hash_entry *) h->root.u.i.link;
+	  if (h->type == STT_GNU_IFUNC)
+	    return false;
+	  if (h->root.type == bfd_link_hash_defined
+	      || h->root.type == bfd_link_hash_defweak)
 	    {
-	      int howto_index = bfd_r_type - BFD_RELOC_KVX_RELOC_START;
-	      _bfd_error_handler
-		/* xgettext:c-format */
-		(_("%pB: local symbol descriptor table be NULL when applying "
-		   "relocation %s against local symbol"),
-		 input_bfd, elf_kvx_howto_table[howto_index].name);
-	      abort ();
+	      sec = h->root.u.def.section;
+	      if (sec == NULL || sec->output_section == NULL)
+		return false;
 	    }
+	  else if (h->root.type == bfd_link_hash_undefweak)
+	    sec = NULL;
+	  else
+	    return false;
+	}
 
-	  off = symbol_got_offset (input_bfd, h, r_symndx);
-	  base_got = globals->root.sgot;
-	  bfd_vma got_entry_addr = (base_got->output_section->vma
-				    + base_got->output_offset + off);
-
-	  if (!symbol_got_offset_mark_p (input_bfd, h, r_symndx))
-	    {
-	      bfd_put_64 (output_bfd, value, base_got->contents + off);
-
-	      if (bfd_link_pic (info))
-		{
-		  asection *s;
-		  Elf_Internal_Rela outrel;
-
-		  /* For PIC executables and shared libraries we need
-		     to relocate the GOT entry at run time.  */
-		  s = globals->root.srelgot;
-		  if (s == NULL)
-		    abort ();
+      switch (bfd_r_type)
+	{
+	case BFD_RELOC_KVX_NN:
+#if ARCH_SIZE == 64
+	case BFD_RELOC_KVX_32:
+#endif
+	case BFD_RELOC_KVX_S37_LO10:
+	case BFD_RELOC_KVX_S37_UP27:
+	case BFD_RELOC_KVX_S32_LO5:
+	case BFD_RELOC_KVX_S32_UP27:
+	case BFD_RELOC_KVX_S43_LO10:
+	case BFD_RELOC_KVX_S43_UP27:
+	case BFD_RELOC_KVX_S43_EX6:
+	case BFD_RELOC_KVX_S64_LO10:
+	case BFD_RELOC_KVX_S64_UP27:
+	case BFD_RELOC_KVX_S64_EX27:
+	  /* These are copied into dynamic relocations in a shared library
+	     or PIE.  */
+	  if (bfd_link_pic (info)
+	      && (input_section->flags & SEC_ALLOC) != 0)
+	    return false;
+	  if (bfd_r_type == BFD_RELOC_KVX_S43_LO10
+	      || bfd_r_type == BFD_RELOC_KVX_S64_LO10)
+	    may_relax = true;
+	  break;
 
-		  outrel.r_offset = got_entry_addr;
-		  outrel.r_info = ELFNN_R_INFO (0, R_KVX_RELATIVE);
-		  outrel.r_addend = value;
-		  elf_append_rela (output_bfd, s, &outrel);
-		}
+	case BFD_RELOC_KVX_PCREL17:
+	case BFD_RELOC_KVX_PCREL27:
+	  /* A branch which is out of range is redirected to a stub, and
+	     looking the stub up updates the hash table entry.  */
+	  if (h != NULL
+	      && globals->root.splt != NULL
+	      && h->plt.offset != (bfd_vma) -1)
+	    value = (globals->root.splt->output_section->vma
+		     + globals->root.splt->output_offset + h->plt.offset);
+	  else if (sec == NULL)
+	    break;
+	  else if (h != NULL)
+	    value = (h->root.u.def.value + sec->output_section->vma
+		     + sec->output_offset);
+	  else
+	    value = (local_syms[r_symndx].st_value
+		     + sec->output_section->vma + sec->output_offset);
+	  place = (input_section->output_section->vma
+		   + input_section->output_offset + rel->r_offset);
+	  if (!kvx_valid_call_p (value, place))
+	    return false;
+	  break;
 
-	      symbol_got_offset_mark (input_bfd, h, r_symndx);
-	    }
+	case BFD_RELOC_KVX_32_PCREL:
+	case BFD_RELOC_KVX_S64_PCREL_LO10:
+	case BFD_RELOC_KVX_S64_PCREL_UP27:
+	case BFD_RELOC_KVX_S64_PCREL_EX27:
+	case BFD_RELOC_KVX_S37_PCREL_LO10:
+	case BFD_RELOC_KVX_S37_PCREL_UP27:
+	case BFD_RELOC_KVX_S43_PCREL_LO10:
+	case BFD_RELOC_KVX_S43_PCREL_UP27:
+	case BFD_RELOC_KVX_S43_PCREL_EX6:
+	case BFD_RELOC_KVX_S37_TLS_LE_LO10:
+	case BFD_RELOC_KVX_S37_TLS_LE_UP27:
+	case BFD_RELOC_KVX_S43_TLS_LE_LO10:
+	case BFD_RELOC_KVX_S43_TLS_LE_UP27:
+	case BFD_RELOC_KVX_S43_TLS_LE_EX6:
+	case BFD_RELOC_KVX_S37_TLS_DTPOFF_LO10:
+	case BFD_RELOC_KVX_S37_TLS_DTPOFF_UP27:
+	case BFD_RELOC_KVX_S43_TLS_DTPOFF_LO10:
+	case BFD_RELOC_KVX_S43_TLS_DTPOFF_UP27:
+	case BFD_RELOC_KVX_S43_TLS_DTPOFF_EX6:
+	  break;
 
-	  /* Update the relocation value to GOT entry addr as we have
-	     transformed the direct data access into an indirect data
-	     access through GOT.  */
-	  value = got_entry_addr;
+	case BFD_RELOC_KVX_S37_GOTADDR_UP27:
+	case BFD_RELOC_KVX_S37_GOTADDR_LO10:
+	case BFD_RELOC_KVX_S43_GOTADDR_UP27:
+	case BFD_RELOC_KVX_S43_GOTADDR_EX6:
+	case BFD_RELOC_KVX_S43_GOTADDR_LO10:
+	case BFD_RELOC_KVX_S64_GOTADDR_UP27:
+	case BFD_RELOC_KVX_S64_GOTADDR_EX27:
+	case BFD_RELOC_KVX_S64_GOTADDR_LO10:
+	case BFD_RELOC_KVX_S37_GOTOFF_LO10:
+	case BFD_RELOC_KVX_S37_GOTOFF_UP27:
+	case BFD_RELOC_KVX_32_GOTOFF:
+	case BFD_RELOC_KVX_64_GOTOFF:
+	case BFD_RELOC_KVX_S43_GOTOFF_LO10:
+	case BFD_RELOC_KVX_S43_GOTOFF_UP27:
+	case BFD_RELOC_KVX_S43_GOTOFF_EX6:
+	  /* These only read the address of the GOT.  */
+	  if (globals->root.sgot == NULL)
+	    return false;
+	  break;
 
-	  return _bfd_final_link_relocate (howto, input_bfd, input_section,
-					   contents, rel->r_offset, off, 0);
+	default:
+	  return false;
 	}
-      break;
-
-    default:
-      return bfd_reloc_notsupported;
     }
 
-  if (saved_addend)
-    *saved_addend = value;
+  /* Relaxing an indirect branch looks for branch targets in the relocs
+     of all the allocated sections of INPUT_BFD.  Read them in now, so
+     that the input file is not read while relocating in parallel.  */
+  if (may_relax && KVX_RELAX_P (info))
+    {
+      asection *sec;
 
-  /* Only apply the final relocation in a sequence.  */
-  if (save_addend)
-    return bfd_reloc_continue;
+      if (!info->keep_memory)
+	return false;
+      for (sec = input_bfd->sections; sec != NULL; sec = sec->next)
+	if (sec != input_section
+	    && (sec->flags & SEC_ALLOC) != 0
+	    && (sec->flags & SEC_RELOC) != 0
+	    && sec->reloc_count != 0
+	    && _bfd_elf_link_read_relocs (input_bfd, sec, NULL, NULL,
+					  true) == NULL)
+	  return false;
+    }
 
-  return _bfd_kvx_elf_put_addend (input_bfd, hit_data, bfd_r_type,
-				  howto, value);
+  return true;
 }
 
-
-
 /* Relocate a KVX ELF section.  */
 
 static int
@@ -2469,6 +3512,7 @@ elfNN_kvx_relocate_section (bfd *output_bfd,
   struct elf_kvx_link_hash_table *globals;
   bool save_addend = false;
   bfd_vma addend = 0;
+  struct kvx_branch_targets targets = { NULL, 0, 0, false };
 
   globals = elf_kvx_hash_table (info);
 
@@ -2500,7 +3544,10 @@ elfNN_kvx_relocate_section (bfd *output_bfd,
       howto = bfd_reloc.howto;
 
       if (howto == NULL)
-	return _bfd_unrecognized_reloc (input_bfd, input_section, r_type);
+	{
+	  free (targets.list);
+	  return _bfd_unrecognized_reloc (input_bfd, input_section, r_type);
+	}
 
       bfd_r_type = elfNN_kvx_bfd_reloc_from_howto (howto);
 
@@ -2595,6 +3642,79 @@ elfNN_kvx_relocate_section (bfd *output_bfd,
       else
 	save_addend = false;
 
+      if (KVX_RELAX_P (info)
+	  && !save_addend
+	  && sec != NULL
+	  && !bfd_is_abs_section (sec)
+	  && !bfd_is_und_section (sec)
+	  && (h == NULL
+	      || ((h->root.type == bfd_link_hash_defined
+		   || h->root.type == bfd_link_hash_defweak)
+		  && h->type != STT_GNU_IFUNC)))
+	{
+	  if (r_type == R_KVX_S37_GOT_LO10
+	      && (h == NULL
+		  ? !bfd_link_pic (info)
+		  : SYMBOL_REFERENCES_LOCAL (info, h)))
+	    {
+	      asection *basegot = globals->root.sgot;
+	      bfd_signed_vma gotoff
+		= (relocation + rel->r_addend
+		   - basegot->output_section->vma - basegot->output_offset);
+
+	      if (gotoff >= -((bfd_signed_vma) 1 << 36)
+		  && gotoff < ((bfd_signed_vma) 1 << 36)
+		  && kvx_relax_got_load (input_bfd, input_section, contents,
+					 rel, relend))
+		{
+		  r_type = ELFNN_R_TYPE (rel->r_info);
+		  howto = elfNN_kvx_howto_from_type (input_bfd, r_type);
+		  bfd_reloc.howto = howto;
+		}
+	    }
+	  else if ((r_type == R_KVX_S43_LO10 || r_type == R_KVX_S64_LO10)
+		   && !bfd_link_pic (info)
+		   && (h == NULL
+		       || (SYMBOL_CALLS_LOCAL (info, h)
+			   && h->plt.offset == (bfd_vma) -1)))
+	    {
+	      bfd_vma destination = relocation + rel->r_addend;
+	      bfd_vma branch
+		= kvx_indirect_branch_after_make (contents,
+						  input_section->size,
+						  rel->r_offset);
+	      bfd_vma place = (input_section->output_section->vma
+			       + input_section->output_offset + branch);
+
+	      if (branch != (bfd_vma) -1
+		  && (destination & 3) == 0
+		  && kvx_valid_call_p (destination, place))
+		{
+		  if (!targets.valid
+		      && !kvx_collect_branch_targets (info, input_bfd,
+						      input_section, contents,
+						      relocs, local_syms,
+						      local_sections,
+						      &targets))
+		    {
+		      free (targets.list);
+		      return false;
+		    }
+
+		  if (!kvx_branch_target_p (&targets, branch))
+		    {
+		      uint32_t insn = bfd_getl32 (contents + branch);
+
+		      insn = ((insn & KVX_PARALLEL_BIT)
+			      | ((insn & KVX_IBRANCH_MASK) == KVX_ICALL_OPCODE
+				 ? KVX_CALL_OPCODE : KVX_GOTO_OPCODE)
+			      | (((destination - place) >> 2) & 0x7ffffff));
+		      bfd_putl32 (insn, contents + branch);
+		    }
+		}
+	    }
+	}
+
       if (r == bfd_reloc_continue)
 	r = elfNN_kvx_final_link_relocate (howto, input_bfd, output_bfd,
 					   input_section, contents, rel,
@@ -2782,6 +3902,7 @@ elfNN_kvx_relocate_section (bfd *output_bfd,
 	       "unresolvable %s relocation against symbol `%s'"),
 	     input_bfd, input_section, (uint64_t) rel->r_offset, howto->name,
 	     h->root.root.string);
+	  free (targets.list);
 	  return false;
 	}
 
@@ -2846,6 +3967,7 @@ elfNN_kvx_relocate_section (bfd *output_bfd,
 	addend = 0;
     }
 
+  free (targets.list);
   return true;
 }
 
@@ -4799,6 +5921,9 @@ elfNN_kvx_plt_sym_val (bfd_vma i, const asection *plt,
 #define elf_backend_relocate_section		\
   elfNN_kvx_relocate_section
 
+#define elf_backend_parallel_relocate_p		\
+  elfNN_kvx_parallel_relocate_p
+
 #define elf_backend_reloc_type_class		\
   elfNN_kvx_reloc_type_class
 
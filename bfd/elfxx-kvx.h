@@ -28,6 +28,8 @@ extern int elf64_kvx_setup_section_lists
   (bfd *, struct bfd_link_info *);
 extern void elf64_kvx_next_input_section
   (struct bfd_link_info *, struct bfd_section *);
+extern void elf64_kvx_end_stub_group
+  (struct bfd_link_info *, struct bfd_section *);
 extern bool elf64_kvx_size_stubs
   (bfd *, bfd *, struct bfd_link_info *, bfd_signed_vma,
    struct bfd_section * (*) (const char *, struct bfd_section *),
@@ -39,6 +41,8 @@ extern int elf32_kvx_setup_section_lists
   (bfd *, struct bfd_link_info *);
 extern void elf32_kvx_next_input_section
   (struct bfd_link_info *, struct bfd_section *);
+extern void elf32_kvx_end_stub_group
+  (struct bfd_link_info *, struct bfd_section *);
 extern bool elf32_kvx_size_stubs
   (bfd *, bfd *, struct bfd_link_info *, bfd_signed_vma,
    struct bfd_section * (*) (const char *, struct bfd_section *),
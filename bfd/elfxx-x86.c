@@ -61,7 +61,10 @@ _bfd_x86_elf_set_tls_module_base (struct bfd_link_info *info)
   if (base == NULL)
     return;
 
-  base->u.def.value = htab->elf.tls_size;
+  /* Only write the value once, since this is also called while
+     sections are relocated in parallel.  */
+  if (base->u.def.value != htab->elf.tls_size)
+    base->u.def.value = htab->elf.tls_size;
 }
 
 /* Return the base VMA address which should be subtracted from real addresses
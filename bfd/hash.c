@@ -92,6 +92,16 @@ SUBSECTION
 	Use <<bfd_hash_set_default_size>> to set the default size of
 	hash table to use.
 
+@findex bfd_hash_table_init_open
+	A table created with <<bfd_hash_table_init_open>> keeps its
+	entries in a flat array instead of chaining them, storing each
+	entry pointer together with its hash code and a one byte tag
+	so that most lookups touch no entry other than the one they
+	find.  Such a table is traversed in a different order, and its
+	entries may not be chained through their <<next>> fields, so
+	it should only be used by code which does not depend on
+	either.  Otherwise it is used like any other hash table.
+
 INODE
 Looking Up or Entering a String, Traversing a Hash Table, Creating and Freeing a Hash Table, Hash Tables
 SUBSECTION
@@ -311,12 +321,30 @@ EXTERNAL
 .  unsigned long hash;
 .};
 .
+.{* A slot of a hash table created by bfd_hash_table_init_open.  *}
+.
+.struct bfd_hash_slot
+.{
+.  {* Hash code of the entry.  *}
+.  unsigned long hash;
+.  {* The entry, if the slot is in use.  *}
+.  struct bfd_hash_entry *entry;
+.};
+.
 .{* A hash table.  *}
 .
 .struct bfd_hash_table
 .{
 .  {* The hash array.  *}
 .  struct bfd_hash_entry **table;
+.  {* For a table created by bfd_hash_table_init_open, the slots and
+.     a control byte for each of them, which says whether the slot is
+.     in use, and if so holds seven bits of the hash code of its
+.     entry.  They are malloc'd rather than on the objalloc, so that
+.     they can be freed when the table grows.  NULL for other
+.     tables.  *}
+.  struct bfd_hash_slot *slots;
+.  unsigned char *ctrl;
 .  {* A function used to create new elements in the hash table.  The
 .     first entry is itself a pointer to an element.  When this
 .     function is first invoked, this pointer will be NULL.  However,
@@ -335,6 +363,9 @@ EXTERNAL
 .  unsigned int count;
 .  {* The size of elements.  *}
 .  unsigned int entsize;
+.  {* The number of slots of an open addressing table which have had
+.     their entry renamed away from them.  *}
+.  unsigned int deleted;
 .  {* If non-zero, don't grow the hash table.  *}
 .  unsigned int frozen:1;
 .};
@@ -405,6 +436,268 @@ higher_prime_number (uint32_t n)
 
 static unsigned int bfd_default_hash_table_size = DEFAULT_SIZE;
 
+/* An open addressing table is probed in groups of GROUP_SIZE slots,
+   whose control bytes are read together into a uint64_t and compared
+   with bitwise operations.  A control byte is CTRL_EMPTY for a slot
+   which has never been used, CTRL_DELETED for one whose entry was
+   renamed, and otherwise seven bits of the hash code of the entry in
+   the slot.  */
+
+#define GROUP_SIZE 8
+#define CTRL_EMPTY 0x80
+#define CTRL_DELETED 0xfe
+#define GROUP_ONES UINT64_C (0x0101010101010101)
+#define GROUP_HIGHS UINT64_C (0x8080808080808080)
+
+/* Open addressing tables grow when more than 7/8 of their slots are
+   used or deleted.  */
+#define OPEN_NEEDS_RESIZE(used, size) ((used) > (size) / 8 * 7)
+
+/* Mix the bits of HASH, as the hash codes of bfd_hash_hash are not
+   well distributed in their low bits.  The group to probe first is
+   taken from the low half of the result and the control byte from
+   the top seven bits.  */
+
+static inline uint64_t
+open_hash_mix (unsigned long hash)
+{
+  return (uint64_t) hash * UINT64_C (0x9e3779b97f4a7c15);
+}
+
+static inline unsigned char
+open_hash_tag (uint64_t mix)
+{
+  return mix >> 57;
+}
+
+/* Read the control bytes of the group at CTRL.  */
+
+static inline uint64_t
+group_load (const unsigned char *ctrl)
+{
+  uint64_t group;
+
+  memcpy (&group, ctrl, sizeof (group));
+  return group;
+}
+
+/* Return a mask with the high bit set in the bytes of GROUP which
+   may be equal to TAG.  There may be false positives but never false
+   negatives.  */
+
+static inline uint64_t
+group_match (uint64_t group, unsigned char tag)
+{
+  uint64_t x = group ^ (GROUP_ONES * tag);
+
+  return (x - GROUP_ONES) & ~x & GROUP_HIGHS;
+}
+
+/* Return a mask with the high bit set in the bytes of GROUP which are
+   CTRL_EMPTY.  */
+
+static inline uint64_t
+group_match_empty (uint64_t group)
+{
+  return group & ~(group << 6) & GROUP_HIGHS;
+}
+
+/* Return a mask with the high bit set in the bytes of GROUP which are
+   CTRL_EMPTY or CTRL_DELETED.  */
+
+static inline uint64_t
+group_match_free (uint64_t group)
+{
+  return group & GROUP_HIGHS;
+}
+
+/* Return the index within its group of the slot of the lowest byte
+   set in the non-zero MASK.  */
+
+static inline unsigned int
+group_first (uint64_t mask)
+{
+  unsigned int bit;
+
+#if GCC_VERSION >= 3004
+  bit = __builtin_ctzll (mask);
+#else
+  for (bit = 0; (mask & 1) == 0; bit++)
+    mask >>= 1;
+#endif
+#ifdef WORDS_BIGENDIAN
+  return GROUP_SIZE - 1 - bit / 8;
+#else
+  return bit / 8;
+#endif
+}
+
+/* Return the index of a free slot for an entry with hash code HASH in
+   the NSLOTS slots with control bytes CTRL.  */
+
+static unsigned int
+open_find_free (const unsigned char *ctrl, unsigned int nslots,
+		unsigned long hash)
+{
+  unsigned int mask = nslots / GROUP_SIZE - 1;
+  unsigned int group = (uint32_t) open_hash_mix (hash) & mask;
+  unsigned int step = 0;
+
+  for (;;)
+    {
+      uint64_t free_slots = group_match_free (group_load (ctrl
+							  + group
+							  * GROUP_SIZE));
+      if (free_slots != 0)
+	return group * GROUP_SIZE + group_first (free_slots);
+      group = (group + ++step) & mask;
+    }
+}
+
+/* Find the entry for STRING, with hash code HASH, in the open
+   addressing TABLE.  */
+
+static struct bfd_hash_entry *
+open_lookup (struct bfd_hash_table *table, const char *string,
+	     unsigned long hash)
+{
+  uint64_t mix = open_hash_mix (hash);
+  unsigned char tag = open_hash_tag (mix);
+  unsigned int mask = table->size / GROUP_SIZE - 1;
+  unsigned int group = (uint32_t) mix & mask;
+  unsigned int step = 0;
+
+  for (;;)
+    {
+      const unsigned char *ctrl = table->ctrl + group * GROUP_SIZE;
+      struct bfd_hash_slot *slots = table->slots + group * GROUP_SIZE;
+      uint64_t bits = group_load (ctrl);
+      uint64_t match;
+
+      for (match = group_match (bits, tag); match != 0; match &= match - 1)
+	{
+	  unsigned int i = group_first (match);
+
+	  if (ctrl[i] == tag
+	      && slots[i].hash == hash
+	      && strcmp (slots[i].entry->string, string) == 0)
+	    return slots[i].entry;
+	}
+      if (group_match_empty (bits) != 0)
+	return NULL;
+      group = (group + ++step) & mask;
+    }
+}
+
+/* Return the slot of ENT in the open addressing TABLE.  */
+
+static unsigned int
+open_find_entry (struct bfd_hash_table *table, struct bfd_hash_entry *ent)
+{
+  unsigned int mask = table->size / GROUP_SIZE - 1;
+  unsigned int group = (uint32_t) open_hash_mix (ent->hash) & mask;
+  unsigned int step = 0;
+
+  for (;;)
+    {
+      unsigned int i;
+
+      for (i = 0; i < GROUP_SIZE; i++)
+	if (table->ctrl[group * GROUP_SIZE + i] < CTRL_EMPTY
+	    && table->slots[group * GROUP_SIZE + i].entry == ent)
+	  return group * GROUP_SIZE + i;
+      if (group_match_empty (group_load (table->ctrl + group * GROUP_SIZE))
+	  != 0)
+	abort ();
+      group = (group + ++step) & mask;
+    }
+}
+
+/* Allocate NSLOTS slots, a power of two no smaller than GROUP_SIZE,
+   for the open addressing TABLE, move its entries there and free the
+   old slots.  */
+
+static bool
+open_resize (struct bfd_hash_table *table, unsigned int nslots)
+{
+  struct bfd_hash_slot *slots;
+  unsigned char *ctrl;
+  unsigned long alloc = nslots * sizeof (*slots);
+  unsigned int i;
+
+  if (alloc / sizeof (*slots) != nslots)
+    return false;
+  ctrl = bfd_malloc (nslots);
+  slots = bfd_malloc (alloc);
+  if (ctrl == NULL || slots == NULL)
+    {
+      free (ctrl);
+      free (slots);
+      return false;
+    }
+  memset (ctrl, CTRL_EMPTY, nslots);
+
+  for (i = 0; i < table->size; i++)
+    if (table->ctrl[i] < CTRL_EMPTY)
+      {
+	unsigned int j = open_find_free (ctrl, nslots, table->slots[i].hash);
+
+	ctrl[j] = table->ctrl[i];
+	slots[j] = table->slots[i];
+      }
+
+  free (table->ctrl);
+  free (table->slots);
+  table->ctrl = ctrl;
+  table->slots = slots;
+  table->size = nslots;
+  table->deleted = 0;
+  return true;
+}
+
+/* Put ENT, whose hash code is set, into a free slot of the open
+   addressing TABLE, growing the table first if need be and if it is
+   not frozen.  USED is the number of slots which will be in use or
+   deleted afterwards.  */
+
+static bool
+open_insert (struct bfd_hash_table *table, struct bfd_hash_entry *ent,
+	     unsigned int used)
+{
+  unsigned int i;
+
+  if (OPEN_NEEDS_RESIZE (used, table->size))
+    {
+      unsigned long nslots = table->size;
+
+      /* Only grow if it is the entries, rather than deleted slots,
+	 which fill the table.  Otherwise just drop the deleted
+	 slots.  */
+      if (table->count >= nslots / 2)
+	nslots *= 2;
+      if (table->frozen
+	  || (unsigned int) nslots != nslots
+	  || !open_resize (table, nslots))
+	{
+	  /* Carry on without growing while an empty slot is left to
+	     stop lookups.  */
+	  if (used >= table->size)
+	    {
+	      bfd_set_error (bfd_error_no_memory);
+	      return false;
+	    }
+	}
+    }
+
+  i = open_find_free (table->ctrl, table->size, ent->hash);
+  if (table->ctrl[i] == CTRL_DELETED)
+    table->deleted--;
+  table->ctrl[i] = open_hash_tag (open_hash_mix (ent->hash));
+  table->slots[i].hash = ent->hash;
+  table->slots[i].entry = ent;
+  return true;
+}
+
 /*
 FUNCTION
 	bfd_hash_table_init_n
@@ -430,6 +723,10 @@ bfd_hash_table_init_n (struct bfd_hash_table *table,
 {
   unsigned long alloc;
 
+  table->slots = NULL;
+  table->ctrl = NULL;
+  table->deleted = 0;
+
   alloc = size;
   alloc *= sizeof (struct bfd_hash_entry *);
   if (alloc / sizeof (struct bfd_hash_entry *) != size)
@@ -487,6 +784,69 @@ bfd_hash_table_init (struct bfd_hash_table *table,
 				bfd_default_hash_table_size);
 }
 
+/*
+FUNCTION
+	bfd_hash_table_init_open
+
+SYNOPSIS
+	bool bfd_hash_table_init_open
+	  (struct bfd_hash_table *,
+	   struct bfd_hash_entry *(* {*newfunc*})
+	     (struct bfd_hash_entry *, struct bfd_hash_table *, const char *),
+	   unsigned int {*entsize*}, unsigned int {*size*});
+
+DESCRIPTION
+	Create a new open addressing hash table with room for about
+	@var{size} entries, or the default number of entries if
+	@var{size} is zero.  The table does not chain entries through
+	their <<next>> fields, and is traversed in the order of its
+	slots.
+*/
+
+bool
+bfd_hash_table_init_open (struct bfd_hash_table *table,
+			  struct bfd_hash_entry *(*newfunc) (struct bfd_hash_entry *,
+							     struct bfd_hash_table *,
+							     const char *),
+			  unsigned int entsize,
+			  unsigned int size)
+{
+  unsigned int nslots;
+
+  if (size == 0)
+    size = bfd_default_hash_table_size;
+  if (size > ~0u / 2)
+    {
+      bfd_set_error (bfd_error_no_memory);
+      return false;
+    }
+  for (nslots = GROUP_SIZE * 2; nslots < size; nslots *= 2)
+    ;
+
+  table->memory = (void *) objalloc_create ();
+  if (table->memory == NULL)
+    {
+      bfd_set_error (bfd_error_no_memory);
+      return false;
+    }
+  table->table = NULL;
+  table->slots = NULL;
+  table->ctrl = NULL;
+  table->size = 0;
+  table->deleted = 0;
+  if (!open_resize (table, nslots))
+    {
+      bfd_hash_table_free (table);
+      bfd_set_error (bfd_error_no_memory);
+      return false;
+    }
+  table->entsize = entsize;
+  table->count = 0;
+  table->frozen = 0;
+  table->newfunc = newfunc;
+  return true;
+}
+
 /*
 FUNCTION
 	bfd_hash_table_free
@@ -503,6 +863,10 @@ bfd_hash_table_free (struct bfd_hash_table *table)
 {
   objalloc_free ((struct objalloc *) table->memory);
   table->memory = NULL;
+  free (table->slots);
+  free (table->ctrl);
+  table->slots = NULL;
+  table->ctrl = NULL;
 }
 
 static inline unsigned long
@@ -555,15 +919,24 @@ bfd_hash_lookup (struct bfd_hash_table *table,
   unsigned int _index;
 
   hash = bfd_hash_hash (string, &len);
-  _index = hash % table->size;
-  for (hashp = table->table[_index];
-       hashp != NULL;
-       hashp = hashp->next)
+  if (table->slots != NULL)
     {
-      if (hashp->hash == hash
-	  && strcmp (hashp->string, string) == 0)
+      hashp = open_lookup (table, string, hash);
+      if (hashp != NULL)
 	return hashp;
     }
+  else
+    {
+      _index = hash % table->size;
+      for (hashp = table->table[_index];
+	   hashp != NULL;
+	   hashp = hashp->next)
+	{
+	  if (hashp->hash == hash
+	      && strcmp (hashp->string, string) == 0)
+	    return hashp;
+	}
+    }
 
   if (! create)
     return NULL;
@@ -613,6 +986,14 @@ bfd_hash_insert (struct bfd_hash_table *table,
     return NULL;
   hashp->string = string;
   hashp->hash = hash;
+  if (table->slots != NULL)
+    {
+      hashp->next = NULL;
+      if (!open_insert (table, hashp, table->count + table->deleted + 1))
+	return NULL;
+      table->count++;
+      return hashp;
+    }
   _index = hash % table->size;
   hashp->next = table->table[_index];
   table->table[_index] = hashp;
@@ -684,6 +1065,19 @@ bfd_hash_rename (struct bfd_hash_table *table,
   unsigned int _index;
   struct bfd_hash_entry **pph;
 
+  if (table->slots != NULL)
+    {
+      _index = open_find_entry (table, ent);
+      table->ctrl[_index] = CTRL_DELETED;
+      table->deleted++;
+      ent->string = string;
+      ent->hash = bfd_hash_hash (string, NULL);
+      /* There is no way to report running out of memory here.  */
+      if (!open_insert (table, ent, table->count + table->deleted))
+	abort ();
+      return;
+    }
+
   _index = ent->hash % table->size;
   for (pph = &table->table[_index]; *pph != NULL; pph = &(*pph)->next)
     if (*pph == ent)
@@ -720,6 +1114,13 @@ bfd_hash_replace (struct bfd_hash_table *table,
   unsigned int _index;
   struct bfd_hash_entry **pph;
 
+  if (table->slots != NULL)
+    {
+      _index = open_find_entry (table, old);
+      table->slots[_index].entry = nw;
+      return;
+    }
+
   _index = old->hash % table->size;
   for (pph = &table->table[_index];
        (*pph) != NULL;
@@ -806,6 +1207,18 @@ bfd_hash_traverse (struct bfd_hash_table *table,
   unsigned int i;
 
   table->frozen = 1;
+  if (table->slots != NULL)
+    {
+      /* Entries added by FUNC go in the slots being traversed, since
+	 the table does not grow while it is frozen.  */
+      for (i = 0; i < table->size; i++)
+	if (table->ctrl[i] < CTRL_EMPTY
+	    && ! (*func) (table->slots[i].entry, info))
+	  break;
+      table->frozen = 0;
+      return;
+    }
+
   for (i = 0; i < table->size; i++)
     {
       struct bfd_hash_entry *p;
@@ -945,8 +1358,8 @@ _bfd_stringtab_init (void)
   if (table == NULL)
     return NULL;
 
-  if (!bfd_hash_table_init (&table->table, strtab_hash_newfunc,
-			    sizeof (struct strtab_hash_entry)))
+  if (!bfd_hash_table_init_open (&table->table, strtab_hash_newfunc,
+				 sizeof (struct strtab_hash_entry), 0))
     {
       free (table);
       return NULL;
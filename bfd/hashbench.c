@@ -0,0 +1,281 @@
+/* Benchmark the BFD hash table implementations.
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This file is part of BFD, the Binary File Descriptor library.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* Usage: hashbench [-n REPEAT] TRACE...
+	  hashbench -g FILE...
+
+   A trace has one lookup per line: "+NAME" looks up NAME, creating an
+   entry for it if it is missing, as the linker does for each symbol it
+   reads, and "?NAME" looks it up without creating it.  Each trace is
+   replayed REPEAT times into a table made by bfd_hash_table_init and
+   one made by bfd_hash_table_init_open, and the time taken by each is
+   printed.
+
+   With -g, a trace made from the symbol tables of the object files and
+   archives FILE... is written to standard output.  Every global or
+   undefined symbol is looked up in turn with creation, then every
+   undefined symbol again without, much as when resolving relocations.
+
+   This program is not built by default.  Use "make hashbench".  */
+
+#include "sysdep.h"
+#include "bfd.h"
+#include "libiberty.h"
+
+/* One lookup of a trace.  */
+
+struct trace_op
+{
+  bool create;
+  const char *name;
+};
+
+/* Read the trace in FILENAME into *OPS, returning the number of
+   lookups in it.  The names point into *BUFP, which should be freed
+   along with *OPS.  */
+
+static size_t
+read_trace (const char *filename, struct trace_op **ops, char **bufp)
+{
+  FILE *f;
+  char *buf, *p, *end;
+  long size;
+  size_t count, alloc;
+
+  f = fopen (filename, "rb");
+  if (f == NULL
+      || fseek (f, 0, SEEK_END) != 0
+      || (size = ftell (f)) < 0
+      || fseek (f, 0, SEEK_SET) != 0)
+    {
+      perror (filename);
+      xexit (1);
+    }
+  *bufp = buf = xmalloc (size + 1);
+  if (fread (buf, 1, size, f) != (size_t) size)
+    {
+      perror (filename);
+      xexit (1);
+    }
+  fclose (f);
+  buf[size] = '\0';
+
+  count = 0;
+  alloc = 1024;
+  *ops = xmalloc (alloc * sizeof (**ops));
+  end = buf + size;
+  for (p = buf; p < end; )
+    {
+      char *nl = memchr (p, '\n', end - p);
+
+      if (nl == NULL)
+	nl = end;
+      *nl = '\0';
+      if (*p == '+' || *p == '?')
+	{
+	  if (count == alloc)
+	    {
+	      alloc *= 2;
+	      *ops = xrealloc (*ops, alloc * sizeof (**ops));
+	    }
+	  (*ops)[count].create = *p == '+';
+	  (*ops)[count].name = p + 1;
+	  count++;
+	}
+      p = nl + 1;
+    }
+  return count;
+}
+
+/* Replay the COUNT lookups OPS REPEAT times into tables made by INIT.
+   Return the time taken in microseconds, and set *ENTRIES and *FOUND
+   to the number of entries in the table and the number of lookups
+   which found an entry.  */
+
+static long
+replay (bool (*init) (struct bfd_hash_table *,
+		      struct bfd_hash_entry *(*) (struct bfd_hash_entry *,
+						  struct bfd_hash_table *,
+						  const char *),
+		      unsigned int, unsigned int),
+	const struct trace_op *ops, size_t count, int repeat,
+	unsigned int *entries, size_t *found)
+{
+  long start = get_run_time ();
+  int r;
+
+  for (r = 0; r < repeat; r++)
+    {
+      struct bfd_hash_table table;
+      size_t i;
+
+      if (!init (&table, bfd_hash_newfunc,
+		 sizeof (struct bfd_hash_entry), 0))
+	{
+	  bfd_perror ("hashbench");
+	  xexit (1);
+	}
+      *found = 0;
+      for (i = 0; i < count; i++)
+	{
+	  unsigned int before = table.count;
+	  struct bfd_hash_entry *h;
+
+	  h = bfd_hash_lookup (&table, ops[i].name, ops[i].create, false);
+	  if (h == NULL && ops[i].create)
+	    {
+	      bfd_perror ("hashbench");
+	      xexit (1);
+	    }
+	  if (h != NULL && table.count == before)
+	    ++*found;
+	}
+      *entries = table.count;
+      bfd_hash_table_free (&table);
+    }
+  return get_run_time () - start;
+}
+
+/* bfd_hash_table_init_n with the default size when SIZE is zero, to
+   match bfd_hash_table_init_open.  */
+
+static bool
+init_chained (struct bfd_hash_table *table,
+	      struct bfd_hash_entry *(*newfunc) (struct bfd_hash_entry *,
+						 struct bfd_hash_table *,
+						 const char *),
+	      unsigned int entsize, unsigned int size)
+{
+  if (size == 0)
+    return bfd_hash_table_init (table, newfunc, entsize);
+  return bfd_hash_table_init_n (table, newfunc, entsize, size);
+}
+
+/* Write the trace lookups for the symbols of ABFD.  */
+
+static void
+print_symbols (bfd *abfd)
+{
+  asymbol **syms;
+  long storage, count, i;
+
+  if (!bfd_check_format (abfd, bfd_object)
+      || (bfd_get_file_flags (abfd) & HAS_SYMS) == 0)
+    return;
+  storage = bfd_get_symtab_upper_bound (abfd);
+  if (storage <= 0)
+    return;
+  syms = xmalloc (storage);
+  count = bfd_canonicalize_symtab (abfd, syms);
+  for (i = 0; i < count; i++)
+    if ((syms[i]->flags & (BSF_GLOBAL | BSF_WEAK)) != 0
+	|| bfd_is_und_section (syms[i]->section)
+	|| bfd_is_com_section (syms[i]->section))
+      printf ("+%s\n", syms[i]->name);
+  for (i = 0; i < count; i++)
+    if (bfd_is_und_section (syms[i]->section))
+      printf ("?%s\n", syms[i]->name);
+  free (syms);
+}
+
+/* Write the trace lookups for the symbols of the object file or
+   archive FILENAME.  */
+
+static void
+print_file (const char *filename)
+{
+  bfd *abfd = bfd_openr (filename, NULL);
+
+  if (abfd == NULL)
+    {
+      bfd_perror (filename);
+      xexit (1);
+    }
+  if (bfd_check_format (abfd, bfd_archive))
+    {
+      bfd *member = NULL;
+
+      while ((member = bfd_openr_next_archived_file (abfd, member)) != NULL)
+	print_symbols (member);
+    }
+  else
+    print_symbols (abfd);
+  bfd_close (abfd);
+}
+
+int
+main (int argc, char **argv)
+{
+  int repeat = 1;
+  int i = 1;
+
+  xmalloc_set_program_name ("hashbench");
+  if (bfd_init () != BFD_INIT_MAGIC)
+    {
+      fprintf (stderr, "hashbench: libbfd ABI mismatch\n");
+      return 1;
+    }
+
+  if (i < argc && strcmp (argv[i], "-g") == 0)
+    {
+      for (i++; i < argc; i++)
+	print_file (argv[i]);
+      return 0;
+    }
+
+  if (i + 1 < argc && strcmp (argv[i], "-n") == 0)
+    {
+      repeat = atoi (argv[i + 1]);
+      i += 2;
+    }
+  if (i >= argc || repeat <= 0)
+    {
+      fprintf (stderr,
+	       "usage: hashbench [-n REPEAT] TRACE...\n"
+	       "       hashbench -g FILE...\n");
+      return 1;
+    }
+
+  for (; i < argc; i++)
+    {
+      struct trace_op *ops;
+      char *buf;
+      size_t count, found_chained, found_open;
+      unsigned int entries_chained, entries_open;
+      long chained_time, open_time;
+
+      count = read_trace (argv[i], &ops, &buf);
+      chained_time = replay (init_chained, ops, count, repeat,
+			     &entries_chained, &found_chained);
+      open_time = replay (bfd_hash_table_init_open, ops, count, repeat,
+			  &entries_open, &found_open);
+      if (entries_chained != entries_open || found_chained != found_open)
+	{
+	  fprintf (stderr, "hashbench: %s: tables differ\n", argv[i]);
+	  return 1;
+	}
+      printf ("%s: %lu lookups, %u entries: chained %.3fs, open %.3fs\n",
+	      argv[i], (unsigned long) count, entries_open,
+	      chained_time / 1e6, open_time / 1e6);
+      free (buf);
+      free (ops);
+    }
+  return 0;
+}
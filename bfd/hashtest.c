@@ -0,0 +1,294 @@
+/* Test the open addressing BFD hash tables.
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This file is part of BFD, the Binary File Descriptor library.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* Usage: hashtest
+
+   Fill a table made by bfd_hash_table_init_open with enough entries
+   to make it grow several times, then check that lookups, traversals,
+   insertions made while traversing, and renames all behave as they
+   do for a chained table.  Nothing is printed unless a check fails,
+   in which case the exit status is non-zero.  This is run by "make
+   check".  */
+
+#include "sysdep.h"
+#include "bfd.h"
+#include "libiberty.h"
+
+/* The number of entries added before traversing the table.  */
+#define NENTRIES 10000
+
+/* The number of entries added while traversing the table.  */
+#define NADDED 64
+
+struct test_entry
+{
+  struct bfd_hash_entry root;
+  /* The number of times a traversal has visited this entry.  */
+  unsigned int visits;
+};
+
+struct traverse_info
+{
+  struct bfd_hash_table *table;
+  /* The size of the table when the traversal started.  */
+  unsigned int size;
+  /* The number of entries visited.  */
+  unsigned int visited;
+  /* The number of entries added by the traversal.  */
+  unsigned int added;
+  bool failed;
+};
+
+static int failures;
+
+static void
+fail (const char *msg, const char *name)
+{
+  fprintf (stderr, "hashtest: %s%s%s\n", msg,
+	   name != NULL ? ": " : "", name != NULL ? name : "");
+  failures++;
+}
+
+static struct bfd_hash_entry *
+test_newfunc (struct bfd_hash_entry *entry,
+	      struct bfd_hash_table *table,
+	      const char *string)
+{
+  if (entry == NULL)
+    entry = bfd_hash_allocate (table, sizeof (struct test_entry));
+  if (entry == NULL)
+    return NULL;
+  entry = bfd_hash_newfunc (entry, table, string);
+  if (entry != NULL)
+    ((struct test_entry *) entry)->visits = 0;
+  return entry;
+}
+
+static const char *
+entry_name (const char *prefix, unsigned int i)
+{
+  static char buf[32];
+
+  sprintf (buf, "%s%u", prefix, i);
+  return buf;
+}
+
+/* Count the visits to ENT.  Add a new entry for each of the first
+   NADDED entries visited; the table must not grow meanwhile.  */
+
+static bool
+visit (struct bfd_hash_entry *ent, void *data)
+{
+  struct traverse_info *info = data;
+
+  ((struct test_entry *) ent)->visits++;
+  info->visited++;
+  if (info->added < NADDED)
+    {
+      const char *name = entry_name ("added", info->added);
+
+      if (bfd_hash_lookup (info->table, name, true, true) == NULL)
+	{
+	  fail ("cannot add entry while traversing", name);
+	  info->failed = true;
+	  return false;
+	}
+      info->added++;
+      if (info->table->size != info->size)
+	{
+	  fail ("table grew while traversing", NULL);
+	  info->failed = true;
+	  return false;
+	}
+    }
+  return true;
+}
+
+/* Check that ENT has been visited once, unless it was added during
+   the traversal, and reset its count.  */
+
+static bool
+check_visits (struct bfd_hash_entry *ent, void *data ATTRIBUTE_UNUSED)
+{
+  struct test_entry *te = (struct test_entry *) ent;
+
+  if (te->visits != 1 && strncmp (ent->string, "added", 5) != 0)
+    fail ("entry not visited exactly once", ent->string);
+  te->visits = 0;
+  return true;
+}
+
+/* Check that entry I of the table can be found under PREFIX and
+   return it.  */
+
+static struct bfd_hash_entry *
+check_lookup (struct bfd_hash_table *table, const char *prefix,
+	      unsigned int i)
+{
+  const char *name = entry_name (prefix, i);
+  struct bfd_hash_entry *ent = bfd_hash_lookup (table, name, false, false);
+
+  if (ent == NULL)
+    fail ("entry not found", name);
+  else if (strcmp (ent->string, name) != 0)
+    fail ("wrong entry found", name);
+  return ent;
+}
+
+int
+main (int argc ATTRIBUTE_UNUSED, char **argv ATTRIBUTE_UNUSED)
+{
+  struct bfd_hash_table table;
+  struct bfd_hash_entry **entries;
+  struct traverse_info info;
+  unsigned int initial_size, nfill, i;
+
+  xmalloc_set_program_name ("hashtest");
+  if (bfd_init () != BFD_INIT_MAGIC)
+    {
+      fprintf (stderr, "hashtest: libbfd ABI mismatch\n");
+      return 1;
+    }
+
+  /* Start small so that the table is resized several times.  */
+  if (!bfd_hash_table_init_open (&table, test_newfunc,
+				 sizeof (struct test_entry), 16))
+    {
+      bfd_perror ("hashtest");
+      return 1;
+    }
+  initial_size = table.size;
+
+  /* Insert.  */
+  entries = xmalloc (NENTRIES * sizeof (*entries));
+  for (i = 0; i < NENTRIES; i++)
+    {
+      const char *name = entry_name ("sym", i);
+
+      entries[i] = bfd_hash_lookup (&table, name, true, true);
+      if (entries[i] == NULL)
+	{
+	  bfd_perror ("hashtest");
+	  return 1;
+	}
+    }
+  if (table.count != NENTRIES)
+    fail ("wrong entry count after inserting", NULL);
+  if (table.size <= initial_size)
+    fail ("table did not grow", NULL);
+
+  /* Look up, both existing entries after the resizes, and missing
+     ones.  Looking up an existing entry with CREATE must not add
+     another.  */
+  for (i = 0; i < NENTRIES; i++)
+    if (check_lookup (&table, "sym", i) != entries[i])
+      fail ("entry moved", entry_name ("sym", i));
+  for (i = 0; i < NENTRIES; i++)
+    if (bfd_hash_lookup (&table, entry_name ("missing", i),
+			 false, false) != NULL)
+      fail ("missing entry found", entry_name ("missing", i));
+  if (bfd_hash_lookup (&table, "sym0", true, true) != entries[0]
+      || table.count != NENTRIES)
+    fail ("existing entry added again", "sym0");
+
+  /* Fill the table up to the point where one more entry makes it
+     grow, then traverse it, adding entries on the way.  */
+  nfill = 0;
+  while (table.count + table.deleted + 1 <= table.size / 8 * 7)
+    {
+      if (bfd_hash_lookup (&table, entry_name ("fill", nfill),
+			   true, true) == NULL)
+	{
+	  bfd_perror ("hashtest");
+	  return 1;
+	}
+      nfill++;
+    }
+  info.table = &table;
+  info.size = table.size;
+  info.visited = 0;
+  info.added = 0;
+  info.failed = false;
+  bfd_hash_traverse (&table, visit, &info);
+  if (!info.failed)
+    {
+      if (info.added != NADDED)
+	fail ("wrong number of entries added while traversing", NULL);
+      if (info.visited < NENTRIES + nfill
+	  || info.visited > NENTRIES + nfill + NADDED)
+	fail ("wrong number of entries visited", NULL);
+      if (table.count != NENTRIES + nfill + NADDED)
+	fail ("wrong entry count after traversing", NULL);
+      bfd_hash_traverse (&table, check_visits, NULL);
+    }
+  if (table.frozen)
+    fail ("table still frozen after traversing", NULL);
+  for (i = 0; i < info.added; i++)
+    check_lookup (&table, "added", i);
+  for (i = 0; i < nfill; i++)
+    check_lookup (&table, "fill", i);
+
+  /* Rename every other entry, then grow the table again.  */
+  for (i = 0; i < NENTRIES; i += 2)
+    {
+      const char *name = entry_name ("renamed", i);
+      char *copy = bfd_hash_allocate (&table, strlen (name) + 1);
+
+      if (copy == NULL)
+	{
+	  bfd_perror ("hashtest");
+	  return 1;
+	}
+      strcpy (copy, name);
+      bfd_hash_rename (&table, copy, entries[i]);
+    }
+  for (i = 0; i < NENTRIES; i++)
+    {
+      const char *name = entry_name ("more", i);
+
+      if (bfd_hash_lookup (&table, name, true, true) == NULL)
+	{
+	  bfd_perror ("hashtest");
+	  return 1;
+	}
+    }
+  for (i = 0; i < NENTRIES; i++)
+    {
+      if (i % 2 == 0)
+	{
+	  if (check_lookup (&table, "renamed", i) != entries[i])
+	    fail ("renamed entry moved", entry_name ("renamed", i));
+	  if (bfd_hash_lookup (&table, entry_name ("sym", i),
+			       false, false) != NULL)
+	    fail ("old name still found", entry_name ("sym", i));
+	}
+      else if (check_lookup (&table, "sym", i) != entries[i])
+	fail ("entry moved", entry_name ("sym", i));
+      check_lookup (&table, "more", i);
+    }
+  if (table.count != 2 * NENTRIES + nfill + NADDED)
+    fail ("wrong entry count after renaming", NULL);
+
+  bfd_hash_table_free (&table);
+  if (table.slots != NULL || table.ctrl != NULL)
+    fail ("slots not freed", NULL);
+  free (entries);
+  return failures != 0;
+}
@@ -1059,6 +1059,9 @@ bool bfd_cache_set_uncloseable (bfd *abfd, bool value, bool *old) ATTRIBUTE_HIDD
 
 FILE* bfd_open_file (bfd *abfd) ATTRIBUTE_HIDDEN;
 
+void *_bfd_mmap_output
+   (bfd *abfd, ufile_ptr size, size_t *map_size) ATTRIBUTE_HIDDEN;
+
 /* Extracted from hash.c.  */
 struct bfd_strtab_hash *_bfd_stringtab_init (void) ATTRIBUTE_HIDDEN;
 
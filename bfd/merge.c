@@ -697,21 +697,35 @@ _bfd_add_merge_section (bfd *abfd, void **psinfo, asection *sec,
   return false;
 }
 
-/* Record one whole input section (described by SECINFO) into the hash table
-   SINFO.  */
+/* The contents of an input section about to be recorded into the hash
+   table, and the hash and length of each blob in it if they were
+   computed ahead of time.  */
+
+struct sec_merge_blobs
+{
+  struct sec_merge_sec_info *secinfo;
+  struct sec_merge_hash *htab;
+  bfd_byte *contents;
+  /* 'hashcode << 32 | len' of each blob in turn, as in the key_lens
+     of the hash table, or NULL if they are to be computed while the
+     blobs are recorded.  */
+  uint64_t *key_lens;
+  size_t count;
+};
+
+/* The most bytes of section contents read ahead of their recording
+   into the hash table, so that they may be hashed in parallel.  This
+   is plenty to keep the threads busy, without holding the contents of
+   every input section in memory at once.  */
+#define MERGE_BATCH_SIZE ((bfd_size_type) 4 << 20)
+
+/* Read in the contents of the input section of BLOBS.  */
 
 static bool
-record_section (struct sec_merge_info *sinfo,
-		struct sec_merge_sec_info *secinfo)
+read_section_blobs (struct sec_merge_blobs *blobs)
 {
-  asection *sec = secinfo->sec;
-  struct sec_merge_hash_entry *entry;
-  unsigned char *p, *end;
-  bfd_vma mask, eltalign;
-  unsigned int align;
+  asection *sec = blobs->secinfo->sec;
   bfd_size_type amt;
-  bfd_byte *contents;
-  void *tmpptr;
 
   amt = sec->size;
   if (sec->flags & SEC_STRINGS)
@@ -719,16 +733,100 @@ record_section (struct sec_merge_info *sinfo,
        See http://gcc.gnu.org/ml/gcc-patches/2006-06/msg01004.html
        Allocate space for an extra zero.  */
     amt += sec->entsize;
-  contents = bfd_malloc (amt);
-  if (!contents)
-    goto error_return;
+  blobs->contents = bfd_malloc (amt);
+  if (!blobs->contents)
+    return false;
 
   /* Slurp in all section contents (possibly decompressing it).  */
   sec->rawsize = sec->size;
   if (sec->flags & SEC_STRINGS)
-    memset (contents + sec->size, 0, sec->entsize);
-  if (! bfd_get_full_section_contents (sec->owner, sec, &contents))
-    goto error_return;
+    memset (blobs->contents + sec->size, 0, sec->entsize);
+  return bfd_get_full_section_contents (sec->owner, sec, &blobs->contents);
+}
+
+/* Calculate the hashes and lengths of all blobs (strings or
+   fixed-size entries) in the contents of BLOBS.  This only reads the
+   hash table, so may be done for several sections at once.  If memory
+   runs out, BLOBS->KEY_LENS is left NULL and record_section computes
+   them instead.  */
+
+static void
+hash_section_blobs (struct sec_merge_blobs *blobs)
+{
+  struct sec_merge_hash *htab = blobs->htab;
+  bfd_size_type size = blobs->secinfo->sec->size;
+  unsigned char *p, *end;
+  size_t alloc;
+
+  /* Strings are usually a good deal longer than this.  */
+  alloc = size / (htab->strings ? 16 * htab->entsize : htab->entsize) + 1;
+  blobs->key_lens = bfd_malloc (alloc * sizeof (blobs->key_lens[0]));
+  blobs->count = 0;
+  if (blobs->key_lens == NULL)
+    return;
+
+  end = blobs->contents + size;
+  for (p = blobs->contents; p < end;)
+    {
+      unsigned int len;
+      uint32_t hash = hashit (htab, (char *) p, &len);
+
+      if (blobs->count == alloc)
+	{
+	  uint64_t *tmp;
+
+	  alloc *= 2;
+	  tmp = bfd_realloc (blobs->key_lens,
+			     alloc * sizeof (blobs->key_lens[0]));
+	  if (tmp == NULL)
+	    {
+	      free (blobs->key_lens);
+	      blobs->key_lens = NULL;
+	      return;
+	    }
+	  blobs->key_lens = tmp;
+	}
+      blobs->key_lens[blobs->count++] = ((uint64_t) hash << 32) | len;
+      p += len;
+    }
+}
+
+/* The parallel_run worker for hash_section_blobs.  */
+
+static void
+hash_section_blobs_worker (void *data, size_t i)
+{
+  hash_section_blobs ((struct sec_merge_blobs *) data + i);
+}
+
+/* Free the buffers of BLOBS.  */
+
+static void
+free_section_blobs (struct sec_merge_blobs *blobs)
+{
+  free (blobs->contents);
+  blobs->contents = NULL;
+  free (blobs->key_lens);
+  blobs->key_lens = NULL;
+}
+
+/* Record one whole input section (described by BLOBS) into the hash
+   table SINFO, using the hashes computed by hash_section_blobs if
+   there are any.  */
+
+static bool
+record_section (struct sec_merge_info *sinfo,
+		struct sec_merge_blobs *blobs)
+{
+  struct sec_merge_sec_info *secinfo = blobs->secinfo;
+  asection *sec = secinfo->sec;
+  struct sec_merge_hash_entry *entry;
+  unsigned char *p, *end;
+  bfd_vma mask, eltalign;
+  unsigned int align;
+  bfd_size_type amt;
+  size_t i;
+  void *tmpptr;
 
   /* Now populate the hash table and offset mapping.  */
 
@@ -742,16 +840,24 @@ record_section (struct sec_merge_info *sinfo,
     }
 
   /* Walk through the contents, calculate hashes and length of all
-     blobs (strings or fixed-size entries) we find and fill the
-     hash and offset tables.  */
+     blobs (strings or fixed-size entries) we find unless that was done
+     already, and fill the hash and offset tables.  */
   align = sec->alignment_power;
   mask = ((bfd_vma) 1 << align) - 1;
-  end = contents + sec->size;
-  for (p = contents; p < end;)
+  end = blobs->contents + sec->size;
+  for (p = blobs->contents, i = 0; p < end; i++)
     {
       unsigned len;
-      uint32_t hash = hashit (sinfo->htab, (char*) p, &len);
-      unsigned int ofs = p - contents;
+      uint32_t hash;
+      unsigned int ofs = p - blobs->contents;
+
+      if (blobs->key_lens != NULL)
+	{
+	  len = (uint32_t) blobs->key_lens[i];
+	  hash = blobs->key_lens[i] >> 32;
+	}
+      else
+	hash = hashit (sinfo->htab, (char *) p, &len);
       eltalign = ofs;
       eltalign = ((eltalign ^ (eltalign - 1)) + 1) >> 1;
       if (!eltalign || eltalign > mask)
@@ -770,8 +876,7 @@ record_section (struct sec_merge_info *sinfo,
   /* But don't count it.  */
   secinfo->noffsetmap--;
 
-  free (contents);
-  contents = NULL;
+  free_section_blobs (blobs);
 
   /* We allocate the ofsmap arrays in blocks of 2048 elements.
      In case we have very many small input files/sections,
@@ -791,11 +896,104 @@ record_section (struct sec_merge_info *sinfo,
   return true;
 
  error_return:
-  free (contents);
-  contents = NULL;
+  free_section_blobs (blobs);
+  return false;
+}
+
+/* Record the input sections of SINFO into its hash table, in order.
+   When INFO allows, the sections are read in a batch at a time and the
+   blobs of the sections in a batch are hashed in parallel.  Otherwise
+   each section is read and hashed as it is recorded.  Return the
+   alignment of the merged section if all input sections were padded
+   to their alignment, 0 if not, or -1 on error.  */
+
+static bfd_size_type
+record_sections (bfd *abfd, struct bfd_link_info *info,
+		 struct sec_merge_info *sinfo,
+		 void (*remove_hook) (bfd *, asection *))
+{
+  struct sec_merge_sec_info *secinfo, *next;
+  struct sec_merge_blobs *batch;
+  size_t nbatch, batch_alloc, i;
+  bfd_size_type align, batch_size;
+  bool parallel;
+
+  parallel = (info != NULL
+	      && info->threads > 1
+	      && info->callbacks->parallel_run != NULL);
+  batch = NULL;
+  batch_alloc = 0;
+  nbatch = 0;
+  align = 1;
+  for (secinfo = sinfo->chain; secinfo; secinfo = next)
+    {
+      /* Read in the next batch of sections.  Without threads a batch
+	 is just one section.  */
+      batch_size = 0;
+      for (next = secinfo; next; next = next->next)
+	{
+	  if (next->sec->flags & SEC_EXCLUDE)
+	    {
+	      *next->psecinfo = NULL;
+	      if (remove_hook)
+		(*remove_hook) (abfd, next->sec);
+	      continue;
+	    }
+
+	  if (nbatch != 0
+	      && (!parallel || batch_size + next->sec->size > MERGE_BATCH_SIZE))
+	    break;
+
+	  if (nbatch == batch_alloc)
+	    {
+	      struct sec_merge_blobs *tmp;
+
+	      batch_alloc = batch_alloc * 2 + 16;
+	      tmp = bfd_realloc (batch, batch_alloc * sizeof (*batch));
+	      if (tmp == NULL)
+		goto error_return;
+	      batch = tmp;
+	    }
+	  memset (&batch[nbatch], 0, sizeof (*batch));
+	  batch[nbatch].secinfo = next;
+	  batch[nbatch].htab = sinfo->htab;
+	  if (!read_section_blobs (&batch[nbatch++]))
+	    goto error_return;
+	  batch_size += next->sec->size;
+	}
+
+      if (nbatch > 1)
+	(*info->callbacks->parallel_run) (info, hash_section_blobs_worker,
+					  batch, nbatch);
+
+      for (i = 0; i < nbatch; i++)
+	{
+	  asection *sec = batch[i].secinfo->sec;
+
+	  if (!record_section (sinfo, &batch[i]))
+	    goto error_return;
+	  if (align)
+	    {
+	      unsigned int opb = bfd_octets_per_byte (abfd, sec);
+
+	      align = (bfd_size_type) 1 << sec->alignment_power;
+	      if (((sec->size / opb) & (align - 1)) != 0)
+		align = 0;
+	    }
+	}
+      nbatch = 0;
+    }
+
+  free (batch);
+  return align;
+
+ error_return:
+  for (i = 0; i < nbatch; i++)
+    free_section_blobs (&batch[i]);
+  free (batch);
   for (secinfo = sinfo->chain; secinfo; secinfo = secinfo->next)
     *secinfo->psecinfo = NULL;
-  return false;
+  return (bfd_size_type) -1;
 }
 
 /* qsort comparison function.  Won't ever return zero as all entries
@@ -865,10 +1063,106 @@ is_suffix (const struct sec_merge_hash_entry *A,
 		 B->str, B->len) == 0;
 }
 
+/* The strings sorted by sort_strings, distributed over buckets.  */
+
+struct sec_merge_sort
+{
+  struct sec_merge_hash_entry **array;
+  /* Bucket I is ARRAY[START[I]] to ARRAY[START[I + 1] - 1].  */
+  size_t *start;
+  int (*cmp) (const void *, const void *);
+};
+
+/* Return the bucket of string E for sort_strings: its last character
+   and, if ALIGNMENT is not 0, its length modulo ALIGNMENT, which are
+   what strrevcmp and strrevcmp_align compare first.  */
+
+static inline unsigned int
+strrev_bucket (const struct sec_merge_hash_entry *e, unsigned int alignment)
+{
+  unsigned int bucket = 0;
+
+  if (e->len != 0)
+    bucket = 1 + (unsigned char) e->str[e->len - 1];
+  if (alignment != 0)
+    bucket += (e->len & (alignment - 1)) * 257;
+  return bucket;
+}
+
+/* Sort bucket I of the struct sec_merge_sort DATA.  */
+
+static void
+sort_strings_bucket (void *data, size_t i)
+{
+  struct sec_merge_sort *sort = data;
+  size_t n = sort->start[i + 1] - sort->start[i];
+
+  if (n > 1)
+    qsort (sort->array + sort->start[i], n,
+	   sizeof (struct sec_merge_hash_entry *), sort->cmp);
+}
+
+/* Sort the COUNT strings of ARRAY with strrevcmp, or strrevcmp_align
+   if ALIGNMENT is not 0.  If INFO allows threads, a counting sort on
+   the bucket given by strrev_bucket comes first, then the buckets are
+   sorted in parallel.  As no two strings compare equal, the order is
+   the same as that of the single qsort done otherwise.  */
+
+static bool
+sort_strings (struct bfd_link_info *info,
+	      struct sec_merge_hash_entry **array, size_t count,
+	      unsigned int alignment)
+{
+  struct sec_merge_sort sort;
+  struct sec_merge_hash_entry **sorted;
+  size_t nbuckets, i;
+
+  sort.cmp = alignment != 0 ? strrevcmp_align : strrevcmp;
+  nbuckets = 257 * (alignment != 0 ? alignment : 1);
+  if (info == NULL
+      || info->threads <= 1
+      || info->callbacks->parallel_run == NULL
+      || alignment > 64
+      || count < 2)
+    {
+      qsort (array, count, sizeof (struct sec_merge_hash_entry *), sort.cmp);
+      return true;
+    }
+
+  sort.start = bfd_zmalloc ((nbuckets + 1) * sizeof (sort.start[0]));
+  sorted = bfd_malloc (count * sizeof (sorted[0]));
+  if (sort.start == NULL || sorted == NULL)
+    {
+      free (sort.start);
+      free (sorted);
+      return false;
+    }
+
+  for (i = 0; i < count; i++)
+    sort.start[strrev_bucket (array[i], alignment) + 1]++;
+  for (i = 0; i < nbuckets; i++)
+    sort.start[i + 1] += sort.start[i];
+  for (i = 0; i < count; i++)
+    sorted[sort.start[strrev_bucket (array[i], alignment)]++] = array[i];
+  /* Each START[I] is now the end of bucket I, i.e. where bucket I + 1
+     begins.  Shift them back.  */
+  memmove (sort.start + 1, sort.start, nbuckets * sizeof (sort.start[0]));
+  sort.start[0] = 0;
+
+  sort.array = sorted;
+  (*info->callbacks->parallel_run) (info, sort_strings_bucket,
+				    &sort, nbuckets);
+
+  memcpy (array, sorted, count * sizeof (array[0]));
+  free (sorted);
+  free (sort.start);
+  return true;
+}
+
 /* This is a helper function for _bfd_merge_sections.  It attempts to
    merge strings matching suffixes of longer strings.  */
 static struct sec_merge_sec_info *
-merge_strings (struct sec_merge_info *sinfo)
+merge_strings (struct bfd_link_info *info, struct sec_merge_info *sinfo)
 {
   struct sec_merge_hash_entry **array, **a, *e;
   struct sec_merge_sec_info *secinfo;
@@ -899,10 +1193,14 @@ merge_strings (struct sec_merge_info *sinfo)
   sinfo->htab->size = a - array;
   if (sinfo->htab->size != 0)
     {
-      qsort (array, (size_t) sinfo->htab->size,
-	     sizeof (struct sec_merge_hash_entry *),
-	     (alignment != (unsigned) -1 && alignment > sinfo->htab->entsize
-	      ? strrevcmp_align : strrevcmp));
+      if (!sort_strings (info, array, sinfo->htab->size,
+			 (alignment != (unsigned) -1
+			  && alignment > sinfo->htab->entsize
+			  ? alignment : 0)))
+	{
+	  free (array);
+	  return NULL;
+	}
 
       /* Loop over the sorted array and merge suffixes */
       e = *--a;
@@ -966,7 +1264,7 @@ merge_strings (struct sec_merge_info *sinfo)
 
 bool
 _bfd_merge_sections (bfd *abfd,
-		     struct bfd_link_info *info ATTRIBUTE_UNUSED,
+		     struct bfd_link_info *info,
 		     void *xsinfo,
 		     void (*remove_hook) (bfd *, asection *))
 {
@@ -981,34 +1279,16 @@ _bfd_merge_sections (bfd *abfd,
 	continue;
 
       /* Record the sections into the hash table.  */
-      align = 1;
-      for (secinfo = sinfo->chain; secinfo; secinfo = secinfo->next)
-	if (secinfo->sec->flags & SEC_EXCLUDE)
-	  {
-	    *secinfo->psecinfo = NULL;
-	    if (remove_hook)
-	      (*remove_hook) (abfd, secinfo->sec);
-	  }
-	else
-	  {
-	    if (!record_section (sinfo, secinfo))
-	      return false;
-	    if (align)
-	      {
-		unsigned int opb = bfd_octets_per_byte (abfd, secinfo->sec);
-
-		align = (bfd_size_type) 1 << secinfo->sec->alignment_power;
-		if (((secinfo->sec->size / opb) & (align - 1)) != 0)
-		  align = 0;
-	      }
-	  }
+      align = record_sections (abfd, info, sinfo, remove_hook);
+      if (align == (bfd_size_type) -1)
+	return false;
 
       if (sinfo->htab->first == NULL)
 	continue;
 
       if (sinfo->htab->strings)
 	{
-	  secinfo = merge_strings (sinfo);
+	  secinfo = merge_strings (info, sinfo);
 	  if (!secinfo)
 	    return false;
 	}
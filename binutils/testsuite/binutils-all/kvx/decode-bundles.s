@@ -0,0 +1,16 @@
+foo:
+	addd $r0 = $r0, 123456789010
+	addd $r1 = $r2, 1234
+	fmuld $r3 = $r4, $r5
+	lwz $r6 = 0[$r7]
+	;;
+	call bar
+	pcrel $r0 = @pcrel(bar)
+	;;
+	make $r1 = -512
+	;;
+	.word 0x3fffffff
+	;;
+bar:
+	ret
+	;;
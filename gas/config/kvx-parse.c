@@ -440,20 +440,121 @@ promote_token (struct token_s tok)
     }
 }
 
+/* Return whether TOKEN is a prefix of some instruction mnemonic, walking
+   the trie of the mnemonics.  */
+
 static int
-is_insn (const struct token_s *token, struct token_class *classes)
+is_insn (const struct token_s *token)
 {
-  int res = false;
   int i = 0;
   int tok_sz = token->end - token->begin;
-  char *tok = token->insn + token->begin;
-  while (!res && classes[i].class_values != NULL)
+  const char *tok = token->insn + token->begin;
+  struct node_s *cur = env.insns;
+
+  while (cur)
     {
-      res = !strncmp (classes[i].class_values[0], tok, tok_sz);
-      i += 1;
+      int n = cur->len < tok_sz - i ? cur->len : tok_sz - i;
+      if (strncmp (tok + i, cur->val, n))
+	return 0;
+
+      i += n;
+      if (i == tok_sz)
+	return 1;
+
+      struct node_list_s *cur_succ = cur->succs;
+      cur = NULL;
+      for (; cur_succ; cur_succ = cur_succ->nxt)
+	if (cur_succ->node && cur_succ->node->val[0] == tok[i])
+	  cur = cur_succ->node;
     }
 
-  return res;
+  return 0;
+}
+
+/* Position of a token text in the token classes of its category.  */
+struct token_class_ref
+{
+  /* Index of the first class that contains the text.  */
+  int cur;
+  /* Index of the text in the values of that class.  */
+  int val;
+};
+
+/* Hash table from the texts of the token classes of a category to their
+   token_class_ref, so that tokens are classified by a single probe.  */
+struct token_class_hash
+{
+  htab_t htab;
+  struct token_class_ref *refs;
+  /* Length of the longest text.  */
+  int max_len;
+  /* The value left in the token on a miss by the linear scan of the
+     classes this table replaces.  */
+  int miss_val;
+};
+
+#define TOKEN_CLASS_MAX_LEN 63
+
+static struct token_class_hash reg_class_hash;
+static struct token_class_hash mod_class_hash;
+static struct token_class_hash insn_class_hash;
+static struct token_class_hash sep_class_hash;
+
+static void
+token_class_hash_free (struct token_class_hash *hash)
+{
+  if (hash->htab)
+    htab_delete (hash->htab);
+  free (hash->refs);
+  memset (hash, 0, sizeof (*hash));
+}
+
+static void
+token_class_hash_init (struct token_class_hash *hash, struct token_class *class)
+{
+  int nb_refs = 0;
+
+  token_class_hash_free (hash);
+  for (int cur = 0; class[cur].class_id != -1; ++cur)
+    nb_refs += class[cur].sz;
+
+  hash->htab = str_htab_create ();
+  hash->refs = XNEWVEC (struct token_class_ref, nb_refs);
+  hash->max_len = 0;
+  hash->miss_val = 0;
+
+  nb_refs = 0;
+  for (int cur = 0; class[cur].class_id != -1; ++cur)
+    for (int i = 0; i < class[cur].sz; ++i)
+      {
+	const char *text = class[cur].class_values[i];
+	struct token_class_ref *ref = &hash->refs[nb_refs++];
+	int len = strlen (text);
+
+	ref->cur = cur;
+	ref->val = i;
+	hash->max_len = max (hash->max_len, len);
+	hash->miss_val = i;
+	/* A text keeps the first class it appears in.  */
+	str_hash_insert (hash->htab, text, ref, 0);
+      }
+
+  if (hash->max_len > TOKEN_CLASS_MAX_LEN)
+    as_fatal ("internal error: token class value too long");
+}
+
+static const struct token_class_ref *
+token_class_hash_find (const struct token_class_hash *hash, const char *tok,
+		       int tok_sz)
+{
+  char text[TOKEN_CLASS_MAX_LEN + 1];
+
+  if (tok_sz > hash->max_len)
+    return NULL;
+
+  memcpy (text, tok, tok_sz);
+  text[tok_sz] = '\0';
+  return str_hash_find (hash->htab, text);
 }
 
 static int64_t
@@ -469,14 +570,17 @@ get_token_class (struct token_s *token, struct token_classes *classes, int insn_
   int token_val_p = 0;
 
   struct token_class *class;
+  const struct token_class_hash *class_hash = NULL;
   if (tok[0] == '$')
     {
       class = classes->reg_classes;
+      class_hash = &reg_class_hash;
       token->category = CAT_REGISTER;
     }
   else if (modifier_p && tok[0] == '.')
     {
       class = classes->mod_classes;
+      class_hash = &mod_class_hash;
       token->category = CAT_MODIFIER;
     }
   else if (isdigit (tok[0]) || tok[0] == '+' || tok[0] == '-')
@@ -494,11 +598,13 @@ get_token_class (struct token_s *token, struct token_classes *classes, int insn_
   else if (tok_sz == 1 && is_delim (tok[0]))
     {
       class = classes->sep_classes;
+      class_hash = &sep_class_hash;
       token->category = CAT_SEPARATOR;
     }
-  else if (insn_p && is_insn (token, classes->insn_classes))
+  else if (insn_p && is_insn (token))
     {
       class = classes->insn_classes;
+      class_hash = &insn_class_hash;
       token->category = CAT_INSTRUCTION;
     }
   else
@@ -555,18 +661,16 @@ get_token_class (struct token_s *token, struct token_classes *classes, int insn_
     }
   else
     {
-      do
+      const struct token_class_ref *ref
+	= token_class_hash_find (class_hash, tok, tok_sz);
+      if (ref)
 	{
-	  for (int i = 0; !found && i < class[cur].sz; ++i)
-	    {
-	      const char *ref = class[cur].class_values[i];
-	      found = ((long) strlen (ref) == tok_sz) && !strncmp (tok, ref, tok_sz);
-	      token->val = i;
-	    }
-
-	  cur += !(found);
+	  cur = ref->cur;
+	  token->val = ref->val;
+	  found = 1;
 	}
-      while (!found && class[cur].class_id != -1);
+      else
+	token->val = class_hash->miss_val;
     }
 
   if (!found)
@@ -792,13 +896,28 @@ rule_expect_error (char *tok, int rule_id, char *buf, int bufsz __attribute__((u
     }
 }
 
+/* Token list cells freed by free_token_list, kept with their text buffer
+   so that parsing a line stops allocating once enough cells exist.  */
+static struct token_list *free_tokens;
+
 static struct token_list *
 create_token (struct token_s tok, int len, int loc)
 {
-  struct token_list *tl = calloc (1, sizeof *tl);
+  struct token_list *tl = free_tokens;
   int tok_sz = tok.end - tok.begin;
-  tl->tok = calloc (tok_sz + 1, sizeof (char));
+
+  if (tl)
+    free_tokens = tl->next;
+  else
+    tl = XCNEW (struct token_list);
+
+  if (tl->tok_size < tok_sz + 1)
+    {
+      tl->tok_size = max (tok_sz + 1, 16);
+      tl->tok = XRESIZEVEC (char, tl->tok, tl->tok_size);
+    }
   memcpy (tl->tok, tok.insn + tok.begin, tok_sz * sizeof (char));
+  tl->tok[tok_sz] = '\0';
   tl->val = tok.val;
   tl->class_id = tok.class_id;
   tl->category = tok.category;
@@ -825,13 +944,26 @@ void
 free_token_list (struct token_list *tok_list)
 {
   struct token_list *cur = tok_list;
+
+  if (!cur)
+    return;
+
+  while (cur->next)
+    cur = cur->next;
+  cur->next = free_tokens;
+  free_tokens = tok_list;
+}
+
+static void
+release_free_tokens (void)
+{
   struct token_list *tmp;
-  while (cur)
+
+  while ((tmp = free_tokens))
     {
-      tmp = cur->next;
-      free (cur->tok);
-      free (cur);
-      cur = tmp;
+      free_tokens = tmp->next;
+      free (tmp->tok);
+      free (tmp);
     }
 }
 
@@ -862,10 +994,18 @@ struct error_list
   struct error_list *nxt;
 };
 
+/* Error list cells freed by free_error_list, for reuse.  */
+static struct error_list *free_errors;
+
 static struct error_list *
 error_list_insert (int rule, int loc, struct error_list *nxt)
 {
-  struct error_list *n = calloc (1, sizeof (*n));
+  struct error_list *n = free_errors;
+
+  if (n)
+    free_errors = n->nxt;
+  else
+    n = XNEW (struct error_list);
   n->loc = loc;
   n->rule = rule;
   n->nxt = nxt;
@@ -875,12 +1015,27 @@ error_list_insert (int rule, int loc, struct error_list *nxt)
 static void
 free_error_list (struct error_list *l)
 {
-  struct error_list *tmp, *cur_err = l;
-  while ((tmp = cur_err))
-  {
+  struct error_list *cur_err = l;
+
+  if (!cur_err)
+    return;
+
+  while (cur_err->nxt)
     cur_err = cur_err->nxt;
-    free (tmp);
-  }
+  cur_err->nxt = free_errors;
+  free_errors = l;
+}
+
+static void
+release_free_errors (void)
+{
+  struct error_list *tmp;
+
+  while ((tmp = free_errors))
+    {
+      free_errors = tmp->nxt;
+      free (tmp);
+    }
 }
 
 static int
@@ -898,10 +1053,143 @@ CLASS_ID (struct token_s tok)
   }
 }
 
-struct parser {
-
+/* The alternatives of a rule steered by a given token class.  */
+struct steering_alt
+{
+  int rule;
+  int steering;
+  /* Index in the rule of the first such alternative.  */
+  int first;
 };
 
+/* Dispatch table of the grammar, compiled at setup: it maps a rule and a
+   token class to the alternatives of the rule steered by that class, in
+   table order, so that parse_with_restarts does not scan the rules.  */
+static struct
+{
+  htab_t htab;
+  struct steering_alt *alts;
+  int nb_rules;
+  /* Offset in NEXT of the alternatives of each rule.  */
+  int *offset;
+  /* For each alternative, the index of the next alternative of the same
+     rule with the same steering, or of the terminator of the rule.  */
+  int *next;
+  /* Index of the terminator of each rule.  */
+  int *end;
+} steering_dispatch;
+
+static hashval_t
+steering_alt_hash (const void *p)
+{
+  const struct steering_alt *alt = p;
+  return (hashval_t) alt->rule * 0x9e3779b1u ^ (hashval_t) alt->steering;
+}
+
+static int
+steering_alt_eq (const void *p1, const void *p2)
+{
+  const struct steering_alt *alt1 = p1;
+  const struct steering_alt *alt2 = p2;
+  return alt1->rule == alt2->rule && alt1->steering == alt2->steering;
+}
+
+static void
+steering_dispatch_free (void)
+{
+  if (steering_dispatch.htab)
+    htab_delete (steering_dispatch.htab);
+  free (steering_dispatch.alts);
+  free (steering_dispatch.offset);
+  free (steering_dispatch.next);
+  free (steering_dispatch.end);
+  memset (&steering_dispatch, 0, sizeof (steering_dispatch));
+}
+
+static void
+steering_dispatch_init (struct rule rules[])
+{
+  int nb_rules = 1;
+  int nb_alts = 0;
+
+  steering_dispatch_free ();
+
+  /* The rules are not terminated: count those reachable from rule 0.  */
+  for (int r = 0; r < nb_rules; ++r)
+    for (struct steering_rule *sr = rules[r].rules; sr->steering != -1; ++sr)
+      {
+	nb_rules = max (nb_rules, sr->jump_target + 1);
+	nb_rules = max (nb_rules, sr->stack_it + 1);
+	nb_alts += 1;
+      }
+
+  steering_dispatch.nb_rules = nb_rules;
+  steering_dispatch.alts = XNEWVEC (struct steering_alt, nb_alts);
+  steering_dispatch.offset = XNEWVEC (int, nb_rules);
+  steering_dispatch.next = XNEWVEC (int, nb_alts + nb_rules);
+  steering_dispatch.end = XNEWVEC (int, nb_rules);
+  steering_dispatch.htab = htab_create_alloc (nb_alts, steering_alt_hash,
+					      steering_alt_eq, NULL,
+					      xcalloc, free);
+
+  int nb_next = 0;
+  nb_alts = 0;
+  for (int r = 0; r < nb_rules; ++r)
+    {
+      struct steering_rule *cur_rule = rules[r].rules;
+      int *next = steering_dispatch.next + nb_next;
+      int end = 0;
+
+      while (cur_rule[end].steering != -1)
+	end += 1;
+      steering_dispatch.offset[r] = nb_next;
+      steering_dispatch.end[r] = end;
+      nb_next += end + 1;
+      next[end] = end;
+
+      /* Walk backwards so that each alternative is chained to the next one
+	 with the same steering, and the table ends up on the first one.  */
+      for (int i = end - 1; i >= 0; --i)
+	{
+	  struct steering_alt key = { r, cur_rule[i].steering, i };
+	  void **slot = htab_find_slot (steering_dispatch.htab, &key, INSERT);
+	  struct steering_alt *alt = *slot;
+
+	  if (alt)
+	    {
+	      next[i] = alt->first;
+	      alt->first = i;
+	    }
+	  else
+	    {
+	      alt = &steering_dispatch.alts[nb_alts++];
+	      *alt = key;
+	      next[i] = end;
+	      *slot = alt;
+	    }
+	}
+    }
+}
+
+/* Return the index of the first alternative of RULE, at or after FROM, that
+   is steered by STEERING, or the index of the terminator of RULE.  */
+
+static int
+steering_find (int rule, int steering, int from)
+{
+  struct steering_alt key = { rule, steering, 0 };
+  struct steering_alt *alt = htab_find (steering_dispatch.htab, &key);
+  const int *next = steering_dispatch.next + steering_dispatch.offset[rule];
+  int i;
+
+  if (!alt)
+    return steering_dispatch.end[rule];
+
+  for (i = alt->first; i < from; i = next[i])
+    ;
+  return i;
+}
+
 static struct token_list *
 parse_with_restarts (struct token_s tok, int jump_target, struct rule rules[],
 		     struct error_list **errs)
@@ -923,9 +1211,7 @@ parse_with_restarts (struct token_s tok, int jump_target, struct rule rules[],
 		jump_target, TOKEN_NAME (CLASS_ID (tok)), CLASS_ID (tok));
 
   /* 1. Find a rule that can be used with the current token. */
-  int i = 0;
-  while (cur_rule[i].steering != -1 && cur_rule[i].steering != CLASS_ID (tok))
-    i += 1;
+  int i = steering_find (jump_target, CLASS_ID (tok), 0);
 
   printf_debug (1, "steering: %d (%s), jump_target: %d, stack_it: %d\n",
 		cur_rule[i].steering, TOKEN_NAME (cur_rule[i].steering),
@@ -976,9 +1262,7 @@ retry:;
 
   if (!fst_part)
     {
-      i += 1;
-      while (cur_rule[i].steering != CLASS_ID(tok) && cur_rule[i].steering != -1)
-	i += 1;
+      i = steering_find (jump_target, CLASS_ID (tok), i + 1);
       if (cur_rule[i].steering != -1)
 	goto retry;
     }
@@ -1026,10 +1310,8 @@ retry:;
   if (!snd_part)
     {
       free_token_list (fst_part);
-      i += 1;
       tok = init_tok;
-      while (cur_rule[i].steering != CLASS_ID (tok) && cur_rule[i].steering != -1)
-	i += 1;
+      i = steering_find (jump_target, CLASS_ID (tok), i + 1);
       if (cur_rule[i].steering != -1)
 	goto retry;
     }
@@ -1194,10 +1476,24 @@ setup (int core)
   for (int i = 0; env.token_classes->insn_classes[i].class_values ; ++i)
     env.insns =
       insert (env.token_classes->insn_classes[i].class_values[0], env.insns);
+
+  token_class_hash_init (&reg_class_hash, env.token_classes->reg_classes);
+  token_class_hash_init (&mod_class_hash, env.token_classes->mod_classes);
+  token_class_hash_init (&insn_class_hash, env.token_classes->insn_classes);
+  token_class_hash_init (&sep_class_hash, env.token_classes->sep_classes);
+  steering_dispatch_init (env.rules);
 }
 
 void
 cleanup ()
 {
   free_node (env.insns);
+  token_class_hash_free (&reg_class_hash);
+  token_class_hash_free (&mod_class_hash);
+  token_class_hash_free (&insn_class_hash);
+  token_class_hash_free (&sep_class_hash);
+  steering_dispatch_free ();
+  release_free_tokens ();
+  release_free_errors ();
 }
+
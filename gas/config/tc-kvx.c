@@ -169,6 +169,22 @@ kvx_insn_compare (const void *a, const void *b)
   return order_a - order_b;
 }
 
+/* Sort the N insns of BUNDLE_INSNS[] with kvx_insn_compare.  A bundle has
+   at most NELEMS (kvx_insn_buffer) insns, for which an insertion sort is
+   cheaper than qsort.  */
+static void
+kvx_sort_bundle_insns (struct kvx_insn *bundle_insns[], int n)
+{
+  for (int i = 1; i < n; i++)
+    {
+      struct kvx_insn *insn = bundle_insns[i];
+      int j = i;
+      for (; j > 0 && kvx_insn_compare (&bundle_insns[j - 1], &insn) > 0; j--)
+	bundle_insns[j] = bundle_insns[j - 1];
+      bundle_insns[j] = insn;
+    }
+}
+
 static int (*kvx_base_bundling) (int bundling) = NULL;
 static void (*kvx_reorder_bundle) (struct kvx_insn *insns[], struct kvx_insn *issued_insns[]) = NULL;
 static void (*kvx_dump_opc) (struct kvx_opc *opc) = NULL;
@@ -988,6 +1004,19 @@ assemble_insn (const struct kvx_opc *opdef, struct token_list *tok, struct kvx_i
     }
 }
 
+/* The first opcode of a mnemonic whose format starts with given operand
+   types.  Each opcode provides a signature for every prefix of its format,
+   since assemble_tokens accepts an opcode with fewer operands than its
+   format.  */
+struct kvx_opc_sig
+{
+  /* First opcode of the mnemonic in the sorted optab.  */
+  const struct kvx_opc *first;
+  int nb_types;
+  int64_t types[KVX_MAXOPERANDS];
+  struct kvx_opc *opc;
+};
+
 /*
  * Assemble a token list into KVX_INSN_BUFFER[] and update KVX_INSN_CNT.
  * Calls assemble_insn() which may update KVX_IMMX_BUFFER and KVX_IMMX_CNT.
@@ -1002,30 +1031,28 @@ assemble_tokens (struct token_list *tok_list)
   while (toks && toks->category == CAT_SEPARATOR)
     toks = toks->next;
 
-  /* Find the kvx_opc requested by the instruction.  */
+  /* Find the kvx_opc requested by the instruction: the first one whose
+     format starts with the classes of the operands.  */
   struct kvx_opc *opc = NULL;
-  struct kvx_opc *try_opc = str_hash_find (env.opcode_hash, opcode);
-  for (; !strcmp(opcode, try_opc->as_op); try_opc++)
+  struct kvx_opc_sig sig;
+  sig.first = str_hash_find (env.opcode_hash, opcode);
+  sig.nb_types = 0;
+  for (struct token_list *toks_ = toks; toks_; toks_ = toks_->next)
+    if (toks_->category != CAT_SEPARATOR)
+      {
+	if (sig.nb_types == KVX_MAXOPERANDS)
+	  {
+	    /* Too many operands for any format.  */
+	    sig.first = NULL;
+	    break;
+	  }
+	sig.types[sig.nb_types++] = toks_->class_id;
+      }
+  if (sig.first)
     {
-      if (try_opc->codewords[0].flags & KVX_OPCODE_FLAG_RISCV)
-	continue;
-
-      struct token_list *toks_ = toks;
-      for (int i = 0 ; toks_ && try_opc->format[i]
-	   && toks_->class_id == try_opc->format[i]->type ;)
-	{
-	  toks_ = toks_->next;
-	  while (toks_ && toks_->category == CAT_SEPARATOR)
-	    toks_ = toks_->next;
-	  i += 1;
-	}
-
-      if (!toks_)
-	{
-	  opc = try_opc;
-	  break;
-	}
-
+      struct kvx_opc_sig *found = htab_find (env.opcode_sig_hash, &sig);
+      if (found)
+	opc = found->opc;
     }
   assert (opc != NULL);
 
@@ -1667,36 +1694,93 @@ kv4_cond_stack_push (void)
   return kv4_cond_stack->cells + kv4_cond_stack->count++;
 }
 
+/* The reservation tables of the core packed with one byte per resource and
+   cycle, KVX_RESERVATION_WORDS words per table, so that the resources used
+   by a bundle are summed a word at a time.  Each byte of
+   KVX_RESERVATION_BIAS is 0x7f minus the resource availability, so that the
+   high bit of a byte of the sum is set iff the resource is over-used.  Set
+   up by kvx_pack_reservation_tables; KVX_RESERVATION_WORDS is 0 if the
+   tables do not fit.  */
+static uint64_t *kvx_reservation_packed;
+static uint64_t *kvx_reservation_bias;
+static int kvx_reservation_words;
+
+#define KVX_RESERVATION_HIGH_BITS 0x8080808080808080ull
+
+static void
+kvx_pack_reservation_tables (int nb_reservations)
+{
+  const int reservation_table_len =
+      (kvx_core_info->reservation_table_cycles * kvx_core_info->resource_count);
+  const int nb_words = (reservation_table_len + 7) / 8;
+  /* The largest use of a resource by an insn such that the sum over a
+     bundle does not overflow a byte.  */
+  const int max_use = 0x7f / (int) NELEMS (kvx_insn_buffer);
+
+  free (kvx_reservation_packed);
+  free (kvx_reservation_bias);
+  kvx_reservation_packed = XCNEWVEC (uint64_t, nb_reservations * nb_words);
+  kvx_reservation_bias = XCNEWVEC (uint64_t, nb_words);
+  kvx_reservation_words = 0;
+
+  for (int r = 0; r < nb_reservations; r++)
+    {
+      const int *reservation_table = kvx_core_info->reservation_tables[r];
+      uint64_t *packed = kvx_reservation_packed + r * nb_words;
+      for (int k = 0; k < reservation_table_len; k++)
+	{
+	  if (reservation_table[k] < 0 || reservation_table[k] > max_use)
+	    return;
+	  packed[k / 8] |= (uint64_t) reservation_table[k] << (k % 8 * 8);
+	}
+    }
+
+  for (int k = 0; k < reservation_table_len; k++)
+    {
+      int available = kvx_core_info->resources[k % kvx_core_info->resource_count];
+      if (available < 0x7f)
+	kvx_reservation_bias[k / 8] |= (uint64_t) (0x7f - available) << (k % 8 * 8);
+    }
+
+  kvx_reservation_words = nb_words;
+}
+
 static void
 kvx_check_resource_usage (struct kvx_insn *bundle_insns[])
 {
   const int reservation_table_len =
       (kvx_core_info->reservation_table_cycles * kvx_core_info->resource_count);
   const int *resources = kvx_core_info->resources;
-  int *resources_used = malloc (reservation_table_len * sizeof (int));
-  memset (resources_used, 0, reservation_table_len * sizeof (int));
+  int over_used = kvx_reservation_words == 0;
 
-  for (int i = 0; i < kvx_insn_cnt; i++)
+  for (int w = 0; w < kvx_reservation_words && !over_used; w++)
     {
-      int insn_reservation = bundle_insns[i]->opdef->reservation;
-      const int *reservation_table = kvx_core_info->reservation_tables[insn_reservation];
-      for (int j = 0; j < reservation_table_len; j++)
-	resources_used[j] += reservation_table[j];
+      uint64_t used = kvx_reservation_bias[w];
+      for (int i = 0; i < kvx_insn_cnt; i++)
+	{
+	  int insn_reservation = bundle_insns[i]->opdef->reservation;
+	  used += kvx_reservation_packed[insn_reservation * kvx_reservation_words + w];
+	}
+      over_used = (used & KVX_RESERVATION_HIGH_BITS) != 0;
     }
 
-  for (int i = 0; i < kvx_core_info->reservation_table_cycles; i++)
+  if (!over_used)
+    return;
+
+  /* Find the first over-used resource.  */
+  for (int k = 0; k < reservation_table_len; k++)
     {
-      for (int j = 0; j < kvx_core_info->resource_count; j++)
-	if (resources_used[(i * kvx_core_info->resource_count) + j] > resources[j])
-	  {
-	    int v = resources_used[(i * kvx_core_info->resource_count) + j];
-	    free (resources_used);
-	    as_fatal ("resource %s over-used in bundle: %d used, %d available",
-		kvx_core_info->resource_names[j], v, resources[j]);
-	  }
+      int j = k % kvx_core_info->resource_count;
+      int v = 0;
+      for (int i = 0; i < kvx_insn_cnt; i++)
+	{
+	  int insn_reservation = bundle_insns[i]->opdef->reservation;
+	  v += kvx_core_info->reservation_tables[insn_reservation][k];
+	}
+      if (v > resources[j])
+	as_fatal ("resource %s over-used in bundle: %d used, %d available",
+		  kvx_core_info->resource_names[j], v, resources[j]);
     }
-
-  free (resources_used);
 }
 
 /*
@@ -1745,7 +1829,7 @@ md_assemble (char *line)
 		  word_cnt + kvx_immx_cnt, KVX_MAXBUNDLEWORDS);
 
       /* Issue insns into ISSUED_INSNS[] and reorder BUNDLE_INSNS[].  */
-      qsort (bundle_insns, kvx_insn_cnt, sizeof (struct kvx_insn *), kvx_insn_compare);
+      kvx_sort_bundle_insns (bundle_insns, kvx_insn_cnt);
       (*kvx_reorder_bundle) (bundle_insns, issued_insns);
 
       if (kv4_cond_stack_count ())
@@ -1843,11 +1927,19 @@ md_assemble (char *line)
       line_cursor += cond_len;
     }
 
-  char *buf = NULL;
-  sscanf (line_cursor, "%m[^\n]", &buf);
+  /* Parse a copy of the line, in a buffer kept across calls.  */
+  static char *buf = NULL;
+  static size_t buf_size = 0;
+  size_t len = strcspn (line_cursor, "\n");
+  if (len + 1 > buf_size)
+    {
+      buf_size = len + 1 < 256 ? 256 : len + 1;
+      buf = XRESIZEVEC (char, buf, buf_size);
+    }
+  memcpy (buf, line_cursor, len);
+  buf[len] = '\0';
   struct token_s my_tok = TOK_FROM_STR (buf);
   struct token_list *tok_lst = parse (my_tok);
-  free (buf);
 
   if (!tok_lst)
     return;
@@ -1936,6 +2028,59 @@ kvx_opc_compare (const void *a, const void *b)
     }
 }
 
+static hashval_t
+kvx_opc_sig_hash (const void *p)
+{
+  const struct kvx_opc_sig *sig = p;
+  hashval_t h = htab_hash_pointer (sig->first);
+
+  for (int i = 0; i < sig->nb_types; ++i)
+    h = h * 31 + (hashval_t) sig->types[i];
+  return h;
+}
+
+static int
+kvx_opc_sig_eq (const void *p1, const void *p2)
+{
+  const struct kvx_opc_sig *sig1 = p1;
+  const struct kvx_opc_sig *sig2 = p2;
+
+  return (sig1->first == sig2->first
+	  && sig1->nb_types == sig2->nb_types
+	  && !memcmp (sig1->types, sig2->types,
+		      sig1->nb_types * sizeof (sig1->types[0])));
+}
+
+/* Record the signatures of OPC, the first opcode of its mnemonic being
+   FIRST.  Opcodes are entered in optab order, so each signature keeps the
+   first opcode that matches it.  */
+
+static void
+kvx_opc_sig_insert (const struct kvx_opc *first, struct kvx_opc *opc)
+{
+  struct kvx_opc_sig key;
+
+  if (opc->codewords[0].flags & KVX_OPCODE_FLAG_RISCV)
+    return;
+
+  key.first = first;
+  for (key.nb_types = 0; ; ++key.nb_types)
+    {
+      void **slot = htab_find_slot (env.opcode_sig_hash, &key, INSERT);
+      if (!*slot)
+	{
+	  struct kvx_opc_sig *sig = notes_alloc (sizeof (*sig));
+	  *sig = key;
+	  sig->opc = opc;
+	  *slot = sig;
+	}
+
+      if (key.nb_types == KVX_MAXOPERANDS || !opc->format[key.nb_types])
+	break;
+      key.types[key.nb_types] = opc->format[key.nb_types]->type;
+    }
+}
+
 /***************************************************/
 /*    INITIALIZE ASSEMBLER                         */
 /***************************************************/
@@ -1988,20 +2133,29 @@ md_begin ()
   /* Each name should appear only once.  */
 
   env.opcode_hash = str_htab_create ();
+  env.opcode_sig_hash = htab_create_alloc (16, kvx_opc_sig_hash,
+					   kvx_opc_sig_eq, NULL,
+					   notes_calloc, NULL);
   env.reloc_hash = str_htab_create ();
 
   {
     struct kvx_opc *opc;
+    struct kvx_opc *first = NULL;
     const char *name = 0;
+    int nb_reservations = 0;
     for (opc = kvx_core_info->optab; !(STREQ ("", opc->as_op)); opc++)
       {
 	/* Enter in hash table if this is a new name.  */
 	if (!(STREQ (name, opc->as_op)))
 	  {
 	    name = opc->as_op;
+	    first = opc;
 	    if (str_hash_insert (env.opcode_hash, name, opc, 0))
 	      as_fatal ("internal error: can't hash opcode `%s'", name);
 	  }
+	kvx_opc_sig_insert (first, opc);
+	if (opc->reservation >= nb_reservations)
+	  nb_reservations = opc->reservation + 1;
 
 
 	for (int i = 0 ; opc->format[i] ; ++i)
@@ -2014,6 +2168,8 @@ md_begin ()
 		  as_fatal ("internal error: can't hash type `%s'", reloc_name);
 	  }
       }
+
+    kvx_pack_reservation_tables (nb_reservations);
   }
 
   if (env.opts.dump_table)
@@ -62,6 +62,8 @@ struct token_list
   int loc;
   struct token_list *next;
   int len;
+  /* Size of the buffer of TOK.  */
+  int tok_size;
 };
 
 
@@ -186,6 +188,8 @@ struct kvx_as_env {
   struct kvx_stcall stcall_info;
   /* The hash table of instruction opcodes.  */
   htab_t opcode_hash;
+  /* The hash table of instruction opcodes by operand signature.  */
+  htab_t opcode_sig_hash;
   /* The hash table of register symbols.  */
   htab_t reg_hash;
   /* The hash table of relocations for immediates.  */
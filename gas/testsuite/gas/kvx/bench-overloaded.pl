@@ -0,0 +1,99 @@
+#!/usr/bin/perl
+#   Copyright (C) 2024 Free Software Foundation, Inc.
+
+#   This program is free software; you can redistribute it and/or modify
+#   it under the terms of the GNU General Public License as published by
+#   the Free Software Foundation; either version 3 of the License, or
+#   (at your option) any later version.
+
+#   This program is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+
+#   You should have received a copy of the GNU General Public License
+#   along with this program; see the file COPYING3. If not,
+#   see <http://www.gnu.org/licenses/>.
+
+# Write to standard output a synthetic kv3 input made of COUNT (8000 by
+# default) bundles of the mnemonics with the most variants: loads and
+# stores in all their addressing modes, make, and arithmetic or
+# comparisons with register or immediate operands.  It is not a test;
+# it measures the assembly rate of overloaded mnemonics, e.g.:
+#   perl bench-overloaded.pl 100000 > bench.s
+#   time as -march=kv3-1 -o /dev/null bench.s
+# overloaded.d checks each of these forms.
+
+use strict;
+use warnings;
+
+my $count = shift || 8000;
+
+my @loads = qw(lbs lbz lhs lhz lws lwz ld);
+my @stores = qw(sb sh sw sd);
+my @alus = qw(addd sbfd andd ord xord maxd mind);
+my @variants = ('', '.s', '.u', '.us');
+my @conds = qw(dnez deqz dltz dgez dlez dgtz wnez weqz);
+my @cmps = qw(ne eq lt ge le gt ltu geu);
+my @offsets = (-64, 0, 511, -4096, -8388608, 2147483647, -8589934592,
+	       2305843009213693951);
+my @cond_offsets = (0, -4096, -8388608, -8589934592);
+my @imms = (-64, 0, 511, -4096, 65535, 2147483647, -8589934592,
+	    1125899906842623, 2305843009213693951);
+
+# A fixed seed keeps the output the same from run to run.
+srand (1);
+
+sub pick { return $_[int (rand (@_))]; }
+sub reg { return '$r' . int (rand (64)); }
+
+print "\t.text\n\t.align 8\n\t.global bench\nbench:\n";
+for (my $i = 0; $i < $count; $i++)
+  {
+    my $kind = int (rand (8));
+    my $insn;
+
+    if ($kind == 0)
+      {
+	$insn = sprintf ("%s%s %s = %d[%s]", pick (@loads), pick (@variants),
+			 reg (), pick (@offsets), reg ());
+      }
+    elsif ($kind == 1)
+      {
+	$insn = sprintf ("%s%s.xs %s = %s[%s]", pick (@loads),
+			 pick (@variants), reg (), reg (), reg ());
+      }
+    elsif ($kind == 2)
+      {
+	$insn = sprintf ("%s%s.%s %s? %s = %d[%s]", pick (@loads),
+			 pick (@variants), pick (@conds), reg (), reg (),
+			 pick (@cond_offsets), reg ());
+      }
+    elsif ($kind == 3)
+      {
+	$insn = sprintf ("%s %d[%s] = %s", pick (@stores), pick (@offsets),
+			 reg (), reg ());
+      }
+    elsif ($kind == 4)
+      {
+	$insn = sprintf ("%s.%s %s? %d[%s] = %s", pick (@stores),
+			 pick (@conds), reg (), pick (@cond_offsets), reg (),
+			 reg ());
+      }
+    elsif ($kind == 5)
+      {
+	$insn = sprintf ("make %s = %d", reg (), pick (@imms));
+      }
+    elsif ($kind == 6)
+      {
+	$insn = sprintf ("compd.%s %s = %s, %s", pick (@cmps), reg (), reg (),
+			 rand (2) < 1 ? reg () : pick (@imms));
+      }
+    else
+      {
+	$insn = sprintf ("%s %s = %s, %s", pick (@alus), reg (), reg (),
+			 rand (2) < 1 ? reg () : pick (@imms));
+      }
+    print "\t$insn\n\t;;\n";
+  }
+print "\tret\n\t;;\n";
@@ -0,0 +1,232 @@
+# Each form of the mnemonics with the most variants, which assemble_tokens
+# finds by the classes of their operands.  Immediates are picked to select
+# each immediate width.
+
+	.text
+	.align 8
+	.global f
+f:
+	lbs $r1 = -64[$r2]
+	;;
+	lbs.s $r1 = -8589934592[$r2]
+	;;
+	lbs.u $r1 = 2305843009213693951[$r2]
+	;;
+	lbs.us.xs $r1 = $r2[$r3]
+	;;
+	lbs.dnez $r1? $r2 = [$r3]
+	;;
+	lbs.weqz $r1? $r2 = -8388608[$r3]
+	;;
+	lbs.dltz $r1? $r2 = -8589934592[$r3]
+	;;
+	lbz $r1 = -64[$r2]
+	;;
+	lbz.s $r1 = -8589934592[$r2]
+	;;
+	lbz.u $r1 = 2305843009213693951[$r2]
+	;;
+	lbz.us.xs $r1 = $r2[$r3]
+	;;
+	lbz.dnez $r1? $r2 = [$r3]
+	;;
+	lbz.weqz $r1? $r2 = -8388608[$r3]
+	;;
+	lbz.dltz $r1? $r2 = -8589934592[$r3]
+	;;
+	lhs $r1 = -64[$r2]
+	;;
+	lhs.s $r1 = -8589934592[$r2]
+	;;
+	lhs.u $r1 = 2305843009213693951[$r2]
+	;;
+	lhs.us.xs $r1 = $r2[$r3]
+	;;
+	lhs.dnez $r1? $r2 = [$r3]
+	;;
+	lhs.weqz $r1? $r2 = -8388608[$r3]
+	;;
+	lhs.dltz $r1? $r2 = -8589934592[$r3]
+	;;
+	lhz $r1 = -64[$r2]
+	;;
+	lhz.s $r1 = -8589934592[$r2]
+	;;
+	lhz.u $r1 = 2305843009213693951[$r2]
+	;;
+	lhz.us.xs $r1 = $r2[$r3]
+	;;
+	lhz.dnez $r1? $r2 = [$r3]
+	;;
+	lhz.weqz $r1? $r2 = -8388608[$r3]
+	;;
+	lhz.dltz $r1? $r2 = -8589934592[$r3]
+	;;
+	lws $r1 = -64[$r2]
+	;;
+	lws.s $r1 = -8589934592[$r2]
+	;;
+	lws.u $r1 = 2305843009213693951[$r2]
+	;;
+	lws.us.xs $r1 = $r2[$r3]
+	;;
+	lws.dnez $r1? $r2 = [$r3]
+	;;
+	lws.weqz $r1? $r2 = -8388608[$r3]
+	;;
+	lws.dltz $r1? $r2 = -8589934592[$r3]
+	;;
+	lwz $r1 = -64[$r2]
+	;;
+	lwz.s $r1 = -8589934592[$r2]
+	;;
+	lwz.u $r1 = 2305843009213693951[$r2]
+	;;
+	lwz.us.xs $r1 = $r2[$r3]
+	;;
+	lwz.dnez $r1? $r2 = [$r3]
+	;;
+	lwz.weqz $r1? $r2 = -8388608[$r3]
+	;;
+	lwz.dltz $r1? $r2 = -8589934592[$r3]
+	;;
+	ld $r1 = -64[$r2]
+	;;
+	ld.s $r1 = -8589934592[$r2]
+	;;
+	ld.u $r1 = 2305843009213693951[$r2]
+	;;
+	ld.us.xs $r1 = $r2[$r3]
+	;;
+	ld.dnez $r1? $r2 = [$r3]
+	;;
+	ld.weqz $r1? $r2 = -8388608[$r3]
+	;;
+	ld.dltz $r1? $r2 = -8589934592[$r3]
+	;;
+	sb -64[$r1] = $r2
+	;;
+	sb -8589934592[$r1] = $r2
+	;;
+	sb 2305843009213693951[$r1] = $r2
+	;;
+	sb.xs $r1[$r2] = $r3
+	;;
+	sb.dnez $r1? [$r2] = $r3
+	;;
+	sb.weqz $r1? -8388608[$r2] = $r3
+	;;
+	sb.dgtz $r1? -8589934592[$r2] = $r3
+	;;
+	sh -64[$r1] = $r2
+	;;
+	sh -8589934592[$r1] = $r2
+	;;
+	sh 2305843009213693951[$r1] = $r2
+	;;
+	sh.xs $r1[$r2] = $r3
+	;;
+	sh.dnez $r1? [$r2] = $r3
+	;;
+	sh.weqz $r1? -8388608[$r2] = $r3
+	;;
+	sh.dgtz $r1? -8589934592[$r2] = $r3
+	;;
+	sw -64[$r1] = $r2
+	;;
+	sw -8589934592[$r1] = $r2
+	;;
+	sw 2305843009213693951[$r1] = $r2
+	;;
+	sw.xs $r1[$r2] = $r3
+	;;
+	sw.dnez $r1? [$r2] = $r3
+	;;
+	sw.weqz $r1? -8388608[$r2] = $r3
+	;;
+	sw.dgtz $r1? -8589934592[$r2] = $r3
+	;;
+	sd -64[$r1] = $r2
+	;;
+	sd -8589934592[$r1] = $r2
+	;;
+	sd 2305843009213693951[$r1] = $r2
+	;;
+	sd.xs $r1[$r2] = $r3
+	;;
+	sd.dnez $r1? [$r2] = $r3
+	;;
+	sd.weqz $r1? -8388608[$r2] = $r3
+	;;
+	sd.dgtz $r1? -8589934592[$r2] = $r3
+	;;
+	make $r1 = 511
+	;;
+	make $r1 = -8589934592
+	;;
+	make $r1 = 2305843009213693951
+	;;
+	addd $r1 = $r2, $r3
+	;;
+	addd $r1 = $r2, -64
+	;;
+	addd $r1 = $r2, -8589934592
+	;;
+	addd $r1 = $r2, 2305843009213693951
+	;;
+	sbfd $r1 = $r2, $r3
+	;;
+	sbfd $r1 = $r2, -64
+	;;
+	sbfd $r1 = $r2, -8589934592
+	;;
+	sbfd $r1 = $r2, 2305843009213693951
+	;;
+	andd $r1 = $r2, $r3
+	;;
+	andd $r1 = $r2, -64
+	;;
+	andd $r1 = $r2, -8589934592
+	;;
+	andd $r1 = $r2, 2305843009213693951
+	;;
+	ord $r1 = $r2, $r3
+	;;
+	ord $r1 = $r2, -64
+	;;
+	ord $r1 = $r2, -8589934592
+	;;
+	ord $r1 = $r2, 2305843009213693951
+	;;
+	xord $r1 = $r2, $r3
+	;;
+	xord $r1 = $r2, -64
+	;;
+	xord $r1 = $r2, -8589934592
+	;;
+	xord $r1 = $r2, 2305843009213693951
+	;;
+	maxd $r1 = $r2, $r3
+	;;
+	maxd $r1 = $r2, -64
+	;;
+	maxd $r1 = $r2, -8589934592
+	;;
+	maxd $r1 = $r2, 2305843009213693951
+	;;
+	mind $r1 = $r2, $r3
+	;;
+	mind $r1 = $r2, -64
+	;;
+	mind $r1 = $r2, -8589934592
+	;;
+	mind $r1 = $r2, 2305843009213693951
+	;;
+	compd.ltu $r1 = $r2, $r3
+	;;
+	compd.ltu $r1 = $r2, -64
+	;;
+	compd.ltu $r1 = $r2, -8589934592
+	;;
+	compd.ltu $r1 = $r2, 2305843009213693951
+	;;
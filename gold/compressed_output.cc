@@ -27,11 +27,35 @@
 #endif
 #include "parameters.h"
 #include "options.h"
+#include "workqueue.h"
 #include "compressed_output.h"
 
 namespace gold
 {
 
+// Sections larger than this are split into blocks of this size which
+// are compressed in parallel.  The block size does not depend on the
+// number of threads, so that the output is the same however many
+// threads are used.
+
+static const section_size_type compression_block_size = 1024 * 1024;
+
+// The size of the window used to prime each zlib block with the end
+// of the previous block.
+
+static const section_size_type zlib_window_size = 32 * 1024;
+
+// Return the zlib compression level to use.
+
+static int
+zlib_compress_level()
+{
+  if (parameters->options().optimize() >= 1)
+    return 9;
+  else
+    return 1;
+}
+
 // Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns true
 // if it successfully compressed, false if it failed for any reason
 // (including not having zlib support in the library).  If it returns
@@ -51,11 +75,7 @@ zlib_compress(int header_size,
   *compressed_size = uncompressed_size + uncompressed_size / 1000 + 128;
   *compressed_data = new unsigned char[*compressed_size + header_size];
 
-  int compress_level;
-  if (parameters->options().optimize() >= 1)
-    compress_level = 9;
-  else
-    compress_level = 1;
+  int compress_level = zlib_compress_level();
 
   int rc = compress2(reinterpret_cast<Bytef*>(*compressed_data) + header_size,
                      compressed_size,
@@ -95,6 +115,92 @@ zstd_compress(int header_size, const unsigned char *uncompressed_data,
 }
 #endif
 
+// Compress one block of a section split for parallel compression as
+// raw deflate data, for later concatenation into a single zlib stream.
+// The block is primed with the DICT_SIZE bytes preceding DATA, which
+// end the previous block.  All blocks but the last are terminated
+// with a sync flush, so that they end on a byte boundary.  Returns
+// true on success, and sets *COMPRESSED_DATA, allocated with new, and
+// *COMPRESSED_SIZE.
+
+static bool
+zlib_compress_block(const unsigned char* data, section_size_type size,
+		    section_size_type dict_size, bool last,
+		    unsigned char** compressed_data,
+		    section_size_type* compressed_size)
+{
+  z_stream strm;
+  memset(&strm, 0, sizeof strm);
+  if (deflateInit2(&strm, zlib_compress_level(), Z_DEFLATED, -MAX_WBITS,
+		   8, Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+
+  if (dict_size > 0
+      && deflateSetDictionary(&strm, reinterpret_cast<const Bytef*>(data
+								    - dict_size),
+			      dict_size) != Z_OK)
+    {
+      deflateEnd(&strm);
+      return false;
+    }
+
+  // Leave room for the sync flush marker.
+  uLong bound = deflateBound(&strm, size) + 16;
+  unsigned char* out = new unsigned char[bound];
+  strm.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(data));
+  strm.avail_in = size;
+  strm.next_out = reinterpret_cast<Bytef*>(out);
+  strm.avail_out = bound;
+
+  int rc = deflate(&strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+  bool ok = (last
+	     ? rc == Z_STREAM_END
+	     : rc == Z_OK && strm.avail_in == 0 && strm.avail_out != 0);
+  deflateEnd(&strm);
+  if (!ok)
+    {
+      delete[] out;
+      return false;
+    }
+
+  *compressed_data = out;
+  *compressed_size = bound - strm.avail_out;
+  return true;
+}
+
+// A task to compress one block of an Output_compressed_section.
+
+class Compress_block_task : public Task
+{
+ public:
+  Compress_block_task(Output_compressed_section* os, unsigned int block,
+		      Task_token* final_blocker)
+    : os_(os), block_(block), final_blocker_(final_blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->os_->compress_block(this->block_); }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  // Unblock FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->final_blocker_); }
+
+  std::string
+  get_name() const
+  { return "Compress_block_task " + std::string(this->os_->name()); }
+
+ private:
+  Output_compressed_section* os_;
+  const unsigned int block_;
+  Task_token* const final_blocker_;
+};
+
 // Decompress COMPRESSED_DATA of size COMPRESSED_SIZE, into a buffer
 // UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns TRUE if it
 // decompressed successfully, false if it failed.  The buffer, of
@@ -227,8 +333,187 @@ decompress_input_section(const unsigned char* compressed_data,
 
 // Class Output_compressed_section.
 
+// Return the compression type requested by the options.
+
+Output_compressed_section::Compression_type
+Output_compressed_section::compression_type() const
+{
+  const char* type = this->options_->compress_debug_sections();
+  if (strcmp(type, "zlib-gnu") == 0)
+    return gnu_zlib;
+  else if (strcmp(type, "none") == 0)
+    return none;
+  else if (strcmp(type, "zstd") == 0)
+    return zstd;
+  else
+    return gabi_zlib;
+}
+
+// Split a section larger than compression_block_size into blocks and
+// queue a task to compress each of them.  Smaller sections are
+// compressed in one go by set_final_data_size.
+
+void
+Output_compressed_section::queue_compression_tasks(Workqueue* workqueue,
+						   Task_token* blocker)
+{
+  if (!this->has_postprocessing_buffer())
+    return;
+
+  Compression_type compress = this->compression_type();
+  section_size_type uncompressed_size = this->postprocessing_buffer_size();
+  if (compress == none || uncompressed_size <= compression_block_size)
+    return;
+#ifndef HAVE_ZSTD
+  if (compress == zstd)
+    return;
+#endif
+
+  // At this point the contents of all regular input sections will
+  // have been copied into the postprocessing buffer, and relocations
+  // will have been applied.  Now we need to copy in the contents of
+  // anything other than a regular input section.
+  this->write_to_postprocessing_buffer();
+
+  const unsigned char* uncompressed_data = this->postprocessing_buffer();
+  unsigned int count = ((uncompressed_size - 1) / compression_block_size) + 1;
+  this->blocks_.resize(count);
+  for (unsigned int i = 0; i < count; ++i)
+    {
+      section_size_type off = i * compression_block_size;
+      Compressed_block& block(this->blocks_[i]);
+      block.data = uncompressed_data + off;
+      block.size = std::min(compression_block_size, uncompressed_size - off);
+      block.compressed_data = NULL;
+      block.compressed_size = 0;
+      block.adler = 0;
+    }
+
+  blocker->add_blockers(count);
+  for (unsigned int i = 0; i < count; ++i)
+    workqueue->queue(new Compress_block_task(this, i, blocker));
+}
+
+// Compress block I.  The blocks are independent, except that zlib
+// blocks read the end of the previous block as a dictionary, which is
+// never modified.
+
+void
+Output_compressed_section::compress_block(unsigned int i)
+{
+  Compressed_block& block(this->blocks_[i]);
+  Compression_type compress = this->compression_type();
+
+  if (compress == gnu_zlib || compress == gabi_zlib)
+    {
+      section_size_type dict_size = 0;
+      if (i > 0)
+	dict_size = std::min(zlib_window_size, this->blocks_[i - 1].size);
+      if (!zlib_compress_block(block.data, block.size, dict_size,
+			       i + 1 == this->blocks_.size(),
+			       &block.compressed_data, &block.compressed_size))
+	block.compressed_data = NULL;
+      block.adler = adler32(adler32(0, NULL, 0),
+			    reinterpret_cast<const Bytef*>(block.data),
+			    block.size);
+    }
+#ifdef HAVE_ZSTD
+  else if (compress == zstd)
+    {
+      // Each block is a separate zstd frame; a sequence of frames is
+      // a valid zstd payload.
+      size_t bound = ZSTD_compressBound(block.size);
+      unsigned char* out = new unsigned char[bound];
+      size_t size = ZSTD_compress(out, bound, block.data, block.size,
+				  ZSTD_CLEVEL_DEFAULT);
+      if (ZSTD_isError(size))
+	delete[] out;
+      else
+	{
+	  block.compressed_data = out;
+	  block.compressed_size = size;
+	}
+    }
+#endif
+  else
+    gold_unreachable();
+}
+
+// Concatenate the compressed blocks into this->data_, after
+// HEADER_SIZE bytes left for the section compression header.  For
+// zlib this builds a single zlib stream out of the raw deflate
+// blocks.  Frees the blocks.  Returns false if any block failed.
+
+bool
+Output_compressed_section::stitch_blocks(Compression_type compress,
+					 int header_size,
+					 unsigned long* compressed_size)
+{
+  const bool is_zlib = compress == gnu_zlib || compress == gabi_zlib;
+  bool ok = true;
+  unsigned long size = header_size;
+  for (std::vector<Compressed_block>::const_iterator p = this->blocks_.begin();
+       p != this->blocks_.end();
+       ++p)
+    {
+      if (p->compressed_data == NULL)
+	ok = false;
+      size += p->compressed_size;
+    }
+  // The zlib stream header and Adler-32 trailer.
+  if (is_zlib)
+    size += 2 + 4;
+
+  if (ok)
+    {
+      this->data_ = new unsigned char[size];
+      unsigned char* pov = this->data_ + header_size;
+      uLong adler = adler32(0, NULL, 0);
+      if (is_zlib)
+	{
+	  // This is the header deflateInit writes: a 32K window, no
+	  // dictionary, and the level hint.
+	  int level = zlib_compress_level();
+	  unsigned int level_flags = (level < 2 ? 0
+				      : level < 6 ? 1
+				      : level == 6 ? 2
+				      : 3);
+	  unsigned int header = ((Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8
+				 | (level_flags << 6));
+	  header += 31 - (header % 31);
+	  elfcpp::Swap_unaligned<16, true>::writeval(pov, header);
+	  pov += 2;
+	}
+      for (std::vector<Compressed_block>::const_iterator p =
+	     this->blocks_.begin();
+	   p != this->blocks_.end();
+	   ++p)
+	{
+	  memcpy(pov, p->compressed_data, p->compressed_size);
+	  pov += p->compressed_size;
+	  if (is_zlib)
+	    adler = adler32_combine(adler, p->adler, p->size);
+	}
+      if (is_zlib)
+	{
+	  elfcpp::Swap_unaligned<32, true>::writeval(pov, adler);
+	  pov += 4;
+	}
+      gold_assert(static_cast<unsigned long>(pov - this->data_) == size);
+      *compressed_size = size;
+    }
+
+  for (std::vector<Compressed_block>::iterator p = this->blocks_.begin();
+       p != this->blocks_.end();
+       ++p)
+    delete[] p->compressed_data;
+  this->blocks_.clear();
+  return ok;
+}
+
 // Set the final data size of a compressed section.  This is where
-// we actually compress the section data.
+// we actually compress the section data, unless it was already
+// compressed in blocks by queue_compression_tasks.
 
 void
 Output_compressed_section::set_final_data_size()
@@ -243,22 +528,15 @@ Output_compressed_section::set_final_data_size()
   // have been copied into the postprocessing buffer, and relocations
   // will have been applied.  Now we need to copy in the contents of
   // anything other than a regular input section.
-  this->write_to_postprocessing_buffer();
+  if (this->blocks_.empty())
+    this->write_to_postprocessing_buffer();
 
   bool success = false;
-  enum { none, gnu_zlib, gabi_zlib, zstd } compress;
+  Compression_type compress = this->compression_type();
   int compression_header_size = 12;
   const int size = parameters->target().get_size();
-  if (strcmp(this->options_->compress_debug_sections(), "zlib-gnu") == 0)
-    compress = gnu_zlib;
-  else if (strcmp(this->options_->compress_debug_sections(), "none") == 0)
-    compress = none;
-  else
+  if (compress != gnu_zlib && compress != none)
     {
-      if (strcmp(this->options_->compress_debug_sections(), "zstd") == 0)
-	compress = zstd;
-      else
-	compress = gabi_zlib;
       if (size == 32)
 	compression_header_size = elfcpp::Elf_sizes<32>::chdr_size;
       else if (size == 64)
@@ -266,7 +544,10 @@ Output_compressed_section::set_final_data_size()
       else
 	gold_unreachable();
     }
-  if (compress == gnu_zlib || compress == gabi_zlib)
+  if (!this->blocks_.empty())
+    success = this->stitch_blocks(compress, compression_header_size,
+				  &compressed_size);
+  else if (compress == gnu_zlib || compress == gabi_zlib)
     success = zlib_compress(compression_header_size, uncompressed_data,
 			    uncompressed_size, &this->data_,
 			    &compressed_size);
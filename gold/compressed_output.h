@@ -29,6 +29,7 @@
 #define GOLD_COMPRESSED_OUTPUT_H
 
 #include <string>
+#include <vector>
 
 #include "output.h"
 
@@ -36,6 +37,8 @@ namespace gold
 {
 
 class General_options;
+class Workqueue;
+class Task_token;
 
 // Read the compression header of a compressed debug section and return
 // the uncompressed size.
@@ -60,9 +63,20 @@ class Output_compressed_section : public Output_section
 			    const char* name, elfcpp::Elf_Word flags,
 			    elfcpp::Elf_Xword type)
     : Output_section(name, flags, type),
-      options_(options)
+      options_(options), data_(NULL), blocks_()
   { this->set_requires_postprocessing(); }
 
+  // Split a large section into blocks and queue a task to compress
+  // each one.  Each task unblocks BLOCKER when it completes.  This is
+  // called once all the relocations have been applied, before
+  // set_final_data_size.
+  void
+  queue_compression_tasks(Workqueue*, Task_token* blocker);
+
+  // Compress block I.  This is called by the compression tasks.
+  void
+  compress_block(unsigned int i);
+
  protected:
   // Set the final data size.
   void
@@ -73,10 +87,44 @@ class Output_compressed_section : public Output_section
   do_write(Output_file*);
 
  private:
+  // The compression formats.
+  enum Compression_type
+  {
+    none,
+    gnu_zlib,
+    gabi_zlib,
+    zstd
+  };
+
+  // A block of the section compressed by a separate task.
+  struct Compressed_block
+  {
+    // The uncompressed data, in the postprocessing buffer.
+    const unsigned char* data;
+    section_size_type size;
+    // The compressed data, allocated with new, or NULL on failure.
+    unsigned char* compressed_data;
+    section_size_type compressed_size;
+    // The Adler-32 checksum of the uncompressed data, for zlib.
+    uint32_t adler;
+  };
+
+  // Return the compression type requested by the options.
+  Compression_type
+  compression_type() const;
+
+  // Stitch the compressed blocks into a single payload after
+  // HEADER_SIZE bytes.  Returns false if any block failed.
+  bool
+  stitch_blocks(Compression_type, int header_size,
+		unsigned long* compressed_size);
+
   // The options--this includes the compression type.
   const General_options* options_;
   // The compressed data.
   unsigned char* data_;
+  // The blocks compressed in parallel, if the section is large.
+  std::vector<Compressed_block> blocks_;
   // The new section name if we do compress.
   std::string new_section_name_;
 };
@@ -1560,6 +1560,17 @@ Dwarf_info_reader::do_parse()
       if (this->cu_version_ < 5)
 	this->address_size_ = *pinfo++;
 
+      // DWARF 5: Skip the dwo_id (8 bytes) of a skeleton or split
+      // compilation unit.
+      if (this->cu_version_ >= 5
+	  && (this->unit_type_ == elfcpp::DW_UT_skeleton
+	      || this->unit_type_ == elfcpp::DW_UT_split_compile))
+	{
+	  if (!this->check_buffer(pinfo + 8))
+	    break;
+	  pinfo += 8;
+	}
+
       // For type units, read the two extra fields.
       uint64_t signature = 0;
       off_t type_offset = 0;
@@ -45,6 +45,7 @@
 #include "compressed_output.h"
 #include "stringpool.h"
 #include "dwarf_reader.h"
+#include "workqueue.h"
 
 static void
 usage(FILE* fd, int) ATTRIBUTE_NORETURN;
@@ -99,6 +100,24 @@ struct Unit_set
   { }
 };
 
+// The location of a compilation unit or type unit within an input
+// .debug_info.dwo or .debug_types.dwo section.
+
+struct Dwo_unit
+{
+  // The section index of the input section.
+  unsigned int shndx;
+  // The offset and length of the unit within the section.
+  off_t offset;
+  off_t length;
+  // The dwo_id of a compilation unit, or the signature of a type unit.
+  uint64_t signature;
+
+  Dwo_unit(unsigned int s, off_t o, off_t l, uint64_t sig)
+    : shndx(s), offset(o), length(l), signature(sig)
+  { }
+};
+
 // An input file.
 // This class may represent a .dwo file, a .dwp file
 // produced by an earlier run, or an executable file whose
@@ -108,9 +127,15 @@ class Dwo_file
 {
  public:
   Dwo_file(const char* name)
-    : name_(name), obj_(NULL), input_file_(NULL), is_compressed_(),
-      sect_offsets_(), str_offset_map_()
-  { }
+    : name_(name), obj_(NULL), input_file_(NULL), machine_(0), size_(0),
+      big_endian_(false), osabi_(0), abiversion_(0), is_compressed_(),
+      sect_offsets_(), str_offset_map_(), debug_types_(), debug_str_(0),
+      debug_cu_index_(0), debug_tu_index_(0), contents_(), strings_(),
+      units_(), next_unit_(0)
+  {
+    for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+      this->debug_shndx_[i] = 0;
+  }
 
   ~Dwo_file();
 
@@ -119,9 +144,28 @@ class Dwo_file
   void
   read_executable(File_list* files);
 
-  // Read the input file and send its contents to OUTPUT_FILE.
+  // Read the input file on behalf of TASK: find the debug sections,
+  // map or decompress their contents, hash the strings, and find the
+  // compilation and type units.  This does not touch the output
+  // file, so it may run in parallel for several input files.
   void
-  read(Dwp_output_file* output_file);
+  read(const Task* task);
+
+  // Send the contents read by read() to OUTPUT_FILE.  This must be
+  // called for each input file in turn.
+  void
+  add_to_output(Dwp_output_file* output_file);
+
+  // Return the object, for locking.  This is NULL until read() has
+  // been called.
+  Relobj*
+  object() const
+  { return this->obj_; }
+
+  // Return the filename.
+  const char*
+  name() const
+  { return this->name_; }
 
   // Verify a .dwp file given a list of .dwo files referenced by the
   // corresponding executable file.  Returns true if no problems
@@ -135,6 +179,9 @@ class Dwo_file
       Str_offset_map_entry;
   typedef std::vector<Str_offset_map_entry> Str_offset_map;
 
+  // Type for the list of .debug_types.dwo sections.
+  typedef std::vector<unsigned int> Types_list;
+
   // A less-than comparison routine for Str_offset_map.
   struct Offset_compare
   {
@@ -144,16 +191,41 @@ class Dwo_file
     { return i1.first < i2.first; }
   };
 
+  // The contents of an input section which we will copy to the
+  // output file.  These stay valid until the Dwo_file is deleted.
+  struct Section_contents
+  {
+    const unsigned char* contents;
+    section_size_type len;
+    // True if CONTENTS was allocated with new[].
+    bool is_new;
+
+    Section_contents()
+      : contents(NULL), len(0), is_new(false)
+    { }
+  };
+
+  // A string in the input .debug_str.dwo section.
+  struct Input_string
+  {
+    section_offset_type offset;
+    size_t len;
+    size_t hash_code;
+
+    Input_string(section_offset_type o, size_t l, size_t h)
+      : offset(o), len(l), hash_code(h)
+    { }
+  };
+
   // Create a Sized_relobj_dwo of the given size and endianness,
-  // and record the target info.  P is a pointer to the ELF header
-  // in memory.
+  // and record the target info.  TASK is the task which will lock
+  // the file, or NULL.
   Relobj*
-  make_object(Dwp_output_file* output_file);
+  make_object(const Task* task);
 
   template <int size, bool big_endian>
   Relobj*
-  sized_make_object(const unsigned char* p, Input_file* input_file,
-		    Dwp_output_file* output_file);
+  sized_make_object(const unsigned char* p, Input_file* input_file);
 
   // Return the number of sections in the input object file.
   unsigned int
@@ -177,6 +249,28 @@ class Dwo_file
   section_contents(unsigned int shndx, section_size_type* plen, bool* is_new)
   { return this->obj_->decompressed_section_contents(shndx, plen, is_new); }
 
+  // Map the contents of a section, decompressing it if necessary, so
+  // that they stay available after the input file has been released.
+  void
+  map_section(unsigned int shndx);
+
+  // Return the contents of a section mapped by map_section.
+  const Section_contents&
+  mapped_section(unsigned int shndx) const
+  {
+    gold_assert(this->contents_[shndx].contents != NULL);
+    return this->contents_[shndx];
+  }
+
+  // Find the strings in the input string table and compute their
+  // hash codes.
+  void
+  hash_strings();
+
+  // Find the compilation or type units in section SHNDX.
+  void
+  read_units(unsigned int shndx, bool is_debug_types);
+
   // Read the .debug_cu_index or .debug_tu_index section of a .dwp file,
   // and process the CU or TU sets.
   void
@@ -200,7 +294,7 @@ class Dwo_file
 
   // Merge the input string table section into the output file.
   void
-  add_strings(Dwp_output_file*, unsigned int);
+  add_strings(Dwp_output_file*);
 
   // Copy a section from the input file to the output file.
   Section_bounds
@@ -232,12 +326,34 @@ class Dwo_file
   Relobj* obj_;
   // The Input_file object.
   Input_file* input_file_;
+  // Target info from the ELF header.
+  int machine_;
+  int size_;
+  bool big_endian_;
+  int osabi_;
+  int abiversion_;
   // Flags indicating which sections are compressed.
   std::vector<bool> is_compressed_;
   // Map input section index onto output section offset and size.
   std::vector<Section_bounds> sect_offsets_;
   // Map input string offsets to output string offsets.
   Str_offset_map str_offset_map_;
+  // The section indexes of the debug sections, indexed by DW_SECT.
+  unsigned int debug_shndx_[elfcpp::DW_SECT_MAX + 1];
+  // The section indexes of the .debug_types.dwo sections.
+  Types_list debug_types_;
+  // The section indexes of the string table and the .dwp index sections.
+  unsigned int debug_str_;
+  unsigned int debug_cu_index_;
+  unsigned int debug_tu_index_;
+  // The mapped contents of the debug sections, indexed by section index.
+  std::vector<Section_contents> contents_;
+  // The strings of the input string table.
+  std::vector<Input_string> strings_;
+  // The compilation and type units, in the order of their sections.
+  std::vector<Dwo_unit> units_;
+  // The next entry in UNITS_ to add to the output file.
+  size_t next_unit_;
 };
 
 // An ELF input file.
@@ -463,14 +579,18 @@ class Dwp_output_file
   record_target_info(const char* name, int machine, int size, bool big_endian,
 		     int osabi, int abiversion);
 
-  // Add a string to the debug strings section.
+  // Add a string to the debug strings section.  HASH_CODE is the
+  // hash code of the string computed by Stringpool::hash_string.  The
+  // string is not copied, so it must remain valid until finalize.
   section_offset_type
-  add_string(const char* str, size_t len);
+  add_string(const char* str, size_t len, size_t hash_code);
 
   // Add a section to the output file, and return the new section offset.
+  // CONTENTS must remain valid until finalize.  If IS_NEW is true, the
+  // output file takes ownership of CONTENTS, which was allocated by new[].
   section_offset_type
   add_contribution(elfcpp::DW_SECT section_id, const unsigned char* contents,
-		   section_size_type len, int align);
+		   section_size_type len, int align, bool is_new);
 
   // Add a set of .debug_info and related sections to the output file.
   void
@@ -496,6 +616,7 @@ class Dwp_output_file
     section_offset_type output_offset;
     section_size_type size;
     const unsigned char* contents;
+    bool is_new;
   };
 
   // Sections in the output file.
@@ -711,23 +832,23 @@ class Dwo_name_info_reader : public Dwarf_info_reader
   File_list* files_;
 };
 
-// A specialization of Dwarf_info_reader, for reading DWARF CUs and TUs
-// and adding them to the output file.
+// A specialization of Dwarf_info_reader, for finding the DWARF CUs
+// and TUs in an input section.
 
 class Unit_reader : public Dwarf_info_reader
 {
  public:
   Unit_reader(bool is_type_unit, Relobj* object, unsigned int shndx)
     : Dwarf_info_reader(is_type_unit, object, NULL, 0, shndx, 0, 0),
-      output_file_(NULL), sections_(NULL)
+      shndx_(shndx), units_(NULL)
   { }
 
   ~Unit_reader()
   { }
 
-  // Read the CUs or TUs and add them to the output file.
+  // Read the CUs or TUs and append their locations to UNITS.
   void
-  add_units(Dwp_output_file*, unsigned int debug_abbrev, Section_bounds*);
+  read_units(unsigned int debug_abbrev, std::vector<Dwo_unit>* units);
 
  protected:
   // Visit a compilation unit.
@@ -740,8 +861,82 @@ class Unit_reader : public Dwarf_info_reader
 		  uint64_t signature, Dwarf_die*);
 
  private:
+  // The section we are reading.
+  unsigned int shndx_;
+  // The list of units to populate.
+  std::vector<Dwo_unit>* units_;
+};
+
+// A task to read an input file.  These tasks may run in parallel.
+
+class Dwp_read_task : public Task
+{
+ public:
+  Dwp_read_task(Dwo_file* dwo_file, Task_token* blocker)
+    : dwo_file_(dwo_file), blocker_(blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const;
+
+ private:
+  Dwo_file* dwo_file_;
+  // Blocker which is released when the file has been read.
+  Task_token* blocker_;
+};
+
+// A task to add an input file to the output file.  These tasks run
+// one at a time in the order of the input files, so that the output
+// does not depend on the number of threads.
+
+class Dwp_add_task : public Task
+{
+ public:
+  Dwp_add_task(Dwo_file* dwo_file, Dwp_output_file* output_file,
+	       Task_token* read_blocker, Task_token* this_blocker,
+	       Task_token* next_blocker)
+    : dwo_file_(dwo_file), output_file_(output_file),
+      read_blocker_(read_blocker), this_blocker_(this_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  ~Dwp_add_task();
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const;
+
+ private:
+  Dwo_file* dwo_file_;
   Dwp_output_file* output_file_;
-  Section_bounds* sections_;
+  // Blocker released by the Dwp_read_task for this file.
+  Task_token* read_blocker_;
+  // Blocker released by the Dwp_add_task for the previous file.
+  Task_token* this_blocker_;
+  // Blocker for the Dwp_add_task for the next file.
+  Task_token* next_blocker_;
 };
 
 // Return the name of a DWARF .dwo section.
@@ -828,6 +1023,9 @@ Sized_relobj_dwo<size, big_endian>::do_section_contents(
 
 Dwo_file::~Dwo_file()
 {
+  for (unsigned int i = 0; i < this->contents_.size(); ++i)
+    if (this->contents_[i].is_new)
+      delete[] this->contents_[i].contents;
   if (this->obj_ != NULL)
     delete this->obj_;
   if (this->input_file_ != NULL)
@@ -880,25 +1078,19 @@ Dwo_file::read_executable(File_list* files)
     }
 }
 
-// Read the input file and send its contents to OUTPUT_FILE.
+// Read the input file on behalf of TASK.  This finds the debug
+// sections and maps their contents, so that add_to_output can pass
+// them to the output file without copying them.
 
 void
-Dwo_file::read(Dwp_output_file* output_file)
+Dwo_file::read(const Task* task)
 {
-  this->obj_ = this->make_object(output_file);
+  this->obj_ = this->make_object(task);
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
   this->sect_offsets_.resize(shnum);
-
-  typedef std::vector<unsigned int> Types_list;
-  Types_list debug_types;
-  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
-  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
-    debug_shndx[i] = 0;
-  unsigned int debug_str = 0;
-  unsigned int debug_cu_index = 0;
-  unsigned int debug_tu_index = 0;
+  this->contents_.resize(shnum);
 
   // Scan the section table and collect debug sections.
   // (Section index 0 is a dummy section; skip it.)
@@ -918,48 +1110,95 @@ Dwo_file::read(Dwp_output_file* output_file)
       else
 	continue;
       if (strcmp(suffix, "info.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_INFO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_INFO] = i;
       else if (strcmp(suffix, "types.dwo") == 0)
-	debug_types.push_back(i);
+	this->debug_types_.push_back(i);
       else if (strcmp(suffix, "abbrev.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_ABBREV] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_ABBREV] = i;
       else if (strcmp(suffix, "line.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_LINE] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_LINE] = i;
       else if (strcmp(suffix, "loc.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_LOC] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_LOC] = i;
       else if (strcmp(suffix, "str.dwo") == 0)
-	debug_str = i;
+	this->debug_str_ = i;
       else if (strcmp(suffix, "str_offsets.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_STR_OFFSETS] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_STR_OFFSETS] = i;
       else if (strcmp(suffix, "macinfo.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_MACINFO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_MACINFO] = i;
       else if (strcmp(suffix, "macro.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_MACRO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_MACRO] = i;
       else if (strcmp(suffix, "cu_index") == 0)
-	debug_cu_index = i;
+	this->debug_cu_index_ = i;
       else if (strcmp(suffix, "tu_index") == 0)
-	debug_tu_index = i;
+	this->debug_tu_index_ = i;
+    }
+
+  // Map the sections that we will copy to the output file.
+  for (int i = elfcpp::DW_SECT_INFO; i <= elfcpp::DW_SECT_MAX; ++i)
+    {
+      if (this->debug_shndx_[i] > 0)
+	this->map_section(this->debug_shndx_[i]);
+    }
+  for (Types_list::const_iterator tp = this->debug_types_.begin();
+       tp != this->debug_types_.end();
+       ++tp)
+    this->map_section(*tp);
+  if (this->debug_str_ > 0)
+    this->map_section(this->debug_str_);
+
+  this->hash_strings();
+
+  // If we found no .dwp index sections, this is a .dwo file, and we
+  // need to find its compilation and type units.
+  if (this->debug_cu_index_ == 0 && this->debug_tu_index_ == 0)
+    {
+      if (this->debug_shndx_[elfcpp::DW_SECT_INFO] > 0)
+	this->read_units(this->debug_shndx_[elfcpp::DW_SECT_INFO], false);
+      for (Types_list::const_iterator tp = this->debug_types_.begin();
+	   tp != this->debug_types_.end();
+	   ++tp)
+	this->read_units(*tp, true);
     }
 
+  // The views that we mapped are cached, so they survive releasing
+  // the file, which lets us close the descriptor.
+  this->input_file_->file().unlock(task);
+}
+
+// Send the contents read by read() to OUTPUT_FILE.
+
+void
+Dwo_file::add_to_output(Dwp_output_file* output_file)
+{
+  output_file->record_target_info(this->name_, this->machine_, this->size_,
+				  this->big_endian_, this->osabi_,
+				  this->abiversion_);
+
+  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
+  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+    debug_shndx[i] = this->debug_shndx_[i];
+
   // Merge the input string table into the output string table.
-  this->add_strings(output_file, debug_str);
+  this->add_strings(output_file);
 
   // If we found any .dwp index sections, read those and add the section
   // sets to the output file.
-  if (debug_cu_index > 0 || debug_tu_index > 0)
+  if (this->debug_cu_index_ > 0 || this->debug_tu_index_ > 0)
     {
-      if (debug_cu_index > 0)
-	this->read_unit_index(debug_cu_index, debug_shndx, output_file, false);
-      if (debug_tu_index > 0)
+      if (this->debug_cu_index_ > 0)
+	this->read_unit_index(this->debug_cu_index_, debug_shndx, output_file,
+			      false);
+      if (this->debug_tu_index_ > 0)
         {
-	  if (debug_types.size() > 1)
+	  if (this->debug_types_.size() > 1)
 	    gold_fatal(_("%s: .dwp file must have no more than one "
 			 ".debug_types.dwo section"), this->name_);
-          if (debug_types.size() == 1)
-            debug_shndx[elfcpp::DW_SECT_TYPES] = debug_types[0];
+          if (this->debug_types_.size() == 1)
+            debug_shndx[elfcpp::DW_SECT_TYPES] = this->debug_types_[0];
           else
             debug_shndx[elfcpp::DW_SECT_TYPES] = 0;
-	  this->read_unit_index(debug_tu_index, debug_shndx, output_file, true);
+	  this->read_unit_index(this->debug_tu_index_, debug_shndx,
+				output_file, true);
 	}
       return;
     }
@@ -969,8 +1208,8 @@ Dwo_file::read(Dwp_output_file* output_file)
     this->add_unit_set(output_file, debug_shndx, false);
 
   debug_shndx[elfcpp::DW_SECT_INFO] = 0;
-  for (Types_list::const_iterator tp = debug_types.begin();
-       tp != debug_types.end();
+  for (Types_list::const_iterator tp = this->debug_types_.begin();
+       tp != this->debug_types_.end();
        ++tp)
     {
       debug_shndx[elfcpp::DW_SECT_TYPES] = *tp;
@@ -1021,17 +1260,18 @@ Dwo_file::verify(const File_list& files)
 }
 
 // Create a Sized_relobj_dwo of the given size and endianness,
-// and record the target info.
+// and record the target info.  TASK is the task which will lock
+// the file, or NULL.
 
 Relobj*
-Dwo_file::make_object(Dwp_output_file* output_file)
+Dwo_file::make_object(const Task* task)
 {
   // Open the input file.
   Input_file* input_file = new Input_file(this->name_);
   this->input_file_ = input_file;
   Dirsearch dirpath;
   int index;
-  if (!input_file->open(dirpath, NULL, &index))
+  if (!input_file->open(dirpath, task, &index))
     gold_fatal(_("%s: can't open"), this->name_);
   
   // Check that it's an ELF file.
@@ -1058,15 +1298,13 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     {
       if (big_endian)
 #ifdef HAVE_TARGET_32_BIG
-	return this->sized_make_object<32, true>(elf_header, input_file,
-						 output_file);
+	return this->sized_make_object<32, true>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_32_LITTLE
-	return this->sized_make_object<32, false>(elf_header, input_file,
-						  output_file);
+	return this->sized_make_object<32, false>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
@@ -1075,15 +1313,13 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     {
       if (big_endian)
 #ifdef HAVE_TARGET_64_BIG
-	return this->sized_make_object<64, true>(elf_header, input_file,
-						 output_file);
+	return this->sized_make_object<64, true>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_64_LITTLE
-	return this->sized_make_object<64, false>(elf_header, input_file,
-						  output_file);
+	return this->sized_make_object<64, false>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
@@ -1097,18 +1333,17 @@ Dwo_file::make_object(Dwp_output_file* output_file)
 
 template <int size, bool big_endian>
 Relobj*
-Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file,
-			    Dwp_output_file* output_file)
+Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file)
 {
   elfcpp::Ehdr<size, big_endian> ehdr(p);
   Sized_relobj_dwo<size, big_endian>* obj =
       new Sized_relobj_dwo<size, big_endian>(this->name_, input_file, ehdr);
   obj->setup();
-  if (output_file != NULL)
-    output_file->record_target_info(
-	this->name_, ehdr.get_e_machine(), size, big_endian,
-	ehdr.get_ei_osabi(),
-	ehdr.get_ei_abiversion());
+  this->machine_ = ehdr.get_e_machine();
+  this->size_ = size;
+  this->big_endian_ = big_endian;
+  this->osabi_ = ehdr.get_ei_osabi();
+  this->abiversion_ = ehdr.get_ei_abiversion();
   return obj;
 }
 
@@ -1192,10 +1427,8 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
     }
 
   // Get the contents of the .debug_info.dwo or .debug_types.dwo section.
-  section_size_type info_len;
-  bool info_is_new;
   const unsigned char* info_contents =
-      this->section_contents(info_shndx, &info_len, &info_is_new);
+      this->mapped_section(info_shndx).contents;
 
   // Loop over the slots of the hash table.
   for (unsigned int i = 0; i < nslots; ++i)
@@ -1236,18 +1469,11 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
 	      info_contents + unit_set->sections[info_sect].offset;
 	  section_size_type unit_length = unit_set->sections[info_sect].size;
 
-	  // Dwp_output_file::add_contribution writes the .debug_info.dwo
-	  // section directly to the output file, so we only need to
-	  // duplicate contributions for .debug_types.dwo section.
-	  if (is_tu_index)
-	    {
-	      unsigned char *copy = new unsigned char[unit_length];
-	      memcpy(copy, unit_start, unit_length);
-	      unit_start = copy;
-	    }
+	  // The section contents stay mapped until the output file
+	  // has been written, so we need not copy the unit.
 	  section_offset_type off =
 	      output_file->add_contribution(info_sect, unit_start,
-					    unit_length, 1);
+					    unit_length, 1, false);
 	  unit_set->sections[info_sect].offset = off;
 	  if (is_tu_index)
 	    output_file->add_tu_set(unit_set);
@@ -1260,8 +1486,6 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
 
   if (index_is_new)
     delete[] contents;
-  if (info_is_new)
-    delete[] info_contents;
 }
 
 // Verify the .debug_cu_index section of a .dwp file, comparing it
@@ -1360,46 +1584,109 @@ Dwo_file::sized_verify_dwo_list(unsigned int shndx, const File_list& files)
   return nmissing == 0;
 }
 
-// Merge the input string table section into the output file.
+// Map the contents of section SHNDX, decompressing it if necessary.
+// We ask for a cached view of an uncompressed section, so that it
+// remains mapped after the file is released.
 
 void
-Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
+Dwo_file::map_section(unsigned int shndx)
 {
-  section_size_type len;
-  bool is_new;
-  const unsigned char* pdata = this->section_contents(debug_str, &len, &is_new);
-  const char* p = reinterpret_cast<const char*>(pdata);
-  const char* pend = p + len;
+  Section_contents* sc = &this->contents_[shndx];
+  if (sc->contents != NULL)
+    return;
+
+  section_size_type uncompressed_size;
+  if (this->obj_->section_is_compressed(shndx, &uncompressed_size))
+    sc->contents = this->section_contents(shndx, &sc->len, &sc->is_new);
+  else
+    {
+      sc->contents = this->obj_->section_contents(shndx, &sc->len, true);
+      sc->is_new = false;
+    }
+}
+
+// Find the strings in the input string table and compute their hash
+// codes, so that add_strings need only enter them in the output
+// string table.
+
+void
+Dwo_file::hash_strings()
+{
+  if (this->debug_str_ == 0)
+    return;
+
+  const Section_contents& sc(this->mapped_section(this->debug_str_));
+  const char* p = reinterpret_cast<const char*>(sc.contents);
+  const char* pend = p + sc.len;
 
   // Check that the last string is null terminated.
-  if (pend[-1] != '\0')
+  if (sc.len > 0 && pend[-1] != '\0')
     gold_fatal(_("%s: last entry in string section '%s' "
 		 "is not null terminated"),
 	       this->name_,
-	       this->section_name(debug_str).c_str());
+	       this->section_name(this->debug_str_).c_str());
 
-  // Count the number of strings in the section, and size the map.
+  // Count the number of strings in the section, and size the list.
   size_t count = 0;
   for (const char* pt = p; pt < pend; pt += strlen(pt) + 1)
     ++count;
-  this->str_offset_map_.reserve(count + 1);
+  this->strings_.reserve(count);
 
-  // Add the strings to the output string table, and record the new offsets
-  // in the map.
   section_offset_type i = 0;
-  section_offset_type new_offset;
   while (p < pend)
     {
       size_t len = strlen(p);
-      new_offset = output_file->add_string(p, len);
-      this->str_offset_map_.push_back(std::make_pair(i, new_offset));
+      this->strings_.push_back(Input_string(i, len,
+					    Stringpool::hash_string(p, len)));
       p += len + 1;
       i += len + 1;
     }
+}
+
+// Find the compilation or type units in section SHNDX.
+
+void
+Dwo_file::read_units(unsigned int shndx, bool is_debug_types)
+{
+  if (this->debug_shndx_[elfcpp::DW_SECT_ABBREV] == 0)
+    gold_fatal(_("%s: no .debug_abbrev.dwo section found"), this->name_);
+
+  Unit_reader reader(is_debug_types, this->obj_, shndx);
+  reader.read_units(this->debug_shndx_[elfcpp::DW_SECT_ABBREV],
+		    &this->units_);
+}
+
+// Merge the input string table section into the output file.
+
+void
+Dwo_file::add_strings(Dwp_output_file* output_file)
+{
+  const char* p = NULL;
+  section_offset_type len = 0;
+  if (this->debug_str_ > 0)
+    {
+      const Section_contents& sc(this->mapped_section(this->debug_str_));
+      p = reinterpret_cast<const char*>(sc.contents);
+      len = sc.len;
+    }
+
+  // Add the strings to the output string table, and record the new offsets
+  // in the map.
+  this->str_offset_map_.reserve(this->strings_.size() + 1);
+  section_offset_type new_offset;
+  for (std::vector<Input_string>::const_iterator s = this->strings_.begin();
+       s != this->strings_.end();
+       ++s)
+    {
+      new_offset = output_file->add_string(p + s->offset, s->len,
+					   s->hash_code);
+      this->str_offset_map_.push_back(std::make_pair(s->offset, new_offset));
+    }
   new_offset = 0;
-  this->str_offset_map_.push_back(std::make_pair(i, new_offset));
-  if (is_new)
-    delete[] pdata;
+  this->str_offset_map_.push_back(std::make_pair(len, new_offset));
+
+  // We no longer need the hash codes.
+  std::vector<Input_string>().swap(this->strings_);
 }
 
 // Copy a section from the input file to the output file.
@@ -1416,32 +1703,23 @@ Dwo_file::copy_section(Dwp_output_file* output_file, unsigned int shndx,
   if (this->sect_offsets_[shndx].size > 0)
     return this->sect_offsets_[shndx];
 
-  // Get the section contents. Upon return, if IS_NEW is true, the memory
-  // has been allocated via new; if false, the memory is part of the mapped
-  // input file, and we will need to duplicate it so that it will persist
-  // after we close the input file.
-  section_size_type len;
-  bool is_new;
-  const unsigned char* contents = this->section_contents(shndx, &len, &is_new);
+  // The section contents were mapped by read(), and remain valid
+  // until the output file has been written, so we pass them to the
+  // output file without copying them.
+  const Section_contents& sc(this->mapped_section(shndx));
+  const unsigned char* contents = sc.contents;
+  section_size_type len = sc.len;
+  bool is_new = false;
 
   if (section_id == elfcpp::DW_SECT_STR_OFFSETS)
     {
-      const unsigned char* remapped = this->remap_str_offsets(contents, len);
-      if (is_new)
-	delete[] contents;
-      contents = remapped;
-    }
-  else if (!is_new)
-    {
-      unsigned char* copy = new unsigned char[len];
-      memcpy(copy, contents, len);
-      contents = copy;
+      contents = this->remap_str_offsets(contents, len);
+      is_new = true;
     }
 
   // Add the contents of the input section to the output section.
-  // The output file takes ownership of the memory pointed to by CONTENTS.
   section_offset_type off = output_file->add_contribution(section_id, contents,
-							  len, 1);
+							  len, 1, is_new);
 
   // Store the output section bounds.
   Section_bounds bounds(off, len);
@@ -1532,11 +1810,40 @@ Dwo_file::add_unit_set(Dwp_output_file* output_file, unsigned int *debug_shndx,
 					 static_cast<elfcpp::DW_SECT>(i));
     }
 
-  // Parse the .debug_info or .debug_types section and add each compilation
-  // or type unit to the output file, along with the contributions to the
+  // Add each compilation or type unit that read() found in this
+  // section to the output file, along with the contributions to the
   // related sections.
-  Unit_reader reader(is_debug_types, this->obj_, shndx);
-  reader.add_units(output_file, debug_shndx[elfcpp::DW_SECT_ABBREV], sections);
+  elfcpp::DW_SECT info_sect = (is_debug_types
+			       ? elfcpp::DW_SECT_TYPES
+			       : elfcpp::DW_SECT_INFO);
+  const unsigned char* info_contents = this->mapped_section(shndx).contents;
+  while (this->next_unit_ < this->units_.size()
+	 && this->units_[this->next_unit_].shndx == shndx)
+    {
+      const Dwo_unit& unit(this->units_[this->next_unit_]);
+      ++this->next_unit_;
+
+      if (is_debug_types && output_file->lookup_tu(unit.signature))
+	continue;
+
+      Unit_set* unit_set = new Unit_set();
+      unit_set->signature = unit.signature;
+      for (unsigned int i = elfcpp::DW_SECT_ABBREV;
+	   i <= elfcpp::DW_SECT_MAX;
+	   ++i)
+	unit_set->sections[i] = sections[i];
+
+      section_offset_type off =
+	  output_file->add_contribution(info_sect,
+					info_contents + unit.offset,
+					unit.length, 1, false);
+      Section_bounds bounds(off, unit.length);
+      unit_set->sections[info_sect] = bounds;
+      if (is_debug_types)
+	output_file->add_tu_set(unit_set);
+      else
+	output_file->add_cu_set(unit_set);
+    }
 }
 
 // Class Dwp_output_file.
@@ -1582,10 +1889,10 @@ Dwp_output_file::record_target_info(const char*, int machine,
 // Add a string to the debug strings section.
 
 section_offset_type
-Dwp_output_file::add_string(const char* str, size_t len)
+Dwp_output_file::add_string(const char* str, size_t len, size_t hash_code)
 {
   Stringpool::Key key;
-  this->stringpool_.add_with_length(str, len, true, &key);
+  this->stringpool_.add_with_length_and_hash(str, len, hash_code, false, &key);
   this->have_strings_ = true;
   // We aren't supposed to call get_offset() until after
   // calling set_string_offsets(), but the offsets will
@@ -1614,15 +1921,16 @@ Dwp_output_file::add_output_section(const char* section_name, int align)
 // Add a contribution to a section in the output file, and return the offset
 // of the contribution within the output section.  The .debug_info.dwo section
 // is expected to be the largest one, so we will write the contents of this
-// section directly to the output file as we receive contributions, allowing
-// us to free that memory as soon as possible. We will save the remaining
-// contributions until we finalize the layout of the output file.
+// section directly to the output file as we receive contributions.  We will
+// save the remaining contributions until we finalize the layout of the output
+// file; these normally point into the mapped input files.
 
 section_offset_type
 Dwp_output_file::add_contribution(elfcpp::DW_SECT section_id,
 				  const unsigned char* contents,
 				  section_size_type len,
-				  int align)
+				  int align,
+				  bool is_new)
 {
   const char* section_name = get_dwarf_section_name(section_id);
   gold_assert(static_cast<size_t>(section_id) < this->section_id_map_.size());
@@ -1645,7 +1953,6 @@ Dwp_output_file::add_contribution(elfcpp::DW_SECT section_id,
   if (section_id == elfcpp::DW_SECT_INFO)
     {
       // Write the .debug_info.dwo section directly.
-      // We do not need to free the memory in this case.
       off_t file_offset = this->next_file_offset_;
       gold_assert(this->size_ > 0 && file_offset > 0);
 
@@ -1673,6 +1980,8 @@ Dwp_output_file::add_contribution(elfcpp::DW_SECT section_id,
 	gold_fatal(_("%s: error writing section '%s'"), this->name_,
 		   section_name);
       this->next_file_offset_ = file_offset + len;
+      if (is_new)
+	delete[] contents;
     }
   else
     {
@@ -1681,7 +1990,7 @@ Dwp_output_file::add_contribution(elfcpp::DW_SECT section_id,
 	section.align = align;
       section_offset = align_offset(section.size, align);
       section.size = section_offset + len;
-      Contribution contrib = { section_offset, len, contents };
+      Contribution contrib = { section_offset, len, contents, is_new };
       section.contributions.push_back(contrib);
     }
 
@@ -1938,7 +2247,8 @@ Dwp_output_file::write_contributions(const Section& sect)
       ::fseek(this->fd_, sect.offset + c.output_offset, SEEK_SET);
       if (::fwrite(c.contents, 1, c.size, this->fd_) < c.size)
 	gold_fatal(_("%s: error writing section '%s'"), this->name_, sect.name);
-      delete[] c.contents;
+      if (c.is_new)
+	delete[] c.contents;
     }
 }
 
@@ -2220,15 +2530,13 @@ Dwo_name_info_reader::visit_compilation_unit(off_t, off_t, Dwarf_die* die)
 
 // Class Unit_reader.
 
-// Read the CUs or TUs and add them to the output file.
+// Read the CUs or TUs and append their locations to UNITS.
 
 void
-Unit_reader::add_units(Dwp_output_file* output_file,
-		       unsigned int debug_abbrev,
-		       Section_bounds* sections)
+Unit_reader::read_units(unsigned int debug_abbrev,
+			std::vector<Dwo_unit>* units)
 {
-  this->output_file_ = output_file;
-  this->sections_ = sections;
+  this->units_ = units;
   this->set_abbrev_shndx(debug_abbrev);
   this->parse();
 }
@@ -2236,52 +2544,97 @@ Unit_reader::add_units(Dwp_output_file* output_file,
 // Visit a compilation unit.
 
 void
-Unit_reader::visit_compilation_unit(off_t, off_t cu_length, Dwarf_die* die)
+Unit_reader::visit_compilation_unit(off_t cu_offset, off_t cu_length,
+				    Dwarf_die* die)
 {
   if (cu_length == 0)
     return;
 
-  Unit_set* unit_set = new Unit_set();
-  unit_set->signature = die->uint_attribute(elfcpp::DW_AT_GNU_dwo_id);
-  for (unsigned int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
-    unit_set->sections[i] = this->sections_[i];
-
-  // Dwp_output_file::add_contribution writes the .debug_info.dwo section
-  // directly to the output file, so we do not need to duplicate the
-  // section contents, and add_contribution does not need to free the memory.
-  section_offset_type off =
-      this->output_file_->add_contribution(elfcpp::DW_SECT_INFO,
-					   this->buffer_at_offset(0),
-					   cu_length, 1);
-  Section_bounds bounds(off, cu_length);
-  unit_set->sections[elfcpp::DW_SECT_INFO] = bounds;
-  this->output_file_->add_cu_set(unit_set);
+  uint64_t dwo_id = die->uint_attribute(elfcpp::DW_AT_GNU_dwo_id);
+  this->units_->push_back(Dwo_unit(this->shndx_, cu_offset, cu_length,
+				   dwo_id));
 }
 
 // Visit a type unit.
 
 void
-Unit_reader::visit_type_unit(off_t, off_t tu_length, off_t,
+Unit_reader::visit_type_unit(off_t tu_offset, off_t tu_length, off_t,
 			     uint64_t signature, Dwarf_die*)
 {
   if (tu_length == 0)
     return;
-  if (this->output_file_->lookup_tu(signature))
-    return;
 
-  Unit_set* unit_set = new Unit_set();
-  unit_set->signature = signature;
-  for (unsigned int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
-    unit_set->sections[i] = this->sections_[i];
-
-  unsigned char* contents = new unsigned char[tu_length];
-  memcpy(contents, this->buffer_at_offset(0), tu_length);
-  section_offset_type off =
-      this->output_file_->add_contribution(elfcpp::DW_SECT_TYPES, contents,
-					   tu_length, 1);
-  Section_bounds bounds(off, tu_length);
-  unit_set->sections[elfcpp::DW_SECT_TYPES] = bounds;
-  this->output_file_->add_tu_set(unit_set);
+  this->units_->push_back(Dwo_unit(this->shndx_, tu_offset, tu_length,
+				   signature));
+}
+
+// Class Dwp_read_task.
+
+// We block the Dwp_add_task for the same file.  The file itself is
+// locked when it is opened.
+
+void
+Dwp_read_task::locks(Task_locker* tl)
+{
+  tl->add(this, this->blocker_);
+}
+
+void
+Dwp_read_task::run(Workqueue*)
+{
+  this->dwo_file_->read(this);
+}
+
+std::string
+Dwp_read_task::get_name() const
+{
+  return std::string("Dwp_read_task ") + this->dwo_file_->name();
+}
+
+// Class Dwp_add_task.
+
+Dwp_add_task::~Dwp_add_task()
+{
+  delete this->read_blocker_;
+  if (this->this_blocker_ != NULL)
+    delete this->this_blocker_;
+  // next_blocker_ is deleted by the task associated with the next
+  // input file.
+}
+
+// We are blocked by this_blocker_ and by the task reading the file.
+// We block next_blocker_.  We also lock the file.
+
+Task_token*
+Dwp_add_task::is_runnable()
+{
+  if (this->read_blocker_->is_blocked())
+    return this->read_blocker_;
+  if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+    return this->this_blocker_;
+  if (this->dwo_file_->object()->is_locked())
+    return this->dwo_file_->object()->token();
+  return NULL;
+}
+
+void
+Dwp_add_task::locks(Task_locker* tl)
+{
+  tl->add(this, this->next_blocker_);
+  tl->add(this, this->dwo_file_->object()->token());
+}
+
+void
+Dwp_add_task::run(Workqueue*)
+{
+  this->dwo_file_->add_to_output(this->output_file_);
+  this->dwo_file_->object()->release();
+}
+
+std::string
+Dwp_add_task::get_name() const
+{
+  return std::string("Dwp_add_task ") + this->dwo_file_->name();
 }
 
 }; // End namespace gold
@@ -2292,6 +2645,7 @@ using namespace gold;
 
 enum Dwp_options {
   VERIFY_ONLY = 0x101,
+  THREADS,
 };
 
 struct option dwp_options[] =
@@ -2299,6 +2653,7 @@ struct option dwp_options[] =
     { "exec", required_argument, NULL, 'e' },
     { "help", no_argument, NULL, 'h' },
     { "output", required_argument, NULL, 'o' },
+    { "threads", optional_argument, NULL, THREADS },
     { "verbose", no_argument, NULL, 'v' },
     { "verify-only", no_argument, NULL, VERIFY_ONLY },
     { "version", no_argument, NULL, 'V' },
@@ -2315,6 +2670,8 @@ usage(FILE* fd, int exit_status)
   fprintf(fd, _("  -e EXE, --exec EXE       Get list of dwo files from EXE"
 					   " (defaults output to EXE.dwp)\n"));
   fprintf(fd, _("  -o FILE, --output FILE   Set output dwp file name\n"));
+  fprintf(fd, _("  --threads[=N]            Read input files using N threads"
+					   " (defaults to one per file)\n"));
   fprintf(fd, _("  -v, --verbose            Verbose output\n"));
   fprintf(fd, _("  --verify-only            Verify output file against"
 					   " exec file\n"));
@@ -2378,6 +2735,8 @@ main(int argc, char** argv)
   const char* exe_filename = NULL;
   bool verbose = false;
   bool verify_only = false;
+  bool threads = false;
+  int thread_count = 0;
   int c;
   while ((c = getopt_long(argc, argv, "e:ho:vV", dwp_options, NULL)) != -1)
     {
@@ -2397,6 +2756,16 @@ main(int argc, char** argv)
 	  case VERIFY_ONLY:
 	    verify_only = true;
 	    break;
+	  case THREADS:
+	    threads = true;
+	    if (optarg != NULL)
+	      {
+		char* endptr;
+		thread_count = strtol(optarg, &endptr, 0);
+		if (*endptr != '\0' || thread_count < 0)
+		  gold_fatal(_("invalid thread count: %s"), optarg);
+	      }
+	    break;
 	  case 'V':
 	    print_version();
 	  case '?':
@@ -2405,6 +2774,18 @@ main(int argc, char** argv)
 	}
     }
 
+  // This must be done before we create any locks.
+  if (threads)
+    {
+#ifdef ENABLE_THREADS
+      options.set_use_threads(true);
+#else
+      gold_warning(_("ignoring --threads: "
+		     "%s was compiled without thread support"),
+		   program_name);
+#endif
+    }
+
   if (output_filename.empty())
     {
       if (exe_filename == NULL)
@@ -2436,16 +2817,49 @@ main(int argc, char** argv)
       return ok ? EXIT_SUCCESS : EXIT_FAILURE;
     }
 
-  // Process each file, adding its contents to the output file.
+  // Process each file, adding its contents to the output file.  The
+  // files are read in parallel, but added to the output file in
+  // order.  The files stay mapped until the output file has been
+  // written, since the output file refers to their contents.
+  Workqueue workqueue(options);
+
   Dwp_output_file output_file(output_filename.c_str());
+  std::vector<Dwo_file*> dwo_files;
+  dwo_files.reserve(files.size());
+  Task_token* this_blocker = NULL;
   for (File_list::const_iterator f = files.begin(); f != files.end(); ++f)
     {
       if (verbose)
 	fprintf(stderr, "%s\n", f->dwo_name.c_str());
-      Dwo_file dwo_file(f->dwo_name.c_str());
-      dwo_file.read(&output_file);
+      Dwo_file* dwo_file = new Dwo_file(f->dwo_name.c_str());
+      dwo_files.push_back(dwo_file);
+
+      Task_token* read_blocker = new Task_token(true);
+      read_blocker->add_blocker();
+      workqueue.queue(new Dwp_read_task(dwo_file, read_blocker));
+
+      Task_token* next_blocker = new Task_token(true);
+      next_blocker->add_blocker();
+      workqueue.queue(new Dwp_add_task(dwo_file, &output_file, read_blocker,
+				       this_blocker, next_blocker));
+      this_blocker = next_blocker;
     }
+
+  // Start the threads once all the tasks are queued.  A thread which
+  // finds no task to run and none running exits.
+  if (thread_count == 0)
+    thread_count = files.size();
+  workqueue.set_thread_count(thread_count);
+
+  workqueue.process(0);
+  delete this_blocker;
+
   output_file.finalize();
 
+  for (std::vector<Dwo_file*>::iterator p = dwo_files.begin();
+       p != dwo_files.end();
+       ++p)
+    delete *p;
+
   return EXIT_SUCCESS;
 }
@@ -38,6 +38,7 @@
 
 #include <sys/stat.h>
 #include "filenames.h"
+#include "md5.h"
 
 #include "debug.h"
 #include "parameters.h"
@@ -114,6 +115,19 @@ get_mtime(const char* filename, Timespec* mtime)
   return true;
 }
 
+// Compute the content hash of an unopened file.
+
+bool
+get_content_hash(const char* filename, unsigned char* hash)
+{
+  FILE* f = fopen(filename, "rb");
+  if (f == NULL)
+    return false;
+  bool ok = md5_stream(f, hash) == 0;
+  fclose(f);
+  return ok;
+}
+
 // Class File_read.
 
 // A lock for the File_read static variables.
@@ -58,6 +58,18 @@ struct Timespec
 bool
 get_mtime(const char* filename, Timespec* mtime);
 
+// The size of the content hash recorded for each input file in an
+// incremental link (an MD5 digest).
+
+const unsigned int content_hash_size = 16;
+
+// Compute the content hash of an unopened file into HASH, which must
+// hold content_hash_size bytes.  Returns false if the file can not be
+// read.
+
+bool
+get_content_hash(const char* filename, unsigned char* hash);
+
 class Position_dependent_options;
 class Input_file_argument;
 class Dirsearch;
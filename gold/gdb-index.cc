@@ -1,4 +1,4 @@
-// gdb-index.cc -- generate .gdb_index section for fast debug lookup
+// gdb-index.cc -- generate .gdb_index and .debug_names sections
 
 // Copyright (C) 2012-2024 Free Software Foundation, Inc.
 // Written by Cary Coutant <ccoutant@google.com>.
@@ -22,12 +22,17 @@
 
 #include "gold.h"
 
+#include <algorithm>
+#include <map>
+
 #include "gdb-index.h"
 #include "dwarf_reader.h"
 #include "dwarf.h"
 #include "object.h"
 #include "output.h"
 #include "demangle.h"
+#include "workqueue.h"
+#include "int_encoding.h"
 
 namespace gold
 {
@@ -171,6 +176,264 @@ mapped_index_string_hash(const unsigned char* str)
   return r;
 }
 
+// The hash function for names in the .debug_names section, from
+// section 7.33 of the DWARF 5 standard.  As in gdb, ASCII letters are
+// folded to lower case.
+
+static unsigned int
+debug_names_hash(const unsigned char* str)
+{
+  unsigned int r = 5381;
+  unsigned char c;
+
+  while ((c = *str++) != 0)
+    {
+      if (c < 0x80)
+	c = tolower(c);
+      r = r * 33 + c;
+    }
+
+  return r;
+}
+
+class Gdb_index_info_reader;
+
+// The .debug_info and .debug_types sections of one object, and the
+// units, address ranges, symbols and names found in them.  The objects
+// are scanned in parallel by Gdb_index_scan_task, and the results are
+// added to the sections in layout order by
+// Debug_index_scanner::add_scanned_units, so that the section contents
+// do not depend on the order in which the tasks run.  A CU index here
+// is local to the object; as in the index, a TU is flagged by a
+// negative index.
+
+class Gdb_index_scan
+{
+ public:
+  Gdb_index_scan(Relobj* object, unsigned int symtab_shndx,
+		 bool want_gdb_index, bool want_debug_names);
+
+  ~Gdb_index_scan();
+
+  // Return the object.
+  Relobj*
+  object() const
+  { return this->object_; }
+
+  // Return whether we are building a .gdb_index section.
+  bool
+  want_gdb_index() const
+  { return this->want_gdb_index_; }
+
+  // Return whether we are building a .debug_names section.
+  bool
+  want_debug_names() const
+  { return this->want_debug_names_; }
+
+  // Record a section to scan.
+  void
+  add_section(bool is_type_unit, unsigned int shndx,
+	      unsigned int reloc_shndx, unsigned int reloc_type)
+  {
+    this->sections_.push_back(Section(is_type_unit, shndx, reloc_shndx,
+				      reloc_type));
+  }
+
+  // Scan the recorded sections.
+  void
+  scan();
+
+  // Add the results of the scan to GDB_INDEX and DEBUG_NAMES, either
+  // of which may be NULL.
+  void
+  add_to_index(Gdb_index* gdb_index, Debug_names* debug_names);
+
+  // Add a compilation unit.
+  int
+  add_comp_unit(off_t cu_offset, off_t cu_length)
+  {
+    ++this->cu_count_;
+    this->comp_units_.push_back(Gdb_index::Comp_unit(cu_offset, cu_length));
+    return this->comp_units_.size() - 1;
+  }
+
+  // Add a type unit.
+  int
+  add_type_unit(off_t tu_offset, off_t type_offset, uint64_t signature)
+  {
+    ++this->tu_count_;
+    this->type_units_.push_back(Gdb_index::Type_unit(tu_offset, type_offset,
+						     signature));
+    return this->type_units_.size() - 1;
+  }
+
+  // Add an address range.
+  void
+  add_address_range_list(unsigned int cu_index, Dwarf_range_list* ranges)
+  {
+    this->ranges_.push_back(Gdb_index::Per_cu_range_list(this->object_,
+							 cu_index, ranges));
+  }
+
+  // Add a symbol.  FLAGS are the gdb_index version 7 flags to be stored in
+  // the high-byte of the cu_index field.
+  void
+  add_symbol(int cu_index, const char* sym_name, uint8_t flags);
+
+  // Add a name for the .debug_names section, for the DIE with tag TAG
+  // at DIE_OFFSET in the unit.
+  void
+  add_name(int cu_index, const char* name, unsigned int tag,
+	   off_t die_offset);
+
+  // Count a unit whose names were found by parsing the DIEs rather than
+  // from the pubnames and pubtypes tables.
+  void
+  count_unit_without_pubnames(bool is_type_unit)
+  {
+    if (is_type_unit)
+      ++this->tu_nopubnames_count_;
+    else
+      ++this->cu_nopubnames_count_;
+  }
+
+  // Return the offset into the pubnames table for the cu at the given
+  // offset.
+  off_t
+  find_pubname_offset(off_t cu_offset);
+
+  // Return the offset into the pubtypes table for the cu at the
+  // given offset.
+  off_t
+  find_pubtype_offset(off_t cu_offset);
+
+  // Return TRUE if we have already processed the pubnames and types
+  // set of the CUs and TUs associated with the statement list at
+  // OFFSET.
+  bool
+  pubnames_read(off_t offset) const
+  { return this->stmt_list_offset_ == offset; }
+
+  // Record that we have already read the pubnames associated with
+  // OFFSET.
+  void
+  set_pubnames_read(off_t offset)
+  { this->stmt_list_offset_ = offset; }
+
+  // Return a pointer to the given table.
+  Dwarf_pubnames_table*
+  pubnames_table()
+  { return this->pubnames_table_; }
+
+  Dwarf_pubnames_table*
+  pubtypes_table()
+  { return this->pubtypes_table_; }
+
+  // Print usage statistics.
+  static void
+  print_stats();
+
+ private:
+  // A section to scan.
+  struct Section
+  {
+    Section(bool is_type, unsigned int sec, unsigned int reloc_sec,
+	    unsigned int rtype)
+      : is_type_unit(is_type), shndx(sec), reloc_shndx(reloc_sec),
+	reloc_type(rtype)
+    { }
+    bool is_type_unit;
+    unsigned int shndx;
+    unsigned int reloc_shndx;
+    unsigned int reloc_type;
+  };
+
+  // A symbol found by the scan.  NAME_OFFSET is the offset of the
+  // name in NAMES_.
+  struct Symbol
+  {
+    Symbol(size_t name_off, unsigned int hash, int index, uint8_t flags)
+      : name_offset(name_off), hashval(hash), cu_index(index),
+	cu_flags(flags)
+    { }
+    size_t name_offset;
+    unsigned int hashval;
+    int cu_index;
+    uint8_t cu_flags;
+  };
+
+  // A name found by the scan, for the .debug_names section.
+  struct Name_entry
+  {
+    Name_entry(size_t name_off, unsigned int hash, int index,
+	       unsigned int t, off_t off)
+      : name_offset(name_off), hashval(hash), cu_index(index), tag(t),
+	die_offset(off)
+    { }
+    size_t name_offset;
+    unsigned int hashval;
+    int cu_index;
+    unsigned int tag;
+    off_t die_offset;
+  };
+
+  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
+
+  // Create a map from dies to pubnames.
+  Dwarf_pubnames_table*
+  map_pubtable_to_dies(unsigned int attr, Gdb_index_info_reader* dwinfo,
+		       Pubname_offset_map* map);
+
+  // The object.
+  Relobj* object_;
+  // Whether we are building the .gdb_index and .debug_names sections.
+  bool want_gdb_index_;
+  bool want_debug_names_;
+  // The index of the symbol table section of the object.
+  unsigned int symtab_shndx_;
+  // The symbol table, used to apply relocations to the debug info.
+  // This is a view of the object, only valid while scan runs.
+  const unsigned char* symbols_;
+  section_size_type symbols_size_;
+  // The sections to scan.
+  std::vector<Section> sections_;
+  // The compilation units and type units.
+  std::vector<Gdb_index::Comp_unit> comp_units_;
+  std::vector<Gdb_index::Type_unit> type_units_;
+  // The address ranges.
+  std::vector<Gdb_index::Per_cu_range_list> ranges_;
+  // The symbols, in the order in which they were found.
+  std::vector<Symbol> symbols_found_;
+  // The names for the .debug_names section.
+  std::vector<Name_entry> names_found_;
+  // The null-terminated names of the symbols and of the names.
+  std::string names_;
+  // Maps from a CU offset to the pubnames and pubtypes of the CU.
+  Pubname_offset_map cu_pubname_map_;
+  Pubname_offset_map cu_pubtype_map_;
+  // The pubnames and pubtypes sections of the object.
+  Dwarf_pubnames_table* pubnames_table_;
+  Dwarf_pubnames_table* pubtypes_table_;
+  // Stmt list offset of the CUs and TUs associated with the last read
+  // pubnames and pubtypes.
+  off_t stmt_list_offset_;
+  // Statistics for this object.
+  unsigned int cu_count_;
+  unsigned int cu_nopubnames_count_;
+  unsigned int tu_count_;
+  unsigned int tu_nopubnames_count_;
+
+  // Statistics.
+  // Total number of DWARF compilation units processed.
+  static unsigned int dwarf_cu_count;
+  // Number of DWARF compilation units with pubnames/pubtypes.
+  static unsigned int dwarf_cu_nopubnames_count;
+  // Total number of DWARF type units processed.
+  static unsigned int dwarf_tu_count;
+  // Number of DWARF type units with pubnames/pubtypes.
+  static unsigned int dwarf_tu_nopubnames_count;
+};
+
 // A specialization of Dwarf_info_reader, for building the .gdb_index.
 
 class Gdb_index_info_reader : public Dwarf_info_reader
@@ -183,19 +446,15 @@ class Gdb_index_info_reader : public Dwarf_info_reader
 			unsigned int shndx,
 			unsigned int reloc_shndx,
 			unsigned int reloc_type,
-			Gdb_index* gdb_index)
+			Gdb_index_scan* scan)
     : Dwarf_info_reader(is_type_unit, object, symbols, symbols_size, shndx,
 			reloc_shndx, reloc_type),
-      gdb_index_(gdb_index), cu_index_(0), cu_language_(0)
+      scan_(scan), cu_index_(0), cu_language_(0), add_symbols_(false)
   { }
 
   ~Gdb_index_info_reader()
   { this->clear_declarations(); }
 
-  // Print usage statistics.
-  static void
-  print_stats();
-
  protected:
   // Visit a compilation unit.
   virtual void
@@ -228,6 +487,11 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   };
   typedef Unordered_map<off_t, Declaration_pair> Declaration_map;
 
+  // The name and linkage name of a DIE seen by the walk for the
+  // .debug_names section, for a later DIE that refers to it.
+  typedef Unordered_map<off_t, std::pair<const char*, const char*> >
+      Name_map;
+
   // Visit a top-level DIE.
   void
   visit_top_die(Dwarf_die* die);
@@ -269,6 +533,19 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   std::string
   get_qualified_name(Dwarf_die* die, Dwarf_die* context);
 
+  // Visit the children of a DIE for the .debug_names section.
+  void
+  visit_children_for_names(Dwarf_die* die);
+
+  // Find the names of the DIE at DIE_OFFSET.
+  void
+  find_names(off_t die_offset, const char** name,
+	     const char** linkage_name);
+
+  // Add the names of DIE to the .debug_names section.
+  void
+  add_names(Dwarf_die* die);
+
   // Record the address ranges for a compilation unit.
   void
   record_cu_ranges(Dwarf_die* die);
@@ -285,44 +562,30 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   void
   clear_declarations();
 
-  // The Gdb_index section.
-  Gdb_index* gdb_index_;
+  // The scan of the object for the .gdb_index section.
+  Gdb_index_scan* scan_;
   // The current CU index (negative for a TU).
   int cu_index_;
   // The language of the current CU or TU.
   unsigned int cu_language_;
+  // Whether to add the symbols of the current CU or TU found in the
+  // DIEs to the .gdb_index section, because it has no pubnames.
+  bool add_symbols_;
   // Map from DIE offset to (parent offset, name) pair,
   // for DW_AT_specification.
   Declaration_map declarations_;
-
-  // Statistics.
-  // Total number of DWARF compilation units processed.
-  static unsigned int dwarf_cu_count;
-  // Number of DWARF compilation units with pubnames/pubtypes.
-  static unsigned int dwarf_cu_nopubnames_count;
-  // Total number of DWARF type units processed.
-  static unsigned int dwarf_tu_count;
-  // Number of DWARF type units with pubnames/pubtypes.
-  static unsigned int dwarf_tu_nopubnames_count;
+  // Map from DIE offset to the name and linkage name of the DIE, for
+  // the .debug_names section.
+  Name_map die_names_;
 };
 
-// Total number of DWARF compilation units processed.
-unsigned int Gdb_index_info_reader::dwarf_cu_count = 0;
-// Number of DWARF compilation units without pubnames/pubtypes.
-unsigned int Gdb_index_info_reader::dwarf_cu_nopubnames_count = 0;
-// Total number of DWARF type units processed.
-unsigned int Gdb_index_info_reader::dwarf_tu_count = 0;
-// Number of DWARF type units without pubnames/pubtypes.
-unsigned int Gdb_index_info_reader::dwarf_tu_nopubnames_count = 0;
-
 // Process a compilation unit and parse its child DIE.
 
 void
 Gdb_index_info_reader::visit_compilation_unit(off_t cu_offset, off_t cu_length,
 					      Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_cu_count;
-  this->cu_index_ = this->gdb_index_->add_comp_unit(cu_offset, cu_length);
+  this->cu_index_ = this->scan_->add_comp_unit(cu_offset, cu_length);
   this->visit_top_die(root_die);
 }
 
@@ -333,10 +596,9 @@ Gdb_index_info_reader::visit_type_unit(off_t tu_offset, off_t,
 				       off_t type_offset, uint64_t signature,
 				       Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_tu_count;
   // Use a negative index to flag this as a TU instead of a CU.
-  this->cu_index_ = -1 - this->gdb_index_->add_type_unit(tu_offset, type_offset,
-							 signature);
+  this->cu_index_ = -1 - this->scan_->add_type_unit(tu_offset, type_offset,
+						    signature);
   this->visit_top_die(root_die);
 }
 
@@ -346,45 +608,63 @@ Gdb_index_info_reader::visit_type_unit(off_t tu_offset, off_t,
 // and process interesting children.  We may need to process
 // certain children just for saving declarations that might be
 // referenced by later DIEs with a DW_AT_specification attribute.
+// For the .debug_names section, we walk all of the DIEs again,
+// since the names there come only from the DIEs.
 
 void
 Gdb_index_info_reader::visit_top_die(Dwarf_die* die)
 {
   this->clear_declarations();
+  this->add_symbols_ = false;
+
+  // The walk for the .debug_names section starts over from the
+  // children of this DIE, so it needs the relocation tracker as it
+  // is now.
+  uint64_t checkpoint = this->get_reloc_checkpoint();
 
   switch (die->tag())
     {
       case elfcpp::DW_TAG_compile_unit:
+      case elfcpp::DW_TAG_skeleton_unit:
       case elfcpp::DW_TAG_type_unit:
 	this->cu_language_ = die->int_attribute(elfcpp::DW_AT_language);
-	if (die->tag() == elfcpp::DW_TAG_compile_unit)
-	  this->record_cu_ranges(die);
-	// If there is a pubnames and/or pubtypes section for this
-	// compilation unit, use those; otherwise, parse the DWARF
-	// info to extract the names.
-	if (!this->read_pubnames_and_pubtypes(die))
+	if (this->scan_->want_gdb_index())
 	  {
-	    // Check for languages that require specialized knowledge to
-	    // construct fully-qualified names, that we don't yet support.
-	    if (this->cu_language_ == elfcpp::DW_LANG_Ada83
-		|| this->cu_language_ == elfcpp::DW_LANG_Fortran77
-		|| this->cu_language_ == elfcpp::DW_LANG_Fortran90
-		|| this->cu_language_ == elfcpp::DW_LANG_Java
-		|| this->cu_language_ == elfcpp::DW_LANG_Ada95
-		|| this->cu_language_ == elfcpp::DW_LANG_Fortran95
-		|| this->cu_language_ == elfcpp::DW_LANG_Fortran03
-		|| this->cu_language_ == elfcpp::DW_LANG_Fortran08)
+	    if (die->tag() != elfcpp::DW_TAG_type_unit)
+	      this->record_cu_ranges(die);
+	    // If there is a pubnames and/or pubtypes section for this
+	    // compilation unit, use those; otherwise, parse the DWARF
+	    // info to extract the names.
+	    if (!this->read_pubnames_and_pubtypes(die))
 	      {
-		gold_warning(_("%s: --gdb-index currently supports "
-			       "only C and C++ languages"),
-			     this->object()->name().c_str());
-		return;
+		// Check for languages that require specialized
+		// knowledge to construct fully-qualified names, that we
+		// don't yet support.
+		if (this->cu_language_ == elfcpp::DW_LANG_Ada83
+		    || this->cu_language_ == elfcpp::DW_LANG_Fortran77
+		    || this->cu_language_ == elfcpp::DW_LANG_Fortran90
+		    || this->cu_language_ == elfcpp::DW_LANG_Java
+		    || this->cu_language_ == elfcpp::DW_LANG_Ada95
+		    || this->cu_language_ == elfcpp::DW_LANG_Fortran95
+		    || this->cu_language_ == elfcpp::DW_LANG_Fortran03
+		    || this->cu_language_ == elfcpp::DW_LANG_Fortran08)
+		  gold_warning(_("%s: --gdb-index currently supports "
+				 "only C and C++ languages"),
+			       this->object()->name().c_str());
+		else
+		  {
+		    this->scan_->count_unit_without_pubnames(
+			die->tag() == elfcpp::DW_TAG_type_unit);
+		    this->add_symbols_ = true;
+		  }
 	      }
-	    if (die->tag() == elfcpp::DW_TAG_compile_unit)
-	      ++Gdb_index_info_reader::dwarf_cu_nopubnames_count;
-	    else
-	      ++Gdb_index_info_reader::dwarf_tu_nopubnames_count;
-	    this->visit_children(die, NULL);
+	  }
+	if (this->add_symbols_)
+	  this->visit_children(die, NULL);
+	if (this->scan_->want_debug_names())
+	  {
+	    this->reset_relocs(checkpoint);
+	    this->visit_children_for_names(die);
 	  }
 	break;
       default:
@@ -437,8 +717,7 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	    // If the DIE is not a declaration, add it to the index.
 	    std::string full_name = this->get_qualified_name(die, context);
 	    if (!full_name.empty())
-	      this->gdb_index_->add_symbol(this->cu_index_,
-                                           full_name.c_str(), 0);
+	      this->scan_->add_symbol(this->cu_index_, full_name.c_str(), 0);
 	  }
 	break;
       case elfcpp::DW_TAG_typedef:
@@ -477,8 +756,7 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	      if (full_name.empty())
 		full_name = this->get_qualified_name(die, context);
 	      if (!full_name.empty())
-		this->gdb_index_->add_symbol(this->cu_index_,
-					     full_name.c_str(), 0);
+		this->scan_->add_symbol(this->cu_index_, full_name.c_str(), 0);
 	    }
 
 	  // We're interested in the children only for namespaces and
@@ -497,6 +775,186 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
     }
 }
 
+// Visit the children of PARENT, and all of their descendants, for
+// the .debug_names section.
+
+void
+Gdb_index_info_reader::visit_children_for_names(Dwarf_die* parent)
+{
+  off_t next_offset = 0;
+  for (off_t die_offset = parent->child_offset();
+       die_offset != 0;
+       die_offset = next_offset)
+    {
+      Dwarf_die die(this, die_offset, parent);
+      if (die.tag() == 0)
+	break;
+      this->add_names(&die);
+      if (die.has_children())
+	this->visit_children_for_names(&die);
+      next_offset = die.sibling_offset();
+    }
+}
+
+// Return true if the location of DIE, a variable, may have a static
+// address.  Section 6.1.1.1 of the DWARF 5 standard indexes only
+// those variables.  GCC emits such an address as the first operation
+// of the expression, or, for a thread-local variable, as an offset
+// followed by a final TLS operation.  We don't read location lists,
+// so a variable with one is indexed in case one of its expressions
+// has a static address.
+
+static bool
+has_static_location(Dwarf_die* die)
+{
+  const Dwarf_die::Attribute_value* loc =
+      die->attribute(elfcpp::DW_AT_location);
+  if (loc == NULL)
+    return false;
+  switch (loc->form)
+    {
+      case elfcpp::DW_FORM_block1:
+      case elfcpp::DW_FORM_block2:
+      case elfcpp::DW_FORM_block4:
+      case elfcpp::DW_FORM_block:
+      case elfcpp::DW_FORM_exprloc:
+	break;
+      case elfcpp::DW_FORM_data4:
+      case elfcpp::DW_FORM_data8:
+      case elfcpp::DW_FORM_sec_offset:
+      case elfcpp::DW_FORM_loclistx:
+	return true;
+      default:
+	return false;
+    }
+  if (loc->aux.blocklen == 0)
+    return false;
+  const unsigned char* expr = loc->val.blockval;
+  unsigned int op = expr[0];
+  if (op == elfcpp::DW_OP_addr
+      || op == elfcpp::DW_OP_addrx
+      || op == elfcpp::DW_OP_GNU_addr_index)
+    return true;
+  op = expr[loc->aux.blocklen - 1];
+  return (op == elfcpp::DW_OP_form_tls_address
+	  || op == elfcpp::DW_OP_GNU_push_tls_address);
+}
+
+// Return true if DIE, which has a name, belongs in the .debug_names
+// section.  Following section 6.1.1.1 of the DWARF 5 standard, the
+// index omits declarations, members, parameters, imported
+// declarations, code without an address, and variables without a
+// static address.  We also index the enumerators, as gdb does.
+
+static bool
+is_indexed_die(Dwarf_die* die)
+{
+  if (die->is_declaration())
+    return false;
+  switch (die->tag())
+    {
+      case elfcpp::DW_TAG_member:
+      case elfcpp::DW_TAG_formal_parameter:
+      case elfcpp::DW_TAG_template_type_param:
+      case elfcpp::DW_TAG_template_value_param:
+      case elfcpp::DW_TAG_GNU_template_parameter_pack:
+      case elfcpp::DW_TAG_GNU_template_template_param:
+      case elfcpp::DW_TAG_imported_declaration:
+	return false;
+      case elfcpp::DW_TAG_subprogram:
+      case elfcpp::DW_TAG_inlined_subroutine:
+      case elfcpp::DW_TAG_label:
+	return (die->attribute(elfcpp::DW_AT_low_pc) != NULL
+		|| die->attribute(elfcpp::DW_AT_high_pc) != NULL
+		|| die->attribute(elfcpp::DW_AT_ranges) != NULL
+		|| die->attribute(elfcpp::DW_AT_entry_pc) != NULL);
+      case elfcpp::DW_TAG_variable:
+	return has_static_location(die);
+      default:
+	return true;
+    }
+}
+
+// Find the name and linkage name of the DIE at DIE_OFFSET in the
+// current unit, which a DW_AT_specification or DW_AT_abstract_origin
+// attribute refers to, and set those of NAME and LINKAGE_NAME that
+// are still NULL.  The names of earlier DIEs were recorded by
+// add_names, since their relocations can't be read again; a later
+// DIE is read ahead, as in guess_full_class_name, and may itself
+// refer to another DIE for its names.  The limit on the length of
+// that chain guards against a cycle in bad input.
+
+void
+Gdb_index_info_reader::find_names(off_t die_offset, const char** name,
+				  const char** linkage_name)
+{
+  uint64_t checkpoint = this->get_reloc_checkpoint();
+  for (int i = 0;
+       i < 8 && die_offset > 0 && (*name == NULL || *linkage_name == NULL);
+       ++i)
+    {
+      Name_map::const_iterator it = this->die_names_.find(die_offset);
+      if (it != this->die_names_.end())
+	{
+	  if (*name == NULL)
+	    *name = it->second.first;
+	  if (*linkage_name == NULL)
+	    *linkage_name = it->second.second;
+	  break;
+	}
+
+      Dwarf_die die(this, die_offset, NULL);
+      if (die.tag() == 0)
+	break;
+      if (*name == NULL)
+	*name = die.name();
+      if (*linkage_name == NULL)
+	*linkage_name = die.linkage_name();
+      die_offset = die.specification();
+      if (die_offset == 0)
+	die_offset = die.abstract_origin();
+    }
+  this->reset_relocs(checkpoint);
+}
+
+// Add the names of DIE to the .debug_names section.  Unlike the
+// .gdb_index section, which holds fully-qualified names, this holds
+// the simple name of the DIE and its linkage name.  A DIE that
+// completes a declaration or an abstract instance elsewhere takes its
+// names from that DIE.  The names of every DIE are recorded, whether
+// or not it is indexed, for the DIEs that refer to it.
+
+void
+Gdb_index_info_reader::add_names(Dwarf_die* die)
+{
+  unsigned int tag = die->tag();
+  const char* name = die->name();
+  const char* linkage_name = die->linkage_name();
+  if (name == NULL || linkage_name == NULL)
+    {
+      off_t spec = die->specification();
+      if (spec == 0)
+	spec = die->abstract_origin();
+      if (spec > 0)
+	this->find_names(spec, &name, &linkage_name);
+    }
+  if (name == NULL && tag == elfcpp::DW_TAG_namespace)
+    name = "(anonymous namespace)";
+  if (name == NULL && linkage_name == NULL)
+    return;
+
+  off_t die_offset = die->offset();
+  this->die_names_.insert(std::make_pair(die_offset,
+					 std::make_pair(name, linkage_name)));
+  if (!is_indexed_die(die))
+    return;
+  if (name != NULL)
+    this->scan_->add_name(this->cu_index_, name, tag, die_offset);
+  if (linkage_name != NULL
+      && (name == NULL || strcmp(linkage_name, name) != 0))
+    this->scan_->add_name(this->cu_index_, linkage_name, tag, die_offset);
+}
+
 // Visit the children of PARENT, looking only for declarations that
 // may be referenced by later specification DIEs.
 
@@ -825,8 +1283,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
     {
       Dwarf_range_list* ranges = this->read_range_list(shndx, ranges_offset);
       if (ranges != NULL)
-	this->gdb_index_->add_address_range_list(this->object(),
-						 this->cu_index_, ranges);
+	this->scan_->add_address_range_list(this->cu_index_, ranges);
       return;
     }
 
@@ -851,8 +1308,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
         {
 	  Dwarf_range_list* ranges = new Dwarf_range_list();
 	  ranges->add(shndx, low_pc, high_pc);
-	  this->gdb_index_->add_address_range_list(this->object(),
-						   this->cu_index_, ranges);
+	  this->scan_->add_address_range_list(this->cu_index_, ranges);
         }
     }
 }
@@ -877,7 +1333,7 @@ Gdb_index_info_reader::read_pubtable(Dwarf_pubnames_table* table, off_t offset)
       if (name == NULL)
         break;
 
-      this->gdb_index_->add_symbol(this->cu_index_, name, flag_byte);
+      this->scan_->add_symbol(this->cu_index_, name, flag_byte);
     }
   return true;
 }
@@ -916,8 +1372,7 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
           // have read. If it does, then no need to read the pubnames.
           // If it doesn't, then the caller will have to parse the
           // dies manually to find the names.
-          return this->gdb_index_->pubnames_read(this->object(),
-                                                 stmt_list_off);
+          return this->scan_->pubnames_read(stmt_list_off);
         }
       else
         {
@@ -928,10 +1383,10 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
 
   // We found the attribute, so we can check if the corresponding
   // pubnames have been read.
-  if (this->gdb_index_->pubnames_read(this->object(), stmt_list_off))
+  if (this->scan_->pubnames_read(stmt_list_off))
     return true;
 
-  this->gdb_index_->set_pubnames_read(this->object(), stmt_list_off);
+  this->scan_->set_pubnames_read(stmt_list_off);
 
   // We have an attribute, and the pubnames haven't been read, so read
   // them.
@@ -939,12 +1394,12 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
   // In some of the cases, we could rely on the previous value of
   // offset here, but sorting out which cases complicates the logic
   // enough that it isn't worth it. So just look up the offset again.
-  offset = this->gdb_index_->find_pubname_offset(this->cu_offset());
-  names = this->read_pubtable(this->gdb_index_->pubnames_table(), offset);
+  offset = this->scan_->find_pubname_offset(this->cu_offset());
+  names = this->read_pubtable(this->scan_->pubnames_table(), offset);
 
   bool types = false;
-  offset = this->gdb_index_->find_pubtype_offset(this->cu_offset());
-  types = this->read_pubtable(this->gdb_index_->pubtypes_table(), offset);
+  offset = this->scan_->find_pubtype_offset(this->cu_offset());
+  types = this->read_pubtable(this->scan_->pubtypes_table(), offset);
   return names || types;
 }
 
@@ -962,89 +1417,63 @@ Gdb_index_info_reader::clear_declarations()
     }
 
   this->declarations_.clear();
+  this->die_names_.clear();
 }
 
-// Print usage statistics.
-void
-Gdb_index_info_reader::print_stats()
-{
-  fprintf(stderr, _("%s: DWARF CUs: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_cu_count);
-  fprintf(stderr, _("%s: DWARF CUs without pubnames/pubtypes: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_cu_nopubnames_count);
-  fprintf(stderr, _("%s: DWARF TUs: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_tu_count);
-  fprintf(stderr, _("%s: DWARF TUs without pubnames/pubtypes: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_tu_nopubnames_count);
-}
-
-// Class Gdb_index.
+// Class Gdb_index_scan.
 
-// Construct the .gdb_index section.
-
-Gdb_index::Gdb_index(Output_section* gdb_index_section)
-  : Output_section_data(4),
-    pubnames_table_(NULL),
-    pubtypes_table_(NULL),
-    gdb_index_section_(gdb_index_section),
-    comp_units_(),
-    type_units_(),
-    ranges_(),
-    cu_vector_list_(),
-    cu_vector_offsets_(NULL),
-    stringpool_(),
-    tu_offset_(0),
-    addr_offset_(0),
-    symtab_offset_(0),
-    cu_pool_offset_(0),
-    stringpool_offset_(0),
-    pubnames_object_(NULL),
-    stmt_list_offset_(-1)
+// Total number of DWARF compilation units processed.
+unsigned int Gdb_index_scan::dwarf_cu_count = 0;
+// Number of DWARF compilation units without pubnames/pubtypes.
+unsigned int Gdb_index_scan::dwarf_cu_nopubnames_count = 0;
+// Total number of DWARF type units processed.
+unsigned int Gdb_index_scan::dwarf_tu_count = 0;
+// Number of DWARF type units without pubnames/pubtypes.
+unsigned int Gdb_index_scan::dwarf_tu_nopubnames_count = 0;
+
+// Record the debug info of OBJECT, whose symbol table is section
+// SYMTAB_SHNDX.  The symbol table is read again when the object is
+// scanned, since the scan runs after the symbols have been released.
+
+Gdb_index_scan::Gdb_index_scan(Relobj* object, unsigned int symtab_shndx,
+			       bool want_gdb_index, bool want_debug_names)
+  : object_(object), want_gdb_index_(want_gdb_index),
+    want_debug_names_(want_debug_names), symtab_shndx_(symtab_shndx),
+    symbols_(NULL), symbols_size_(0), sections_(), comp_units_(), type_units_(),
+    ranges_(), symbols_found_(), names_found_(), names_(), cu_pubname_map_(),
+    cu_pubtype_map_(), pubnames_table_(NULL), pubtypes_table_(NULL),
+    stmt_list_offset_(-1), cu_count_(0), cu_nopubnames_count_(0),
+    tu_count_(0), tu_nopubnames_count_(0)
 {
-  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
 }
 
-Gdb_index::~Gdb_index()
+Gdb_index_scan::~Gdb_index_scan()
 {
-  // Free the memory used by the symbol table.
-  delete this->gdb_symtab_;
-  // Free the memory used by the CU vectors.
-  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
-    delete this->cu_vector_list_[i];
+  delete this->pubnames_table_;
+  delete this->pubtypes_table_;
 }
 
-
-// Scan the pubnames and pubtypes sections and build a map of the
-// various cus and tus they refer to, so we can process the entries
-// when we encounter the die for that cu or tu.
-// Return the just-read table so it can be cached.
+// Scan the pubnames or pubtypes section, depending on ATTR, and build
+// a map of the various cus and tus it refers to, so we can process
+// the entries when we encounter the die for that cu or tu.  Return
+// the just-read table.
 
 Dwarf_pubnames_table*
-Gdb_index::map_pubtable_to_dies(unsigned int attr,
-                                Gdb_index_info_reader* dwinfo,
-                                Relobj* object,
-                                const unsigned char* symbols,
-                                off_t symbols_size)
+Gdb_index_scan::map_pubtable_to_dies(unsigned int attr,
+				     Gdb_index_info_reader* dwinfo,
+				     Pubname_offset_map* map)
 {
   uint64_t section_offset = 0;
-  Dwarf_pubnames_table* table;
-  Pubname_offset_map* map;
+  Dwarf_pubnames_table* table
+    = new Dwarf_pubnames_table(dwinfo, attr == elfcpp::DW_AT_GNU_pubtypes);
 
-  if (attr == elfcpp::DW_AT_GNU_pubnames)
-    {
-      table = new Dwarf_pubnames_table(dwinfo, false);
-      map = &this->cu_pubname_map_;
-    }
-  else
+  if (!table->read_section(this->object_, this->symbols_,
+			   this->symbols_size_))
     {
-      table = new Dwarf_pubnames_table(dwinfo, true);
-      map = &this->cu_pubtype_map_;
+      delete table;
+      return NULL;
     }
 
-  map->clear();
-  if (!table->read_section(object, symbols, symbols_size))
-    return NULL;
-
   while (table->read_header(section_offset))
     {
       map->insert(std::make_pair(table->cu_offset(), section_offset));
@@ -1054,33 +1483,89 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
   return table;
 }
 
-// Wrapper for map_pubtable_to_dies
+// Scan the recorded .debug_info and .debug_types sections.  This is
+// called with the object locked.
 
 void
-Gdb_index::map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                          Relobj* object,
-                                          const unsigned char* symbols,
-                                          off_t symbols_size)
+Gdb_index_scan::scan()
 {
-  // This is a new object, so reset the relevant variables.
-  this->pubnames_object_ = object;
-  this->stmt_list_offset_ = -1;
+  if (this->sections_.empty())
+    return;
+
+  // Read the symbol table through a view of the object, which stays
+  // valid while the object is locked.
+  if (this->symtab_shndx_ != 0)
+    this->symbols_ = this->object_->section_contents(this->symtab_shndx_,
+						     &this->symbols_size_,
+						     false);
+
+  // The pubnames tables refer to the reader they were built with,
+  // so keep that reader for the whole scan.  They are only used for
+  // the .gdb_index section.
+  const Section& first = this->sections_.front();
+  Gdb_index_info_reader pubnames_reader(first.is_type_unit, this->object_,
+					this->symbols_, this->symbols_size_,
+					first.shndx, first.reloc_shndx,
+					first.reloc_type, this);
+  if (this->want_gdb_index_)
+    {
+      this->pubnames_table_
+	  = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames,
+				       &pubnames_reader,
+				       &this->cu_pubname_map_);
+      this->pubtypes_table_
+	  = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes,
+				       &pubnames_reader,
+				       &this->cu_pubtype_map_);
+    }
 
-  delete this->pubnames_table_;
-  this->pubnames_table_
-      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames, dwinfo,
-                                   object, symbols, symbols_size);
-  delete this->pubtypes_table_;
-  this->pubtypes_table_
-      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes, dwinfo,
-                                   object, symbols, symbols_size);
+  for (std::vector<Section>::const_iterator p = this->sections_.begin();
+       p != this->sections_.end();
+       ++p)
+    {
+      Gdb_index_info_reader dwinfo(p->is_type_unit, this->object_,
+				   this->symbols_, this->symbols_size_,
+				   p->shndx, p->reloc_shndx, p->reloc_type,
+				   this);
+      dwinfo.parse();
+    }
+
+  this->symbols_ = NULL;
+  this->symbols_size_ = 0;
+}
+
+// Add a symbol.  The name is hashed here, so that the hashing is
+// done by the scan tasks.
+
+void
+Gdb_index_scan::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
+{
+  unsigned int hash = mapped_index_string_hash(
+      reinterpret_cast<const unsigned char*>(sym_name));
+  this->symbols_found_.push_back(Symbol(this->names_.size(), hash, cu_index,
+					flags));
+  this->names_.append(sym_name, strlen(sym_name) + 1);
+}
+
+// Add a name for the .debug_names section.  As for symbols, the name
+// is hashed here.
+
+void
+Gdb_index_scan::add_name(int cu_index, const char* name, unsigned int tag,
+			 off_t die_offset)
+{
+  unsigned int hash = debug_names_hash(
+      reinterpret_cast<const unsigned char*>(name));
+  this->names_found_.push_back(Name_entry(this->names_.size(), hash,
+					  cu_index, tag, die_offset));
+  this->names_.append(name, strlen(name) + 1);
 }
 
 // Given a cu_offset, find the associated section of the pubnames
 // table.
 
 off_t
-Gdb_index::find_pubname_offset(off_t cu_offset)
+Gdb_index_scan::find_pubname_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubname_map_.find(cu_offset);
   if (it != this->cu_pubname_map_.end())
@@ -1088,11 +1573,11 @@ Gdb_index::find_pubname_offset(off_t cu_offset)
   return -1;
 }
 
-// Given a cu_offset, find the associated section of the pubnames
+// Given a cu_offset, find the associated section of the pubtypes
 // table.
 
 off_t
-Gdb_index::find_pubtype_offset(off_t cu_offset)
+Gdb_index_scan::find_pubtype_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubtype_map_.find(cu_offset);
   if (it != this->cu_pubtype_map_.end())
@@ -1100,36 +1585,185 @@ Gdb_index::find_pubtype_offset(off_t cu_offset)
   return -1;
 }
 
-// Scan a .debug_info or .debug_types input section.
+// Convert CU_INDEX, which is local to an object, to an index into the
+// units of the whole index, given the number of compilation units
+// CU_BASE and type units TU_BASE of the objects before it.
+
+static inline int
+rebase_cu_index(int cu_index, int cu_base, int tu_base)
+{
+  if (cu_index < 0)
+    return cu_index - tu_base;
+  return cu_index + cu_base;
+}
+
+// Add the units, address ranges, symbols and names found by the scan
+// to GDB_INDEX and DEBUG_NAMES, in the order in which they were found.
 
 void
-Gdb_index::scan_debug_info(bool is_type_unit,
-			   Relobj* object,
-			   const unsigned char* symbols,
-			   off_t symbols_size,
-			   unsigned int shndx,
-			   unsigned int reloc_shndx,
-			   unsigned int reloc_type)
+Gdb_index_scan::add_to_index(Gdb_index* gdb_index, Debug_names* debug_names)
+{
+  const char* names = this->names_.data();
+
+  if (gdb_index != NULL)
+    {
+      int cu_base = gdb_index->comp_units_.size();
+      int tu_base = gdb_index->type_units_.size();
+
+      gdb_index->comp_units_.insert(gdb_index->comp_units_.end(),
+				    this->comp_units_.begin(),
+				    this->comp_units_.end());
+      gdb_index->type_units_.insert(gdb_index->type_units_.end(),
+				    this->type_units_.begin(),
+				    this->type_units_.end());
+
+      for (std::vector<Gdb_index::Per_cu_range_list>::const_iterator p
+	     = this->ranges_.begin();
+	   p != this->ranges_.end();
+	   ++p)
+	{
+	  int cu_index = rebase_cu_index(p->cu_index, cu_base, tu_base);
+	  gdb_index->ranges_.push_back(
+	      Gdb_index::Per_cu_range_list(p->object, cu_index, p->ranges));
+	}
+
+      for (std::vector<Symbol>::const_iterator p
+	     = this->symbols_found_.begin();
+	   p != this->symbols_found_.end();
+	   ++p)
+	gdb_index->add_symbol(rebase_cu_index(p->cu_index, cu_base, tu_base),
+			      names + p->name_offset, p->hashval, p->cu_flags);
+    }
+
+  if (debug_names != NULL)
+    {
+      int cu_base = debug_names->comp_unit_count();
+      int tu_base = debug_names->type_unit_count();
+
+      for (std::vector<Gdb_index::Comp_unit>::const_iterator p
+	     = this->comp_units_.begin();
+	   p != this->comp_units_.end();
+	   ++p)
+	debug_names->add_comp_unit(p->cu_offset);
+      for (std::vector<Gdb_index::Type_unit>::const_iterator p
+	     = this->type_units_.begin();
+	   p != this->type_units_.end();
+	   ++p)
+	debug_names->add_type_unit(p->tu_offset);
+
+      for (std::vector<Name_entry>::const_iterator p
+	     = this->names_found_.begin();
+	   p != this->names_found_.end();
+	   ++p)
+	debug_names->add_entry(names + p->name_offset, p->hashval,
+			       rebase_cu_index(p->cu_index, cu_base, tu_base),
+			       p->tag, p->die_offset);
+    }
+
+  Gdb_index_scan::dwarf_cu_count += this->cu_count_;
+  Gdb_index_scan::dwarf_cu_nopubnames_count += this->cu_nopubnames_count_;
+  Gdb_index_scan::dwarf_tu_count += this->tu_count_;
+  Gdb_index_scan::dwarf_tu_nopubnames_count += this->tu_nopubnames_count_;
+}
+
+// Print usage statistics.
+void
+Gdb_index_scan::print_stats()
+{
+  fprintf(stderr, _("%s: DWARF CUs: %u\n"),
+          program_name, Gdb_index_scan::dwarf_cu_count);
+  fprintf(stderr, _("%s: DWARF CUs without pubnames/pubtypes: %u\n"),
+          program_name, Gdb_index_scan::dwarf_cu_nopubnames_count);
+  fprintf(stderr, _("%s: DWARF TUs: %u\n"),
+          program_name, Gdb_index_scan::dwarf_tu_count);
+  fprintf(stderr, _("%s: DWARF TUs without pubnames/pubtypes: %u\n"),
+          program_name, Gdb_index_scan::dwarf_tu_nopubnames_count);
+}
+
+// A task to scan the debug info of one object for the .gdb_index
+// section.
+
+class Gdb_index_scan_task : public Task
+{
+ public:
+  Gdb_index_scan_task(Gdb_index_scan* scan, Task_token* blocker)
+    : scan_(scan), blocker_(blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  {
+    this->scan_->scan();
+    this->scan_->object()->release();
+  }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->scan_->object()->is_locked())
+      return this->scan_->object()->token();
+    return NULL;
+  }
+
+  // Lock the object, and unblock BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->scan_->object()->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->blocker_);
+  }
+
+  std::string
+  get_name() const
+  { return "Gdb_index_scan_task " + this->scan_->object()->name(); }
+
+ private:
+  Gdb_index_scan* const scan_;
+  Task_token* const blocker_;
+};
+
+// Class Gdb_index.
+
+// Construct the .gdb_index section.
+
+Gdb_index::Gdb_index(Output_section* gdb_index_section)
+  : Output_section_data(4),
+    gdb_index_section_(gdb_index_section),
+    comp_units_(),
+    type_units_(),
+    ranges_(),
+    cu_vector_list_(),
+    cu_vector_offsets_(NULL),
+    stringpool_(),
+    tu_offset_(0),
+    addr_offset_(0),
+    symtab_offset_(0),
+    cu_pool_offset_(0),
+    stringpool_offset_(0)
 {
-  Gdb_index_info_reader dwinfo(is_type_unit, object,
-			       symbols, symbols_size,
-			       shndx, reloc_shndx,
-			       reloc_type, this);
-  if (object != this->pubnames_object_)
-    map_pubnames_and_types_to_dies(&dwinfo, object, symbols, symbols_size);
-  dwinfo.parse();
+  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+}
+
+Gdb_index::~Gdb_index()
+{
+  // Free the memory used by the symbol table.
+  delete this->gdb_symtab_;
+  // Free the memory used by the CU vectors.
+  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
+    delete this->cu_vector_list_[i];
 }
 
 // Add a symbol.
 
 void
-Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
+Gdb_index::add_symbol(int cu_index, const char* sym_name,
+		      unsigned int hashval, uint8_t flags)
 {
-  unsigned int hash = mapped_index_string_hash(
-      reinterpret_cast<const unsigned char*>(sym_name));
   Gdb_symbol* sym = new Gdb_symbol();
   this->stringpool_.add(sym_name, true, &sym->name_key);
-  sym->hashval = hash;
+  sym->hashval = hashval;
   sym->cu_vector_index = 0;
 
   Gdb_symbol* found = this->gdb_symtab_->add(sym);
@@ -1156,27 +1790,6 @@ Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
     cu_vec->push_back(std::make_pair(cu_index, flags));
 }
 
-// Return TRUE if we have already processed the pubnames associated
-// with the statement list at the given OFFSET.
-
-bool
-Gdb_index::pubnames_read(const Relobj* object, off_t offset)
-{
-  bool ret = (this->pubnames_object_ == object
-	      && this->stmt_list_offset_ == offset);
-  return ret;
-}
-
-// Record that we have processed the pubnames associated with the
-// statement list for OBJECT at the given OFFSET.
-
-void
-Gdb_index::set_pubnames_read(const Relobj* object, off_t offset)
-{
-  this->pubnames_object_ = object;
-  this->stmt_list_offset_ = offset;
-}
-
 // Set the size of the .gdb_index section.
 
 void
@@ -1352,8 +1965,369 @@ Gdb_index::do_write(Output_file* of)
 void
 Gdb_index::print_stats()
 {
-  if (parameters->options().gdb_index())
-    Gdb_index_info_reader::print_stats();
+  if (parameters->options().gdb_index()
+      || parameters->options().debug_names())
+    Gdb_index_scan::print_stats();
+}
+
+// Class Debug_names.
+
+// The .debug_names section is built from the same walk of the DIEs as
+// the .gdb_index section.  The names themselves are added to the
+// .debug_str section by an Output_data_strtab of our own.
+
+Debug_names::Debug_names(Output_section* debug_str_section)
+  : Output_section_data(4),
+    comp_units_(),
+    type_units_(),
+    names_(),
+    name_map_(),
+    stringpool_(),
+    strtab_(NULL),
+    bucket_count_(0),
+    name_order_(),
+    entry_offsets_(),
+    abbrevs_(),
+    entry_pool_()
+{
+  this->strtab_ = new Output_data_strtab(&this->stringpool_);
+  debug_str_section->add_output_section_data(this->strtab_);
+}
+
+// Add an entry for a name.
+
+void
+Debug_names::add_entry(const char* name, unsigned int hashval,
+		       int cu_index, unsigned int tag, off_t die_offset)
+{
+  Stringpool::Key key;
+  this->stringpool_.add(name, true, &key);
+
+  std::pair<Unordered_map<Stringpool::Key, unsigned int>::iterator, bool>
+      ins = this->name_map_.insert(std::make_pair(key,
+						  this->names_.size()));
+  if (ins.second)
+    this->names_.push_back(Name(key, hashval));
+  this->names_[ins.first->second].entries.push_back(
+      Entry(cu_index, tag, die_offset));
+}
+
+// Sort the names by hash bucket, then by hash, then in the order in
+// which they were first seen, which is the order required by the
+// hash lookup table.
+
+struct Debug_names::Name_less
+{
+  Name_less(const std::vector<Name>& names, unsigned int bucket_count)
+    : names_(names), bucket_count_(bucket_count)
+  { }
+
+  bool
+  operator()(unsigned int i1, unsigned int i2) const
+  {
+    unsigned int h1 = this->names_[i1].hashval;
+    unsigned int h2 = this->names_[i2].hashval;
+    if (h1 % this->bucket_count_ != h2 % this->bucket_count_)
+      return h1 % this->bucket_count_ < h2 % this->bucket_count_;
+    if (h1 != h2)
+      return h1 < h2;
+    return i1 < i2;
+  }
+
+  const std::vector<Name>& names_;
+  unsigned int bucket_count_;
+};
+
+// Build the abbreviation table and the entry pool.  There is one
+// abbreviation for each combination of DIE tag and unit kind, in the
+// order in which they are first used.  Each entry records the index
+// of its unit and the offset of its DIE within the unit.
+
+template<bool big_endian>
+void
+Debug_names::build_entry_pool()
+{
+  typedef std::map<std::pair<unsigned int, bool>, unsigned int> Abbrev_map;
+  Abbrev_map abbrev_map;
+
+  this->abbrevs_.clear();
+  this->entry_pool_.clear();
+  this->entry_offsets_.clear();
+  this->entry_offsets_.reserve(this->name_order_.size());
+
+  for (std::vector<unsigned int>::const_iterator p = this->name_order_.begin();
+       p != this->name_order_.end();
+       ++p)
+    {
+      const Name& name(this->names_[*p]);
+      this->entry_offsets_.push_back(this->entry_pool_.size());
+      for (std::vector<Entry>::const_iterator pe = name.entries.begin();
+	   pe != name.entries.end();
+	   ++pe)
+	{
+	  bool is_type_unit = pe->cu_index < 0;
+	  std::pair<Abbrev_map::iterator, bool> ins
+	      = abbrev_map.insert(std::make_pair(std::make_pair(pe->tag,
+								 is_type_unit),
+						 abbrev_map.size() + 1));
+	  unsigned int code = ins.first->second;
+	  if (ins.second)
+	    {
+	      write_unsigned_LEB_128(&this->abbrevs_, code);
+	      write_unsigned_LEB_128(&this->abbrevs_, pe->tag);
+	      write_unsigned_LEB_128(&this->abbrevs_,
+				     (is_type_unit
+				      ? elfcpp::DW_IDX_type_unit
+				      : elfcpp::DW_IDX_compile_unit));
+	      write_unsigned_LEB_128(&this->abbrevs_, elfcpp::DW_FORM_udata);
+	      write_unsigned_LEB_128(&this->abbrevs_,
+				     elfcpp::DW_IDX_die_offset);
+	      write_unsigned_LEB_128(&this->abbrevs_, elfcpp::DW_FORM_ref4);
+	      write_unsigned_LEB_128(&this->abbrevs_, 0);
+	      write_unsigned_LEB_128(&this->abbrevs_, 0);
+	    }
+
+	  write_unsigned_LEB_128(&this->entry_pool_, code);
+	  write_unsigned_LEB_128(&this->entry_pool_,
+				 (is_type_unit
+				  ? -1 - pe->cu_index
+				  : pe->cu_index));
+	  unsigned char buf[4];
+	  elfcpp::Swap_unaligned<32, big_endian>::writeval(buf,
+							   pe->die_offset);
+	  this->entry_pool_.insert(this->entry_pool_.end(), buf, buf + 4);
+	}
+      // The entries of each name end with a zero abbreviation code.
+      this->entry_pool_.push_back(0);
+    }
+
+  // The abbreviation table ends with a zero code.
+  write_unsigned_LEB_128(&this->abbrevs_, 0);
+}
+
+// Set the size of the .debug_names section.
+
+void
+Debug_names::set_final_data_size()
+{
+  // Use the same number of hash buckets as LLVM.
+  unsigned int name_count = this->names_.size();
+  if (name_count > 1024)
+    this->bucket_count_ = name_count / 4;
+  else if (name_count > 16)
+    this->bucket_count_ = name_count / 2;
+  else
+    this->bucket_count_ = std::max(name_count, 1U);
+
+  this->name_order_.clear();
+  this->name_order_.reserve(name_count);
+  for (unsigned int i = 0; i < name_count; ++i)
+    this->name_order_.push_back(i);
+  std::sort(this->name_order_.begin(), this->name_order_.end(),
+	    Name_less(this->names_, this->bucket_count_));
+
+  if (parameters->target().is_big_endian())
+    {
+#if defined(HAVE_TARGET_32_BIG) || defined(HAVE_TARGET_64_BIG)
+      this->build_entry_pool<true>();
+#else
+      gold_unreachable();
+#endif
+    }
+  else
+    {
+#if defined(HAVE_TARGET_32_LITTLE) || defined(HAVE_TARGET_64_LITTLE)
+      this->build_entry_pool<false>();
+#else
+      gold_unreachable();
+#endif
+    }
+
+  // The header is followed by the CU and TU lists, the buckets, the
+  // hashes, string offsets and entry offsets of the names, the
+  // abbreviation table and the entry pool.
+  off_t data_size = 36;
+  data_size += 4 * (this->comp_units_.size() + this->type_units_.size());
+  data_size += 4 * this->bucket_count_;
+  data_size += 3 * 4 * name_count;
+  data_size += this->abbrevs_.size();
+  data_size += this->entry_pool_.size();
+  this->set_data_size(data_size);
+}
+
+// Write the section contents to POV.
+
+template<bool big_endian>
+void
+Debug_names::write_index(unsigned char* pov)
+{
+  unsigned char* const oview = pov;
+  const off_t oview_size = this->data_size();
+  unsigned int name_count = this->name_order_.size();
+
+  // Write the header.
+  elfcpp::Swap<32, big_endian>::writeval(pov, oview_size - 4);
+  elfcpp::Swap<16, big_endian>::writeval(pov + 4, 5);
+  elfcpp::Swap<16, big_endian>::writeval(pov + 6, 0);
+  elfcpp::Swap<32, big_endian>::writeval(pov + 8, this->comp_units_.size());
+  elfcpp::Swap<32, big_endian>::writeval(pov + 12, this->type_units_.size());
+  elfcpp::Swap<32, big_endian>::writeval(pov + 16, 0);
+  elfcpp::Swap<32, big_endian>::writeval(pov + 20, this->bucket_count_);
+  elfcpp::Swap<32, big_endian>::writeval(pov + 24, name_count);
+  elfcpp::Swap<32, big_endian>::writeval(pov + 28, this->abbrevs_.size());
+  elfcpp::Swap<32, big_endian>::writeval(pov + 32, 0);
+  pov += 36;
+
+  // Write the CU and TU lists.
+  for (std::vector<off_t>::const_iterator p = this->comp_units_.begin();
+       p != this->comp_units_.end();
+       ++p, pov += 4)
+    elfcpp::Swap<32, big_endian>::writeval(pov, *p);
+  for (std::vector<off_t>::const_iterator p = this->type_units_.begin();
+       p != this->type_units_.end();
+       ++p, pov += 4)
+    elfcpp::Swap<32, big_endian>::writeval(pov, *p);
+
+  // Write the buckets.  Each holds the index, counting from one, of
+  // the first name in the bucket, or zero if the bucket is empty.
+  unsigned char* buckets = pov;
+  memset(buckets, 0, 4 * this->bucket_count_);
+  for (unsigned int i = name_count; i > 0; --i)
+    {
+      unsigned int hash = this->names_[this->name_order_[i - 1]].hashval;
+      elfcpp::Swap<32, big_endian>::writeval(
+	  buckets + 4 * (hash % this->bucket_count_), i);
+    }
+  pov += 4 * this->bucket_count_;
+
+  // Write the hashes, the string offsets and the entry offsets.
+  // The strings may be in a postprocessing buffer, so don't use the
+  // address of the string table.
+  off_t strtab_offset =
+    this->strtab_->output_section()->output_section_data_offset(
+	this->strtab_);
+  unsigned char* hashes = pov;
+  unsigned char* str_offsets = hashes + 4 * name_count;
+  unsigned char* entry_offsets = str_offsets + 4 * name_count;
+  for (unsigned int i = 0; i < name_count; ++i)
+    {
+      const Name& name(this->names_[this->name_order_[i]]);
+      elfcpp::Swap<32, big_endian>::writeval(hashes + 4 * i, name.hashval);
+      off_t str_offset = (strtab_offset
+			  + this->stringpool_.get_offset_from_key(
+			      name.name_key));
+      elfcpp::Swap<32, big_endian>::writeval(str_offsets + 4 * i,
+					     str_offset);
+      elfcpp::Swap<32, big_endian>::writeval(entry_offsets + 4 * i,
+					     this->entry_offsets_[i]);
+    }
+  pov += 3 * 4 * name_count;
+
+  // Write the abbreviation table and the entry pool.
+  if (!this->abbrevs_.empty())
+    memcpy(pov, &this->abbrevs_[0], this->abbrevs_.size());
+  pov += this->abbrevs_.size();
+  if (!this->entry_pool_.empty())
+    memcpy(pov, &this->entry_pool_[0], this->entry_pool_.size());
+  pov += this->entry_pool_.size();
+
+  gold_assert(pov - oview == oview_size);
+}
+
+// Write the data to the file.
+
+void
+Debug_names::do_write(Output_file* of)
+{
+  const off_t off = this->offset();
+  const off_t oview_size = this->data_size();
+  unsigned char* const oview = of->get_output_view(off, oview_size);
+  this->do_write_to_buffer(oview);
+  of->write_output_view(off, oview_size, oview);
+}
+
+// Write the data to a buffer.
+
+void
+Debug_names::do_write_to_buffer(unsigned char* buffer)
+{
+  if (parameters->target().is_big_endian())
+    {
+#if defined(HAVE_TARGET_32_BIG) || defined(HAVE_TARGET_64_BIG)
+      this->write_index<true>(buffer);
+#else
+      gold_unreachable();
+#endif
+    }
+  else
+    {
+#if defined(HAVE_TARGET_32_LITTLE) || defined(HAVE_TARGET_64_LITTLE)
+      this->write_index<false>(buffer);
+#else
+      gold_unreachable();
+#endif
+    }
+}
+
+// Class Debug_index_scanner.
+
+Debug_index_scanner::~Debug_index_scanner()
+{
+  for (unsigned int i = 0; i < this->scans_.size(); ++i)
+    delete this->scans_[i];
+}
+
+// Record a .debug_info or .debug_types input section to be scanned.
+// The sections of an object are all recorded during its layout.
+
+void
+Debug_index_scanner::scan_debug_info(bool is_type_unit,
+				     Relobj* object,
+				     unsigned int symtab_shndx,
+				     unsigned int shndx,
+				     unsigned int reloc_shndx,
+				     unsigned int reloc_type)
+{
+  if (this->scans_.empty() || this->scans_.back()->object() != object)
+    this->scans_.push_back(new Gdb_index_scan(object, symtab_shndx,
+					      this->gdb_index_ != NULL,
+					      this->debug_names_ != NULL));
+  this->scans_.back()->add_section(is_type_unit, shndx, reloc_shndx,
+				   reloc_type);
+}
+
+// Queue a task for each object to scan its debug info.  This is
+// called by the middle tasks, after all the objects have been laid
+// out.
+
+void
+Debug_index_scanner::queue_scan_tasks(Workqueue* workqueue,
+				      Task_token* blocker)
+{
+  for (std::vector<Gdb_index_scan*>::const_iterator p = this->scans_.begin();
+       p != this->scans_.end();
+       ++p)
+    {
+      workqueue->add_blocker(blocker);
+      workqueue->queue(new Gdb_index_scan_task(*p, blocker));
+    }
+}
+
+// Add the results of the scan tasks to the sections.  The objects are
+// added in layout order, which gives the same units, symbol table
+// and constant pool as scanning them one at a time.
+
+void
+Debug_index_scanner::add_scanned_units()
+{
+  for (std::vector<Gdb_index_scan*>::const_iterator p = this->scans_.begin();
+       p != this->scans_.end();
+       ++p)
+    {
+      (*p)->add_to_index(this->gdb_index_, this->debug_names_);
+      delete *p;
+    }
+  this->scans_.clear();
 }
 
 } // End namespace gold.
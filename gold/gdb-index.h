@@ -1,4 +1,4 @@
-// gdb-index.h -- generate .gdb_index section for fast debug lookup  -*- C++ -*-
+// gdb-index.h -- generate .gdb_index and .debug_names sections  -*- C++ -*-
 
 // Copyright (C) 2012-2024 Free Software Foundation, Inc.
 // Written by Cary Coutant <ccoutant@google.com>.
@@ -42,8 +42,10 @@ class Sized_relobj;
 class Dwarf_range_list;
 template <typename T>
 class Gdb_hashtab;
-class Gdb_index_info_reader;
-class Dwarf_pubnames_table;
+class Gdb_index_scan;
+class Workqueue;
+class Task_token;
+class Output_data_strtab;
 
 // This class manages the .gdb_index section, which is a fast
 // lookup table for DWARF information used by the gdb debugger.
@@ -56,74 +58,6 @@ class Gdb_index : public Output_section_data
 
   ~Gdb_index();
 
-  // Scan a .debug_info or .debug_types input section.
-  void scan_debug_info(bool is_type_unit,
-		       Relobj* object,
-		       const unsigned char* symbols,
-		       off_t symbols_size,
-		       unsigned int shndx,
-		       unsigned int reloc_shndx,
-		       unsigned int reloc_type);
-
-  // Add a compilation unit.
-  int
-  add_comp_unit(off_t cu_offset, off_t cu_length)
-  {
-    this->comp_units_.push_back(Comp_unit(cu_offset, cu_length));
-    return this->comp_units_.size() - 1;
-  }
-
-  // Add a type unit.
-  int
-  add_type_unit(off_t tu_offset, off_t type_offset, uint64_t signature)
-  {
-    this->type_units_.push_back(Type_unit(tu_offset, type_offset, signature));
-    return this->type_units_.size() - 1;
-  }
-
-  // Add an address range.
-  void
-  add_address_range_list(Relobj* object, unsigned int cu_index,
-			 Dwarf_range_list* ranges)
-  {
-    this->ranges_.push_back(Per_cu_range_list(object, cu_index, ranges));
-  }
-
-  // Add a symbol.  FLAGS are the gdb_index version 7 flags to be stored in
-  // the high-byte of the cu_index field.
-  void
-  add_symbol(int cu_index, const char* sym_name, uint8_t flags);
-
-  // Return the offset into the pubnames table for the cu at the given
-  // offset.
-  off_t
-  find_pubname_offset(off_t cu_offset);
-
-  // Return the offset into the pubtypes table for the cu at the
-  // given offset.
-  off_t
-  find_pubtype_offset(off_t cu_offset);
-
-  // Return TRUE if we have already processed the pubnames and types
-  // set for OBJECT of the CUs and TUS associated with the statement
-  // list at OFFSET.
-  bool
-  pubnames_read(const Relobj* object, off_t offset);
-
-  // Record that we have already read the pubnames associated with
-  // OBJECT and OFFSET.
-  void
-  set_pubnames_read(const Relobj* object, off_t offset);
-
-  // Return a pointer to the given table.
-  Dwarf_pubnames_table*
-  pubnames_table()
-  { return pubnames_table_; }
-
-  Dwarf_pubnames_table*
-  pubtypes_table()
-  { return pubtypes_table_; }
-
   // Print usage statistics.
   static void
   print_stats();
@@ -148,22 +82,9 @@ class Gdb_index : public Output_section_data
   do_print_to_mapfile(Mapfile* mapfile) const
   { mapfile->print_output_data(this, _("** gdb_index")); }
 
-  // Create a map from dies to pubnames.
-  Dwarf_pubnames_table*
-  map_pubtable_to_dies(unsigned int attr,
-                       Gdb_index_info_reader* dwinfo,
-                       Relobj* object,
-                       const unsigned char* symbols,
-                       off_t symbols_size);
-
-  // Wrapper for map_pubtable_to_dies
-  void
-  map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                 Relobj* object,
-                                 const unsigned char* symbols,
-                                 off_t symbols_size);
-
  private:
+  friend class Gdb_index_scan;
+
   // An entry in the compilation unit list.
   struct Comp_unit
   {
@@ -216,20 +137,12 @@ class Gdb_index : public Output_section_data
 
   typedef std::vector<std::pair<int, uint8_t> > Cu_vector;
 
-  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
-  Pubname_offset_map cu_pubname_map_;
-  Pubname_offset_map cu_pubtype_map_;
-
-  // Scan the given pubtable and build a map of the various dies it
-  // refers to, so we can process the entries when we encounter the
-  // die.
+  // Add a symbol.  HASHVAL is the hash of SYM_NAME.  FLAGS are the
+  // gdb_index version 7 flags to be stored in the high-byte of the
+  // cu_index field.
   void
-  map_pubtable_to_dies(Dwarf_pubnames_table* table,
-                       Pubname_offset_map* map);
-
-  // Tables to store the pubnames section of the current object.
-  Dwarf_pubnames_table* pubnames_table_;
-  Dwarf_pubnames_table* pubtypes_table_;
+  add_symbol(int cu_index, const char* sym_name, unsigned int hashval,
+	     uint8_t flags);
 
   // The .gdb_index section.
   Output_section* gdb_index_section_;
@@ -253,10 +166,166 @@ class Gdb_index : public Output_section_data
   off_t symtab_offset_;
   off_t cu_pool_offset_;
   off_t stringpool_offset_;
-  // Object, stmt list offset of the CUs and TUs associated with the
-  // last read pubnames and pubtypes sections.
-  const Relobj* pubnames_object_;
-  off_t stmt_list_offset_;
+};
+
+// This class manages the .debug_names section, the DWARF 5 index of
+// names.  The names themselves are added to the .debug_str section.
+
+class Debug_names : public Output_section_data
+{
+ public:
+  Debug_names(Output_section* debug_str_section);
+
+  // Add a compilation unit at CU_OFFSET in .debug_info.
+  void
+  add_comp_unit(off_t cu_offset)
+  { this->comp_units_.push_back(cu_offset); }
+
+  // Add a type unit at TU_OFFSET.
+  void
+  add_type_unit(off_t tu_offset)
+  { this->type_units_.push_back(tu_offset); }
+
+  // Return the number of compilation units.
+  int
+  comp_unit_count() const
+  { return this->comp_units_.size(); }
+
+  // Return the number of type units.
+  int
+  type_unit_count() const
+  { return this->type_units_.size(); }
+
+  // Add an entry for NAME, whose hash is HASHVAL, for the DIE with tag
+  // TAG at DIE_OFFSET in compilation unit CU_INDEX.  As in the
+  // .gdb_index section, a negative CU_INDEX refers to a type unit.
+  void
+  add_entry(const char* name, unsigned int hashval, int cu_index,
+	    unsigned int tag, off_t die_offset);
+
+ protected:
+  // This is called to update the section size prior to assigning
+  // the address and file offset.
+  void
+  update_data_size()
+  { this->set_final_data_size(); }
+
+  // Set the final data size.
+  void
+  set_final_data_size();
+
+  // Write the data to the file.
+  void
+  do_write(Output_file*);
+
+  // Write the data to a buffer, when the section is compressed.
+  void
+  do_write_to_buffer(unsigned char* buffer);
+
+  // Write to a map file.
+  void
+  do_print_to_mapfile(Mapfile* mapfile) const
+  { mapfile->print_output_data(this, _("** debug_names")); }
+
+ private:
+  // An entry in the entry pool.
+  struct Entry
+  {
+    Entry(int index, unsigned int t, off_t off)
+      : cu_index(index), tag(t), die_offset(off)
+    { }
+    int cu_index;
+    unsigned int tag;
+    off_t die_offset;
+  };
+
+  // A name, with its entries.
+  struct Name
+  {
+    Name(Stringpool::Key key, unsigned int hash)
+      : name_key(key), hashval(hash), entries()
+    { }
+    Stringpool::Key name_key;
+    unsigned int hashval;
+    std::vector<Entry> entries;
+  };
+
+  // Sort the names by hash bucket.
+  struct Name_less;
+
+  // Build the abbreviation table and the entry pool.
+  template<bool big_endian>
+  void
+  build_entry_pool();
+
+  // Write the section contents to POV.
+  template<bool big_endian>
+  void
+  write_index(unsigned char* pov);
+
+  // The list of DWARF compilation units and type units.
+  std::vector<off_t> comp_units_;
+  std::vector<off_t> type_units_;
+  // The names, in the order in which they were first seen.
+  std::vector<Name> names_;
+  // Map from a name in STRINGPOOL_ to its index in NAMES_.
+  Unordered_map<Stringpool::Key, unsigned int> name_map_;
+  // The names, added to the .debug_str section by STRTAB_.
+  Stringpool stringpool_;
+  Output_data_strtab* strtab_;
+  // The number of hash buckets.
+  unsigned int bucket_count_;
+  // The indexes in NAMES_ of the names in the order of the index.
+  std::vector<unsigned int> name_order_;
+  // The offset of the entries of each name in the entry pool, in the
+  // order of the index.
+  std::vector<off_t> entry_offsets_;
+  // The abbreviation table and the entry pool.
+  std::vector<unsigned char> abbrevs_;
+  std::vector<unsigned char> entry_pool_;
+};
+
+// This class records the .debug_info and .debug_types input sections
+// of the objects, and scans them for the .gdb_index and .debug_names
+// sections.
+
+class Debug_index_scanner
+{
+ public:
+  Debug_index_scanner(Gdb_index* gdb_index, Debug_names* debug_names)
+    : gdb_index_(gdb_index), debug_names_(debug_names), scans_()
+  { }
+
+  ~Debug_index_scanner();
+
+  // Record a .debug_info or .debug_types input section to be scanned.
+  // The sections are scanned later by queue_scan_tasks.
+  void
+  scan_debug_info(bool is_type_unit,
+		  Relobj* object,
+		  unsigned int symtab_shndx,
+		  unsigned int shndx,
+		  unsigned int reloc_shndx,
+		  unsigned int reloc_type);
+
+  // Queue a task for each object recorded by scan_debug_info to scan
+  // its debug info sections.  Each task unblocks BLOCKER when done.
+  void
+  queue_scan_tasks(Workqueue* workqueue, Task_token* blocker);
+
+  // Add the units and symbols found by the scan tasks to the sections,
+  // in the order in which the objects were laid out.  This must be
+  // called before the sizes of the sections are set.
+  void
+  add_scanned_units();
+
+ private:
+  // The .gdb_index section, or NULL.
+  Gdb_index* gdb_index_;
+  // The .debug_names section, or NULL.
+  Debug_names* debug_names_;
+  // The objects whose debug info is to be scanned, in layout order.
+  std::vector<Gdb_index_scan*> scans_;
 };
 
 } // End namespace gold.
@@ -134,6 +134,39 @@ Middle_runner::run(Workqueue* workqueue, const Task* task)
 		     this->layout_, workqueue, this->mapfile_);
 }
 
+// This class arranges to run the rest of the functions done in the
+// middle of the link once identical code folding has finished.
+
+class Middle_layout_runner : public Task_function_runner
+{
+ public:
+  Middle_layout_runner(const General_options& options,
+		       const Input_objects* input_objects,
+		       Symbol_table* symtab,
+		       Layout* layout, Mapfile* mapfile)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Mapfile* mapfile_;
+};
+
+void
+Middle_layout_runner::run(Workqueue* workqueue, const Task* task)
+{
+  queue_middle_layout_tasks(this->options_, task, this->input_objects_,
+			    this->symtab_, this->layout_, workqueue,
+			    this->mapfile_);
+}
+
 // This class arranges the tasks to process the relocs for garbage collection.
 
 class Gc_runner : public Task_function_runner
@@ -166,6 +199,29 @@ Gc_runner::run(Workqueue* workqueue, const Task* task)
 			this->mapfile_);
 }
 
+// Open BASE_NAME as the base file for an incremental update, and
+// check that it is compatible with this link.  If BASE_NAME is NULL,
+// the output file is updated in place.  Returns NULL if the base file
+// can't be used.
+
+static Incremental_binary*
+open_incremental_base(const char* base_name, const Command_line& cmdline,
+		      Layout* layout)
+{
+  Output_file* of = new Output_file(parameters->options().output_file_name());
+  if (!of->open_base_file(base_name, true))
+    return NULL;
+
+  Incremental_binary* ibase = open_incremental_binary(of);
+  if (ibase != NULL
+      && ibase->check_inputs(cmdline, layout->incremental_inputs()))
+    return ibase;
+
+  delete ibase;
+  of->close();
+  return NULL;
+}
+
 // Queue up the initial set of tasks for this link job.
 
 void
@@ -200,21 +256,24 @@ queue_initial_tasks(const General_options& options,
 
   if (parameters->incremental_update())
     {
-      Output_file* of = new Output_file(options.output_file_name());
-      if (of->open_base_file(options.incremental_base(), true))
+      ibase = open_incremental_base(options.incremental_base(), cmdline,
+				    layout);
+
+      // If the output file was removed or can't be used, fall back to
+      // the copy saved in the --incremental-cache directory by an
+      // earlier link of the same command line in the same directory.
+      if (ibase == NULL && options.incremental_cache() != NULL)
 	{
-	  ibase = open_incremental_binary(of);
-	  if (ibase != NULL
-	      && ibase->check_inputs(cmdline, layout->incremental_inputs()))
-	    ibase->init_layout(layout);
-	  else
-	    {
-	      delete ibase;
-	      ibase = NULL;
-	      of->close();
-	    }
+	  std::string cache_name =
+	      incremental_cache_file_name(layout->incremental_inputs());
+	  ibase = open_incremental_base(cache_name.c_str(), cmdline, layout);
+	  if (ibase != NULL)
+	    gold_info(_("using incremental base file %s"), cache_name.c_str());
 	}
-      if (ibase == NULL)
+
+      if (ibase != NULL)
+	ibase->init_layout(layout);
+      else
 	{
 	  if (set_parameters_incremental_full())
 	    gold_info(_("linking with --incremental-full"));
@@ -525,14 +584,47 @@ queue_middle_tasks(const General_options& options,
       symtab->gc()->do_transitive_closure();
     }
 
+  int thread_count = options.thread_count_middle();
+  if (thread_count == 0)
+    thread_count = std::max(2, input_objects->number_of_input_objects());
+  workqueue->set_thread_count(thread_count);
+
   // If identical code folding (--icf) is chosen it makes sense to do it
   // only after garbage collection (--gc-sections) as we do not want to
-  // be folding sections that will be garbage.
+  // be folding sections that will be garbage.  The sections are hashed
+  // by several tasks, so the rest of the middle tasks are queued once
+  // they have been folded.
   if (parameters->options().icf_enabled())
     {
-      symtab->icf()->find_identical_sections(input_objects, symtab);
+      Task_token* icf_blocker = new Task_token(true);
+      symtab->icf()->queue_find_identical_sections(input_objects, symtab,
+						   workqueue, icf_blocker);
+      workqueue->queue(new Task_function(new Middle_layout_runner(options,
+								  input_objects,
+								  symtab,
+								  layout,
+								  mapfile),
+					 icf_blocker,
+					 "Task_function Middle_layout_runner"));
+      return;
     }
 
+  queue_middle_layout_tasks(options, task, input_objects, symtab, layout,
+			    workqueue, mapfile);
+}
+
+// Queue up the rest of the middle set of tasks.  This is called from
+// queue_middle_tasks, or once identical code folding has finished.
+
+void
+queue_middle_layout_tasks(const General_options& options,
+			  const Task* task,
+			  const Input_objects* input_objects,
+			  Symbol_table* symtab,
+			  Layout* layout,
+			  Workqueue* workqueue,
+			  Mapfile* mapfile)
+{
   // Call Object::layout for the second time to determine the
   // output_sections for all referenced input sections.  When
   // --gc-sections or --icf is turned on, or when certain input
@@ -597,11 +689,6 @@ queue_middle_tasks(const General_options& options,
 	}
     }
 
-  int thread_count = options.thread_count_middle();
-  if (thread_count == 0)
-    thread_count = std::max(2, input_objects->number_of_input_objects());
-  workqueue->set_thread_count(thread_count);
-
   // Now we have seen all the input files.
   const bool doing_static_link =
     (!input_objects->any_dynamic()
@@ -777,6 +864,10 @@ queue_middle_tasks(const General_options& options,
 	}
     }
 
+  // When building a .gdb_index or .debug_names section, scan the
+  // debug info of each object in parallel with the relocs.
+  layout->queue_gdb_index_tasks(workqueue, this_blocker);
+
   // When all those tasks are complete, we can start laying out the
   // output file.
   workqueue->queue(new Task_function(new Layout_task_runner(options,
@@ -876,12 +967,13 @@ queue_final_tasks(const General_options& options,
     }
   else
     {
+      // Large compressed sections are compressed in parallel first.
       Task_token* new_final_blocker = new Task_token(true);
       new_final_blocker->add_blocker();
-      Task* t = new Write_after_input_sections_task(layout, of,
-						    final_blocker,
-						    new_final_blocker);
-      workqueue->queue(t);
+      workqueue->queue(new Task_function(
+	  new Compress_sections_task_runner(layout, of, new_final_blocker),
+	  final_blocker,
+	  "Task_function Compress_sections_task_runner"));
       final_blocker = new_final_blocker;
     }
 
@@ -93,6 +93,19 @@
 // frequent and Algorithm I wins because of its ability to be stopped
 // arbitrarily.
 //
+// Hashing in tasks :
+// ----------------
+//
+// The candidate sections are read by one task per input object, which
+// can run in parallel.  The first set of tasks checksums the raw
+// contents of each section; a section whose raw checksum is unique
+// cannot be folded and is not considered any further.  The second set
+// builds the contents of the others, with their relocs, and checksums
+// them.  The groups are then formed by a single task.  Each iteration
+// after the first only hashes again the sections with a reloc to a
+// section whose kept section has changed since they were last hashed.
+// --stats reports the number of iterations and of folded bytes.
+//
 // Caveat with using function pointers :
 // ------------------------------------
 //
@@ -167,73 +180,135 @@
 #include "demangle.h"
 #include "elfcpp.h"
 #include "int_encoding.h"
+#include "workqueue.h"
 
 #include <limits>
 
 namespace gold
 {
 
-// This function determines if a section or a group of identical
-// sections has unique contents.  Such unique sections or groups can be
-// declared final and need not be processed any further.
-// Parameters :
-// ID_SECTION : Vector mapping a section index to a Section_id pair.
-// IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
-//                            sections is already known to be unique.
-// SECTION_CONTENTS : Contains the section's text and relocs to sections
-//                    that cannot be folded.   SECTION_CONTENTS are NULL
-//                    implies that this function is being called for the
-//                    first time before the first iteration of icf.
-
-static void
-preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
-                               std::vector<bool>* is_secn_or_group_unique,
-                               std::vector<std::string>* section_contents)
+// Compute the CRC32 of S, continuing from CRC.
+
+static inline uint32_t
+string_crc32(const std::string& s, uint32_t crc)
 {
-  Unordered_map<uint32_t, unsigned int> uniq_map;
-  std::pair<Unordered_map<uint32_t, unsigned int>::iterator, bool>
-    uniq_map_insert;
+  return xcrc32(reinterpret_cast<const unsigned char*>(s.data()), s.length(),
+		crc);
+}
 
-  for (unsigned int i = 0; i < id_section.size(); i++)
-    {
-      if ((*is_secn_or_group_unique)[i])
-        continue;
+// An Icf_hash_task reads the candidate sections of one input object.
+// It either checksums their raw contents, or builds the contents that
+// are compared to find identical sections and checksums those.
 
-      uint32_t cksum;
-      Section_id secn = id_section[i];
-      section_size_type plen;
-      if (section_contents == NULL)
-        {
-          // Lock the object so we can read from it.  This is only called
-          // single-threaded from queue_middle_tasks, so it is OK to lock.
-          // Unfortunately we have no way to pass in a Task token.
-          const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-          Task_lock_obj<Object> tl(dummy_task, secn.first);
-          const unsigned char* contents;
-          contents = secn.first->section_contents(secn.second,
-                                                  &plen,
-                                                  false);
-          cksum = xcrc32(contents, plen, 0xffffffff);
-        }
-      else
-        {
-          const unsigned char* contents_array = reinterpret_cast
-            <const unsigned char*>((*section_contents)[i].c_str());
-          cksum = xcrc32(contents_array, (*section_contents)[i].length(),
-                         0xffffffff);
-        }
-      uniq_map_insert = uniq_map.insert(std::make_pair(cksum, i));
-      if (uniq_map_insert.second)
-        {
-          (*is_secn_or_group_unique)[i] = true;
-        }
-      else
-        {
-          (*is_secn_or_group_unique)[i] = false;
-          (*is_secn_or_group_unique)[uniq_map_insert.first->second] = false;
-        }
-    }
-}
+class Icf_hash_task : public Task
+{
+ public:
+  Icf_hash_task(Icf* icf, Symbol_table* symtab, Relobj* object,
+		unsigned int first, unsigned int last, bool raw_contents,
+		Task_token* final_blocker)
+    : icf_(icf), symtab_(symtab), object_(object), first_(first),
+      last_(last), raw_contents_(raw_contents),
+      final_blocker_(final_blocker)
+  { }
+
+  // Only OBJECT_ is locked.  The section headers of the other objects
+  // are read from the symbols data kept for ICF; see
+  // get_section_contents.
+  void
+  run(Workqueue*)
+  {
+    if (this->raw_contents_)
+      this->icf_->checksum_raw_contents(this->object_, this->first_,
+					this->last_);
+    else
+      this->icf_->build_section_contents(this->symtab_, this->object_,
+					 this->first_, this->last_);
+    this->object_->release();
+  }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->object_->is_locked())
+      return this->object_->token();
+    return NULL;
+  }
+
+  // Lock the object, and unblock FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->object_->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->final_blocker_);
+  }
+
+  std::string
+  get_name() const
+  { return "Icf_hash_task " + this->object_->name(); }
+
+ private:
+  Icf* const icf_;
+  Symbol_table* const symtab_;
+  Relobj* const object_;
+  const unsigned int first_;
+  const unsigned int last_;
+  const bool raw_contents_;
+  Task_token* const final_blocker_;
+};
+
+// An Icf_match_task runs once the Icf_hash_tasks queued before it are
+// done.  After the raw contents have been checksummed, it queues the
+// tasks which build the contents of the sections that are not unique.
+// After those, it forms the groups of identical sections.
+
+class Icf_match_task : public Task
+{
+ public:
+  Icf_match_task(Icf* icf, Symbol_table* symtab, bool raw_contents,
+		 Task_token* this_blocker, Task_token* final_blocker)
+    : icf_(icf), symtab_(symtab), raw_contents_(raw_contents),
+      this_blocker_(this_blocker), final_blocker_(final_blocker)
+  { }
+
+  ~Icf_match_task()
+  { delete this->this_blocker_; }
+
+  void
+  run(Workqueue* workqueue)
+  {
+    if (this->raw_contents_)
+      this->icf_->queue_build_contents_tasks(this->symtab_, workqueue,
+					     this->final_blocker_);
+    else
+      this->icf_->find_identical_sections(this->symtab_);
+  }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  // Unblock FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->final_blocker_); }
+
+  std::string
+  get_name() const
+  { return "Icf_match_task"; }
+
+ private:
+  Icf* const icf_;
+  Symbol_table* const symtab_;
+  const bool raw_contents_;
+  Task_token* const this_blocker_;
+  Task_token* const final_blocker_;
+};
 
 // For SHF_MERGE sections that use REL relocations, the addend is stored in
 // the text section at the relocation offset.  Read  the addend value given
@@ -274,38 +349,45 @@ get_rel_addend(const unsigned char* reloc_addend_ptr,
     }
 }
 
-// This returns the buffer containing the section's contents, both
-// text and relocs.  Relocs are differentiated as those pointing to
-// sections that could be folded and those that cannot.  Only relocs
-// pointing to sections that could be folded are recomputed on
-// subsequent invocations of this function.
+// This appends the section's contents, both text and relocs, to two
+// buffers.  Relocs are differentiated as those pointing to sections
+// that could be folded and those that cannot.  Only relocs pointing
+// to sections that could be folded are recomputed on subsequent
+// invocations of this function.  This returns false if the contents
+// of a section in an object other than LOCKED_OBJECT are needed.
 // Parameters  :
 // FIRST_ITERATION    : true if it is the first invocation.
-// FIXED_CACHE        : String that stores the portion of the result that
-//                      does not change from iteration to iteration;
-//                      written if first_iteration is true, read if it's false.
 // SECN               : Section for which contents are desired.
 // SELF_SECN          : Relocations that target this section will be
 //                      considered "relocations to self" so that recursive
 //                      functions can be folded. Should normally be the
 //                      same as `secn` except when processing extra identity
 //                      regions.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
+// LOCKED_OBJECT      : If not NULL, the only object whose section contents
+//                      may be read.
+// TRACKED_SECTIONS   : Vector to which the ids of the ICF sections that
+//                      relocs point to are appended.
 // KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
+// FIXED_CONTENTS     : String to which the portion of the result that
+//                      does not change from iteration to iteration is
+//                      appended if first_iteration is true.
+// TRACKED_RELOC_CONTENTS : String to which the portion of the result
+//                      for the relocs to ICF sections is appended.
 // START_OFFSET       : Only consider the part of the section at and after
 //                      this offset.
 // END_OFFSET         : Only consider the part of the section before this
 //                      offset.
 
-static std::string
+static bool
 get_section_contents(bool first_iteration,
-		     std::string* fixed_cache,
                      const Section_id& secn,
 		     const Section_id& self_secn,
-                     unsigned int* num_tracked_relocs,
+		     const Relobj* locked_object,
+                     std::vector<unsigned int>* tracked_sections,
                      Symbol_table* symtab,
                      const std::vector<unsigned int>& kept_section_id,
+		     std::string* fixed_contents,
+		     std::string* tracked_reloc_contents,
 		     section_offset_type start_offset = 0,
 		     section_offset_type end_offset =
 		       std::numeric_limits<section_offset_type>::max())
@@ -315,10 +397,10 @@ get_section_contents(bool first_iteration,
   if (first_iteration)
     contents = secn.first->section_contents(secn.second, &plen, false);
 
-  // The buffer to hold all the contents including relocs.  A checksum
-  // is then computed on this buffer.
-  std::string buffer;
-  std::string icf_reloc_buffer;
+  // The buffers to hold all the contents including relocs.  A checksum
+  // is then computed on their concatenation.
+  std::string& buffer(*fixed_contents);
+  std::string& icf_reloc_buffer(*tracked_reloc_contents);
 
   Icf::Reloc_info_list& reloc_info_list = 
     symtab->icf()->reloc_info_list();
@@ -326,9 +408,6 @@ get_section_contents(bool first_iteration,
   Icf::Reloc_info_list::iterator it_reloc_info_list =
     reloc_info_list.find(secn);
 
-  buffer.clear();
-  icf_reloc_buffer.clear();
-
   // Process relocs and put them into the buffer.
 
   if (it_reloc_info_list != reloc_info_list.end())
@@ -367,6 +446,16 @@ get_section_contents(bool first_iteration,
 	      gsym = NULL;
 	    }
 
+	  // A hash task locks only LOCKED_OBJECT, but reads the section
+	  // flags and entry sizes of the sections the relocations point
+	  // to in other objects.  These come from the symbols data that
+	  // do_layout keeps between its two passes when ICF is on, and
+	  // need no file access.
+	  gold_assert(locked_object == NULL
+		      || it_v->first == NULL
+		      || it_v->first == locked_object
+		      || it_v->first->get_symbols_data() != NULL);
+
 	  if (first_iteration
 	      && it_v->first != NULL)
 	    {
@@ -443,11 +532,11 @@ get_section_contents(bool first_iteration,
               && section_id_map_it != section_id_map.end())
             {
               // This is a reloc to a section that might be folded.
-              if (num_tracked_relocs)
-                (*num_tracked_relocs)++;
+              unsigned int secn_id = section_id_map_it->second;
+              if (tracked_sections != NULL)
+                tracked_sections->push_back(secn_id);
 
               char kept_section_str[10];
-              unsigned int secn_id = section_id_map_it->second;
               snprintf(kept_section_str, sizeof(kept_section_str), "%u",
                        kept_section_id[secn_id]);
               if (first_iteration)
@@ -473,6 +562,11 @@ get_section_contents(bool first_iteration,
               if ((secn_flags & elfcpp::SHF_MERGE) != 0
 		  && parameters->target().can_icf_inline_merge_sections())
                 {
+                  // A hash task may only read the contents of the
+                  // object it has locked.
+                  if (locked_object != NULL && it_v->first != locked_object)
+                    return false;
+
                   uint64_t entsize =
                     (it_v->first)->section_entsize(it_v->second);
 		  long long offset = it_a->first;
@@ -616,42 +710,59 @@ get_section_contents(bool first_iteration,
   for (Icf::Extra_identity_list::const_iterator it_ext = extra_range.first;
        it_ext != extra_range.second; ++it_ext)
     {
-      std::string external_fixed;
-      std::string external_all =
-	get_section_contents(first_iteration, &external_fixed,
-			     it_ext->second.section, self_secn,
-			     num_tracked_relocs, symtab,
-			     kept_section_id, it_ext->second.offset,
-			     it_ext->second.offset + it_ext->second.length);
-      buffer.append(external_fixed);
-      icf_reloc_buffer.append(external_all, external_fixed.length(),
-			      std::string::npos);
+      if (!get_section_contents(first_iteration, it_ext->second.section,
+				self_secn, locked_object, tracked_sections,
+				symtab, kept_section_id, fixed_contents,
+				tracked_reloc_contents, it_ext->second.offset,
+				it_ext->second.offset + it_ext->second.length))
+	return false;
     }
 
-  if (first_iteration)
-    {
-      // Store the section contents that don't change to avoid recomputing
-      // during the next call to this function.
-      *fixed_cache = buffer;
-    }
-  else
-    {
-      gold_assert(buffer.empty());
+  return true;
+}
 
-      // Reuse the contents computed in the previous iteration.
-      buffer.append(*fixed_cache);
-    }
+// Returns true if the kept section of any of the sections that
+// section I has relocs to has changed since I was last hashed.
 
-  buffer.append(icf_reloc_buffer);
-  return buffer;
+bool
+Icf::needs_rehash(unsigned int i) const
+{
+  const std::vector<unsigned int>& tracked = this->tracked_sections_[i];
+  for (std::vector<unsigned int>::const_iterator p = tracked.begin();
+       p != tracked.end();
+       ++p)
+    if (this->changed_at_[*p] > this->hashed_at_[i])
+      return true;
+  return false;
+}
+
+// Recompute the part of the contents of section I that depends on the
+// kept sections, and the checksum of the whole.
+
+void
+Icf::rehash_section(Symbol_table* symtab, unsigned int i)
+{
+  const Section_id& secn = this->id_section_[i];
+  std::string* tracked_reloc_contents = &this->tracked_reloc_contents_[i];
+  tracked_reloc_contents->clear();
+  get_section_contents(false, secn, secn, NULL, NULL, symtab,
+		       this->kept_section_id_, &this->section_contents_[i],
+		       tracked_reloc_contents);
+  this->section_checksums_[i] = string_crc32(*tracked_reloc_contents,
+					     this->fixed_checksums_[i]);
+  this->hashed_at_[i] = this->clock_;
+  ++this->num_rehashed_;
 }
 
-// This function computes a checksum on each section to detect and form
-// groups of identical sections.  The first iteration does this for all 
-// sections.
-// Further iterations do this only for the kept sections from each group to
-// determine if larger groups of identical sections could be formed.  The
-// first section in each group is the kept section for that group.
+// This function uses the checksum of each section to detect and form
+// groups of identical sections.  The first iteration does this for
+// all sections, using the checksums computed by the hash tasks.
+// Further iterations do this only for the kept sections from each
+// group whose relocs point to sections whose kept section has changed
+// since they were last hashed, to determine if larger groups of
+// identical sections could be formed.  Folding a section marks the
+// sections with relocs to it to be hashed again, later in the same
+// iteration if they come after it.
 //
 // CRC32 is the checksumming algorithm and can have collisions.  That is,
 // two sections with different contents can have the same checksum. Hence,
@@ -661,156 +772,107 @@ get_section_contents(bool first_iteration,
 //
 // Parameters  :
 // ITERATION_NUM           : Invocation instance of this function.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
-// KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
-// ID_SECTION         : Vector mapping a section to an unique integer.
-// IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
-//                            sections is already known to be unique.
-// SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
-//                      sections.
 
-static bool
-match_sections(unsigned int iteration_num,
-               Symbol_table* symtab,
-               std::vector<unsigned int>* num_tracked_relocs,
-               std::vector<unsigned int>* kept_section_id,
-               const std::vector<Section_id>& id_section,
-	       const std::vector<uint64_t>& section_addraligns,
-               std::vector<bool>* is_secn_or_group_unique,
-               std::vector<std::string>* section_contents)
+bool
+Icf::match_sections(Symbol_table* symtab, unsigned int iteration_num)
 {
-  Unordered_multimap<uint32_t, unsigned int> section_cksum;
-  std::pair<Unordered_multimap<uint32_t, unsigned int>::iterator,
-            Unordered_multimap<uint32_t, unsigned int>::iterator> key_range;
   bool converged = true;
+  unsigned int num_sections = this->id_section_.size();
 
-  if (iteration_num == 1)
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   NULL);
-  else
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   section_contents);
-
-  std::vector<std::string> full_section_contents;
-
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < num_sections; i++)
     {
-      full_section_contents.push_back("");
-      if ((*is_secn_or_group_unique)[i])
+      if (this->is_secn_or_group_unique_[i])
         continue;
 
-      Section_id secn = id_section[i];
-
-      // Lock the object so we can read from it.  This is only called
-      // single-threaded from queue_middle_tasks, so it is OK to lock.
-      // Unfortunately we have no way to pass in a Task token.
-      const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-      Task_lock_obj<Object> tl(dummy_task, secn.first);
+      if (this->kept_section_id_[i] != i)
+        {
+          // This section is already folded into something.
+          continue;
+        }
 
-      std::string this_secn_contents;
-      uint32_t cksum;
-      std::string* this_secn_cache = &((*section_contents)[i]);
+      uint32_t cksum = this->section_checksums_[i];
       if (iteration_num == 1)
         {
-          unsigned int num_relocs = 0;
-          this_secn_contents = get_section_contents(true, this_secn_cache,
-						    secn, secn, &num_relocs,
-						    symtab, (*kept_section_id));
-          (*num_tracked_relocs)[i] = num_relocs;
+          if (this->needs_rehash(i))
+            this->rehash_section(symtab, i);
         }
       else
         {
-          if ((*kept_section_id)[i] != i)
+          if (!this->needs_rehash(i))
+            continue;
+
+          // Remove this section from its old group before hashing it
+          // again.
+          std::pair<Section_cksum_map::iterator,
+                    Section_cksum_map::iterator> old_range =
+            this->section_cksum_.equal_range(cksum);
+          for (Section_cksum_map::iterator it = old_range.first;
+               it != old_range.second;
+               ++it)
             {
-              // This section is already folded into something.
-              continue;
+              if (it->second == i)
+                {
+                  this->section_cksum_.erase(it);
+                  break;
+                }
             }
-          this_secn_contents = get_section_contents(false, this_secn_cache,
-						    secn, secn, NULL,
-						    symtab, (*kept_section_id));
+          this->rehash_section(symtab, i);
         }
-
-      const unsigned char* this_secn_contents_array =
-            reinterpret_cast<const unsigned char*>(this_secn_contents.c_str());
-      cksum = xcrc32(this_secn_contents_array, this_secn_contents.length(),
-                     0xffffffff);
-      size_t count = section_cksum.count(cksum);
-
-      if (count == 0)
+      cksum = this->section_checksums_[i];
+
+      std::pair<Section_cksum_map::iterator,
+                Section_cksum_map::iterator> key_range =
+        this->section_cksum_.equal_range(cksum);
+      Section_cksum_map::iterator it;
+      // Search all the groups with this cksum for a match.
+      for (it = key_range.first; it != key_range.second; ++it)
         {
-          // Start a group with this cksum.
-          section_cksum.insert(std::make_pair(cksum, i));
-          full_section_contents[i] = this_secn_contents;
-        }
-      else
-        {
-          key_range = section_cksum.equal_range(cksum);
-          Unordered_multimap<uint32_t, unsigned int>::iterator it;
-          // Search all the groups with this cksum for a match.
-          for (it = key_range.first; it != key_range.second; ++it)
-            {
-              unsigned int kept_section = it->second;
-              if (full_section_contents[kept_section].length()
-                  != this_secn_contents.length())
-                  continue;
-              if (memcmp(full_section_contents[kept_section].c_str(),
-                         this_secn_contents.c_str(),
-                         this_secn_contents.length()) != 0)
-                  continue;
-
-	      // Check section alignment here.
-	      // The section with the larger alignment requirement
-	      // should be kept.  We assume alignment can only be 
-	      // zero or positive integral powers of two.
-	      uint64_t align_i = section_addraligns[i];
-	      uint64_t align_kept = section_addraligns[kept_section];
-	      if (align_i <= align_kept)
-		{
-		  (*kept_section_id)[i] = kept_section;
-		}
-	      else
-		{
-		  (*kept_section_id)[kept_section] = i;
-		  it->second = i;
-		  full_section_contents[kept_section].swap(
-		      full_section_contents[i]);
-		}
+          unsigned int kept_section = it->second;
+          if (!this->same_contents(i, kept_section))
+            continue;
 
-              converged = false;
-              break;
-            }
-          if (it == key_range.second)
+          // Check section alignment here.
+          // The section with the larger alignment requirement
+          // should be kept, or the first one if they are the same.
+          // We assume alignment can only be zero or positive
+          // integral powers of two.
+          uint64_t align_i = this->section_addraligns_[i];
+          uint64_t align_kept = this->section_addraligns_[kept_section];
+          if (align_i < align_kept
+              || (align_i == align_kept && kept_section < i))
+            this->set_kept_section(i, kept_section);
+          else
             {
-              // Create a new group for this cksum.
-              section_cksum.insert(std::make_pair(cksum, i));
-              full_section_contents[i] = this_secn_contents;
+              this->set_kept_section(kept_section, i);
+              it->second = i;
             }
+
+          converged = false;
+          break;
+        }
+      if (it == key_range.second)
+        {
+          // Create a new group for this cksum.
+          this->section_cksum_.insert(std::make_pair(cksum, i));
         }
-      // If there are no relocs to foldable sections do not process
-      // this section any further.
-      if (iteration_num == 1 && (*num_tracked_relocs)[i] == 0)
-        (*is_secn_or_group_unique)[i] = true;
     }
 
   // If a section was folded into another section that was later folded
   // again then the former has to be updated.
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < num_sections; i++)
     {
       // Find the end of the folding chain
       unsigned int kept = i;
-      while ((*kept_section_id)[kept] != kept)
+      while (this->kept_section_id_[kept] != kept)
         {
-          kept = (*kept_section_id)[kept];
+          kept = this->kept_section_id_[kept];
         }
       // Update every element of the chain
       unsigned int current = i;
-      while ((*kept_section_id)[current] != kept)
+      while (this->kept_section_id_[current] != kept)
         {
-          unsigned int next = (*kept_section_id)[current];
-          (*kept_section_id)[current] = kept;
+          unsigned int next = this->kept_section_id_[current];
+          this->set_kept_section(current, kept);
           current = next;
         }
     }
@@ -943,19 +1005,17 @@ Icf::add_ehframe_links(Relobj* object, unsigned int ehframe_shndx,
   return true;
 }
 
-// This is the main ICF function called in gold.cc.  This does the
-// initialization and calls match_sections repeatedly (thrice by default)
-// which computes the crc checksums and detects identical functions.
+// This is the main ICF function called in gold.cc.  This decides
+// which sections are candidates for folding and queues the tasks which
+// compute their checksums and detect identical functions.
 
 void
-Icf::find_identical_sections(const Input_objects* input_objects,
-                             Symbol_table* symtab)
+Icf::queue_find_identical_sections(const Input_objects* input_objects,
+				   Symbol_table* symtab,
+				   Workqueue* workqueue,
+				   Task_token* final_blocker)
 {
   unsigned int section_num = 0;
-  std::vector<unsigned int> num_tracked_relocs;
-  std::vector<uint64_t> section_addraligns;
-  std::vector<bool> is_secn_or_group_unique;
-  std::vector<std::string> section_contents;
   const Target& target = parameters->target();
 
   // Decide which sections are possible candidates first.
@@ -1001,10 +1061,8 @@ Icf::find_identical_sections(const Input_objects* input_objects,
           this->id_section_.push_back(Section_id(*p, i));
           this->section_id_[Section_id(*p, i)] = section_num;
           this->kept_section_id_.push_back(section_num);
-          num_tracked_relocs.push_back(0);
-	  section_addraligns.push_back((*p)->section_addralign(i));
-          is_secn_or_group_unique.push_back(false);
-          section_contents.push_back("");
+	  this->section_sizes_.push_back((*p)->section_size(i));
+	  this->section_addraligns_.push_back((*p)->section_addralign(i));
           section_num++;
         }
 
@@ -1034,7 +1092,184 @@ Icf::find_identical_sections(const Input_objects* input_objects,
 	}
     }
 
-  unsigned int num_iterations = 0;
+  this->is_secn_or_group_unique_.resize(section_num, false);
+  this->section_checksums_.resize(section_num, 0);
+  this->fixed_checksums_.resize(section_num, 0);
+  this->section_contents_.resize(section_num);
+  this->tracked_reloc_contents_.resize(section_num);
+  this->tracked_sections_.resize(section_num);
+  this->changed_at_.resize(section_num, 0);
+  this->hashed_at_.resize(section_num, 0);
+
+  // Checksum the raw contents of the candidates, and then continue
+  // with the sections that are not unique.
+  Task_token* hash_blocker = new Task_token(true);
+  this->queue_hash_tasks(symtab, workqueue, true, hash_blocker);
+  final_blocker->add_blocker();
+  workqueue->queue(new Icf_match_task(this, symtab, true, hash_blocker,
+				      final_blocker));
+}
+
+// Queue an Icf_hash_task for each input object that has candidate
+// sections which are not yet known to be unique.  The candidate
+// sections of an object are consecutive.  BLOCKER is unblocked when
+// they are all done.
+
+void
+Icf::queue_hash_tasks(Symbol_table* symtab, Workqueue* workqueue,
+		      bool raw_contents, Task_token* blocker)
+{
+  std::vector<std::pair<unsigned int, unsigned int> > ranges;
+  unsigned int num_sections = this->id_section_.size();
+  unsigned int first = 0;
+  while (first < num_sections)
+    {
+      Relobj* object = this->id_section_[first].first;
+      bool any_left = false;
+      unsigned int last = first;
+      while (last < num_sections && this->id_section_[last].first == object)
+	{
+	  if (!this->is_secn_or_group_unique_[last])
+	    any_left = true;
+	  ++last;
+	}
+      if (any_left)
+	ranges.push_back(std::make_pair(first, last));
+      first = last;
+    }
+
+  blocker->add_blockers(ranges.size());
+  for (std::vector<std::pair<unsigned int, unsigned int> >::const_iterator p =
+	 ranges.begin();
+       p != ranges.end();
+       ++p)
+    {
+      Relobj* object = this->id_section_[p->first].first;
+      workqueue->queue(new Icf_hash_task(this, symtab, object, p->first,
+					 p->second, raw_contents, blocker));
+    }
+}
+
+// Compute the checksums of the raw contents of sections FIRST to
+// LAST - 1.  The sections are only compared with their relocs if
+// some other section has the same checksum.
+
+void
+Icf::checksum_raw_contents(Relobj* object, unsigned int first,
+			   unsigned int last)
+{
+  for (unsigned int i = first; i < last; ++i)
+    {
+      section_size_type plen;
+      const unsigned char* contents =
+	object->section_contents(this->id_section_[i].second, &plen, false);
+      this->section_checksums_[i] = xcrc32(contents, plen, 0xffffffff);
+    }
+}
+
+// Mark the sections whose raw contents are unique, which can never be
+// folded, and queue the tasks which build the contents of the others.
+// This runs in an Icf_match_task which holds FINAL_BLOCKER.
+
+void
+Icf::queue_build_contents_tasks(Symbol_table* symtab, Workqueue* workqueue,
+				Task_token* final_blocker)
+{
+  Unordered_map<uint32_t, unsigned int> uniq_map;
+  std::pair<Unordered_map<uint32_t, unsigned int>::iterator, bool>
+    uniq_map_insert;
+
+  for (unsigned int i = 0; i < this->id_section_.size(); i++)
+    {
+      uniq_map_insert =
+	uniq_map.insert(std::make_pair(this->section_checksums_[i], i));
+      if (uniq_map_insert.second)
+	this->is_secn_or_group_unique_[i] = true;
+      else
+	{
+	  this->is_secn_or_group_unique_[i] = false;
+	  this->is_secn_or_group_unique_[uniq_map_insert.first->second] = false;
+	}
+    }
+
+  for (unsigned int i = 0; i < this->id_section_.size(); i++)
+    if (!this->is_secn_or_group_unique_[i])
+      ++this->num_hashed_;
+
+  Task_token* hash_blocker = new Task_token(true);
+  this->queue_hash_tasks(symtab, workqueue, false, hash_blocker);
+  workqueue->add_blocker(final_blocker);
+  workqueue->queue(new Icf_match_task(this, symtab, false, hash_blocker,
+				      final_blocker));
+}
+
+// Build the contents of sections FIRST to LAST - 1 that are not
+// unique, using the sections they are not yet folded into, and
+// compute their checksums.  A section whose contents depend on the
+// contents of another object is left empty, to be built by
+// find_identical_sections.
+
+void
+Icf::build_section_contents(Symbol_table* symtab, Relobj* object,
+			    unsigned int first, unsigned int last)
+{
+  for (unsigned int i = first; i < last; ++i)
+    {
+      if (this->is_secn_or_group_unique_[i])
+	continue;
+
+      const Section_id& secn = this->id_section_[i];
+      if (!get_section_contents(true, secn, secn, object,
+				&this->tracked_sections_[i], symtab,
+				this->kept_section_id_,
+				&this->section_contents_[i],
+				&this->tracked_reloc_contents_[i]))
+	{
+	  this->section_contents_[i].clear();
+	  this->tracked_reloc_contents_[i].clear();
+	  this->tracked_sections_[i].clear();
+	  continue;
+	}
+
+      this->fixed_checksums_[i] = string_crc32(this->section_contents_[i],
+					       0xffffffff);
+      this->section_checksums_[i] =
+	string_crc32(this->tracked_reloc_contents_[i],
+		     this->fixed_checksums_[i]);
+    }
+}
+
+// This forms the groups of identical sections once the hash tasks are
+// done.  It calls match_sections repeatedly (thrice by default).
+
+void
+Icf::find_identical_sections(Symbol_table* symtab)
+{
+  // Build the contents of the sections that the hash tasks left.
+  for (unsigned int i = 0; i < this->id_section_.size(); i++)
+    {
+      if (this->is_secn_or_group_unique_[i]
+	  || !this->section_contents_[i].empty())
+	continue;
+
+      Section_id secn = this->id_section_[i];
+
+      // Lock the object so we can read from it.  This is only called
+      // single-threaded from an Icf_match_task, so it is OK to lock.
+      const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+      Task_lock_obj<Object> tl(dummy_task, secn.first);
+
+      get_section_contents(true, secn, secn, NULL,
+			   &this->tracked_sections_[i], symtab,
+			   this->kept_section_id_,
+			   &this->section_contents_[i],
+			   &this->tracked_reloc_contents_[i]);
+      this->fixed_checksums_[i] = string_crc32(this->section_contents_[i],
+					       0xffffffff);
+      this->section_checksums_[i] =
+	string_crc32(this->tracked_reloc_contents_[i],
+		     this->fixed_checksums_[i]);
+    }
 
   // Default number of iterations to run ICF is 3.
   unsigned int max_iterations = (parameters->options().icf_iterations() > 0)
@@ -1043,25 +1278,28 @@ Icf::find_identical_sections(const Input_objects* input_objects,
 
   bool converged = false;
 
-  while (!converged && (num_iterations < max_iterations))
+  while (!converged && (this->num_iterations_ < max_iterations))
     {
-      num_iterations++;
-      converged = match_sections(num_iterations, symtab,
-                                 &num_tracked_relocs, &this->kept_section_id_,
-                                 this->id_section_, section_addraligns,
-                                 &is_secn_or_group_unique, &section_contents);
+      this->num_iterations_++;
+      converged = this->match_sections(symtab, this->num_iterations_);
     }
 
   if (parameters->options().print_icf_sections())
     {
       if (converged)
         gold_info(_("%s: ICF Converged after %u iteration(s)"),
-                  program_name, num_iterations);
+                  program_name, this->num_iterations_);
       else
         gold_info(_("%s: ICF stopped after %u iteration(s)"),
-                  program_name, num_iterations);
+                  program_name, this->num_iterations_);
     }
 
+  // The contents are no longer needed.
+  this->section_cksum_.clear();
+  std::vector<std::string>().swap(this->section_contents_);
+  std::vector<std::string>().swap(this->tracked_reloc_contents_);
+  std::vector<std::vector<unsigned int> >().swap(this->tracked_sections_);
+
   // Unfold --keep-unique symbols.
   for (options::String_set::const_iterator p =
 	 parameters->options().keep_unique_begin();
@@ -1091,6 +1329,33 @@ Icf::find_identical_sections(const Input_objects* input_objects,
   this->icf_ready();
 }
 
+// Print statistics about identical code folding to stderr.
+
+void
+Icf::print_stats() const
+{
+  unsigned int num_folded = 0;
+  uint64_t folded_bytes = 0;
+  for (unsigned int i = 0; i < this->kept_section_id_.size(); i++)
+    {
+      if (this->kept_section_id_[i] != i)
+	{
+	  ++num_folded;
+	  folded_bytes += this->section_sizes_[i];
+	}
+    }
+
+  fprintf(stderr, _("%s: ICF candidate sections: %zu; hashed: %u; "
+		    "rehashed: %u\n"),
+	  program_name, this->id_section_.size(), this->num_hashed_,
+	  this->num_rehashed_);
+  fprintf(stderr, _("%s: ICF iterations: %u\n"),
+	  program_name, this->num_iterations_);
+  fprintf(stderr, _("%s: ICF folded sections: %u; folded bytes: %llu\n"),
+	  program_name, num_folded,
+	  static_cast<unsigned long long>(folded_bytes));
+}
+
 // Unfolds the section denoted by OBJ and SHNDX if folded.
 
 void
@@ -35,6 +35,8 @@ namespace gold
 class Object;
 class Input_objects;
 class Symbol_table;
+class Workqueue;
+class Task_token;
 
 class Icf
 {
@@ -81,7 +83,11 @@ class Icf
   : id_section_(), section_id_(), kept_section_id_(),
     fptr_section_id_(),
     icf_ready_(false),
-    reloc_info_list_()
+    reloc_info_list_(), section_sizes_(), section_addraligns_(),
+    is_secn_or_group_unique_(), section_checksums_(), fixed_checksums_(),
+    section_contents_(), tracked_reloc_contents_(), tracked_sections_(),
+    changed_at_(), hashed_at_(), section_cksum_(), clock_(0),
+    num_iterations_(0), num_hashed_(0), num_rehashed_(0)
   { }
 
   // Returns the kept folded identical section corresponding to
@@ -89,11 +95,41 @@ class Icf
   Section_id
   get_folded_section(Relobj* dup_obj, unsigned int dup_shndx);
 
-  // Forms groups of identical sections where the first member
-  // of each group is the kept section during folding.
+  // Queue the tasks which form groups of identical sections, where
+  // the first member of each group is the kept section during
+  // folding.  FINAL_BLOCKER is unblocked when the groups are formed.
   void
-  find_identical_sections(const Input_objects* input_objects,
-                          Symbol_table* symtab);
+  queue_find_identical_sections(const Input_objects* input_objects,
+				Symbol_table* symtab, Workqueue* workqueue,
+				Task_token* final_blocker);
+
+  // Compute the checksums of the raw contents of the candidate
+  // sections FIRST to LAST - 1, which are all in OBJECT.  This is
+  // called by an Icf_hash_task.
+  void
+  checksum_raw_contents(Relobj* object, unsigned int first,
+			unsigned int last);
+
+  // Build the contents of the candidate sections FIRST to LAST - 1,
+  // which are all in OBJECT, and compute their checksums.  This is
+  // called by an Icf_hash_task.
+  void
+  build_section_contents(Symbol_table* symtab, Relobj* object,
+			 unsigned int first, unsigned int last);
+
+  // Mark the sections with unique raw contents, and queue the tasks
+  // which build the contents of the others.
+  void
+  queue_build_contents_tasks(Symbol_table* symtab, Workqueue* workqueue,
+			     Task_token* final_blocker);
+
+  // Form the groups of identical sections from the section contents.
+  void
+  find_identical_sections(Symbol_table* symtab);
+
+  // Print statistics to stderr.
+  void
+  print_stats() const;
 
   // This is set when ICF has been run and the groups of
   // identical sections have been formed.
@@ -167,6 +203,43 @@ class Icf
   add_ehframe_links(Relobj* object, unsigned int ehframe_shndx,
 		    Reloc_info& ehframe_relocs);
 
+  // Queue an Icf_hash_task for each input object with candidate
+  // sections still to be processed.
+  void
+  queue_hash_tasks(Symbol_table* symtab, Workqueue* workqueue,
+		   bool raw_contents, Task_token* blocker);
+
+  // Returns true if the kept section of a section tracked by
+  // section I has changed since I was last hashed.
+  bool
+  needs_rehash(unsigned int i) const;
+
+  // Hash section I again using the current kept sections.
+  void
+  rehash_section(Symbol_table* symtab, unsigned int i);
+
+  // Returns true if sections I and J have the same contents.
+  bool
+  same_contents(unsigned int i, unsigned int j) const
+  {
+    return (this->section_contents_[i] == this->section_contents_[j]
+	    && (this->tracked_reloc_contents_[i]
+		== this->tracked_reloc_contents_[j]));
+  }
+
+  // Record that the kept section of section I has changed.
+  void
+  set_kept_section(unsigned int i, unsigned int kept)
+  {
+    this->kept_section_id_[i] = kept;
+    this->changed_at_[i] = ++this->clock_;
+  }
+
+  bool
+  match_sections(Symbol_table* symtab, unsigned int iteration_num);
+
+  typedef Unordered_multimap<uint32_t, unsigned int> Section_cksum_map;
+
   // Maps integers to sections.
   std::vector<Section_id> id_section_;
   // Does the reverse.
@@ -186,6 +259,46 @@ class Icf
   // Regions of other sections that should be considered part of
   // each section for ICF purposes.
   Extra_identity_list extra_identity_list_;
+
+  // The rest of the fields are only used while forming the groups of
+  // identical sections, and are indexed by section id.
+
+  // The size of each section.
+  std::vector<uint64_t> section_sizes_;
+  // The alignment of each section.
+  std::vector<uint64_t> section_addraligns_;
+  // True for a section, or the kept section of a group, that is known
+  // to be unique and need not be processed any further.  This is
+  // only written when no hash tasks are running.
+  std::vector<bool> is_secn_or_group_unique_;
+  // The checksum of the raw contents of each section, then of the
+  // full contents when it was last hashed.
+  std::vector<uint32_t> section_checksums_;
+  // The checksum of SECTION_CONTENTS_ of each section.  The full
+  // checksum continues from it.
+  std::vector<uint32_t> fixed_checksums_;
+  // The contents of each section that do not change from iteration to
+  // iteration: the text and the relocs to sections that cannot be
+  // folded.  This is empty for a section that could not be built by
+  // a hash task because it refers to contents in another object.
+  std::vector<std::string> section_contents_;
+  // The contents of the relocs to sections that might be folded, as
+  // of the last time each section was hashed.
+  std::vector<std::string> tracked_reloc_contents_;
+  // The sections that might be folded which each section refers to.
+  std::vector<std::vector<unsigned int> > tracked_sections_;
+  // The value of CLOCK_ when the kept section of each section last
+  // changed, and when each section was last hashed.
+  std::vector<unsigned int> changed_at_;
+  std::vector<unsigned int> hashed_at_;
+  // Maps a checksum to the kept sections hashed to it.
+  Section_cksum_map section_cksum_;
+  // Counts the changes to kept sections.
+  unsigned int clock_;
+  // Statistics.
+  unsigned int num_iterations_;
+  unsigned int num_hashed_;
+  unsigned int num_rehashed_;
 };
 
 // This function returns true if this section corresponds to a function that
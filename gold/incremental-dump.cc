@@ -96,7 +96,7 @@ dump_incremental_inputs(const char* argv0, const char* filename,
   Incremental_inputs_reader<size, big_endian>
       incremental_inputs(inc->inputs_reader());
 
-  if (incremental_inputs.version() != 2)
+  if (incremental_inputs.version() != 3)
     {
       fprintf(stderr, "%s: %s: unknown incremental version %d\n", argv0,
               filename, incremental_inputs.version());
@@ -133,6 +133,12 @@ dump_incremental_inputs(const char* argv0, const char* filename,
 	     mtime.nanoseconds,
 	     ctime(&mtime.seconds));
 
+      const unsigned char* hash = input_file.get_content_hash();
+      printf("    Content Hash: ");
+      for (unsigned int j = 0; j < content_hash_size; ++j)
+	printf("%02x", hash[j]);
+      printf("\n");
+
       printf("    Serial Number: %d\n", input_file.arg_serial());
       printf("    In System Directory: %s\n",
 	     input_file.is_in_system_directory() ? "true" : "false");
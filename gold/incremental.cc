@@ -24,7 +24,12 @@
 
 #include <set>
 #include <cstdarg>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 #include "libiberty.h"
+#include "filenames.h"
+#include "md5.h"
 
 #include "elfcpp.h"
 #include "options.h"
@@ -36,6 +41,7 @@
 #include "target-select.h"
 #include "target.h"
 #include "fileread.h"
+#include "descriptors.h"
 #include "script.h"
 
 namespace gold {
@@ -43,7 +49,8 @@ namespace gold {
 // Version number for the .gnu_incremental_inputs section.
 // Version 1 was the initial checkin.
 // Version 2 adds some padding to ensure 8-byte alignment where necessary.
-const unsigned int INCREMENTAL_LINK_VERSION = 2;
+// Version 3 adds a content hash to each input file entry.
+const unsigned int INCREMENTAL_LINK_VERSION = 3;
 
 // This class manages the .gnu_incremental_inputs section, which holds
 // the header information, a directory of input files, and separate
@@ -511,11 +518,25 @@ Sized_incremental_binary<size, big_endian>::do_file_has_changed(
       return true;
     }
 
-  if (new_mtime.seconds > old_mtime.seconds)
-    return true;
   if (new_mtime.seconds == old_mtime.seconds
-      && new_mtime.nanoseconds > old_mtime.nanoseconds)
+      && new_mtime.nanoseconds == old_mtime.nanoseconds)
+    return false;
+
+  // The timestamp differs, but the file may have been rewritten with
+  // the same contents (e.g., by a rebuild in another directory, or a
+  // build system that touches its outputs).  Compare the content hash
+  // recorded in the base file, if there is one.
+  static const unsigned char no_hash[content_hash_size] = { 0 };
+  const unsigned char* old_hash = input_file.get_content_hash();
+  if (memcmp(old_hash, no_hash, content_hash_size) == 0)
+    return true;
+  unsigned char new_hash[content_hash_size];
+  if (!get_content_hash(filename, new_hash)
+      || memcmp(old_hash, new_hash, content_hash_size) != 0)
     return true;
+
+  gold_debug(DEBUG_INCREMENTAL, "%s: timestamp changed, contents unchanged",
+	     filename);
   return false;
 }
 
@@ -953,6 +974,123 @@ open_incremental_binary(Output_file* file)
   return result;
 }
 
+// Return the name of the file in the --incremental-cache directory that
+// holds the base file for a link with the command line recorded in
+// INPUTS.  The file is named after a hash of the command line, the
+// current directory and the absolute name of the output file.  The
+// command line may name its inputs and its output relative to the
+// current directory, so the same command line run somewhere else is
+// another link, and must not find this one's base file.
+
+std::string
+incremental_cache_file_name(const Incremental_inputs* inputs)
+{
+  const std::string& command_line(inputs->command_line());
+  const char* cwd = getpwd();
+  if (cwd == NULL)
+    cwd = "";
+  std::string output_name(parameters->options().output_file_name());
+  if (!IS_ABSOLUTE_PATH(output_name.c_str()))
+    output_name = std::string(cwd) + '/' + output_name;
+
+  // Hash the strings with their terminating null characters, so that
+  // the boundaries between them are part of the hash.
+  md5_ctx ctx;
+  md5_init_ctx(&ctx);
+  md5_process_bytes(command_line.c_str(), command_line.size() + 1, &ctx);
+  md5_process_bytes(cwd, strlen(cwd) + 1, &ctx);
+  md5_process_bytes(output_name.c_str(), output_name.size() + 1, &ctx);
+  unsigned char hash[16];
+  md5_finish_ctx(&ctx, hash);
+
+  std::string name(parameters->options().incremental_cache());
+  name += '/';
+  static const char hex[] = "0123456789abcdef";
+  for (unsigned int i = 0; i < sizeof(hash); ++i)
+    {
+      name += hex[hash[i] >> 4];
+      name += hex[hash[i] & 0xf];
+    }
+  return name;
+}
+
+// Save a copy of the output file OUTPUT_NAME in the --incremental-cache
+// directory.  We write to a temporary file and rename it into place, so
+// that a concurrent link never sees a partial base file.  Failures are
+// only warnings, since the cache is not needed for a correct link.
+// This copies the whole output file after every link, however little
+// the incremental update changed.
+
+void
+save_incremental_cache(const char* output_name,
+		       const Incremental_inputs* inputs)
+{
+  if (strcmp(output_name, "-") == 0)
+    return;
+
+  std::string cache_name = incremental_cache_file_name(inputs);
+  char pid[32];
+  snprintf(pid, sizeof(pid), ".%ld", static_cast<long>(getpid()));
+  std::string temp_name = cache_name + pid;
+
+  int i = open_descriptor(-1, output_name, O_RDONLY);
+  if (i < 0)
+    {
+      gold_warning(_("%s: open: %s"), output_name, strerror(errno));
+      return;
+    }
+  int o = open_descriptor(-1, temp_name.c_str(),
+			  O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (o < 0)
+    {
+      gold_warning(_("%s: open: %s"), temp_name.c_str(), strerror(errno));
+      release_descriptor(i, true);
+      return;
+    }
+
+  bool ok = true;
+  char buf[65536];
+  ssize_t len;
+  while ((len = ::read(i, buf, sizeof(buf))) > 0)
+    {
+      ssize_t off = 0;
+      while (off < len)
+	{
+	  ssize_t n = ::write(o, buf + off, len - off);
+	  if (n < 0)
+	    {
+	      gold_warning(_("%s: write: %s"), temp_name.c_str(),
+			   strerror(errno));
+	      ok = false;
+	      break;
+	    }
+	  off += n;
+	}
+      if (!ok)
+	break;
+    }
+  if (len < 0)
+    {
+      gold_warning(_("%s: read: %s"), output_name, strerror(errno));
+      ok = false;
+    }
+
+  release_descriptor(i, true);
+  if (::close(o) < 0 && ok)
+    {
+      gold_warning(_("%s: close: %s"), temp_name.c_str(), strerror(errno));
+      ok = false;
+    }
+
+  if (ok && ::rename(temp_name.c_str(), cache_name.c_str()) < 0)
+    {
+      gold_warning(_("%s: rename: %s"), cache_name.c_str(), strerror(errno));
+      ok = false;
+    }
+  if (!ok)
+    ::unlink(temp_name.c_str());
+}
+
 // Class Incremental_inputs.
 
 // Add the command line to the string table, setting
@@ -978,10 +1116,12 @@ Incremental_inputs::report_command_line(int argc, const char* const* argv)
 	  || strcmp(argv[i], "--incremental-unknown") == 0
 	  || strcmp(argv[i], "--incremental-startup-unchanged") == 0
 	  || is_prefix_of("--incremental-base=", argv[i])
+	  || is_prefix_of("--incremental-cache=", argv[i])
 	  || is_prefix_of("--incremental-patch=", argv[i])
 	  || is_prefix_of("--debug=", argv[i]))
 	continue;
       if (strcmp(argv[i], "--incremental-base") == 0
+	  || strcmp(argv[i], "--incremental-cache") == 0
 	  || strcmp(argv[i], "--incremental-patch") == 0
 	  || strcmp(argv[i], "--debug") == 0)
 	{
@@ -1011,6 +1151,56 @@ Incremental_inputs::report_command_line(int argc, const char* const* argv)
 		     &this->command_line_key_);
 }
 
+// Record the base file of an incremental update.  Called from
+// Layout::set_incremental_base.
+
+void
+Incremental_inputs::set_base(Incremental_binary* base)
+{
+  this->base_ = base;
+  this->base_inputs_.clear();
+  unsigned int count = base->input_file_count();
+  for (unsigned int i = 0; i < count; ++i)
+    {
+      const Incremental_binary::Input_reader* input_file =
+	  base->get_input_reader(i);
+      this->base_inputs_[input_file->filename()] = i;
+    }
+}
+
+// Set the content hash of ENTRY from the file FILENAME.  If the file
+// has the same modification time that was recorded in the base file,
+// we copy the hash from there rather than reading the file again.  If
+// the file can't be read, the hash is left as all zeroes.
+
+void
+Incremental_inputs::record_content_hash(Incremental_input_entry* entry,
+					const char* filename)
+{
+  if (this->base_ != NULL)
+    {
+      Unordered_map<std::string, unsigned int>::const_iterator p =
+	  this->base_inputs_.find(filename);
+      if (p != this->base_inputs_.end())
+	{
+	  const Incremental_binary::Input_reader* input_file =
+	      this->base_->get_input_reader(p->second);
+	  Timespec old_mtime = input_file->get_mtime();
+	  const Timespec& mtime = entry->get_mtime();
+	  if (old_mtime.seconds == mtime.seconds
+	      && old_mtime.nanoseconds == mtime.nanoseconds)
+	    {
+	      entry->set_content_hash(input_file->get_content_hash());
+	      return;
+	    }
+	}
+    }
+
+  unsigned char hash[content_hash_size];
+  if (get_content_hash(filename, hash))
+    entry->set_content_hash(hash);
+}
+
 // Record the input archive file ARCHIVE.  This is called by the
 // Add_archive_symbols task before determining which archive members
 // to include.  We create the Incremental_archive_entry here and
@@ -1032,6 +1222,7 @@ Incremental_inputs::report_archive_begin(Library_base* arch,
   this->strtab_->add(arch->filename().c_str(), false, &filename_key);
   Incremental_archive_entry* entry =
       new Incremental_archive_entry(filename_key, arg_serial, mtime);
+  this->record_content_hash(entry, arch->filename().c_str());
   arch->set_incremental_info(entry);
 
   if (script_info != NULL)
@@ -1130,6 +1321,10 @@ Incremental_inputs::report_object(Object* obj, unsigned int arg_serial,
 						 arg_serial, mtime);
     }
 
+  // Archive members are covered by the hash of the archive itself.
+  if (arch == NULL)
+    this->record_content_hash(input_entry, obj->name().c_str());
+
   if (obj->is_in_system_directory())
     input_entry->set_is_in_system_directory();
 
@@ -1190,6 +1385,7 @@ Incremental_inputs::report_script(Script_info* script,
   this->strtab_->add(script->filename().c_str(), false, &filename_key);
   Incremental_script_entry* entry =
       new Incremental_script_entry(filename_key, arg_serial, script, mtime);
+  this->record_content_hash(entry, script->filename().c_str());
   this->inputs_.push_back(entry);
   script->set_incremental_info(entry);
 }
@@ -1502,7 +1698,8 @@ Output_section_incremental_inputs<size, big_endian>::write_input_files(
       Swap32::writeval(pov + 16, mtime.nanoseconds);
       Swap16::writeval(pov + 20, flags);
       Swap16::writeval(pov + 22, (*p)->arg_serial());
-      gold_assert(this->input_entry_size == 24);
+      memcpy(pov + 24, (*p)->get_content_hash(), content_hash_size);
+      gold_assert(this->input_entry_size == 24 + content_hash_size);
       pov += this->input_entry_size;
     }
   return pov;
@@ -2104,7 +2301,7 @@ Sized_relobj_incr<size, big_endian>::do_layout(
        ++p)
     {
       unsigned int i = *p;
-      layout->add_to_gdb_index(false, this, NULL, 0, i, 0, 0);
+      layout->add_to_gdb_index(false, this, 0, i, 0, 0);
     }
   for (std::vector<unsigned int>::const_iterator p
 	   = debug_types_sections.begin();
@@ -2112,7 +2309,7 @@ Sized_relobj_incr<size, big_endian>::do_layout(
        ++p)
     {
       unsigned int i = *p;
-      layout->add_to_gdb_index(true, this, 0, 0, i, 0, 0);
+      layout->add_to_gdb_index(true, this, 0, i, 0, 0);
     }
 }
 
@@ -92,6 +92,19 @@ can_incremental_update(unsigned int sh_type);
 Incremental_binary*
 open_incremental_binary(Output_file* file);
 
+// Return the name of the file in the --incremental-cache directory that
+// holds the base file for a link with the command line recorded in INPUTS.
+
+std::string
+incremental_cache_file_name(const Incremental_inputs* inputs);
+
+// Save a copy of the output file OUTPUT_NAME in the --incremental-cache
+// directory, for use as the base file of a later link.
+
+void
+save_incremental_cache(const char* output_name,
+		       const Incremental_inputs* inputs);
+
 // Base class for recording each input file.
 
 class Incremental_input_entry
@@ -102,7 +115,7 @@ class Incremental_input_entry
     : filename_key_(filename_key), file_index_(0), offset_(0), info_offset_(0),
       arg_serial_(arg_serial), mtime_(mtime), is_in_system_directory_(false),
       as_needed_(false)
-  { }
+  { memset(this->content_hash_, 0, content_hash_size); }
 
   virtual
   ~Incremental_input_entry()
@@ -156,6 +169,17 @@ class Incremental_input_entry
   get_mtime() const
   { return this->mtime_; }
 
+  // Set the content hash of the input file.
+  void
+  set_content_hash(const unsigned char* hash)
+  { memcpy(this->content_hash_, hash, content_hash_size); }
+
+  // Get the content hash of the input file.  All zeroes if the hash
+  // is not known.
+  const unsigned char*
+  get_content_hash() const
+  { return this->content_hash_; }
+
   // Record that the file was found in a system directory.
   void
   set_is_in_system_directory()
@@ -248,6 +272,9 @@ class Incremental_input_entry
   // Last modification time of the file.
   Timespec mtime_;
 
+  // Content hash of the file.
+  unsigned char content_hash_[content_hash_size];
+
   // TRUE if the file was found in a system directory.
   bool is_in_system_directory_;
 
@@ -560,7 +587,8 @@ class Incremental_inputs
 
   Incremental_inputs()
     : inputs_(), command_line_(), command_line_key_(0),
-      strtab_(new Stringpool()), current_object_(NULL),
+      strtab_(new Stringpool()), base_(NULL), base_inputs_(),
+      current_object_(NULL),
       current_object_entry_(NULL), inputs_section_(NULL),
       symtab_section_(NULL), relocs_section_(NULL),
       reloc_count_(0)
@@ -572,6 +600,11 @@ class Incremental_inputs
   void
   report_command_line(int argc, const char* const* argv);
 
+  // Record the base file of an incremental update, so that the
+  // content hashes of unchanged inputs can be copied from it.
+  void
+  set_base(Incremental_binary* base);
+
   // Record the initial info for archive file ARCHIVE.
   void
   report_archive_begin(Library_base* arch, unsigned int arg_serial,
@@ -670,6 +703,10 @@ class Incremental_inputs
   relocs_entsize() const;
 
  private:
+  // Set the content hash of ENTRY from the file FILENAME.
+  void
+  record_content_hash(Incremental_input_entry* entry, const char* filename);
+
   // The list of input files.
   Input_list inputs_;
 
@@ -684,6 +721,12 @@ class Incremental_inputs
   // .gnu_incremental_inputs.
   Stringpool* strtab_;
 
+  // The base file for an incremental update, or NULL.
+  Incremental_binary* base_;
+
+  // Map from input file name to input file index in the base file.
+  Unordered_map<std::string, unsigned int> base_inputs_;
+
   // Keep track of the object currently being processed.
   Object* current_object_;
   Incremental_object_entry* current_object_entry_;
@@ -760,8 +803,9 @@ class Incremental_inputs_reader
   // (3 x 4-byte fields, plus 4 bytes padding.)
   static const unsigned int header_size = 16;
   // Size of an input file entry.
-  // (2 x 4-byte fields, 1 x 12-byte field, 2 x 2-byte fields.)
-  static const unsigned int input_entry_size = 24;
+  // (2 x 4-byte fields, 1 x 12-byte field, 2 x 2-byte fields,
+  // 1 x 16-byte field.)
+  static const unsigned int input_entry_size = 40;
   // Size of the first part of the supplemental info block for
   // relocatable objects and archive members.
   // (7 x 4-byte fields, plus 4 bytes padding.)
@@ -846,6 +890,11 @@ class Incremental_inputs_reader
       return t;
     }
 
+    // Return the content hash.
+    const unsigned char*
+    get_content_hash() const
+    { return this->inputs_->p_ + this->offset_ + 24; }
+
     // Return the type of input file.
     Incremental_input_type
     type() const
@@ -1383,6 +1432,10 @@ class Incremental_binary
     get_mtime() const
     { return this->do_get_mtime(); }
 
+    const unsigned char*
+    get_content_hash() const
+    { return this->do_get_content_hash(); }
+
     Incremental_input_type
     type() const
     { return this->do_type(); }
@@ -1406,6 +1459,9 @@ class Incremental_binary
     virtual Timespec
     do_get_mtime() const = 0;
 
+    virtual const unsigned char*
+    do_get_content_hash() const = 0;
+
     virtual Incremental_input_type
     do_type() const = 0;
 
@@ -1728,6 +1784,10 @@ class Sized_incremental_binary : public Incremental_binary
     do_get_mtime() const
     { return this->reader_.get_mtime(); }
 
+    const unsigned char*
+    do_get_content_hash() const
+    { return this->reader_.get_content_hash(); }
+
     Incremental_input_type
     do_type() const
     { return this->reader_.type(); }
@@ -286,6 +286,55 @@ class Hash_task : public Task
   Task_token* const final_blocker_;
 };
 
+// A Count_local_symbols_task adds the names of the local symbols of
+// one input object to the symbol string pools, which must accept
+// concurrent additions.
+
+class Count_local_symbols_task : public Task
+{
+ public:
+  Count_local_symbols_task(Relobj* object, Stringpool* sympool,
+			   Stringpool* dynpool, Task_token* final_blocker)
+    : object_(object), sympool_(sympool), dynpool_(dynpool),
+      final_blocker_(final_blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  {
+    this->object_->count_local_symbols(this->sympool_, this->dynpool_);
+    this->object_->release();
+  }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->object_->is_locked())
+      return this->object_->token();
+    return NULL;
+  }
+
+  // Lock the object, and unblock FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->object_->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->final_blocker_);
+  }
+
+  std::string
+  get_name() const
+  { return "Count_local_symbols_task " + this->object_->name(); }
+
+ private:
+  Relobj* const object_;
+  Stringpool* const sympool_;
+  Stringpool* const dynpool_;
+  Task_token* const final_blocker_;
+};
+
 // Layout::Relaxation_debug_check methods.
 
 // Check that sections and special data are in reset states.
@@ -370,11 +419,34 @@ Layout::Relaxation_debug_check::verify_sections(
 void
 Layout_task_runner::run(Workqueue* workqueue, const Task* task)
 {
+  Layout* layout = this->layout_;
+
+  // If the local symbols can be counted in parallel, queue a task
+  // for each input object, along with the tasks which sort the merged
+  // strings, and run the rest of the layout again once they are done.
+  if (layout->count_local_symbols_in_parallel()
+      && !layout->local_symbols_counted())
+    {
+      Task_token* blocker = new Task_token(true);
+      layout->queue_count_local_symbols_tasks(this->input_objects_,
+					      this->symtab_, this->target_,
+					      workqueue, blocker);
+      layout->queue_merge_sort_tasks(workqueue, blocker);
+      workqueue->queue(new Task_function(new Layout_task_runner(
+					   this->options_,
+					   this->input_objects_,
+					   this->symtab_,
+					   this->target_,
+					   layout,
+					   this->mapfile_),
+					 blocker,
+					 "Task_function Layout_task_runner"));
+      return;
+    }
+
   // See if any of the input definitions violate the One Definition Rule.
   // TODO: if this is too slow, do this as a task, rather than inline.
   this->symtab_->detect_odr_violations(task, this->options_.output_file_name());
-
-  Layout* layout = this->layout_;
   off_t file_size = layout->finalize(this->input_objects_,
 				     this->symtab_,
 				     this->target_,
@@ -432,6 +504,7 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     segment_list_(),
     section_list_(),
     unattached_section_list_(),
+    compressed_section_list_(),
     special_output_list_(),
     relax_output_list_(),
     section_headers_(NULL),
@@ -450,7 +523,7 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     eh_frame_data_(NULL),
     added_eh_frame_data_(false),
     eh_frame_hdr_section_(NULL),
-    gdb_index_data_(NULL),
+    debug_index_scanner_(NULL),
     build_id_note_(NULL),
     debug_abbrev_(NULL),
     debug_info_(NULL),
@@ -464,6 +537,7 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     has_static_tls_(false),
     any_postprocessing_sections_(false),
     resized_signatures_(false),
+    local_symbols_counted_(false),
     have_stabstr_section_(false),
     section_ordering_specified_(false),
     unique_segment_for_sections_specified_(false),
@@ -496,6 +570,16 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
   // The section name pool is worth optimizing in all cases, because
   // it is small, but there are often overlaps due to .rel sections.
   this->namepool_.set_optimize();
+
+  // When running with threads, the local symbol names are added to
+  // the symbol string pools by one task per input object, at the
+  // positions a serial link would add them.  The keys of these pools
+  // are never used to order the output.
+  if (parameters->options().threads() && !parameters->incremental())
+    {
+      this->sympool_.set_concurrent();
+      this->dynpool_.set_concurrent();
+    }
 }
 
 // For incremental links, record the base file to be modified.
@@ -505,6 +589,8 @@ Layout::set_incremental_base(Incremental_binary* base)
 {
   this->incremental_base_ = base;
   this->free_list_.init(base->output_file()->filesize(), true);
+  if (this->incremental_inputs_ != NULL)
+    this->incremental_inputs_->set_base(base);
 }
 
 // Hash a key we use to look up an output section mapping.
@@ -738,6 +824,15 @@ Layout::include_section(Sized_relobj_file<size, big_endian>*, const char* name,
 	      && is_gdb_fast_lookup_section(name + 8))
 	    return false;
 	}
+      if (parameters->options().debug_names()
+	  && !parameters->options().relocatable()
+	  && (shdr.get_sh_flags() & elfcpp::SHF_ALLOC) == 0)
+	{
+	  // When building .debug_names, the per-object name indexes
+	  // are replaced by the one built for the whole output.
+	  if (strcmp(name, ".debug_names") == 0)
+	    return false;
+	}
       if (parameters->options().strip_lto_sections()
 	  && !parameters->options().relocatable()
 	  && (shdr.get_sh_flags() & elfcpp::SHF_ALLOC) == 0)
@@ -1624,35 +1719,73 @@ Layout::remove_eh_frame_for_plt(Output_data* plt, const unsigned char* cie_data,
 }
 
 // Scan a .debug_info or .debug_types section, and add summary
-// information to the .gdb_index section.
+// information to the .gdb_index and .debug_names sections.
 
 template<int size, bool big_endian>
 void
 Layout::add_to_gdb_index(bool is_type_unit,
 			 Sized_relobj<size, big_endian>* object,
-			 const unsigned char* symbols,
-			 off_t symbols_size,
+			 unsigned int symtab_shndx,
 			 unsigned int shndx,
 			 unsigned int reloc_shndx,
 			 unsigned int reloc_type)
 {
-  if (this->gdb_index_data_ == NULL)
+  if (this->debug_index_scanner_ == NULL)
     {
-      Output_section* os = this->choose_output_section(NULL, ".gdb_index",
-						       elfcpp::SHT_PROGBITS, 0,
-						       false, ORDER_INVALID,
-						       false, false, false);
-      if (os == NULL)
+      Gdb_index* gdb_index = NULL;
+      if (parameters->options().gdb_index())
+	{
+	  Output_section* os =
+	    this->choose_output_section(NULL, ".gdb_index",
+					elfcpp::SHT_PROGBITS, 0, false,
+					ORDER_INVALID, false, false, false);
+	  if (os != NULL)
+	    {
+	      gdb_index = new Gdb_index(os);
+	      os->add_output_section_data(gdb_index);
+	      os->set_after_input_sections();
+	    }
+	}
+
+      // The names in the .debug_names section go in .debug_str.
+      Debug_names* debug_names = NULL;
+      if (parameters->options().debug_names())
+	{
+	  Output_section* os =
+	    this->choose_output_section(NULL, ".debug_names",
+					elfcpp::SHT_PROGBITS, 0, false,
+					ORDER_INVALID, false, false, false);
+	  Output_section* str_os =
+	    this->choose_output_section(NULL, ".debug_str",
+					elfcpp::SHT_PROGBITS, 0, false,
+					ORDER_INVALID, false, false, false);
+	  if (os != NULL && str_os != NULL)
+	    {
+	      debug_names = new Debug_names(str_os);
+	      os->add_output_section_data(debug_names);
+	    }
+	}
+
+      if (gdb_index == NULL && debug_names == NULL)
 	return;
 
-      this->gdb_index_data_ = new Gdb_index(os);
-      os->add_output_section_data(this->gdb_index_data_);
-      os->set_after_input_sections();
+      this->debug_index_scanner_ = new Debug_index_scanner(gdb_index,
+							   debug_names);
     }
 
-  this->gdb_index_data_->scan_debug_info(is_type_unit, object, symbols,
-					 symbols_size, shndx, reloc_shndx,
-					 reloc_type);
+  this->debug_index_scanner_->scan_debug_info(is_type_unit, object,
+					      symtab_shndx, shndx,
+					      reloc_shndx, reloc_type);
+}
+
+// Queue the tasks which scan the debug info for the .gdb_index and
+// .debug_names sections.
+
+void
+Layout::queue_gdb_index_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  if (this->debug_index_scanner_ != NULL)
+    this->debug_index_scanner_->queue_scan_tasks(workqueue, blocker);
 }
 
 // Add POSD to an output section using NAME, TYPE, and FLAGS.  Return
@@ -1699,8 +1832,13 @@ Layout::make_output_section(const char* name, elfcpp::Elf_Word type,
   if ((flags & elfcpp::SHF_ALLOC) == 0
       && strcmp(parameters->options().compress_debug_sections(), "none") != 0
       && is_compressible_debug_section(name))
-    os = new Output_compressed_section(&parameters->options(), name, type,
-				       flags);
+    {
+      Output_compressed_section* ocs =
+	new Output_compressed_section(&parameters->options(), name, type,
+				      flags);
+      this->compressed_section_list_.push_back(ocs);
+      os = ocs;
+    }
   else if ((flags & elfcpp::SHF_ALLOC) == 0
 	   && parameters->options().strip_debug_non_line()
 	   && strcmp(".debug_abbrev", name) == 0)
@@ -2994,9 +3132,19 @@ Layout::finalize(const Input_objects* input_objects, Symbol_table* symtab,
   unsigned int local_dynamic_count = 0;
   unsigned int forced_local_dynamic_count = 0;
 
-  target->finalize_sections(this, input_objects, symtab);
+  // Add the results of the debug info scans before any section sizes
+  // are set.
+  if (this->debug_index_scanner_ != NULL)
+    this->debug_index_scanner_->add_scanned_units();
 
-  this->count_local_symbols(task, input_objects);
+  // If the local symbols were counted in parallel, the target
+  // sections were finalized before that was done.
+  if (!this->local_symbols_counted_)
+    {
+      target->finalize_sections(this, input_objects, symtab);
+
+      this->count_local_symbols(task, input_objects);
+    }
 
   this->link_stabs_sections();
 
@@ -4397,6 +4545,80 @@ Layout::place_orphan_sections_in_script()
 void
 Layout::count_local_symbols(const Task* task,
 			    const Input_objects* input_objects)
+{
+  this->reserve_local_symbol_pools(input_objects);
+
+  for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
+       p != input_objects->relobj_end();
+       ++p)
+    {
+      Task_lock_obj<Object> tlo(task, *p);
+      (*p)->count_local_symbols(&this->sympool_, &this->dynpool_);
+    }
+  this->local_symbols_counted_ = true;
+}
+
+// Finalize the target sections and queue a task for each input
+// object which counts its local symbols.  The tasks unblock BLOCKER
+// when done.  This is only used when the string pools accept
+// concurrent additions.
+
+void
+Layout::queue_count_local_symbols_tasks(const Input_objects* input_objects,
+					Symbol_table* symtab, Target* target,
+					Workqueue* workqueue,
+					Task_token* blocker)
+{
+  gold_assert(this->count_local_symbols_in_parallel()
+	      && !this->local_symbols_counted_);
+
+  target->finalize_sections(this, input_objects, symtab);
+
+  this->reserve_local_symbol_pools(input_objects);
+
+  // Give each object the positions at which a serial link would add
+  // the names of its local symbols, so that the string tables are the
+  // same as without threads.
+  size_t position = 0;
+  for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
+       p != input_objects->relobj_end();
+       ++p)
+    {
+      (*p)->set_local_symbol_position(position);
+      position += (*p)->local_symbol_count();
+    }
+  this->sympool_.reserve_positions(position);
+  this->dynpool_.reserve_positions(position);
+
+  for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
+       p != input_objects->relobj_end();
+       ++p)
+    {
+      blocker->add_blocker();
+      workqueue->queue(new Count_local_symbols_task(*p, &this->sympool_,
+						    &this->dynpool_,
+						    blocker));
+    }
+  this->local_symbols_counted_ = true;
+}
+
+// Queue the tasks which sort the strings of the merged string
+// sections.  This is only done once all input sections have been
+// laid out; finalize_merged_data then only has to assign the offsets.
+
+void
+Layout::queue_merge_sort_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  for (Section_list::iterator p = this->section_list_.begin();
+       p != this->section_list_.end();
+       ++p)
+    (*p)->queue_merge_sort_tasks(workqueue, blocker);
+}
+
+// Reserve space in the symbol string pools for the local symbols.
+
+void
+Layout::reserve_local_symbol_pools(const Input_objects* input_objects)
 {
   // First, figure out an upper bound on the number of symbols we'll
   // be inserting into each pool.  This helps us create the pools with
@@ -4416,14 +4638,6 @@ Layout::count_local_symbols(const Task* task,
   // We assume all symbols will go into both the sympool and dynpool.
   this->sympool_.reserve(symbol_count);
   this->dynpool_.reserve(symbol_count);
-
-  for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
-       p != input_objects->relobj_end();
-       ++p)
-    {
-      Task_lock_obj<Object> tlo(task, *p);
-      (*p)->count_local_symbols(&this->sympool_, &this->dynpool_);
-    }
 }
 
 // Create the symbol table sections.  Here we also set the final
@@ -5910,6 +6124,18 @@ Layout::write_data(const Symbol_table* symtab, Output_file* of) const
     (*p)->write(of);
 }
 
+// Queue the tasks which compress the large compressed debug sections.
+
+void
+Layout::queue_compression_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  for (std::vector<Output_compressed_section*>::const_iterator p =
+	 this->compressed_section_list_.begin();
+       p != this->compressed_section_list_.end();
+       ++p)
+    (*p)->queue_compression_tasks(workqueue, blocker);
+}
+
 // Write out the Output_sections which can only be written after the
 // input sections are complete.
 
@@ -6184,6 +6410,23 @@ Write_after_input_sections_task::run(Workqueue*)
   this->layout_->write_sections_after_input_sections(this->of_);
 }
 
+// Compress_sections_task_runner methods.
+
+// Queue a task for each block of the compressed sections, and the
+// task which finalizes and writes out the postprocessing sections
+// once they are all done.
+
+void
+Compress_sections_task_runner::run(Workqueue* workqueue, const Task*)
+{
+  Task_token* compress_blocker = new Task_token(true);
+  this->layout_->queue_compression_tasks(workqueue, compress_blocker);
+  workqueue->queue(new Write_after_input_sections_task(this->layout_,
+						       this->of_,
+						       compress_blocker,
+						       this->final_blocker_));
+}
+
 // Build IDs can be computed as a "flat" sha1 or md5 of a string of bytes,
 // or as a "tree" where each chunk of the string is hashed and then those
 // hashes are put into a (much smaller) string which is hashed with sha1.
@@ -6491,8 +6734,7 @@ template
 void
 Layout::add_to_gdb_index(bool is_type_unit,
 			 Sized_relobj<32, false>* object,
-			 const unsigned char* symbols,
-			 off_t symbols_size,
+			 unsigned int symtab_shndx,
 			 unsigned int shndx,
 			 unsigned int reloc_shndx,
 			 unsigned int reloc_type);
@@ -6503,8 +6745,7 @@ template
 void
 Layout::add_to_gdb_index(bool is_type_unit,
 			 Sized_relobj<32, true>* object,
-			 const unsigned char* symbols,
-			 off_t symbols_size,
+			 unsigned int symtab_shndx,
 			 unsigned int shndx,
 			 unsigned int reloc_shndx,
 			 unsigned int reloc_type);
@@ -6515,8 +6756,7 @@ template
 void
 Layout::add_to_gdb_index(bool is_type_unit,
 			 Sized_relobj<64, false>* object,
-			 const unsigned char* symbols,
-			 off_t symbols_size,
+			 unsigned int symtab_shndx,
 			 unsigned int shndx,
 			 unsigned int reloc_shndx,
 			 unsigned int reloc_type);
@@ -6527,8 +6767,7 @@ template
 void
 Layout::add_to_gdb_index(bool is_type_unit,
 			 Sized_relobj<64, true>* object,
-			 const unsigned char* symbols,
-			 off_t symbols_size,
+			 unsigned int symtab_shndx,
 			 unsigned int shndx,
 			 unsigned int reloc_shndx,
 			 unsigned int reloc_type);
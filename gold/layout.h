@@ -47,6 +47,7 @@ class Mapfile;
 class Symbol_table;
 class Output_section_data;
 class Output_section;
+class Output_compressed_section;
 class Output_section_headers;
 class Output_segment_headers;
 class Output_file_header;
@@ -58,7 +59,7 @@ class Output_symtab_xindex;
 class Output_reduced_debug_abbrev_section;
 class Output_reduced_debug_info_section;
 class Eh_frame;
-class Gdb_index;
+class Debug_index_scanner;
 class Target;
 struct Timespec;
 
@@ -685,17 +686,22 @@ class Layout
 			  size_t cie_length);
 
   // Scan a .debug_info or .debug_types section, and add summary
-  // information to the .gdb_index section.
+  // information to the .gdb_index and .debug_names sections.
+  // SYMTAB_SHNDX is the index of the symbol table section of OBJECT.
   template<int size, bool big_endian>
   void
   add_to_gdb_index(bool is_type_unit,
 		   Sized_relobj<size, big_endian>* object,
-		   const unsigned char* symbols,
-		   off_t symbols_size,
+		   unsigned int symtab_shndx,
 		   unsigned int shndx,
 		   unsigned int reloc_shndx,
 		   unsigned int reloc_type);
 
+  // Queue the tasks which scan the sections passed to add_to_gdb_index.
+  // BLOCKER is unblocked when they are done.
+  void
+  queue_gdb_index_tasks(Workqueue*, Task_token* blocker);
+
   // Handle a GNU stack note.  This is called once per input object
   // file.  SEEN_GNU_STACK is true if the object file has a
   // .note.GNU-stack section.  GNU_STACK_FLAGS is the section flags
@@ -851,6 +857,34 @@ class Layout
   any_postprocessing_sections() const
   { return this->any_postprocessing_sections_; }
 
+  // Queue the tasks which compress the large compressed debug
+  // sections in parallel.  They unblock BLOCKER when done.
+  void
+  queue_compression_tasks(Workqueue*, Task_token* blocker);
+
+  // Whether the local symbols of the input objects may be counted
+  // in parallel, before finalize is called.
+  bool
+  count_local_symbols_in_parallel() const
+  { return this->sympool_.is_concurrent(); }
+
+  // Whether the local symbols have been counted.
+  bool
+  local_symbols_counted() const
+  { return this->local_symbols_counted_; }
+
+  // Finalize the target sections and queue the tasks which count the
+  // local symbols of each input object.  They unblock BLOCKER when
+  // done.
+  void
+  queue_count_local_symbols_tasks(const Input_objects*, Symbol_table*,
+				  Target*, Workqueue*, Task_token* blocker);
+
+  // Queue the tasks which sort the strings of the merged string
+  // sections when optimizing.  They unblock BLOCKER when done.
+  void
+  queue_merge_sort_tasks(Workqueue*, Task_token* blocker);
+
   // Return the size of the output file.
   off_t
   output_file_size() const
@@ -1131,6 +1165,10 @@ class Layout
   void
   count_local_symbols(const Task*, const Input_objects*);
 
+  // Reserve space in the string pools for the local symbols.
+  void
+  reserve_local_symbol_pools(const Input_objects*);
+
   // Create the output sections for the symbol table.
   void
   create_symtab_sections(const Input_objects*, Symbol_table*,
@@ -1415,6 +1453,8 @@ class Layout
   // The list of output sections which are not attached to any output
   // segment.
   Section_list unattached_section_list_;
+  // The output sections whose contents are compressed.
+  std::vector<Output_compressed_section*> compressed_section_list_;
   // The list of unattached Output_data objects which require special
   // handling because they are not Output_sections.
   Data_list special_output_list_;
@@ -1454,8 +1494,9 @@ class Layout
   bool added_eh_frame_data_;
   // The exception frame header output section if there is one.
   Output_section* eh_frame_hdr_section_;
-  // The data for the .gdb_index section.
-  Gdb_index* gdb_index_data_;
+  // The scanner of the debug info for the .gdb_index and .debug_names
+  // sections.
+  Debug_index_scanner* debug_index_scanner_;
   // The space for the build ID checksum if there is one.
   Output_section_data* build_id_note_;
   // The space for the package metadata JSON if there is one.
@@ -1487,6 +1528,8 @@ class Layout
   bool any_postprocessing_sections_;
   // Whether we have resized the signatures_ hash table.
   bool resized_signatures_;
+  // Whether we have counted the local symbols of the input objects.
+  bool local_symbols_counted_;
   // Whether we have created a .stab*str output section.
   bool have_stabstr_section_;
   // True if the input sections in the output sections should be sorted
@@ -1680,6 +1723,29 @@ class Write_after_input_sections_task : public Task
   Task_token* final_blocker_;
 };
 
+// This task function queues the tasks which compress the large
+// compressed debug sections, and then Write_after_input_sections_task,
+// which waits for them.  It cannot run until all the relocations
+// have been applied to the postprocessing buffers.
+
+class Compress_sections_task_runner : public Task_function_runner
+{
+ public:
+  Compress_sections_task_runner(Layout* layout, Output_file* of,
+				Task_token* final_blocker)
+    : layout_(layout), of_(of), final_blocker_(final_blocker)
+  { }
+
+  // Run the operation.
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  Layout* layout_;
+  Output_file* of_;
+  Task_token* final_blocker_;
+};
+
 // This task function handles computation of the build id.
 // When using --build-id=tree, it schedules the tasks that
 // compute the hashes for each chunk of the file. This task
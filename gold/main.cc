@@ -306,9 +306,12 @@ main(int argc, char** argv)
       fprintf(stderr, _("%s: output file size: %lld bytes\n"),
 	      program_name, static_cast<long long>(layout.output_file_size()));
       symtab.print_stats();
+      if (parameters->options().icf_enabled())
+	icf.print_stats();
       layout.print_stats();
       Gdb_index::print_stats();
       Free_list::print_stats();
+      workqueue.print_stats();
     }
 
   // Issue defined symbol report.
@@ -323,6 +326,13 @@ main(int argc, char** argv)
   if (mapfile != NULL)
     mapfile->close();
 
+  // Keep a copy of a successful incremental link for later links.
+  if (layout.incremental_inputs() != NULL
+      && command_line.options().incremental_cache() != NULL
+      && errors.error_count() == 0)
+    save_incremental_cache(command_line.options().output_file_name(),
+			   layout.incremental_inputs());
+
   if (parameters->options().fatal_warnings()
       && errors.warning_count() > 0
       && errors.error_count() == 0)
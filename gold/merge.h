@@ -201,6 +201,13 @@ class Output_merge_base : public Output_section_data
   set_keeps_input_sections()
   { this->do_set_keeps_input_sections(); }
 
+  // Queue tasks which prepare the merged data for finalizing, and
+  // which unblock BLOCKER when done.  No more input sections may be
+  // added after this is called.
+  void
+  queue_sort_tasks(Workqueue* workqueue, Task_token* blocker)
+  { this->do_queue_sort_tasks(workqueue, blocker); }
+
   // Return the object of the first merged input section.  This used
   // for script processing.  This is NULL if merge section is empty.
   Relobj*
@@ -253,6 +260,11 @@ class Output_merge_base : public Output_section_data
   do_set_keeps_input_sections()
   { this->keeps_input_sections_ = true; }
 
+  // This may be overridden by the child class.
+  virtual void
+  do_queue_sort_tasks(Workqueue*, Task_token*)
+  { }
+
   // Record the merged input section for script processing.
   void
   record_input_section(Relobj* relobj, unsigned int shndx);
@@ -448,6 +460,11 @@ class Output_merge_string : public Output_merge_base
   clear_stringpool()
   { this->stringpool_.clear(); }
 
+  // Sort the strings for the optimized string table in parallel.
+  void
+  do_queue_sort_tasks(Workqueue* workqueue, Task_token* blocker)
+  { this->stringpool_.queue_sort_tasks(workqueue, blocker); }
+
   // Whether this is a merge string section.
   virtual bool
   do_is_string()
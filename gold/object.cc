@@ -682,12 +682,12 @@ need_decompressed_section(const char* name)
       // We will need .zdebug_str if this is not an incremental link
       // (i.e., we are processing string merge sections) or if we need
       // to build a gdb index.
-      if ((!parameters->incremental() || parameters->options().gdb_index())
+      if ((!parameters->incremental() || parameters->options().debug_index())
 	  && strcmp(name, "str") == 0)
 	return true;
 
       // We will need these other sections when building a gdb index.
-      if (parameters->options().gdb_index()
+      if (parameters->options().debug_index()
 	  && (strcmp(name, "info") == 0
 	      || strcmp(name, "types") == 0
 	      || strcmp(name, "pubnames") == 0
@@ -703,7 +703,7 @@ need_decompressed_section(const char* name)
   // Otherwise, we would decompress the section twice: once for
   // string merge processing, and once for building the gdb index.
   if (!parameters->incremental()
-      && parameters->options().gdb_index()
+      && parameters->options().debug_index()
       && strcmp(name, "str") == 0)
     return true;
 
@@ -817,7 +817,7 @@ Sized_relobj_file<size, big_endian>::do_find_special_sections(
 
   return (this->has_eh_frame_
 	  || (!parameters->options().relocatable()
-	      && parameters->options().gdb_index()
+	      && parameters->options().debug_index()
 	      && (memmem(names, sd->section_names_size, "debug_info", 11) != NULL
 		  || memmem(names, sd->section_names_size,
 			    "debug_types", 12) != NULL)));
@@ -1872,7 +1872,7 @@ Sized_relobj_file<size, big_endian>::do_layout(Symbol_table* symtab,
 	  // processing of .debug_info and .debug_types sections after all
 	  // the other sections for the same reason as above.
 	  if (!relocatable
-	      && parameters->options().gdb_index()
+	      && parameters->options().debug_index()
 	      && !(shdr.get_sh_flags() & elfcpp::SHF_ALLOC))
 	    {
 	      if (strcmp(name, ".debug_info") == 0
@@ -1995,7 +1995,7 @@ Sized_relobj_file<size, big_endian>::do_layout(Symbol_table* symtab,
        ++p)
     {
       unsigned int i = *p;
-      layout->add_to_gdb_index(false, this, symbols_data, symbols_size,
+      layout->add_to_gdb_index(false, this, this->symtab_shndx_,
 			       i, reloc_shndx[i], reloc_type[i]);
     }
   for (std::vector<unsigned int>::const_iterator p
@@ -2004,7 +2004,7 @@ Sized_relobj_file<size, big_endian>::do_layout(Symbol_table* symtab,
        ++p)
     {
       unsigned int i = *p;
-      layout->add_to_gdb_index(true, this, symbols_data, symbols_size,
+      layout->add_to_gdb_index(true, this, this->symtab_shndx_,
 			       i, reloc_shndx[i], reloc_type[i]);
     }
 
@@ -2274,9 +2274,9 @@ Sized_relobj_file<size, big_endian>::set_local_plt_offset(
 
 // First pass over the local symbols.  Here we add their names to
 // *POOL and *DYNPOOL, and we store the symbol value in
-// THIS->LOCAL_VALUES_.  This function is always called from a
-// singleton thread.  This is followed by a call to
-// finalize_local_symbols.
+// THIS->LOCAL_VALUES_.  This function may be called for several
+// objects at once if *POOL and *DYNPOOL are concurrent.  This is
+// followed by a call to finalize_local_symbols.
 
 template<int size, bool big_endian>
 void
@@ -2384,7 +2384,8 @@ Sized_relobj_file<size, big_endian>::do_count_local_symbols(Stringpool* pool,
       // If needed, add the symbol to the dynamic symbol table string pool.
       if (lv.needs_output_dynsym_entry())
 	{
-	  dynpool->add(name, true, NULL);
+	  dynpool->add_at_position(name, this->local_symbol_position() + i,
+				   true, NULL);
 	  ++dyncount;
 	}
 
@@ -2430,7 +2431,8 @@ Sized_relobj_file<size, big_endian>::do_count_local_symbols(Stringpool* pool,
 	}
 
       // Add the symbol to the symbol table string pool.
-      pool->add(name, true, NULL);
+      pool->add_at_position(name, this->local_symbol_position() + i, true,
+			    NULL);
       ++count;
     }
 
@@ -1150,7 +1150,8 @@ class Relobj : public Object
       reloc_counts_(NULL),
       reloc_bases_(NULL),
       first_dyn_reloc_(0),
-      dyn_reloc_count_(0)
+      dyn_reloc_count_(0),
+      local_symbol_position_(0)
   { }
 
   // During garbage collection, the Read_symbols_data pass for 
@@ -1267,6 +1268,19 @@ class Relobj : public Object
                       Stringpool_template<char>* dynpool)
   { return this->do_count_local_symbols(pool, dynpool); }
 
+  // The position in the symbol string pools of the name of the first
+  // local symbol, when the pools are concurrent.  The name of local
+  // symbol I is added at this position plus I, so that the string
+  // tables do not depend on the order in which the objects are
+  // counted.
+  size_t
+  local_symbol_position() const
+  { return this->local_symbol_position_; }
+
+  void
+  set_local_symbol_position(size_t position)
+  { this->local_symbol_position_ = position; }
+
   // Set the values of the local symbols, set the output symbol table
   // indexes for the local variables, and set the offset where local
   // symbol information will be stored. Returns the new local symbol index.
@@ -1605,6 +1619,8 @@ class Relobj : public Object
   unsigned int first_dyn_reloc_;
   // Count of dynamic relocations for this object.
   unsigned int dyn_reloc_count_;
+  // Position of the local symbol names in the symbol string pools.
+  size_t local_symbol_position_;
 };
 
 // This class is used to handle relocations against a section symbol
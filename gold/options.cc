@@ -1431,6 +1431,11 @@ General_options::finalize()
 			 "incremental link"));
 	  this->set_compress_debug_sections("none");
 	}
+      if (this->debug_names())
+	{
+	  gold_warning(_("ignoring --debug-names for an incremental link"));
+	  this->set_debug_names(false);
+	}
     }
 
 #ifndef HAVE_ZSTD
@@ -799,6 +799,10 @@ class General_options
 		N_("Turn on debugging"),
 		N_("[all,files,script,task][,...]"));
 
+  DEFINE_bool(debug_names, options::TWO_DASHES, '\0', false,
+	      N_("Generate .debug_names section"),
+	      N_("Do not generate .debug_names section"));
+
   DEFINE_special(defsym, options::TWO_DASHES, '\0',
 		 N_("Define a symbol"), N_("SYMBOL=EXPRESSION"));
 
@@ -985,6 +989,12 @@ class General_options
 		   " (default is output file)"),
 		N_("FILE"));
 
+  DEFINE_string(incremental_cache, options::TWO_DASHES, '\0', NULL,
+		N_("Keep a copy of the output in DIR, and use it as the"
+		   " incremental base when the output file can't be used"
+		   " (copies the whole output after each link)"),
+		N_("DIR"));
+
   DEFINE_special(incremental_changed, options::TWO_DASHES, '\0',
 		 N_("Assume files changed"), NULL);
 
@@ -1585,6 +1595,18 @@ class General_options
   output_is_executable() const
   { return !this->shared() && !this->relocatable(); }
 
+  // Return true if we are building a .gdb_index or .debug_names
+  // section, which requires scanning the debug info.
+  bool
+  debug_index() const
+  { return this->gdb_index() || this->debug_names(); }
+
+  // Turn threads on or off.  This is for tools such as dwp which use
+  // these options without parsing a linker command line.
+  void
+  set_use_threads(bool value)
+  { this->set_threads(value); }
+
   // This would normally be static(), and defined automatically, but
   // since static is a keyword, we need to come up with our own name.
   bool
@@ -2653,6 +2653,26 @@ Output_section::add_output_section_data(Input_section* inp)
   inp->set_output_section(this);
 }
 
+// Return the offset of POSD within this section.  This follows the
+// layout of set_final_data_size and create_postprocessing_buffer.
+
+off_t
+Output_section::output_section_data_offset(
+    const Output_section_data* posd) const
+{
+  off_t off = this->first_input_offset_;
+  for (Input_section_list::const_iterator p = this->input_sections_.begin();
+       p != this->input_sections_.end();
+       ++p)
+    {
+      off = align_address(off, p->addralign());
+      if (p->is_output_section_data() && p->output_section_data() == posd)
+	return off;
+      off += p->data_size();
+    }
+  gold_unreachable();
+}
+
 // Add a merge section to an output section.
 
 void
@@ -2745,6 +2765,22 @@ Output_section::add_merge_input_section(Relobj* object, unsigned int shndx,
     }
 }
 
+// Queue tasks which sort the strings of the merged string sections.
+// This is done when all the input sections have been added, so that
+// the sorting can overlap with other work rather than being done by
+// finalize_merged_data.
+
+void
+Output_section::queue_merge_sort_tasks(Workqueue* workqueue,
+				       Task_token* blocker)
+{
+  for (Input_section_list::iterator p = this->input_sections_.begin();
+       p != this->input_sections_.end();
+       ++p)
+    if (p->is_merge_section())
+      p->output_merge_base()->queue_sort_tasks(workqueue, blocker);
+}
+
 // Build a relaxation map to speed up relaxation of existing input sections.
 // Look up to the first LIMIT elements in INPUT_SECTIONS.
 
@@ -3245,6 +3245,13 @@ class Output_section : public Output_data
   void
   add_output_section_data(Output_section_data* posd);
 
+  // Return the offset within this section of POSD, which was added
+  // with add_output_section_data.  This may be called after the data
+  // sizes have been set, even if the section is built in a
+  // postprocessing buffer, where POSD is not given an address.
+  off_t
+  output_section_data_offset(const Output_section_data* posd) const;
+
   // Add a relaxed input section PORIS called NAME to this output section
   // with LAYOUT.
   void
@@ -3573,6 +3580,11 @@ class Output_section : public Output_data
   set_after_input_sections()
   { this->after_input_sections_ = true; }
 
+  // Queue tasks which sort the strings of the merged string sections
+  // of this section.  They unblock BLOCKER when done.
+  void
+  queue_merge_sort_tasks(Workqueue*, Task_token* blocker);
+
   // Return whether this section requires postprocessing after all
   // relocations have been applied.
   bool
@@ -3609,6 +3621,11 @@ class Output_section : public Output_data
     return this->postprocessing_buffer_;
   }
 
+  // Return whether the postprocessing buffer has been created.
+  bool
+  has_postprocessing_buffer() const
+  { return this->postprocessing_buffer_ != NULL; }
+
   // If a section requires postprocessing, create the buffer to use.
   void
   create_postprocessing_buffer();
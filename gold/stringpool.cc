@@ -29,6 +29,8 @@
 
 #include "output.h"
 #include "parameters.h"
+#include "gold-threads.h"
+#include "workqueue.h"
 #include "stringpool.h"
 
 namespace gold
@@ -36,9 +38,10 @@ namespace gold
 
 template<typename Stringpool_char>
 Stringpool_template<Stringpool_char>::Stringpool_template(uint64_t addralign)
-  : string_set_(), key_to_offset_(), strings_(), strtab_size_(0),
-    zero_null_(true), optimize_(false), offset_(sizeof(Stringpool_char)),
-    addralign_(addralign)
+  : shards_(1), shard_bits_(0), sort_vector_(), strings_sorted_(false),
+    strtab_size_(0), zero_null_(true),
+    optimize_(false), offset_(sizeof(Stringpool_char)), addralign_(addralign),
+    next_position_(0), reserved_position_(0), position_lock_(NULL)
 {
   if (parameters->options_valid()
       && parameters->options().optimize() >= 2
@@ -50,48 +53,129 @@ template<typename Stringpool_char>
 void
 Stringpool_template<Stringpool_char>::clear()
 {
-  for (typename std::list<Stringdata*>::iterator p = this->strings_.begin();
-       p != this->strings_.end();
-       ++p)
-    delete[] reinterpret_cast<char*>(*p);
-  this->strings_.clear();
-  this->key_to_offset_.clear();
-  this->string_set_.clear();
+  for (typename Shards::iterator ps = this->shards_.begin();
+       ps != this->shards_.end();
+       ++ps)
+    {
+      for (typename Stringdata_list::iterator p = ps->strings.begin();
+	   p != ps->strings.end();
+	   ++p)
+	delete[] reinterpret_cast<char*>(*p);
+      ps->strings.clear();
+      ps->key_to_offset.clear();
+      ps->string_set.clear();
+    }
 }
 
 template<typename Stringpool_char>
 Stringpool_template<Stringpool_char>::~Stringpool_template()
 {
   this->clear();
+  for (typename Shards::iterator p = this->shards_.begin();
+       p != this->shards_.end();
+       ++p)
+    delete p->lock;
+  delete this->position_lock_;
+}
+
+// Split the pool into shards which may be added to concurrently.
+
+template<typename Stringpool_char>
+void
+Stringpool_template<Stringpool_char>::set_concurrent()
+{
+  gold_assert(this->shard_bits_ == 0 && this->string_count() == 0);
+  this->shard_bits_ = concurrent_shard_bits;
+  this->shards_.resize(static_cast<size_t>(1) << this->shard_bits_);
+  for (typename Shards::iterator p = this->shards_.begin();
+       p != this->shards_.end();
+       ++p)
+    p->lock = new Lock();
+  this->position_lock_ = new Lock();
+}
+
+// Reserve COUNT positions in the order of addition of a concurrent
+// pool.
+
+template<typename Stringpool_char>
+void
+Stringpool_template<Stringpool_char>::reserve_positions(size_t count)
+{
+  if (this->shard_bits_ == 0)
+    return;
+  Hold_lock hl(*this->position_lock_);
+  this->reserved_position_ = this->next_position_;
+  this->next_position_ += count;
+}
+
+// Add a string at a position reserved by reserve_positions.
+
+template<typename Stringpool_char>
+const Stringpool_char*
+Stringpool_template<Stringpool_char>::add_at_position(const Stringpool_char* s,
+						      size_t position,
+						      bool copy, Key* pkey)
+{
+  if (this->shard_bits_ == 0)
+    return this->add(s, copy, pkey);
+
+  const section_offset_type pos = this->reserved_position_ + position;
+  gold_assert(pos < this->next_position_);
+  const size_t length = string_length(s);
+  return this->add_with_position(s, length, string_hash(s, length), pos,
+				 copy, pkey);
+}
+
+// Return the number of strings in the pool.
+
+template<typename Stringpool_char>
+size_t
+Stringpool_template<Stringpool_char>::string_count() const
+{
+  size_t count = 0;
+  for (typename Shards::const_iterator p = this->shards_.begin();
+       p != this->shards_.end();
+       ++p)
+    count += p->string_set.size();
+  return count;
 }
 
 // Resize the internal hashtable with the expectation we'll get n new
 // elements.  Note that the hashtable constructor takes a "number of
 // buckets you'd like," rather than "number of elements you'd like,"
-// but that's the best we can do.
+// but that's the best we can do.  The elements of a concurrent pool
+// are spread evenly over its shards.
 
 template<typename Stringpool_char>
 void
 Stringpool_template<Stringpool_char>::reserve(unsigned int n)
 {
-  this->key_to_offset_.reserve(n);
+  if (this->shard_bits_ != 0)
+    n = (n >> this->shard_bits_) + 1;
+
+  for (typename Shards::iterator p = this->shards_.begin();
+       p != this->shards_.end();
+       ++p)
+    {
+      p->key_to_offset.reserve(n);
 
 #if defined(HAVE_UNORDERED_MAP)
-  this->string_set_.rehash(this->string_set_.size() + n);
-  return;
+      p->string_set.rehash(p->string_set.size() + n);
+      continue;
 #elif defined(HAVE_TR1_UNORDERED_MAP)
-  // rehash() implementation is broken in gcc 4.0.3's stl
-  //this->string_set_.rehash(this->string_set_.size() + n);
-  //return;
+      // rehash() implementation is broken in gcc 4.0.3's stl
+      //p->string_set.rehash(p->string_set.size() + n);
+      //continue;
 #elif defined(HAVE_EXT_HASH_MAP)
-  this->string_set_.resize(this->string_set_.size() + n);
-  return;
+      p->string_set.resize(p->string_set.size() + n);
+      continue;
 #endif
 
-  // This is the generic "reserve" code, if no #ifdef above triggers.
-  String_set_type new_string_set(this->string_set_.size() + n);
-  new_string_set.insert(this->string_set_.begin(), this->string_set_.end());
-  this->string_set_.swap(new_string_set);
+      // This is the generic "reserve" code, if no #ifdef above triggers.
+      String_set_type new_string_set(p->string_set.size() + n);
+      new_string_set.insert(p->string_set.begin(), p->string_set.end());
+      p->string_set.swap(new_string_set);
+    }
 }
 
 // Compare two strings of arbitrary character type for equality.
@@ -141,14 +225,14 @@ Stringpool_template<Stringpool_char>::string_hash(const Stringpool_char* s,
   return gold::string_hash<Stringpool_char>(s, length);
 }
 
-// Add the string S to the list of canonical strings.  Return a
-// pointer to the canonical string.  If PKEY is not NULL, set *PKEY to
-// the key.  LENGTH is the length of S in characters.  Note that S may
-// not be NUL terminated.
+// Add the string S to the list of canonical strings of SHARD.
+// Return a pointer to the canonical string.  LENGTH is the length of
+// S in characters.  Note that S may not be NUL terminated.
 
 template<typename Stringpool_char>
 const Stringpool_char*
-Stringpool_template<Stringpool_char>::add_string(const Stringpool_char* s,
+Stringpool_template<Stringpool_char>::add_string(Shard* shard,
+						 const Stringpool_char* s,
 						 size_t len)
 {
   // We are in trouble if we've already computed the string offsets.
@@ -172,11 +256,11 @@ Stringpool_template<Stringpool_char>::add_string(const Stringpool_char* s,
       alc = sizeof(Stringdata) + len;
       front = false;
     }
-  else if (this->strings_.empty())
+  else if (shard->strings.empty())
     alc = sizeof(Stringdata) + buffer_size;
   else
     {
-      Stringdata* psd = this->strings_.front();
+      Stringdata* psd = shard->strings.front();
       if (len > psd->alc - psd->len)
 	alc = sizeof(Stringdata) + buffer_size;
       else
@@ -200,9 +284,9 @@ Stringpool_template<Stringpool_char>::add_string(const Stringpool_char* s,
   psd->len = len;
 
   if (front)
-    this->strings_.push_front(psd);
+    shard->strings.push_front(psd);
   else
-    this->strings_.push_back(psd);
+    shard->strings.push_back(psd);
 
   return reinterpret_cast<const Stringpool_char*>(psd->data);
 }
@@ -217,14 +301,32 @@ Stringpool_template<Stringpool_char>::add(const Stringpool_char* s, bool copy,
   return this->add_with_length(s, string_length(s), copy, pkey);
 }
 
-// Add a new key offset entry.
+// Add a new key offset entry.  The strings of a concurrent pool are
+// given their offsets in set_string_offsets; until then the entry
+// holds the position of the string, which is the next one unless
+// POSITION says otherwise.
 
 template<typename Stringpool_char>
 void
-Stringpool_template<Stringpool_char>::new_key_offset(size_t length)
+Stringpool_template<Stringpool_char>::new_key_offset(
+    Shard* shard,
+    size_t length,
+    section_offset_type position)
 {
+  // We are in trouble if we have already sorted the strings.
+  gold_assert(!this->strings_sorted_);
+
   section_offset_type offset;
-  if (this->zero_null_ && length == 0)
+  if (this->shard_bits_ != 0)
+    {
+      if (position < 0)
+	{
+	  Hold_lock hl(*this->position_lock_);
+	  position = this->next_position_++;
+	}
+      offset = position;
+    }
+  else if (this->zero_null_ && length == 0)
     offset = 0;
   else
     {
@@ -233,29 +335,58 @@ Stringpool_template<Stringpool_char>::new_key_offset(size_t length)
       offset = align_address(offset, this->addralign_);
       this->offset_ = offset + (length + 1) * sizeof(Stringpool_char);
     }
-  this->key_to_offset_.push_back(offset);
+  shard->key_to_offset.push_back(offset);
 }
 
+// Add a string whose hash code has already been computed.
+
 template<typename Stringpool_char>
 const Stringpool_char*
-Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
-						      size_t length,
-						      bool copy,
-						      Key* pkey)
+Stringpool_template<Stringpool_char>::add_with_length_and_hash(
+    const Stringpool_char* s,
+    size_t length,
+    size_t hash_code,
+    bool copy,
+    Key* pkey)
+{
+  return this->add_with_position(s, length, hash_code, -1, copy, pkey);
+}
+
+// Add a string at POSITION.  If the string is already in a
+// concurrent pool at a later position, move it to POSITION, so that
+// each string ends up at the first position where it was added
+// whichever order the threads ran in.
+
+template<typename Stringpool_char>
+const Stringpool_char*
+Stringpool_template<Stringpool_char>::add_with_position(
+    const Stringpool_char* s,
+    size_t length,
+    size_t hash_code,
+    section_offset_type position,
+    bool copy,
+    Key* pkey)
 {
   typedef std::pair<typename String_set_type::iterator, bool> Insert_type;
 
+  Hashkey hk(s, length, hash_code);
+  const size_t shard_index = this->shard_index(hk.hash_code);
+  Shard* shard = &this->shards_[shard_index];
+  Hold_optional_lock hl(shard->lock);
+
   // We add 1 so that 0 is always invalid.
-  const Key k = this->key_to_offset_.size() + 1;
+  const Key k = (((shard->key_to_offset.size() << this->shard_bits_)
+		  | shard_index)
+		 + 1);
 
   if (!copy)
     {
       // When we don't need to copy the string, we can call insert
       // directly.
 
-      std::pair<Hashkey, Hashval> element(Hashkey(s, length), k);
+      std::pair<Hashkey, Hashval> element(hk, k);
 
-      Insert_type ins = this->string_set_.insert(element);
+      Insert_type ins = shard->string_set.insert(element);
 
       typename String_set_type::const_iterator p = ins.first;
 
@@ -263,11 +394,12 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
 	{
 	  // We just added the string.  The key value has now been
 	  // used.
-	  this->new_key_offset(length);
+	  this->new_key_offset(shard, length, position);
 	}
       else
 	{
 	  gold_assert(k != p->second);
+	  this->move_to_position(shard, p->second, position);
 	}
 
       if (pkey != NULL)
@@ -280,24 +412,24 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
   // canonicalize it by copying it into the canonical list. The hash
   // code will only be computed once.
 
-  Hashkey hk(s, length);
-  typename String_set_type::const_iterator p = this->string_set_.find(hk);
-  if (p != this->string_set_.end())
+  typename String_set_type::const_iterator p = shard->string_set.find(hk);
+  if (p != shard->string_set.end())
     {
+      this->move_to_position(shard, p->second, position);
       if (pkey != NULL)
 	*pkey = p->second;
       return p->first.string;
     }
 
-  this->new_key_offset(length);
+  this->new_key_offset(shard, length, position);
 
-  hk.string = this->add_string(s, length);
+  hk.string = this->add_string(shard, s, length);
   // The contents of the string stay the same, so we don't need to
   // adjust hk.hash_code or hk.length.
 
   std::pair<Hashkey, Hashval> element(hk, k);
 
-  Insert_type ins = this->string_set_.insert(element);
+  Insert_type ins = shard->string_set.insert(element);
   gold_assert(ins.second);
 
   if (pkey != NULL)
@@ -311,8 +443,10 @@ Stringpool_template<Stringpool_char>::find(const Stringpool_char* s,
 					   Key* pkey) const
 {
   Hashkey hk(s);
-  typename String_set_type::const_iterator p = this->string_set_.find(hk);
-  if (p == this->string_set_.end())
+  const Shard& shard(this->shards_[this->shard_index(hk.hash_code)]);
+  Hold_optional_lock hl(shard.lock);
+  typename String_set_type::const_iterator p = shard.string_set.find(hk);
+  if (p == shard.string_set.end())
     return NULL;
 
   if (pkey != NULL)
@@ -369,6 +503,208 @@ Stringpool_template<Stringpool_char>::is_suffix(const Stringpool_char* s1,
   return memcmp(s1, s2 + len2 - len1, len1 * sizeof(Stringpool_char)) == 0;
 }
 
+// Partition the strings from BEGIN to END on their sort key at DEPTH,
+// using a median of three pivot.  The strings whose key is greater
+// than the pivot are moved to the front, followed by those whose key
+// is equal, starting at *PEQ_BEGIN, followed by those whose key is
+// less, starting at *PLT_BEGIN.  Return the key of the pivot.
+
+template<typename Stringpool_char>
+typename Stringpool_template<Stringpool_char>::Sort_key
+Stringpool_template<Stringpool_char>::partition_strings(
+    Sort_iterator begin,
+    Sort_iterator end,
+    size_t depth,
+    Sort_iterator* peq_begin,
+    Sort_iterator* plt_begin)
+{
+  Sort_key a = sort_key(*begin, depth);
+  Sort_key b = sort_key(*(begin + (end - begin) / 2), depth);
+  Sort_key c = sort_key(*(end - 1), depth);
+  Sort_key pivot;
+  if (a < b)
+    pivot = b < c ? b : (a < c ? c : a);
+  else
+    pivot = a < c ? a : (b < c ? c : b);
+
+  // [begin, gt_end) holds keys greater than the pivot, [gt_end, p)
+  // keys equal to it, and [lt_begin, end) keys less than it.
+  Sort_iterator gt_end = begin;
+  Sort_iterator lt_begin = end;
+  Sort_iterator p = begin;
+  while (p < lt_begin)
+    {
+      Sort_key k = sort_key(*p, depth);
+      if (k > pivot)
+	{
+	  std::iter_swap(p, gt_end);
+	  ++gt_end;
+	  ++p;
+	}
+      else if (k < pivot)
+	{
+	  --lt_begin;
+	  std::iter_swap(p, lt_begin);
+	}
+      else
+	++p;
+    }
+
+  *peq_begin = gt_end;
+  *plt_begin = lt_begin;
+  return pivot;
+}
+
+// Sort the strings from BEGIN to END into the order required by
+// Stringpool_sort_comparison.  All the strings agree in their last
+// DEPTH characters.  This is a multikey quicksort, a radix sort on
+// the reversed strings: each pass partitions on one character from
+// the end, working towards the start of the strings, and strings
+// which run out of characters sort after the longer strings of which
+// they are a suffix.  Since the strings are unique the order is
+// total, and the result is the same as sorting with the comparison.
+
+template<typename Stringpool_char>
+void
+Stringpool_template<Stringpool_char>::sort_strings(Sort_iterator begin,
+						   Sort_iterator end,
+						   size_t depth)
+{
+  // Below this size a comparison sort is faster.
+  const ptrdiff_t small_sort_size = 16;
+
+  while (end - begin > small_sort_size)
+    {
+      Sort_iterator eq_begin;
+      Sort_iterator lt_begin;
+      Sort_key pivot = partition_strings(begin, end, depth, &eq_begin,
+					 &lt_begin);
+      sort_strings(begin, eq_begin, depth);
+      sort_strings(lt_begin, end, depth);
+
+      // At most one string can end here.
+      if (pivot == sort_key_end)
+	return;
+
+      begin = eq_begin;
+      end = lt_begin;
+      ++depth;
+    }
+
+  if (end - begin > 1)
+    std::sort(begin, end, Stringpool_sort_comparison());
+}
+
+// A Sort_task sorts one part of the strings of a pool.  A large part
+// is partitioned on one character, and the partitions are sorted by
+// new tasks.
+
+template<typename Stringpool_char>
+class Stringpool_template<Stringpool_char>::Sort_task : public Task
+{
+ public:
+  Sort_task(Sort_iterator begin, Sort_iterator end, size_t depth,
+	    Task_token* final_blocker)
+    : begin_(begin), end_(end), depth_(depth), final_blocker_(final_blocker)
+  { }
+
+  void
+  run(Workqueue*);
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  // Unblock FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->final_blocker_); }
+
+  std::string
+  get_name() const
+  { return "Stringpool_template::Sort_task"; }
+
+ private:
+  // Queue a task to sort the strings from BEGIN to END.  This is
+  // done while this task still holds FINAL_BLOCKER_, so the blocker
+  // is not released before the new task runs.
+  void
+  queue(Workqueue* workqueue, Sort_iterator begin, Sort_iterator end,
+	size_t depth)
+  {
+    if (end - begin <= 1)
+      return;
+    workqueue->add_blocker(this->final_blocker_);
+    workqueue->queue(new Sort_task(begin, end, depth, this->final_blocker_));
+  }
+
+  const Sort_iterator begin_;
+  const Sort_iterator end_;
+  const size_t depth_;
+  Task_token* const final_blocker_;
+};
+
+template<typename Stringpool_char>
+void
+Stringpool_template<Stringpool_char>::Sort_task::run(Workqueue* workqueue)
+{
+  // Parts smaller than this are not worth splitting further.
+  const ptrdiff_t task_sort_size = 32768;
+
+  if (this->end_ - this->begin_ <= task_sort_size)
+    {
+      sort_strings(this->begin_, this->end_, this->depth_);
+      return;
+    }
+
+  Sort_iterator eq_begin;
+  Sort_iterator lt_begin;
+  Sort_key pivot = partition_strings(this->begin_, this->end_, this->depth_,
+				     &eq_begin, &lt_begin);
+  this->queue(workqueue, this->begin_, eq_begin, this->depth_);
+  this->queue(workqueue, lt_begin, this->end_, this->depth_);
+  if (pivot != sort_key_end)
+    this->queue(workqueue, eq_begin, lt_begin, this->depth_ + 1);
+}
+
+// Fill sort_vector_ with all the strings of the pool.
+
+template<typename Stringpool_char>
+void
+Stringpool_template<Stringpool_char>::collect_strings_to_sort()
+{
+  this->sort_vector_.clear();
+  this->sort_vector_.reserve(this->string_count());
+  for (typename Shards::iterator ps = this->shards_.begin();
+       ps != this->shards_.end();
+       ++ps)
+    for (typename String_set_type::iterator p = ps->string_set.begin();
+	 p != ps->string_set.end();
+	 ++p)
+      this->sort_vector_.push_back(Stringpool_sort_info(p));
+}
+
+// Queue tasks which sort the strings of an optimized pool, so that
+// set_string_offsets only has to do the final pass over them.
+
+template<typename Stringpool_char>
+void
+Stringpool_template<Stringpool_char>::queue_sort_tasks(Workqueue* workqueue,
+						       Task_token* blocker)
+{
+  if (!this->optimize_ || this->strtab_size_ != 0 || this->strings_sorted_)
+    return;
+
+  this->collect_strings_to_sort();
+  this->strings_sorted_ = true;
+  if (this->sort_vector_.size() <= 1)
+    return;
+
+  blocker->add_blocker();
+  workqueue->queue(new Sort_task(this->sort_vector_.begin(),
+				 this->sort_vector_.end(), 0, blocker));
+}
+
 // Turn the stringpool into an ELF strtab: determine the offsets of
 // each string in the table.
 
@@ -394,22 +730,23 @@ Stringpool_template<Stringpool_char>::set_string_offsets()
   // take the time to sort when the user asks for heavy optimization.
   if (!this->optimize_)
     {
-      // If we are not optimizing, the offsets are already assigned.
-      offset = this->offset_;
+      // If we are not optimizing, the offsets are already assigned,
+      // unless strings were added concurrently.
+      if (this->shard_bits_ == 0)
+	offset = this->offset_;
+      else
+	offset = this->set_concurrent_string_offsets(offset);
     }
   else
     {
-      size_t count = this->string_set_.size();
-
-      std::vector<Stringpool_sort_info> v;
-      v.reserve(count);
-
-      for (typename String_set_type::iterator p = this->string_set_.begin();
-           p != this->string_set_.end();
-           ++p)
-        v.push_back(Stringpool_sort_info(p));
-
-      std::sort(v.begin(), v.end(), Stringpool_sort_comparison());
+      // The strings may already have been sorted by Sort_tasks.
+      if (!this->strings_sorted_)
+	{
+	  this->collect_strings_to_sort();
+	  sort_strings(this->sort_vector_.begin(), this->sort_vector_.end(),
+		       0);
+	}
+      Sort_vector& v(this->sort_vector_);
 
       section_offset_type last_offset = -1;
       for (typename std::vector<Stringpool_sort_info>::iterator last = v.end(),
@@ -435,14 +772,60 @@ Stringpool_template<Stringpool_char>::set_string_offsets()
               this_offset = align_address(offset, this->addralign_);
               offset = this_offset + ((*curr)->first.length + 1) * charsize;
             }
-	  this->key_to_offset_[(*curr)->second - 1] = this_offset;
+	  this->set_key_offset((*curr)->second, this_offset);
 	  last_offset = this_offset;
         }
+
+      // Release the memory.
+      Sort_vector().swap(this->sort_vector_);
     }
 
   this->strtab_size_ = offset;
 }
 
+// Assign string table offsets to the strings of a concurrent pool,
+// starting at OFFSET, and return the offset following the last
+// string.  The strings are laid out in the order of their positions,
+// which is the order in which a serial link adds them, so the string
+// table is the same as if the pool had not been concurrent.
+
+template<typename Stringpool_char>
+section_offset_type
+Stringpool_template<Stringpool_char>::set_concurrent_string_offsets(
+    section_offset_type offset)
+{
+  std::vector<Position_info> v;
+  v.reserve(this->string_count());
+  for (typename Shards::iterator ps = this->shards_.begin();
+       ps != this->shards_.end();
+       ++ps)
+    for (typename String_set_type::iterator p = ps->string_set.begin();
+	 p != ps->string_set.end();
+	 ++p)
+      v.push_back(Position_info(ps->key_to_offset[(p->second - 1)
+						  >> this->shard_bits_],
+				p));
+
+  std::sort(v.begin(), v.end(), Stringpool_position_comparison());
+
+  for (typename std::vector<Position_info>::const_iterator p = v.begin();
+       p != v.end();
+       ++p)
+    {
+      const size_t length = p->second->first.length;
+      section_offset_type this_offset;
+      if (this->zero_null_ && length == 0)
+	this_offset = 0;
+      else
+	{
+	  this_offset = align_address(offset, this->addralign_);
+	  offset = this_offset + (length + 1) * sizeof(Stringpool_char);
+	}
+      this->set_key_offset(p->second->second, this_offset);
+    }
+  return offset;
+}
+
 // Get the offset of a string in the ELF strtab.  The string must
 // exist.
 
@@ -462,9 +845,10 @@ Stringpool_template<Stringpool_char>::get_offset_with_length(
 {
   gold_assert(this->strtab_size_ != 0);
   Hashkey hk(s, length);
-  typename String_set_type::const_iterator p = this->string_set_.find(hk);
-  if (p != this->string_set_.end())
-    return this->key_to_offset_[p->second - 1];
+  const Shard& shard(this->shards_[this->shard_index(hk.hash_code)]);
+  typename String_set_type::const_iterator p = shard.string_set.find(hk);
+  if (p != shard.string_set.end())
+    return this->get_offset_from_key(p->second);
   gold_unreachable();
 }
 
@@ -480,15 +864,22 @@ Stringpool_template<Stringpool_char>::write_to_buffer(
   gold_assert(bufsize >= this->strtab_size_);
   if (this->zero_null_)
     buffer[0] = '\0';
-  for (typename String_set_type::const_iterator p = this->string_set_.begin();
-       p != this->string_set_.end();
-       ++p)
+  for (typename Shards::const_iterator ps = this->shards_.begin();
+       ps != this->shards_.end();
+       ++ps)
     {
-      const int len = (p->first.length + 1) * sizeof(Stringpool_char);
-      const section_offset_type offset = this->key_to_offset_[p->second - 1];
-      gold_assert(static_cast<section_size_type>(offset) + len
-		  <= this->strtab_size_);
-      memcpy(buffer + offset, p->first.string, len);
+      for (typename String_set_type::const_iterator p =
+	     ps->string_set.begin();
+	   p != ps->string_set.end();
+	   ++p)
+	{
+	  const int len = (p->first.length + 1) * sizeof(Stringpool_char);
+	  const section_offset_type offset =
+	    this->get_offset_from_key(p->second);
+	  gold_assert(static_cast<section_size_type>(offset) + len
+		      <= this->strtab_size_);
+	  memcpy(buffer + offset, p->first.string, len);
+	}
     }
 }
 
@@ -510,16 +901,30 @@ template<typename Stringpool_char>
 void
 Stringpool_template<Stringpool_char>::print_stats(const char* name) const
 {
+  size_t buckets = 0;
+  size_t stringdata = 0;
+  for (typename Shards::const_iterator p = this->shards_.begin();
+       p != this->shards_.end();
+       ++p)
+    {
+#if defined(HAVE_UNORDERED_MAP) || defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_EXT_HASH_MAP)
+      buckets += p->string_set.bucket_count();
+#endif
+      stringdata += p->strings.size();
+    }
+
 #if defined(HAVE_UNORDERED_MAP) || defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_EXT_HASH_MAP)
   fprintf(stderr, _("%s: %s entries: %zu; buckets: %zu\n"),
-	  program_name, name, this->string_set_.size(),
-	  this->string_set_.bucket_count());
+	  program_name, name, this->string_count(), buckets);
 #else
   fprintf(stderr, _("%s: %s entries: %zu\n"),
-	  program_name, name, this->table_.size());
+	  program_name, name, this->string_count());
 #endif
   fprintf(stderr, _("%s: %s Stringdata structures: %zu\n"),
-	  program_name, name, this->strings_.size());
+	  program_name, name, stringdata);
+  if (this->shard_bits_ != 0)
+    fprintf(stderr, _("%s: %s shards: %zu\n"),
+	    program_name, name, this->shards_.size());
 }
 
 // Instantiate the templates we need.
@@ -31,6 +31,9 @@ namespace gold
 {
 
 class Output_file;
+class Lock;
+class Workqueue;
+class Task_token;
 
 // Return the length of a string in units of Char_type.
 
@@ -89,6 +92,17 @@ string_length(const char* p)
 // string "abc" will be stored, and "bc" will be represented by an
 // offset into the middle of the string "abc".
 
+// A Stringpool may be made concurrent, in which case strings may be
+// added to it from several threads at once.  The strings are then
+// split across a number of shards chosen by hash code, each with its
+// own hash table and lock.  A key is still unique to its string, but
+// since the order of insertions is no longer fixed the key value may
+// differ from one run to the next.  Instead each string records its
+// position in the order in which a serial link would have added it.
+// The string table offsets are assigned when the string table is
+// built, in that order, so that the string table is the same as the
+// one built by a serial link.
+
 
 // A simple chunked vector class--this is a subset of std::vector
 // which stores memory in chunks.  We don't provide iterators, because
@@ -200,7 +214,7 @@ class Stringpool_template
   void
   set_no_zero_null()
   {
-    gold_assert(this->string_set_.empty()
+    gold_assert(this->string_count() == 0
 		&& this->offset_ == sizeof(Stringpool_char));
     this->zero_null_ = false;
     this->offset_ = 0;
@@ -212,6 +226,33 @@ class Stringpool_template
   set_optimize()
   { this->optimize_ = true; }
 
+  // Permit strings to be added to this pool by several threads at
+  // once.  This must be called before any strings are added.  It
+  // should only be used for pools whose key values are not used to
+  // order any output.
+  void
+  set_concurrent();
+
+  // Reserve COUNT positions in the order of addition of a concurrent
+  // pool, following the strings added so far.  Strings added with
+  // add_at_position until the next call are laid out as if they had
+  // been added in the order of their position, whichever thread adds
+  // them first.  This does nothing for a pool which is not concurrent.
+  void
+  reserve_positions(size_t count);
+
+  // Add the string S to the pool at POSITION, which must be less than
+  // the count passed to the last call to reserve_positions.  If the
+  // pool is not concurrent, this is the same as add.
+  const Stringpool_char*
+  add_at_position(const Stringpool_char* s, size_t position, bool copy,
+		  Key* pkey);
+
+  // Whether strings may be added concurrently.
+  bool
+  is_concurrent() const
+  { return this->shard_bits_ != 0; }
+
   // Add the string S to the pool.  This returns a canonical permanent
   // pointer to the string in the pool.  If COPY is true, the string
   // is copied into permanent storage.  If PKEY is not NULL, this sets
@@ -227,7 +268,25 @@ class Stringpool_template
   // Add string S of length LEN characters to the pool.  If COPY is
   // true, S need not be null terminated.
   const Stringpool_char*
-  add_with_length(const Stringpool_char* s, size_t len, bool copy, Key* pkey);
+  add_with_length(const Stringpool_char* s, size_t len, bool copy, Key* pkey)
+  {
+    return this->add_with_length_and_hash(s, len, string_hash(s, len), copy,
+					  pkey);
+  }
+
+  // Add string S of length LEN characters to the pool, where
+  // HASH_CODE is the value returned by hash_string for S and LEN.
+  // This lets callers compute hash codes ahead of time, perhaps in
+  // another thread.
+  const Stringpool_char*
+  add_with_length_and_hash(const Stringpool_char* s, size_t len,
+			   size_t hash_code, bool copy, Key* pkey);
+
+  // Return the hash code which this pool will use for string S of
+  // length LEN characters.
+  static size_t
+  hash_string(const Stringpool_char* s, size_t len)
+  { return string_hash(s, len); }
 
   // If the string S is present in the pool, return the canonical
   // string pointer.  Otherwise, return NULL.  If PKEY is not NULL,
@@ -241,6 +300,13 @@ class Stringpool_template
   void
   set_string_offsets();
 
+  // If this pool is optimized, queue tasks on WORKQUEUE which sort
+  // the strings for set_string_offsets, and which unblock BLOCKER
+  // when done.  After this is called, no more strings may be added
+  // to the stringpool.
+  void
+  queue_sort_tasks(Workqueue*, Task_token* blocker);
+
   // Get the offset of the string S in the string table.  This returns
   // the offset in bytes, not in units of Stringpool_char.  This may
   // only be called after set_string_offsets has been called.
@@ -261,8 +327,10 @@ class Stringpool_template
   section_offset_type
   get_offset_from_key(Key k) const
   {
-    gold_assert(k <= this->key_to_offset_.size());
-    return this->key_to_offset_[k - 1];
+    const Shard& shard(this->shards_[(k - 1) & this->shard_mask()]);
+    const size_t index = (k - 1) >> this->shard_bits_;
+    gold_assert(index < shard.key_to_offset.size());
+    return shard.key_to_offset[index];
   }
 
   // Get the size of the string table.  This returns the number of
@@ -313,13 +381,23 @@ class Stringpool_template
     char data[1];
   };
 
-  // Add a new key offset entry.
+  struct Shard;
+
+  // Add a new key offset entry to SHARD for a string of LENGTH
+  // characters added at POSITION.
   void
-  new_key_offset(size_t);
+  new_key_offset(Shard*, size_t length, section_offset_type position);
+
+  // Add a string at POSITION in the order of addition of a
+  // concurrent pool, or at the next position if POSITION is -1.
+  const Stringpool_char*
+  add_with_position(const Stringpool_char* s, size_t len, size_t hash_code,
+		    section_offset_type position, bool copy, Key* pkey);
 
-  // Copy a string into the buffers, returning a canonical string.
+  // Copy a string into the buffers of SHARD, returning a canonical
+  // string.
   const Stringpool_char*
-  add_string(const Stringpool_char*, size_t);
+  add_string(Shard*, const Stringpool_char*, size_t);
 
   // Return whether s1 is a suffix of s2.
   static bool
@@ -353,6 +431,10 @@ class Stringpool_template
     Hashkey(const Stringpool_char* s, size_t len)
       : string(s), length(len), hash_code(string_hash(s, len))
     { }
+
+    Hashkey(const Stringpool_char* s, size_t len, size_t hash)
+      : string(s), length(len), hash_code(hash)
+    { }
   };
 
   // Hash function.  This is trivial, since we have already computed
@@ -388,6 +470,56 @@ class Stringpool_template
     operator()(const Stringpool_sort_info&, const Stringpool_sort_info&) const;
   };
 
+  // The strings sorted into string table order, and an iterator into
+  // them.
+  typedef std::vector<Stringpool_sort_info> Sort_vector;
+  typedef typename Sort_vector::iterator Sort_iterator;
+
+  // The sort key of a string at a given depth: a character of the
+  // string counting from its end, or sort_key_end past its start.
+  typedef int64_t Sort_key;
+  static const Sort_key sort_key_end = INT64_MIN;
+
+  // A task which sorts part of sort_vector_.
+  class Sort_task;
+
+  // Return the sort key of the string of SORT_INFO at DEPTH.
+  static Sort_key
+  sort_key(const Stringpool_sort_info& sort_info, size_t depth)
+  {
+    const Hashkey& hk(sort_info->first);
+    if (depth >= hk.length)
+      return sort_key_end;
+    return static_cast<Sort_key>(hk.string[hk.length - 1 - depth]);
+  }
+
+  // Partition the strings from BEGIN to END, which agree in their
+  // last DEPTH characters, on their sort key at DEPTH.
+  static Sort_key
+  partition_strings(Sort_iterator begin, Sort_iterator end, size_t depth,
+		    Sort_iterator* peq_begin, Sort_iterator* plt_begin);
+
+  // Sort the strings from BEGIN to END, which agree in their last
+  // DEPTH characters, into string table order.
+  static void
+  sort_strings(Sort_iterator begin, Sort_iterator end, size_t depth);
+
+  // Fill sort_vector_ with the strings of the pool.
+  void
+  collect_strings_to_sort();
+
+  // A string of a concurrent pool and its position.
+  typedef std::pair<section_offset_type, Stringpool_sort_info> Position_info;
+
+  // Comparison routine used to lay out the strings of a concurrent
+  // pool in the order of their positions, which are unique.
+  struct Stringpool_position_comparison
+  {
+    bool
+    operator()(const Position_info& p1, const Position_info& p2) const
+    { return p1.first < p2.first; }
+  };
+
   // Keys map to offsets via a Chunked_vector.  We only use the
   // offsets if we turn this into an string table section.
   typedef Chunked_vector<section_offset_type> Key_to_offset;
@@ -395,12 +527,88 @@ class Stringpool_template
   // List of Stringdata structures.
   typedef std::list<Stringdata*> Stringdata_list;
 
-  // Mapping from const char* to namepool entry.
-  String_set_type string_set_;
-  // Mapping from Key to string table offset.
-  Key_to_offset key_to_offset_;
-  // List of buffers.
-  Stringdata_list strings_;
+  // The strings of the pool, or of one shard of a concurrent pool.
+  struct Shard
+  {
+    Shard()
+      : string_set(), key_to_offset(), strings(), lock(NULL)
+    { }
+
+    // Mapping from const char* to namepool entry.
+    String_set_type string_set;
+    // Mapping from the index part of a Key to string table offset.
+    // In a concurrent pool this holds the position of the string in
+    // the order of addition until set_string_offsets is called.
+    Key_to_offset key_to_offset;
+    // List of buffers.
+    Stringdata_list strings;
+    // Lock held while adding strings; NULL if not concurrent.
+    Lock* lock;
+  };
+
+  typedef std::vector<Shard> Shards;
+
+  // The number of shards of a concurrent pool, as a power of two.
+  // The low bits of a key, less one, select the shard, and the
+  // remaining bits are the index of the string within the shard.
+  static const unsigned int concurrent_shard_bits = 6;
+
+  // The mask of the shard bits of a key.
+  size_t
+  shard_mask() const
+  { return (static_cast<size_t>(1) << this->shard_bits_) - 1; }
+
+  // Return the index of the shard for a string with hash code
+  // HASH_CODE.  The string hash keeps little entropy in its high bits
+  // for short strings, so mix it first.
+  size_t
+  shard_index(size_t hash_code) const
+  {
+    if (this->shard_bits_ == 0)
+      return 0;
+    const size_t mult = static_cast<size_t>(0x9e3779b97f4a7c15ULL);
+    return (hash_code * mult) >> (sizeof(size_t) * 8 - this->shard_bits_);
+  }
+
+  // Return the number of strings in the pool.
+  size_t
+  string_count() const;
+
+  // Set the string table offset of the string with key K.
+  void
+  set_key_offset(Key k, section_offset_type offset)
+  {
+    Shard& shard(this->shards_[(k - 1) & this->shard_mask()]);
+    shard.key_to_offset[(k - 1) >> this->shard_bits_] = offset;
+  }
+
+  // In a concurrent pool, move the string with key K in SHARD to
+  // POSITION if that comes before its current position.
+  void
+  move_to_position(Shard* shard, Key k, section_offset_type position)
+  {
+    if (this->shard_bits_ == 0 || position < 0)
+      return;
+    section_offset_type& current(
+	shard->key_to_offset[(k - 1) >> this->shard_bits_]);
+    if (position < current)
+      current = position;
+  }
+
+  // Assign offsets to the strings of a concurrent pool in the order
+  // of their positions.
+  section_offset_type
+  set_concurrent_string_offsets(section_offset_type);
+
+  // The shards holding the strings; there is only one unless the
+  // pool is concurrent.
+  Shards shards_;
+  // The number of shard bits in a key; zero if not concurrent.
+  unsigned int shard_bits_;
+  // The strings in string table order, when optimizing.
+  Sort_vector sort_vector_;
+  // Whether sort_vector_ has been filled by queue_sort_tasks.
+  bool strings_sorted_;
   // Size of string table.
   section_size_type strtab_size_;
   // Whether to reserve offset 0 to hold the null string.
@@ -411,6 +619,12 @@ class Stringpool_template
   section_offset_type offset_;
   // The alignment of strings in the stringpool.
   uint64_t addralign_;
+  // In a concurrent pool, the position of the next string added
+  // without a reserved position, the first position reserved by
+  // reserve_positions, and the lock which protects them.
+  section_offset_type next_position_;
+  section_offset_type reserved_position_;
+  Lock* position_lock_;
 };
 
 // The most common type of Stringpool.
@@ -470,6 +470,75 @@ relocate_section(
     }
 }
 
+// A batch of relocations which have been resolved to a value to store
+// at an offset in the section view, and which need no further
+// processing.  A target can use this for runs of simple absolute
+// relocations, to avoid the per-relocation work of relocate_section.
+// The values are kept in target byte order, so that values at
+// adjacent offsets, as in a vtable or .init_array, are stored with a
+// single block copy.  VALSIZE is the size of each value in bits.
+
+template<int valsize, bool big_endian>
+class Resolved_reloc_batch
+{
+ public:
+  typedef typename elfcpp::Swap<valsize, big_endian>::Valtype Valtype;
+
+  Resolved_reloc_batch()
+    : offsets_(), values_()
+  { }
+
+  // Add a relocation storing VALUE at OFFSET in the view.
+  void
+  add(section_size_type offset, Valtype value)
+  {
+    size_t n = this->values_.size();
+    this->offsets_.push_back(offset);
+    this->values_.resize(n + value_size);
+    elfcpp::Swap_unaligned<valsize, big_endian>::writeval(&this->values_[n],
+							  value);
+  }
+
+  // Return the number of relocations in the batch.
+  size_t
+  size() const
+  { return this->offsets_.size(); }
+
+  // Remove all the relocations, keeping the allocated memory.
+  void
+  clear()
+  {
+    this->offsets_.clear();
+    this->values_.clear();
+  }
+
+  // Store the values into VIEW.
+  void
+  apply(unsigned char* view) const
+  {
+    size_t count = this->offsets_.size();
+    size_t i = 0;
+    while (i < count)
+      {
+	size_t j = i + 1;
+	while (j < count
+	       && this->offsets_[j] == this->offsets_[j - 1] + value_size)
+	  ++j;
+	memcpy(view + this->offsets_[i], &this->values_[i * value_size],
+	       (j - i) * value_size);
+	i = j;
+      }
+  }
+
+ private:
+  static const int value_size = valsize / 8;
+
+  // The offsets in the view.
+  std::vector<section_size_type> offsets_;
+  // The values, in target byte order.
+  std::vector<unsigned char> values_;
+};
+
 // Apply an incremental relocation.
 
 template<int size, bool big_endian, typename Target_type,
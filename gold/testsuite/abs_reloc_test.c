@@ -0,0 +1,116 @@
+/* abs_reloc_test.c -- test absolute relocations in data sections.
+
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* The x86_64 target applies runs of absolute relocations against
+   local symbols as a batch.  This test builds a large table of such
+   relocations, with runs broken up by relocations against global
+   symbols, and checks that every entry is resolved correctly.  The
+   large table also makes this a convenient test case for timing the
+   relocation of data sections.  */
+
+#include <assert.h>
+#include <stddef.h>
+
+#define TABLE_SIZE 4096
+
+static int data[TABLE_SIZE];
+
+#define E1(i) &data[i],
+#define E4(i) E1(i) E1(i + 1) E1(i + 2) E1(i + 3)
+#define E16(i) E4(i) E4(i + 4) E4(i + 8) E4(i + 12)
+#define E64(i) E16(i) E16(i + 16) E16(i + 32) E16(i + 48)
+#define E256(i) E64(i) E64(i + 64) E64(i + 128) E64(i + 192)
+#define E1024(i) E256(i) E256(i + 256) E256(i + 512) E256(i + 768)
+
+/* All relocations against the local symbol DATA.  */
+
+static int * const table[TABLE_SIZE] =
+{
+  E1024(0) E1024(1024) E1024(2048) E1024(3072)
+};
+
+int global_data[4];
+
+/* Runs of local relocations of various lengths, separated by
+   relocations against a global symbol.  */
+
+static int * const mixed[] =
+{
+  &data[0], &global_data[0],
+  &data[1], &data[2], &global_data[1],
+  &data[3], &data[4], &data[5], &global_data[2],
+  &data[6], &data[7], &data[8], &data[9], &global_data[3],
+  &data[10], &data[11], &data[12], &data[13], &data[14],
+  &global_data[0], &data[15], &data[16], &data[17], &data[18]
+};
+
+/* The entries of MIXED: an index into DATA, or -1 - an index into
+   GLOBAL_DATA.  */
+
+static const int mixed_index[] =
+{
+  0, -1,
+  1, 2, -2,
+  3, 4, 5, -3,
+  6, 7, 8, 9, -4,
+  10, 11, 12, 13, 14,
+  -1, 15, 16, 17, 18
+};
+
+/* Absolute relocations against local functions in .init_array.  */
+
+static int ctor_count;
+
+static void ctor1 (void) __attribute__ ((constructor));
+static void ctor2 (void) __attribute__ ((constructor));
+static void ctor3 (void) __attribute__ ((constructor));
+static void ctor4 (void) __attribute__ ((constructor));
+static void ctor5 (void) __attribute__ ((constructor));
+
+static void ctor1 (void) { ++ctor_count; }
+static void ctor2 (void) { ++ctor_count; }
+static void ctor3 (void) { ++ctor_count; }
+static void ctor4 (void) { ++ctor_count; }
+static void ctor5 (void) { ++ctor_count; }
+
+int
+main (void)
+{
+  size_t i;
+
+  for (i = 0; i < TABLE_SIZE; ++i)
+    assert (table[i] == data + i);
+
+  assert (sizeof mixed / sizeof mixed[0]
+	  == sizeof mixed_index / sizeof mixed_index[0]);
+  for (i = 0; i < sizeof mixed / sizeof mixed[0]; ++i)
+    {
+      int index = mixed_index[i];
+      if (index >= 0)
+	assert (mixed[i] == data + index);
+      else
+	assert (mixed[i] == global_data + (-1 - index));
+    }
+
+  assert (ctor_count == 5);
+
+  return 0;
+}
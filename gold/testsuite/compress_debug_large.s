@@ -0,0 +1,10 @@
+	.text
+	.globl _start
+_start:
+
+	.section .debug_large,"",%progbits
+	x = 1
+	.rept 400000
+	x = (x * 1103515245 + 12345) & 0x7fffffff
+	.long x >> 16
+	.endr
@@ -0,0 +1,396 @@
+	.file	"gdb_index_test_3.c"
+	.text
+.Ltext0:
+	.file 0 "/root/repo/gold/testsuite" "gdb_index_test_3.c"
+	.globl	j
+	.bss
+	.align 4
+	.type	j, @object
+	.size	j, 4
+j:
+	.zero	4
+	.text
+	.globl	check_int
+	.type	check_int, @function
+check_int:
+.LFB0:
+	.file 1 "gdb_index_test_3.c"
+	.loc 1 33 1
+	.cfi_startproc
+	pushq	%rbp
+	.cfi_def_cfa_offset 16
+	.cfi_offset 6, -16
+	movq	%rsp, %rbp
+	.cfi_def_cfa_register 6
+	movl	%edi, -4(%rbp)
+	.loc 1 33 12
+	cmpl	$0, -4(%rbp)
+	setg	%al
+	movzbl	%al, %eax
+	.loc 1 33 17
+	popq	%rbp
+	.cfi_def_cfa 7, 8
+	ret
+	.cfi_endproc
+.LFE0:
+	.size	check_int, .-check_int
+	.globl	main
+	.type	main, @function
+main:
+.LFB1:
+	.loc 1 37 1
+	.cfi_startproc
+	pushq	%rbp
+	.cfi_def_cfa_offset 16
+	.cfi_offset 6, -16
+	movq	%rsp, %rbp
+	.cfi_def_cfa_register 6
+	.loc 1 38 10
+	movl	$0, %edi
+	call	check_int
+	.loc 1 39 1
+	popq	%rbp
+	.cfi_def_cfa 7, 8
+	ret
+	.cfi_endproc
+.LFE1:
+	.size	main, .-main
+.Letext0:
+	.section	.debug_addr,"",@progbits
+	.long	0x1c
+	.value	0x5
+	.byte	0x8
+	.byte	0
+.Ldebug_addr0:
+	.quad	j
+	.quad	.LFB0
+	.quad	.LFB1
+	.section	.debug_info.dwo,"e",@progbits
+.Ldebug_info0:
+	.long	0x60
+	.value	0x5
+	.byte	0x5
+	.byte	0x8
+	.long	.Ldebug_abbrev0
+	.byte	0x8f
+	.byte	0x8b
+	.byte	0xe6
+	.byte	0x11
+	.byte	0xfe
+	.byte	0x89
+	.byte	0x24
+	.byte	0x60
+	.uleb128 0x1
+	.uleb128 0
+	.byte	0x1d
+	.uleb128 0x1
+	.uleb128 0x2
+	.uleb128 0x2
+	.string	"j"
+	.byte	0x1
+	.byte	0x1d
+	.byte	0x5
+	.long	0x26
+	.uleb128 0x2
+	.byte	0xa1
+	.uleb128 0
+	.uleb128 0x3
+	.byte	0x4
+	.byte	0x5
+	.string	"int"
+	.uleb128 0x4
+	.uleb128 0x4
+	.byte	0x1
+	.byte	0x24
+	.byte	0x1
+	.long	0x26
+	.uleb128 0x2
+	.quad	.LFE1-.LFB1
+	.uleb128 0x1
+	.byte	0x9c
+	.uleb128 0x5
+	.uleb128 0x3
+	.byte	0x1
+	.byte	0x20
+	.byte	0x1
+	.long	0x26
+	.uleb128 0x1
+	.quad	.LFE0-.LFB0
+	.uleb128 0x1
+	.byte	0x9c
+	.uleb128 0x6
+	.string	"i"
+	.byte	0x1
+	.byte	0x20
+	.byte	0x10
+	.long	0x26
+	.uleb128 0x2
+	.byte	0x91
+	.sleb128 -20
+	.byte	0
+	.byte	0
+	.section	.debug_info,"",@progbits
+.Lskeleton_debug_info0:
+	.long	0x31
+	.value	0x5
+	.byte	0x4
+	.byte	0x8
+	.long	.Lskeleton_debug_abbrev0
+	.byte	0x8f
+	.byte	0x8b
+	.byte	0xe6
+	.byte	0x11
+	.byte	0xfe
+	.byte	0x89
+	.byte	0x24
+	.byte	0x60
+	.uleb128 0x1
+	.quad	.Ltext0
+	.quad	.Letext0-.Ltext0
+	.long	.Ldebug_line0
+	.long	.LASF0
+	.long	.LASF1
+	.long	.Ldebug_addr0
+	.section	.debug_abbrev,"",@progbits
+.Lskeleton_debug_abbrev0:
+	.uleb128 0x1
+	.uleb128 0x4a
+	.byte	0
+	.uleb128 0x11
+	.uleb128 0x1
+	.uleb128 0x12
+	.uleb128 0x7
+	.uleb128 0x10
+	.uleb128 0x17
+	.uleb128 0x76
+	.uleb128 0xe
+	.uleb128 0x1b
+	.uleb128 0xe
+	.uleb128 0x2134
+	.uleb128 0x19
+	.uleb128 0x73
+	.uleb128 0x17
+	.byte	0
+	.byte	0
+	.byte	0
+	.section	.debug_abbrev.dwo,"e",@progbits
+.Ldebug_abbrev0:
+	.uleb128 0x1
+	.uleb128 0x11
+	.byte	0x1
+	.uleb128 0x25
+	.uleb128 0x1a
+	.uleb128 0x13
+	.uleb128 0xb
+	.uleb128 0x3
+	.uleb128 0x1a
+	.uleb128 0x1b
+	.uleb128 0x1a
+	.byte	0
+	.byte	0
+	.uleb128 0x2
+	.uleb128 0x34
+	.byte	0
+	.uleb128 0x3
+	.uleb128 0x8
+	.uleb128 0x3a
+	.uleb128 0xb
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x49
+	.uleb128 0x13
+	.uleb128 0x3f
+	.uleb128 0x19
+	.uleb128 0x2
+	.uleb128 0x18
+	.byte	0
+	.byte	0
+	.uleb128 0x3
+	.uleb128 0x24
+	.byte	0
+	.uleb128 0xb
+	.uleb128 0xb
+	.uleb128 0x3e
+	.uleb128 0xb
+	.uleb128 0x3
+	.uleb128 0x8
+	.byte	0
+	.byte	0
+	.uleb128 0x4
+	.uleb128 0x2e
+	.byte	0
+	.uleb128 0x3f
+	.uleb128 0x19
+	.uleb128 0x3
+	.uleb128 0x1a
+	.uleb128 0x3a
+	.uleb128 0xb
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x27
+	.uleb128 0x19
+	.uleb128 0x49
+	.uleb128 0x13
+	.uleb128 0x11
+	.uleb128 0x1b
+	.uleb128 0x12
+	.uleb128 0x7
+	.uleb128 0x40
+	.uleb128 0x18
+	.uleb128 0x7c
+	.uleb128 0x19
+	.byte	0
+	.byte	0
+	.uleb128 0x5
+	.uleb128 0x2e
+	.byte	0x1
+	.uleb128 0x3f
+	.uleb128 0x19
+	.uleb128 0x3
+	.uleb128 0x1a
+	.uleb128 0x3a
+	.uleb128 0xb
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x27
+	.uleb128 0x19
+	.uleb128 0x49
+	.uleb128 0x13
+	.uleb128 0x11
+	.uleb128 0x1b
+	.uleb128 0x12
+	.uleb128 0x7
+	.uleb128 0x40
+	.uleb128 0x18
+	.uleb128 0x7a
+	.uleb128 0x19
+	.byte	0
+	.byte	0
+	.uleb128 0x6
+	.uleb128 0x5
+	.byte	0
+	.uleb128 0x3
+	.uleb128 0x8
+	.uleb128 0x3a
+	.uleb128 0xb
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x49
+	.uleb128 0x13
+	.uleb128 0x2
+	.uleb128 0x18
+	.byte	0
+	.byte	0
+	.byte	0
+	.section	.debug_gnu_pubnames,"",@progbits
+	.long	0x2e
+	.value	0x2
+	.long	.Lskeleton_debug_info0
+	.long	0x64
+	.long	0x19
+	.byte	0x20
+	.string	"j"
+	.long	0x2d
+	.byte	0x30
+	.string	"main"
+	.long	0x41
+	.byte	0x30
+	.string	"check_int"
+	.long	0
+	.section	.debug_gnu_pubtypes,"",@progbits
+	.long	0x17
+	.value	0x2
+	.long	.Lskeleton_debug_info0
+	.long	0x64
+	.long	0x26
+	.byte	0x90
+	.string	"int"
+	.long	0
+	.section	.debug_aranges,"",@progbits
+	.long	0x2c
+	.value	0x2
+	.long	.Lskeleton_debug_info0
+	.byte	0x8
+	.byte	0
+	.value	0
+	.value	0
+	.quad	.Ltext0
+	.quad	.Letext0-.Ltext0
+	.quad	0
+	.quad	0
+	.section	.debug_line,"",@progbits
+.Ldebug_line0:
+	.section	.debug_line.dwo,"e",@progbits
+.Lskeleton_debug_line0:
+	.long	.LELT0-.LSLT0
+.LSLT0:
+	.value	0x5
+	.byte	0x8
+	.byte	0
+	.long	.LELTP0-.LASLTP0
+.LASLTP0:
+	.byte	0x1
+	.byte	0x1
+	.byte	0x1
+	.byte	0xf6
+	.byte	0xf2
+	.byte	0xd
+	.byte	0
+	.byte	0x1
+	.byte	0x1
+	.byte	0x1
+	.byte	0x1
+	.byte	0
+	.byte	0
+	.byte	0
+	.byte	0x1
+	.byte	0
+	.byte	0
+	.byte	0x1
+	.byte	0x1
+	.uleb128 0x1
+	.uleb128 0x8
+	.uleb128 0x1
+	.string	"/root/repo/gold/testsuite"
+	.byte	0x2
+	.uleb128 0x1
+	.uleb128 0x8
+	.uleb128 0x2
+	.uleb128 0xb
+	.uleb128 0x2
+	.string	"gdb_index_test_3.c"
+	.byte	0
+	.string	"gdb_index_test_3.c"
+	.byte	0
+.LELTP0:
+.LELT0:
+	.section	.debug_str,"MS",@progbits,1
+.LASF0:
+	.string	"gdb_index_test_5.dwo"
+.LASF1:
+	.string	"/root/repo/gold/testsuite"
+	.section	.debug_str_offsets.dwo,"e",@progbits
+	.long	0x18
+	.value	0x5
+	.value	0
+	.long	0
+	.long	0x65
+	.long	0x78
+	.long	0x92
+	.long	0x9c
+	.section	.debug_str.dwo,"e",@progbits
+	.string	"GNU C17 12.2.0 -mtune=generic -march=x86-64 -gdwarf-5 -gsplit-dwarf -O0 -fasynchronous-unwind-tables"
+	.string	"gdb_index_test_3.c"
+	.string	"/root/repo/gold/testsuite"
+	.string	"check_int"
+	.string	"main"
+	.ident	"GCC: (Debian 12.2.0-14+deb12u1) 12.2.0"
+	.section	.note.GNU-stack,"",@progbits
@@ -29,9 +29,9 @@ namespace gold
 class Condvar;
 class Task;
 
-// A list of Tasks, managed through the next_locked_ field in the
-// class Task.  We define this class here because we need it in
-// Task_token.
+// A list of Tasks, managed through the list_next_ and list_prev_
+// fields in the class Task.  Tasks may be added and removed at either
+// end.  We define this class here because we need it in Task_token.
 
 class Task_list
 {
@@ -61,6 +61,11 @@ class Task_list
   Task*
   pop_front();
 
+  // Remove the last Task on the list and return it.  Return NULL if
+  // the list is empty.
+  Task*
+  pop_back();
+
  private:
   // The start of the list.  NULL if the list is empty.
   Task* head_;
@@ -91,6 +91,10 @@ class Workqueue_threader_threadpool : public Workqueue_threader
   process(int thread_number)
   { this->get_workqueue()->process(thread_number); }
 
+  // Note that a thread has returned from process.
+  void
+  thread_exited();
+
  private:
   // This is set if we need to check the thread count.
   volatile sig_atomic_t check_thread_count_;
@@ -102,6 +106,13 @@ class Workqueue_threader_threadpool : public Workqueue_threader
   int desired_thread_count_;
   // The number of threads currently running.
   int threads_;
+  // The number of threads which have been created and have not yet
+  // returned from Workqueue::process.  This differs from threads_
+  // because threads which find no more work exit without being
+  // cancelled.
+  int live_threads_;
+  // Signalled when live_threads_ drops to zero.
+  Condvar threads_exited_;
 };
 
 } // End namespace gold.
@@ -113,12 +113,15 @@ void*
 Workqueue_thread::thread_body(void* arg)
 {
   Workqueue_thread* pwt = reinterpret_cast<Workqueue_thread*>(arg);
+  Workqueue_threader_threadpool* threadpool = pwt->threadpool_;
 
-  pwt->threadpool_->process(pwt->thread_number_);
+  threadpool->process(pwt->thread_number_);
 
   // Delete the thread object as we exit.
   delete pwt;
 
+  threadpool->thread_exited();
+
   return NULL;
 }
 
@@ -132,7 +135,9 @@ Workqueue_threader_threadpool::Workqueue_threader_threadpool(
     check_thread_count_(0),
     lock_(),
     desired_thread_count_(1),
-    threads_(1)
+    threads_(1),
+    live_threads_(0),
+    threads_exited_(this->lock_)
 {
 }
 
@@ -142,6 +147,11 @@ Workqueue_threader_threadpool::~Workqueue_threader_threadpool()
 {
   // Tell the threads to exit.
   this->get_workqueue()->set_thread_count(0);
+
+  // Wait for them, since they still use the Workqueue as they exit.
+  Hold_lock hl(this->lock_);
+  while (this->live_threads_ > 0)
+    this->threads_exited_.wait();
 }
 
 // Set the thread count.
@@ -165,12 +175,28 @@ Workqueue_threader_threadpool::set_thread_count(int thread_count)
 	{
 	  // Note that threads delete themselves when they exit, so we
 	  // don't keep pointers to them.
+	  {
+	    Hold_lock hl(this->lock_);
+	    ++this->live_threads_;
+	  }
 	  new Workqueue_thread(this, this->threads_);
 	  ++this->threads_;
 	}
     }
 }
 
+// Note that a thread has returned from process, and is no longer
+// using the Workqueue.
+
+void
+Workqueue_threader_threadpool::thread_exited()
+{
+  Hold_lock hl(this->lock_);
+  --this->live_threads_;
+  if (this->live_threads_ == 0)
+    this->threads_exited_.broadcast();
+}
+
 // Return whether the current thread should be cancelled.
 
 bool
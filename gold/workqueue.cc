@@ -38,7 +38,7 @@ namespace gold
 inline void
 Task_list::push_back(Task* t)
 {
-  gold_assert(t->list_next() == NULL);
+  gold_assert(t->list_next() == NULL && t->list_prev() == NULL);
   if (this->head_ == NULL)
     {
       this->head_ = t;
@@ -47,6 +47,7 @@ Task_list::push_back(Task* t)
   else
     {
       this->tail_->set_list_next(t);
+      t->set_list_prev(this->tail_);
       this->tail_ = t;
     }
 }
@@ -56,7 +57,7 @@ Task_list::push_back(Task* t)
 inline void
 Task_list::push_front(Task* t)
 {
-  gold_assert(t->list_next() == NULL);
+  gold_assert(t->list_next() == NULL && t->list_prev() == NULL);
   if (this->head_ == NULL)
     {
       this->head_ = t;
@@ -65,6 +66,7 @@ Task_list::push_front(Task* t)
   else
     {
       t->set_list_next(this->head_);
+      this->head_->set_list_prev(t);
       this->head_ = t;
     }
 }
@@ -88,12 +90,38 @@ Task_list::pop_front()
 	{
 	  this->head_ = ret->list_next();
 	  gold_assert(this->head_ != NULL);
+	  this->head_->clear_list_prev();
 	  ret->clear_list_next();
 	}
     }
   return ret;
 }
 
+// Remove and return the last Task on the list.
+
+inline Task*
+Task_list::pop_back()
+{
+  Task* ret = this->tail_;
+  if (ret != NULL)
+    {
+      if (ret == this->head_)
+	{
+	  gold_assert(ret->list_prev() == NULL);
+	  this->head_ = NULL;
+	  this->tail_ = NULL;
+	}
+      else
+	{
+	  this->tail_ = ret->list_prev();
+	  gold_assert(this->tail_ != NULL);
+	  this->tail_->clear_list_next();
+	  ret->clear_list_prev();
+	}
+    }
+  return ret;
+}
+
 // The simple single-threaded implementation of Workqueue_threader.
 
 class Workqueue_threader_single : public Workqueue_threader
@@ -116,12 +144,26 @@ class Workqueue_threader_single : public Workqueue_threader
 
 // Workqueue methods.
 
+// All runnable tasks, including those on the deques of the threads,
+// are protected by the workqueue lock.  The Task interface requires
+// is_runnable and locks to be called with that lock held, and the
+// Task_tokens they look at are only consistent under it, so a thread
+// must hold it to start a task wherever the task came from.  What the
+// deques give us is that the tasks made runnable by a task tend to run
+// on the same thread, that a thread looks at a short list of its own
+// before the lists shared by all, and that idle threads are only
+// woken when there is a task for them.
+
 Workqueue::Workqueue(const General_options& options)
   : lock_(),
     first_tasks_(),
     tasks_(),
     running_(0),
     waiting_(0),
+    queued_(0),
+    sleeping_(0),
+    threads_(),
+    record_times_(options.stats()),
     condvar_(this->lock_),
     threader_(NULL)
 {
@@ -141,8 +183,58 @@ Workqueue::Workqueue(const General_options& options)
     }
 }
 
+// The threads may still be looking at the lock and the condition
+// variable after the last task has run, so wait for them to exit
+// before destroying the Workqueue.
+
 Workqueue::~Workqueue()
 {
+  delete this->threader_;
+  for (std::vector<Thread_state*>::iterator p = this->threads_.begin();
+       p != this->threads_.end();
+       ++p)
+    delete *p;
+}
+
+// Return the state of thread THREAD_NUMBER.  The workqueue lock must
+// be held when this is called.
+
+Workqueue::Thread_state*
+Workqueue::thread_state(int thread_number)
+{
+  gold_assert(thread_number >= 0);
+  unsigned int n = thread_number;
+  if (n >= this->threads_.size())
+    this->threads_.resize(n + 1, NULL);
+  if (this->threads_[n] == NULL)
+    this->threads_[n] = new Thread_state();
+  return this->threads_[n];
+}
+
+// Add the runnable task T to the list QUEUE.  The workqueue lock must
+// be held when this is called.
+
+void
+Workqueue::push_runnable(Task_list* queue, Task* t, bool front)
+{
+  if (front)
+    queue->push_front(t);
+  else
+    queue->push_back(t);
+  ++this->queued_;
+  this->wake_thread();
+}
+
+// Wake up one thread waiting for a task to run.  We don't signal the
+// condition variable when no thread is waiting, so that a thread
+// making many tasks runnable does not make a system call for each
+// one.  The workqueue lock must be held when this is called.
+
+inline void
+Workqueue::wake_thread()
+{
+  if (this->sleeping_ > 0)
+    this->condvar_.signal();
 }
 
 // Add a task to the end of a specific queue, or put it on the list
@@ -163,14 +255,7 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
       ++this->waiting_;
     }
   else
-    {
-      if (front)
-	queue->push_front(t);
-      else
-	queue->push_back(t);
-      // Tell any waiting thread that there is work to do.
-      this->condvar_.signal();
-    }
+    this->push_runnable(queue, t, front);
 }
 
 // Add a task to the queue.
@@ -217,6 +302,8 @@ Workqueue::find_runnable_in_list(Task_list* tasks)
   Task* t;
   while ((t = tasks->pop_front()) != NULL)
     {
+      --this->queued_;
+
       Task_token* token = t->is_runnable();
 
       if (token == NULL)
@@ -230,15 +317,58 @@ Workqueue::find_runnable_in_list(Task_list* tasks)
   return NULL;
 }
 
-// Find a runnable task.  Return NULL if none could be found.  The
-// workqueue lock must be held when this is called.
+// Steal a runnable task from the back of the deque of a thread other
+// than THREAD_NUMBER, leaving the tasks at the front to their owner.
+// We start with the next thread, so that idle threads don't all take
+// from the same deque.  The workqueue lock must be held when this is
+// called.
 
 Task*
-Workqueue::find_runnable()
+Workqueue::steal_runnable(int thread_number)
 {
+  unsigned int count = this->threads_.size();
+  for (unsigned int i = 1; i < count; ++i)
+    {
+      Thread_state* victim = this->threads_[(thread_number + i) % count];
+      if (victim == NULL)
+	continue;
+      Task* t;
+      while ((t = victim->tasks.pop_back()) != NULL)
+	{
+	  --this->queued_;
+
+	  Task_token* token = t->is_runnable();
+	  if (token == NULL)
+	    {
+	      ++this->thread_state(thread_number)->tasks_stolen;
+	      return t;
+	    }
+
+	  token->add_waiting(t);
+	  ++this->waiting_;
+	}
+    }
+  return NULL;
+}
+
+// Find a runnable task for thread THREAD_NUMBER.  Tasks which should
+// run soon come first, then the tasks on this thread's deque, then
+// the tasks added with queue, and finally the tasks on the deques of
+// other threads.  Return NULL if none could be found.  The workqueue
+// lock must be held when this is called.
+
+Task*
+Workqueue::find_runnable(int thread_number)
+{
+  if (this->queued_ == 0)
+    return NULL;
   Task* t = this->find_runnable_in_list(&this->first_tasks_);
+  if (t == NULL)
+    t = this->find_runnable_in_list(&this->thread_state(thread_number)->tasks);
   if (t == NULL)
     t = this->find_runnable_in_list(&this->tasks_);
+  if (t == NULL)
+    t = this->steal_runnable(thread_number);
   return t;
 }
 
@@ -249,13 +379,11 @@ Workqueue::find_runnable()
 Task*
 Workqueue::find_runnable_or_wait(int thread_number)
 {
-  Task* t = this->find_runnable();
+  Task* t = this->find_runnable(thread_number);
 
   while (t == NULL)
     {
-      if (this->running_ == 0
-	  && this->first_tasks_.empty()
-	  && this->tasks_.empty())
+      if (this->running_ == 0 && this->queued_ == 0)
 	{
 	  // Kick all the threads to make them exit.
 	  this->condvar_.broadcast();
@@ -269,11 +397,13 @@ Workqueue::find_runnable_or_wait(int thread_number)
 
       gold_debug(DEBUG_TASK, "%3d sleeping", thread_number);
 
+      ++this->sleeping_;
       this->condvar_.wait();
+      --this->sleeping_;
 
       gold_debug(DEBUG_TASK, "%3d awake", thread_number);
 
-      t = this->find_runnable();
+      t = this->find_runnable(thread_number);
     }
 
   return t;
@@ -312,16 +442,19 @@ Workqueue::find_and_run_task(int thread_number)
       gold_debug(DEBUG_TASK, "%3d running   task %s", thread_number,
 		 t->name().c_str());
 
+      bool timing = this->record_times_ || is_debugging_enabled(DEBUG_TASK);
       Timer timer;
-      if (is_debugging_enabled(DEBUG_TASK))
+      if (timing)
         timer.start();
 
       t->run(this);
 
+      Timer::TimeStats elapsed = { 0, 0, 0 };
+      if (timing)
+	elapsed = timer.get_elapsed_time();
+
       if (is_debugging_enabled(DEBUG_TASK))
         {
-          Timer::TimeStats elapsed = timer.get_elapsed_time();
-
           gold_debug(DEBUG_TASK,
                      "%3d completed task %s "
                      "(user: %ld.%06ld sys: %ld.%06ld wall: %ld.%06ld)",
@@ -337,12 +470,16 @@ Workqueue::find_and_run_task(int thread_number)
 
 	--this->running_;
 
+	Thread_state* state = this->thread_state(thread_number);
+	++state->tasks_run;
+	state->busy_time += elapsed.wall;
+
 	// Release the locks for the task.  This must be done with the
 	// workqueue lock held.  Get the next Task to run if any.
-	next = this->release_locks(t, &tl);
+	next = this->release_locks(t, &tl, thread_number);
 
 	if (next == NULL)
-	  next = this->find_runnable();
+	  next = this->find_runnable(thread_number);
 
 	// If we have another Task to run, get the Locks.  This must
 	// be called while we are still holding the Workqueue lock.
@@ -370,8 +507,9 @@ Workqueue::find_and_run_task(int thread_number)
 // 1) If T is not runnable, queue it on the appropriate token.
 
 // 2) Otherwise, T is runnable.  If *PRET is not NULL, then we have
-// already decided which Task to run next.  Add T to the list of
-// runnable tasks, and signal another thread.
+// already decided which Task to run next.  Add T to the deque of
+// thread THREAD_NUMBER, and wake up a waiting thread, which may
+// steal it.
 
 // 3) Otherwise, *PRET is NULL.  If IS_BLOCKER is false, then T was
 // waiting on a write lock.  We can grab that lock now, so we run T
@@ -394,7 +532,8 @@ Workqueue::find_and_run_task(int thread_number)
 // Return true if we set *PRET to T, false otherwise.
 
 bool
-Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
+Workqueue::return_or_queue(Task* t, bool is_blocker, int thread_number,
+			   Task** pret)
 {
   Task_token* token = t->is_runnable();
 
@@ -414,7 +553,7 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
     should_return = true;
   else if (t->should_run_soon())
     should_return = true;
-  else if (!this->first_tasks_.empty() || !this->tasks_.empty())
+  else if (this->queued_ > 0)
     should_queue = true;
   else
     should_return = true;
@@ -428,10 +567,10 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
   else if (should_queue)
     {
       if (t->should_run_soon())
-	this->first_tasks_.push_back(t);
+	this->push_runnable(&this->first_tasks_, t, false);
       else
-	this->tasks_.push_back(t);
-      this->condvar_.signal();
+	this->push_runnable(&this->thread_state(thread_number)->tasks, t,
+			    false);
       return false;
     }
 
@@ -440,11 +579,11 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
 
 // Release the locks associated with a Task.  Return the first
 // runnable Task that we find.  If we find more runnable tasks, add
-// them to the run queue and signal any other threads.  This must be
-// called with the Workqueue lock held.
+// them to the deque of thread THREAD_NUMBER and wake up a waiting
+// thread for each.  This must be called with the Workqueue lock held.
 
 Task*
-Workqueue::release_locks(Task* t, Task_locker* tl)
+Workqueue::release_locks(Task* t, Task_locker* tl, int thread_number)
 {
   Task* ret = NULL;
   for (Task_locker::iterator p = tl->begin(); p != tl->end(); ++p)
@@ -460,7 +599,7 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	      while ((t = token->remove_first_waiting()) != NULL)
 		{
 		  --this->waiting_;
-		  this->return_or_queue(t, true, &ret);
+		  this->return_or_queue(t, true, thread_number, &ret);
 		}
 	    }
 	}
@@ -477,7 +616,7 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	  while ((t = token->remove_first_waiting()) != NULL)
 	    {
 	      --this->waiting_;
-	      if (this->return_or_queue(t, false, &ret))
+	      if (this->return_or_queue(t, false, thread_number, &ret))
 		break;
 	    }
 	}
@@ -518,4 +657,22 @@ Workqueue::add_blocker(Task_token* token)
   token->add_blocker();
 }
 
+// Print statistics about the threads to stderr.
+
+void
+Workqueue::print_stats()
+{
+  Hold_lock hl(this->lock_);
+  for (unsigned int i = 0; i < this->threads_.size(); ++i)
+    {
+      const Thread_state* state = this->threads_[i];
+      if (state == NULL)
+	continue;
+      fprintf(stderr, _("%s: thread %u: tasks run: %u (%u stolen), "
+			"busy time: %ld.%03ld\n"),
+	      program_name, i, state->tasks_run, state->tasks_stolen,
+	      state->busy_time / 1000, state->busy_time % 1000);
+    }
+}
+
 } // End namespace gold.
@@ -28,6 +28,7 @@
 #define GOLD_WORKQUEUE_H
 
 #include <string>
+#include <vector>
 
 #include "gold-threads.h"
 #include "token.h"
@@ -45,7 +46,7 @@ class Task
 {
  public:
   Task()
-    : list_next_(NULL), name_(), should_run_soon_(false)
+    : list_next_(NULL), list_prev_(NULL), name_(), should_run_soon_(false)
   { }
   virtual ~Task()
   { }
@@ -96,6 +97,25 @@ class Task
   clear_list_next()
   { this->list_next_ = NULL; }
 
+  // Get the previous Task on the list of Tasks.  Called by Task_list.
+  Task*
+  list_prev() const
+  { return this->list_prev_; }
+
+  // Set the previous Task on the list of Tasks.  Called by Task_list.
+  void
+  set_list_prev(Task* t)
+  {
+    gold_assert(this->list_prev_ == NULL);
+    this->list_prev_ = t;
+  }
+
+  // Clear the previous Task on the list of Tasks.  Called by
+  // Task_list.
+  void
+  clear_list_prev()
+  { this->list_prev_ = NULL; }
+
   // Return the name of the Task.  This is only used for debugging
   // purposes.
   const std::string&
@@ -117,11 +137,12 @@ class Task
   Task(const Task&);
   Task& operator=(const Task&);
 
-  // If this Task is on a list, this is a pointer to the next Task on
-  // the list.  We use this simple list structure rather than building
-  // a container, in order to avoid memory allocation while holding
-  // the Workqueue lock.
+  // If this Task is on a list, these are pointers to the next and
+  // previous Tasks on the list.  We use this simple list structure
+  // rather than building a container, in order to avoid memory
+  // allocation while holding the Workqueue lock.
   Task* list_next_;
+  Task* list_prev_;
   // Task name, for debugging purposes.
   std::string name_;
   // Whether this Task should be executed soon.  This is used for
@@ -233,7 +254,31 @@ class Workqueue
   void
   add_blocker(Task_token*);
 
+  // Print statistics about the threads to stderr.
+  void
+  print_stats();
+
  private:
+  // The scheduling state of a single thread.
+  struct Thread_state
+  {
+    Thread_state()
+      : tasks(), tasks_run(0), tasks_stolen(0), busy_time(0)
+    { }
+
+    // The deque of tasks made runnable when tasks run by this thread
+    // released their locks.  The thread takes tasks from the front,
+    // and other threads steal them from the back.
+    Task_list tasks;
+    // The number of tasks run by this thread.
+    unsigned int tasks_run;
+    // The number of those tasks which were stolen from other threads.
+    unsigned int tasks_stolen;
+    // The wall clock time spent running tasks, in milliseconds.  This
+    // is only recorded with --stats or --debug=task.
+    long busy_time;
+  };
+
   // This class can not be copied.
   Workqueue(const Workqueue&);
   Workqueue& operator=(const Workqueue&);
@@ -246,9 +291,25 @@ class Workqueue
   Task*
   find_runnable_or_wait(int thread_number);
 
-  // Find a runnable task.
+  // Find a runnable task for a thread.
   Task*
-  find_runnable();
+  find_runnable(int thread_number);
+
+  // Steal a runnable task from the deque of another thread.
+  Task*
+  steal_runnable(int thread_number);
+
+  // Return the state of a thread, creating it if necessary.
+  Thread_state*
+  thread_state(int thread_number);
+
+  // Add a runnable task to a list.
+  void
+  push_runnable(Task_list*, Task*, bool front);
+
+  // Wake up a thread waiting for a task to run, if there is one.
+  void
+  wake_thread();
 
   // Find a runnable task in a list.
   Task*
@@ -260,11 +321,11 @@ class Workqueue
 
   // Release the locks for a Task.  Return the next Task to run.
   Task*
-  release_locks(Task*, Task_locker*);
+  release_locks(Task*, Task_locker*, int thread_number);
 
   // Store T into *PRET, or queue it as appropriate.
   bool
-  return_or_queue(Task* t, bool is_blocker, Task** pret);
+  return_or_queue(Task* t, bool is_blocker, int thread_number, Task** pret);
 
   // Return whether to cancel this thread.
   bool
@@ -281,6 +342,15 @@ class Workqueue
   int running_;
   // Number of tasks waiting for a lock to release.
   int waiting_;
+  // Number of runnable tasks on first_tasks_, tasks_ and the deques
+  // of the threads.
+  int queued_;
+  // Number of threads waiting on condvar_ for a task to run.
+  int sleeping_;
+  // The state of each thread, indexed by thread number.
+  std::vector<Thread_state*> threads_;
+  // Whether to record the time each thread spends running tasks.
+  bool record_times_;
   // Condition variable associated with lock_.  This is signalled when
   // there may be a new Task to execute.
   Condvar condvar_;
@@ -1041,6 +1041,30 @@ class Target_x86_64 : public Sized_target<size, false>
     bool skip_call_tls_get_addr_;
   };
 
+  // Runs of at least this many R_X86_64_64 relocations against local
+  // symbols are applied as a batch by relocate_section.
+  static const size_t min_abs64_batch = 4;
+
+  // If PRELOC is an R_X86_64_64 relocation against a local symbol
+  // which needs no special handling, add it to BATCH and return true.
+  static inline bool
+  resolve_local_abs64(const Relocate_info<size, false>* relinfo,
+		      const unsigned char* preloc,
+		      section_size_type view_size,
+		      Resolved_reloc_batch<64, false>* batch);
+
+  // Apply relocations using the generic relocate_section.
+  void
+  relocate_section_generic(const Relocate_info<size, false>* relinfo,
+			   const unsigned char* prelocs,
+			   size_t reloc_count,
+			   Output_section* output_section,
+			   bool needs_special_offset_handling,
+			   unsigned char* view,
+			   typename elfcpp::Elf_types<size>::Elf_Addr address,
+			   section_size_type view_size,
+			   const Reloc_symbol_changes* reloc_symbol_changes);
+
   // Check if relocation against this symbol is a candidate for
   // conversion from
   // mov foo@GOTPCREL(%rip), %reg
@@ -5422,11 +5446,120 @@ Target_x86_64<size>::relocate_section(
     typename elfcpp::Elf_types<size>::Elf_Addr address,
     section_size_type view_size,
     const Reloc_symbol_changes* reloc_symbol_changes)
+{
+  gold_assert(sh_type == elfcpp::SHT_RELA);
+
+  // Most of the relocations in data sections such as vtables,
+  // .data.rel.ro and .init_array are R_X86_64_64 relocations against
+  // local symbols.  The value stored only depends on the symbol value
+  // and the addend, so we resolve runs of them into a batch and store
+  // the values together, passing everything else to the generic code.
+  // Executable sections are left alone, since TLS sequences there are
+  // handled by the state kept in Relocate.
+  size_t done = 0;
+  if (!needs_special_offset_handling
+      && reloc_symbol_changes == NULL
+      && output_section != NULL
+      && (output_section->flags() & elfcpp::SHF_EXECINSTR) == 0)
+    {
+      const int reloc_size = elfcpp::Elf_sizes<size>::rela_size;
+      Resolved_reloc_batch<64, false> batch;
+      size_t i = 0;
+      while (i < reloc_count)
+	{
+	  size_t start = i;
+	  while (i < reloc_count
+		 && resolve_local_abs64(relinfo, prelocs + i * reloc_size,
+					view_size, &batch))
+	    ++i;
+	  if (i - start >= min_abs64_batch)
+	    {
+	      this->relocate_section_generic(relinfo,
+					     prelocs + done * reloc_size,
+					     start - done, output_section,
+					     false, view, address, view_size,
+					     NULL);
+	      batch.apply(view);
+	      done = i;
+	    }
+	  batch.clear();
+
+	  // Relocation I, if any, was not added to the batch.
+	  ++i;
+	}
+      if (done > 0)
+	prelocs += done * reloc_size;
+    }
+
+  this->relocate_section_generic(relinfo, prelocs, reloc_count - done,
+				 output_section,
+				 needs_special_offset_handling, view,
+				 address, view_size, reloc_symbol_changes);
+}
+
+// If PRELOC is an R_X86_64_64 relocation against a local symbol that
+// is defined in a section included in the link, and is not an IFUNC,
+// add it to BATCH and return true.  The generic code would do nothing
+// for such a relocation but store the symbol value plus the addend.
+
+template<int size>
+inline bool
+Target_x86_64<size>::resolve_local_abs64(
+    const Relocate_info<size, false>* relinfo,
+    const unsigned char* preloc,
+    section_size_type view_size,
+    Resolved_reloc_batch<64, false>* batch)
+{
+  const elfcpp::Rela<size, false> rela(preloc);
+  typename elfcpp::Elf_types<size>::Elf_WXword r_info = rela.get_r_info();
+  if (elfcpp::elf_r_type<size>(r_info) != elfcpp::R_X86_64_64)
+    return false;
+
+  Sized_relobj_file<size, false>* object = relinfo->object;
+  unsigned int r_sym = elfcpp::elf_r_sym<size>(r_info);
+  if (r_sym >= object->local_symbol_count())
+    return false;
+
+  const Symbol_value<size>* psymval = object->local_symbol(r_sym);
+  if (psymval->is_ifunc_symbol())
+    return false;
+
+  bool is_ordinary;
+  unsigned int shndx = psymval->input_shndx(&is_ordinary);
+  if (!is_ordinary
+      || shndx == elfcpp::SHN_UNDEF
+      || !object->is_section_included(shndx))
+    return false;
+
+  section_offset_type offset =
+    convert_to_section_size_type(rela.get_r_offset());
+  if (offset < 0 || static_cast<section_size_type>(offset) + 8 > view_size)
+    return false;
+
+  batch->add(offset, psymval->value(object, rela.get_r_addend()));
+  return true;
+}
+
+// Apply relocations using the generic relocate_section.
+
+template<int size>
+void
+Target_x86_64<size>::relocate_section_generic(
+    const Relocate_info<size, false>* relinfo,
+    const unsigned char* prelocs,
+    size_t reloc_count,
+    Output_section* output_section,
+    bool needs_special_offset_handling,
+    unsigned char* view,
+    typename elfcpp::Elf_types<size>::Elf_Addr address,
+    section_size_type view_size,
+    const Reloc_symbol_changes* reloc_symbol_changes)
 {
   typedef gold::Default_classify_reloc<elfcpp::SHT_RELA, size, false>
       Classify_reloc;
 
-  gold_assert(sh_type == elfcpp::SHT_RELA);
+  if (reloc_count == 0)
+    return;
 
   gold::relocate_section<size, false, Target_x86_64<size>, Relocate,
 			 gold::Default_comdat_behavior, Classify_reloc>(
@@ -412,6 +412,11 @@ struct bfd_link_info
      should be freed and reread.  */
   unsigned int keep_memory: 1;
 
+  /* TRUE if input sections may be relocated in place in the output
+     file mapped into memory, FALSE if their contents must be written
+     out with bfd_write.  */
+  unsigned int mmap_output: 1;
+
   /* TRUE if BFD should generate relocation information in the final
      executable.  */
   unsigned int emitrelocations: 1;
@@ -762,6 +767,11 @@ struct bfd_link_info
   /* The maximum cache size.  Backend can use cache_size and and
      max_cache_size to decide if keep_memory should be honored.  */
   bfd_size_type max_cache_size;
+
+  /* The number of threads which may be used to relocate input files
+     in parallel.  Zero or one means that input files are relocated
+     one at a time.  */
+  unsigned int threads;
 };
 
 /* Some forward-definitions used by some callbacks.  */
@@ -906,6 +916,12 @@ struct bfd_link_callbacks
      the output BFD named .ctf or a name beginning with ".ctf.".  */
   void (*emit_ctf)
     (void);
+  /* This callback is called to run FUNC (DATA, I) for each I from 0 to
+     COUNT - 1, using up to INFO->threads threads.  The calls may be
+     made in any order, and this returns once all of them are done.  */
+  void (*parallel_run)
+    (struct bfd_link_info *info, void (*func) (void *data, size_t i),
+     void *data, size_t count);
 };
 
 /* The linker builds link_order structures which tell the code how to
@@ -23,6 +23,9 @@
 #ifndef OPCODE_KVX_H
 #define OPCODE_KVX_H
 
+#include "bfd.h"
+#include <stdint.h>
+
 #define KVX_NUMCORES 3
 #define KVX_MAXSYLLABLES 3
 #define KVX_MAXOPERANDS 7
@@ -3393,5 +3396,61 @@ extern struct kvx_reloc kv4_v1_rel8_reloc;
 extern struct kvx_reloc kv4_v1_pcrel11_reloc;
 extern struct kvx_reloc kv4_v1_pcrel38_reloc;
 
+/* Category of an operand decoded by kvx_decode_bundles.  */
+enum kvx_operand_category
+{
+  KVX_CAT_REGISTER,
+  KVX_CAT_MODIFIER,
+  KVX_CAT_IMMEDIATE,
+};
+
+struct kvx_decoded_operand
+{
+  /* The operand value.  For a register, its index in the register table
+     of the core; for a modifier, its index in the modifier category; for
+     a pc relative immediate, the target address.  */
+  uint64_t val;
+  /* An enum kvx_operand_category.  */
+  uint8_t type;
+  /* If it is an immediate, its sign.  */
+  uint8_t sign;
+  /* If it is an immediate, is it pc relative.  */
+  uint8_t pcrel;
+  /* The bit width of the operand.  */
+  uint8_t width;
+  /* If it is a modifier, the modifier category.
+     An index in the modifier table.  */
+  int mod_idx;
+};
+
+struct kvx_decoded_insn
+{
+  /* The entry in the opcode table, NULL if the instruction is invalid.  */
+  const struct kvx_opc *opc;
+  /* The address of the bundle of the instruction.  */
+  bfd_vma bundle_addr;
+  /* The number of syllables of the instruction, including IMMX.  */
+  uint8_t nb_syllables;
+  /* The execution unit the instruction issues to, a KV3 or KV4 EXU.  */
+  uint8_t exu;
+  /* Whether this is the last instruction of its bundle.  */
+  uint8_t bundle_end;
+  /* The number of operands.  */
+  uint8_t nb_ops;
+  struct kvx_decoded_operand operands[KVX_MAXOPERANDS];
+};
+
+/* Bundle decoding, for tools that need the instructions of large code
+   images without their text.  A decoder has its own tables and state, so
+   that it does not interfere with print_insn_kvx or with other decoders.  */
+
+struct kvx_decoder;
+
+extern struct kvx_decoder *kvx_decoder_new (unsigned long mach);
+extern void kvx_decoder_free (struct kvx_decoder *);
+extern long kvx_decode_bundles (struct kvx_decoder *, const bfd_byte *buf,
+				size_t len, bfd_vma addr,
+				struct kvx_decoded_insn *insns,
+				size_t max_insns, size_t *consumed);
 
 #endif /* OPCODE_KVX_H */
@@ -1188,6 +1188,7 @@ AC_SUBST([am__untar])
 m4_include([../bfd/acinclude.m4])
 m4_include([../bfd/warning.m4])
 m4_include([../config/acx.m4])
+m4_include([../config/ax_pthread.m4])
 m4_include([../config/bfd64.m4])
 m4_include([../config/depstand.m4])
 m4_include([../config/enable.m4])
@@ -25,6 +25,9 @@
 fragment <<EOF
 
 #include "ldctor.h"
+#include "filenames.h"
+#include "hashtab.h"
+#include "safe-ctype.h"
 #include "elf/kvx.h"
 #include "elfxx-kvx.h"
 
@@ -47,6 +50,548 @@ fragment <<EOF
 }
 
 
+/* Call graph driven function ordering.  The file given with
+   --kvx-call-graph holds one "CALLER CALLEE COUNT" triple per line,
+   typically produced by a profiler.  Functions are clustered with the
+   C3 heuristic: each function, hottest first, is appended to the
+   cluster of its most frequent caller as long as the merged cluster
+   does not exceed the cluster size limit.  Clusters are then laid out
+   by decreasing density at the start of the .text output section, and
+   each cluster gets its own stub group so that the long-branch stubs
+   stay next to the code that uses them.  */
+
+/* Default limit on the size of a cluster of functions, chosen to fit
+   the instruction cache of the KVX cores.  */
+#define KVX_DEFAULT_CLUSTER_SIZE 16384
+
+#define KVX_WILDCARDP(name) (strpbrk ((name), "?*[") != NULL)
+
+static const char *kvx_call_graph_file;
+static bfd_size_type kvx_cluster_size = KVX_DEFAULT_CLUSTER_SIZE;
+
+struct kvx_cg_node
+{
+  asection *sec;
+  /* Sum of the counts of the call graph edges touching SEC.  */
+  bfd_vma weight;
+  /* Most frequent caller, or -1U if none.  */
+  unsigned int pred;
+  bfd_vma pred_count;
+  /* Cluster holding this node, and next node in that cluster.  */
+  unsigned int cluster;
+  unsigned int next;
+};
+
+struct kvx_cg_edge
+{
+  unsigned int caller;
+  unsigned int callee;
+  bfd_vma count;
+};
+
+struct kvx_cg_cluster
+{
+  unsigned int first;
+  unsigned int last;
+  bfd_size_type size;
+  bfd_vma weight;
+};
+
+/* Input sections laid out from the call graph, in order, and whether
+   each one ends a cluster.  Used to cut stub groups at cluster
+   boundaries after allocation.  */
+struct kvx_cg_order
+{
+  asection *sec;
+  bool cluster_end;
+};
+
+static struct kvx_cg_order *kvx_cg_order;
+static unsigned int kvx_cg_order_count;
+
+static struct kvx_cg_node *kvx_cg_nodes;
+static struct kvx_cg_cluster *kvx_cg_clusters;
+
+static hashval_t
+kvx_cg_node_hash (const void *p)
+{
+  return htab_hash_pointer (kvx_cg_nodes[*(const unsigned int *) p].sec);
+}
+
+static int
+kvx_cg_node_eq (const void *p1, const void *p2)
+{
+  return (kvx_cg_nodes[*(const unsigned int *) p1].sec
+	  == kvx_cg_nodes[*(const unsigned int *) p2].sec);
+}
+
+/* Return the input section defining function NAME if it can be
+   reordered, or NULL.  */
+
+static asection *
+kvx_cg_function_section (const char *name)
+{
+  struct bfd_link_hash_entry *h;
+  asection *sec;
+  lang_input_statement_type *is;
+
+  h = bfd_link_hash_lookup (link_info.hash, name, false, false, true);
+  if (h == NULL
+      || (h->type != bfd_link_hash_defined
+	  && h->type != bfd_link_hash_defweak))
+    return NULL;
+
+  sec = h->u.def.section;
+  if (sec->owner == NULL
+      || (sec->owner->flags & (DYNAMIC | BFD_LINKER_CREATED)) != 0
+      || (sec->flags & SEC_CODE) == 0
+      || (strcmp (sec->name, ".text") != 0
+	  && !startswith (sec->name, ".text."))
+      || KVX_WILDCARDP (sec->name))
+    return NULL;
+
+  is = bfd_usrdata (sec->owner);
+  if (is == NULL || is->flags.just_syms)
+    return NULL;
+
+  return sec;
+}
+
+/* Return the node for SEC, creating it if needed.  */
+
+static unsigned int
+kvx_cg_node (htab_t table, asection *sec, unsigned int *count,
+	     unsigned int *alloc)
+{
+  void **slot;
+  unsigned int n = *count;
+
+  if (n == *alloc)
+    {
+      *alloc = *alloc * 2 + 64;
+      kvx_cg_nodes = xrealloc (kvx_cg_nodes,
+			       *alloc * sizeof (*kvx_cg_nodes));
+    }
+  memset (&kvx_cg_nodes[n], 0, sizeof (kvx_cg_nodes[n]));
+  kvx_cg_nodes[n].sec = sec;
+  kvx_cg_nodes[n].pred = -1U;
+
+  slot = htab_find_slot (table, &n, INSERT);
+  if (*slot != NULL)
+    return *(unsigned int *) *slot;
+
+  *slot = xmalloc (sizeof (unsigned int));
+  *(unsigned int *) *slot = n;
+  *count = n + 1;
+  return n;
+}
+
+/* Open the call graph file, looking in the -L directories as is done
+   for linker scripts if it is not found as given.  */
+
+static FILE *
+kvx_cg_open (void)
+{
+  search_dirs_type *search;
+  FILE *f;
+
+  f = fopen (kvx_call_graph_file, FOPEN_RT);
+  if (f != NULL || IS_ABSOLUTE_PATH (kvx_call_graph_file))
+    return f;
+
+  for (search = search_head; search != NULL; search = search->next)
+    {
+      char *path = concat (search->name, "/", kvx_call_graph_file,
+			   (const char *) NULL);
+
+      f = fopen (path, FOPEN_RT);
+      free (path);
+      if (f != NULL)
+	break;
+    }
+  return f;
+}
+
+/* Read the call graph file and return its edges in *EDGES.  */
+
+static unsigned int
+kvx_cg_read (htab_t table, unsigned int *node_count,
+	     struct kvx_cg_edge **edges)
+{
+  FILE *f;
+  char *buf;
+  char *p;
+  long len = 0;
+  unsigned int line = 0;
+  unsigned int count = 0, alloc = 0, node_alloc = 0;
+
+  f = kvx_cg_open ();
+  if (f == NULL
+      || fseek (f, 0, SEEK_END) != 0
+      || (len = ftell (f)) < 0
+      || fseek (f, 0, SEEK_SET) != 0)
+    einfo (_("%F%P: cannot read call graph file %s: %E\n"),
+	   kvx_call_graph_file);
+
+  buf = xmalloc (len + 1);
+  len = fread (buf, 1, len, f);
+  buf[len] = 0;
+  fclose (f);
+
+  *edges = NULL;
+  for (p = buf; *p != 0; )
+    {
+      char *field[3];
+      char *eol = strchr (p, '\n');
+      const char *end;
+      asection *caller, *callee;
+      bfd_vma weight;
+      int i;
+
+      if (eol != NULL)
+	*eol = 0;
+      line++;
+
+      for (i = 0; i < 3; i++)
+	{
+	  while (ISSPACE (*p))
+	    p++;
+	  if (*p == 0 || *p == '#')
+	    break;
+	  field[i] = p;
+	  while (*p != 0 && !ISSPACE (*p))
+	    p++;
+	  if (*p != 0)
+	    *p++ = 0;
+	}
+      while (ISSPACE (*p))
+	p++;
+
+      if (i == 0)
+	;
+      else if (i != 3 || (*p != 0 && *p != '#'))
+	einfo (_("%P: %s:%u: warning: malformed call graph entry\n"),
+	       kvx_call_graph_file, line);
+      else
+	{
+	  weight = bfd_scan_vma (field[2], &end, 10);
+	  if (*end != 0)
+	    einfo (_("%P: %s:%u: warning: malformed call graph entry\n"),
+		   kvx_call_graph_file, line);
+	  else if (weight != 0
+		   && (caller = kvx_cg_function_section (field[0])) != NULL
+		   && (callee = kvx_cg_function_section (field[1])) != NULL
+		   && caller != callee)
+	    {
+	      if (count == alloc)
+		{
+		  alloc = alloc * 2 + 64;
+		  *edges = xrealloc (*edges, alloc * sizeof (**edges));
+		}
+	      (*edges)[count].caller
+		= kvx_cg_node (table, caller, node_count, &node_alloc);
+	      (*edges)[count].callee
+		= kvx_cg_node (table, callee, node_count, &node_alloc);
+	      (*edges)[count].count = weight;
+	      count++;
+	    }
+	}
+
+      if (eol == NULL)
+	break;
+      p = eol + 1;
+    }
+
+  free (buf);
+  return count;
+}
+
+static int
+kvx_cg_edge_cmp (const void *p1, const void *p2)
+{
+  const struct kvx_cg_edge *e1 = p1;
+  const struct kvx_cg_edge *e2 = p2;
+
+  if (e1->callee != e2->callee)
+    return e1->callee < e2->callee ? -1 : 1;
+  if (e1->caller != e2->caller)
+    return e1->caller < e2->caller ? -1 : 1;
+  return 0;
+}
+
+/* Order nodes by decreasing weight, keeping file order for ties.  */
+
+static int
+kvx_cg_node_cmp (const void *p1, const void *p2)
+{
+  unsigned int n1 = *(const unsigned int *) p1;
+  unsigned int n2 = *(const unsigned int *) p2;
+
+  if (kvx_cg_nodes[n1].weight != kvx_cg_nodes[n2].weight)
+    return kvx_cg_nodes[n1].weight > kvx_cg_nodes[n2].weight ? -1 : 1;
+  return n1 < n2 ? -1 : n1 > n2;
+}
+
+/* Order clusters by decreasing density, keeping creation order for
+   ties.  */
+
+static int
+kvx_cg_cluster_cmp (const void *p1, const void *p2)
+{
+  const struct kvx_cg_cluster *c1 = &kvx_cg_clusters[*(const unsigned int *) p1];
+  const struct kvx_cg_cluster *c2 = &kvx_cg_clusters[*(const unsigned int *) p2];
+  double d1 = (double) c1->weight / (c1->size ? c1->size : 1);
+  double d2 = (double) c2->weight / (c2->size ? c2->size : 1);
+
+  if (d1 != d2)
+    return d1 > d2 ? -1 : 1;
+  return c1->first < c2->first ? -1 : c1->first > c2->first;
+}
+
+/* Add a wild statement placing exactly SEC to the current statement
+   list.  Return false if SEC can not be named unambiguously.  */
+
+static bool
+kvx_cg_add_wild (asection *sec)
+{
+  struct wildcard_spec filespec;
+  struct wildcard_list *section;
+  bfd *abfd = sec->owner;
+  const char *name;
+
+  if (abfd->my_archive != NULL)
+    {
+      const char *aname = bfd_get_filename (abfd->my_archive);
+      const char *mname = bfd_get_filename (abfd);
+      size_t alen = strlen (aname);
+      size_t mlen = strlen (mname);
+      char *spec;
+
+      if (KVX_WILDCARDP (aname) || KVX_WILDCARDP (mname)
+	  || strchr (aname, link_info.path_separator) != NULL)
+	return false;
+      spec = stat_alloc (alen + mlen + 2);
+      memcpy (spec, aname, alen);
+      spec[alen] = link_info.path_separator;
+      memcpy (spec + alen + 1, mname, mlen + 1);
+      name = spec;
+    }
+  else
+    {
+      lang_input_statement_type *is = bfd_usrdata (abfd);
+
+      name = is->local_sym_name;
+      if (name == NULL
+	  || KVX_WILDCARDP (name)
+	  || strchr (name, link_info.path_separator) != NULL)
+	return false;
+    }
+
+  memset (&filespec, 0, sizeof (filespec));
+  filespec.name = name;
+  filespec.sorted = none;
+
+  section = stat_alloc (sizeof (*section));
+  memset (section, 0, sizeof (*section));
+  section->spec.name = sec->name;
+  section->spec.sorted = none;
+
+  lang_add_wild (&filespec, section, false);
+  return true;
+}
+
+/* Cluster the functions of the call graph file and place them at the
+   start of the .text output section.  */
+
+static void
+kvx_cg_layout (void)
+{
+  lang_output_section_statement_type *os;
+  lang_statement_list_type list;
+  lang_statement_union_type **where;
+  struct kvx_cg_edge *edges;
+  unsigned int *order;
+  unsigned int edge_count, node_count = 0, cluster_count;
+  unsigned int i, j;
+  htab_t table;
+
+  os = lang_output_section_find (".text");
+  if (os == NULL)
+    {
+      einfo (_("%P: warning: no .text output section, "
+	       "ignoring %s\n"), kvx_call_graph_file);
+      return;
+    }
+
+  table = htab_create (1024, kvx_cg_node_hash, kvx_cg_node_eq, free);
+  edge_count = kvx_cg_read (table, &node_count, &edges);
+  htab_delete (table);
+  if (edge_count == 0)
+    {
+      free (edges);
+      free (kvx_cg_nodes);
+      kvx_cg_nodes = NULL;
+      return;
+    }
+
+  /* Merge duplicate edges, then find the hotness and most frequent
+     caller of each function.  */
+  qsort (edges, edge_count, sizeof (*edges), kvx_cg_edge_cmp);
+  for (i = 0, j = 0; i < edge_count; i++)
+    {
+      if (j != 0
+	  && edges[j - 1].caller == edges[i].caller
+	  && edges[j - 1].callee == edges[i].callee)
+	edges[j - 1].count += edges[i].count;
+      else
+	edges[j++] = edges[i];
+    }
+  edge_count = j;
+
+  for (i = 0; i < edge_count; i++)
+    {
+      struct kvx_cg_node *callee = &kvx_cg_nodes[edges[i].callee];
+
+      kvx_cg_nodes[edges[i].caller].weight += edges[i].count;
+      callee->weight += edges[i].count;
+      if (edges[i].count > callee->pred_count)
+	{
+	  callee->pred = edges[i].caller;
+	  callee->pred_count = edges[i].count;
+	}
+    }
+  free (edges);
+
+  /* Start with one cluster per function.  */
+  kvx_cg_clusters = xmalloc (node_count * sizeof (*kvx_cg_clusters));
+  order = xmalloc (node_count * sizeof (*order));
+  for (i = 0; i < node_count; i++)
+    {
+      kvx_cg_nodes[i].cluster = i;
+      kvx_cg_nodes[i].next = -1U;
+      kvx_cg_clusters[i].first = i;
+      kvx_cg_clusters[i].last = i;
+      kvx_cg_clusters[i].size = kvx_cg_nodes[i].sec->size;
+      kvx_cg_clusters[i].weight = kvx_cg_nodes[i].weight;
+      order[i] = i;
+    }
+
+  /* Hottest functions first, append each function's cluster to the
+     cluster of its most frequent caller.  */
+  qsort (order, node_count, sizeof (*order), kvx_cg_node_cmp);
+  for (i = 0; i < node_count; i++)
+    {
+      struct kvx_cg_node *node = &kvx_cg_nodes[order[i]];
+      struct kvx_cg_cluster *to, *from;
+      unsigned int n;
+
+      if (node->pred == -1U
+	  || kvx_cg_nodes[node->pred].cluster == node->cluster)
+	continue;
+
+      to = &kvx_cg_clusters[kvx_cg_nodes[node->pred].cluster];
+      from = &kvx_cg_clusters[node->cluster];
+      if (to->size + from->size > kvx_cluster_size)
+	continue;
+
+      for (n = from->first; n != -1U; n = kvx_cg_nodes[n].next)
+	kvx_cg_nodes[n].cluster = kvx_cg_nodes[node->pred].cluster;
+      kvx_cg_nodes[to->last].next = from->first;
+      to->last = from->last;
+      to->size += from->size;
+      to->weight += from->weight;
+      from->first = -1U;
+    }
+
+  /* Lay out the surviving clusters by decreasing density.  */
+  for (i = 0, cluster_count = 0; i < node_count; i++)
+    if (kvx_cg_clusters[i].first != -1U)
+      order[cluster_count++] = i;
+  qsort (order, cluster_count, sizeof (*order), kvx_cg_cluster_cmp);
+
+  kvx_cg_order = xmalloc (node_count * sizeof (*kvx_cg_order));
+  lang_list_init (&list);
+  push_stat_ptr (&list);
+  for (i = 0; i < cluster_count; i++)
+    {
+      unsigned int n;
+      unsigned int first = kvx_cg_order_count;
+
+      for (n = kvx_cg_clusters[order[i]].first;
+	   n != -1U;
+	   n = kvx_cg_nodes[n].next)
+	if (kvx_cg_add_wild (kvx_cg_nodes[n].sec))
+	  {
+	    kvx_cg_order[kvx_cg_order_count].sec = kvx_cg_nodes[n].sec;
+	    kvx_cg_order[kvx_cg_order_count].cluster_end = false;
+	    kvx_cg_order_count++;
+	  }
+      if (kvx_cg_order_count != first)
+	kvx_cg_order[kvx_cg_order_count - 1].cluster_end = true;
+    }
+  pop_stat_ptr ();
+
+  free (order);
+  free (kvx_cg_clusters);
+  kvx_cg_clusters = NULL;
+  free (kvx_cg_nodes);
+  kvx_cg_nodes = NULL;
+
+  /* Splice the new statements before the first wild statement of .text,
+     as is done for --section-ordering-file.  */
+  if (list.head == NULL)
+    return;
+  for (where = &os->children.head;
+       *where != NULL;
+       where = &(*where)->header.next)
+    if ((*where)->header.type == lang_wild_statement_enum)
+      break;
+  *list.tail = *where;
+  *where = list.head;
+  if (os->children.tail == where)
+    os->children.tail = list.tail;
+}
+
+static void
+kvx_elf_after_open (void)
+{
+  /* Call the standard elf routine.  */
+  gld${EMULATION_NAME}_after_open ();
+
+  if (kvx_call_graph_file != NULL && !bfd_link_relocatable (&link_info))
+    kvx_cg_layout ();
+}
+
+/* Cut stub groups at the end of each cluster laid out by
+   kvx_cg_layout, ignoring sections that were discarded.  */
+
+static void
+kvx_cg_end_stub_groups (void)
+{
+  asection *last = NULL;
+  unsigned int i;
+
+  for (i = 0; i < kvx_cg_order_count; i++)
+    {
+      asection *sec = kvx_cg_order[i].sec;
+
+      if ((sec->flags & SEC_EXCLUDE) == 0
+	  && sec->output_section != NULL
+	  && sec->output_section->owner == link_info.output_bfd)
+	last = sec;
+      if (kvx_cg_order[i].cluster_end && last != NULL)
+	{
+	  elf${ELFSIZE}_kvx_end_stub_group (&link_info, last);
+	  last = NULL;
+	}
+    }
+
+  /* The order is not needed once the stub groups are set.  */
+  free (kvx_cg_order);
+  kvx_cg_order = NULL;
+  kvx_cg_order_count = 0;
+}
+
 
 /* Fake input file for stubs.  */
 static lang_input_statement_type *stub_file;
@@ -238,6 +783,7 @@ gld${EMULATION_NAME}_after_allocation (void)
 	    }
 
 	  lang_for_each_statement (build_section_lists);
+	  kvx_cg_end_stub_groups ();
 
 	  /* Call into the BFD backend to do the real work.  */
 	  if (! elf${ELFSIZE}_kvx_size_stubs (link_info.output_bfd,
@@ -304,10 +850,45 @@ kvx_elf_create_output_section_statements (void)
 }
 
 
+
 #define lang_for_each_input_file kvx_lang_for_each_input_file
 
 EOF
 
+# Define some shell vars to insert bits of code into the standard elf
+# parse_args and list_options functions.
+#
+PARSE_AND_LIST_LONGOPTS='
+  { "kvx-call-graph", required_argument, NULL, OPTION_KVX_CALL_GRAPH },
+  { "kvx-cluster-size", required_argument, NULL, OPTION_KVX_CLUSTER_SIZE },
+'
+
+PARSE_AND_LIST_OPTIONS='
+  fprintf (file, _("\
+  --kvx-call-graph=FILE       Order functions from the weighted call graph\n\
+                                in FILE (lines of CALLER CALLEE COUNT)\n"));
+  fprintf (file, _("\
+  --kvx-cluster-size=N        Maximum size of a cluster of functions laid\n\
+                                out together (default 16384)\n"));
+'
+
+PARSE_AND_LIST_ARGS_CASES='
+    case OPTION_KVX_CALL_GRAPH:
+      kvx_call_graph_file = optarg;
+      break;
+
+    case OPTION_KVX_CLUSTER_SIZE:
+      {
+	const char *end;
+
+	kvx_cluster_size = bfd_scan_vma (optarg, &end, 0);
+	if (*end)
+	  einfo (_("%F%P: invalid number `%s'\''\n"), optarg);
+      }
+      break;
+'
+
+LDEMUL_AFTER_OPEN=kvx_elf_after_open
 LDEMUL_BEFORE_ALLOCATION=elf${ELFSIZE}_kvx_before_allocation
 LDEMUL_AFTER_ALLOCATION=gld${EMULATION_NAME}_after_allocation
 LDEMUL_CREATE_OUTPUT_SECTION_STATEMENTS=kvx_elf_create_output_section_statements
@@ -183,6 +183,10 @@ enum option_values
   OPTION_DISABLE_LINKER_VERSION,
   OPTION_REMAP_INPUTS,
   OPTION_REMAP_INPUTS_FILE,
+  OPTION_THREADS,
+  OPTION_NO_THREADS,
+  OPTION_MMAP_OUTPUT,
+  OPTION_NO_MMAP_OUTPUT,
   /* Used by emultempl/elf.em, emultempl/pe.em and emultempl/pep.em.  */
   OPTION_BUILD_ID,
   OPTION_EXCLUDE_LIBS,
@@ -293,6 +297,9 @@ enum option_values
   OPTION_MULTI_SUBSPACE,
   /* Used by emultempl/ia64elf.em.  */
   OPTION_ITANIUM,
+  /* Used by emultempl/kvxelf.em.  */
+  OPTION_KVX_CALL_GRAPH,
+  OPTION_KVX_CLUSTER_SIZE,
   /* Used by emultempl/m68hc1xelf.em.  */
   OPTION_NO_TRAMPOLINE,
   OPTION_BANK_WINDOW,
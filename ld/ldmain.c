@@ -51,6 +51,10 @@
 
 #include <string.h>
 
+#ifdef ENABLE_THREADS
+#include <pthread.h>
+#endif
+
 #ifndef TARGET_SYSTEM_ROOT
 #define TARGET_SYSTEM_ROOT ""
 #endif
@@ -134,6 +138,12 @@ static void unattached_reloc
 static bool notice
   (struct bfd_link_info *, struct bfd_link_hash_entry *,
    struct bfd_link_hash_entry *, bfd *, asection *, bfd_vma, flagword);
+#ifdef ENABLE_THREADS
+static void ld_parallel_run
+  (struct bfd_link_info *, void (*) (void *, size_t), void *, size_t);
+#else
+#define ld_parallel_run NULL
+#endif
 
 static struct bfd_link_callbacks link_callbacks =
 {
@@ -155,7 +165,8 @@ static struct bfd_link_callbacks link_callbacks =
   ldlang_ctf_acquire_strings,
   NULL,
   ldlang_ctf_new_dynsym,
-  ldlang_write_ctf_late
+  ldlang_write_ctf_late,
+  ld_parallel_run
 };
 
 static bfd_assert_handler_type default_bfd_assert_handler;
@@ -234,8 +245,10 @@ static void
 ld_bfd_assert_handler (const char *fmt, const char *bfdver,
 		       const char *file, int line)
 {
+  ld_lock_messages ();
   config.make_executable = false;
   (*default_bfd_assert_handler) (fmt, bfdver, file, line);
+  ld_unlock_messages ();
 }
 
 /* Hook the bfd error/warning handler for --fatal-warnings.  */
@@ -243,9 +256,199 @@ ld_bfd_assert_handler (const char *fmt, const char *bfdver,
 static void
 ld_bfd_error_handler (const char *fmt, va_list ap)
 {
+  ld_lock_messages ();
   if (config.fatal_warnings)
     config.make_executable = false;
   (*default_bfd_error_handler) (fmt, ap);
+  ld_unlock_messages ();
+}
+
+#ifdef ENABLE_THREADS
+
+/* The lock passed to bfd_thread_init.  BFD may take it again while
+   holding it, so it is recursive.  */
+
+static pthread_mutex_t ld_bfd_mutex;
+
+static bool
+ld_bfd_lock (void *data)
+{
+  if (pthread_mutex_lock ((pthread_mutex_t *) data) != 0)
+    {
+      bfd_set_error (bfd_error_system_call);
+      return false;
+    }
+  return true;
+}
+
+static bool
+ld_bfd_unlock (void *data)
+{
+  if (pthread_mutex_unlock ((pthread_mutex_t *) data) != 0)
+    {
+      bfd_set_error (bfd_error_system_call);
+      return false;
+    }
+  return true;
+}
+
+/* Allow BFD to be called from the threads started by
+   ld_parallel_run.  Returns false if that is not possible.  */
+
+static bool
+ld_thread_init (void)
+{
+  pthread_mutexattr_t attr;
+  bool ret;
+
+  if (pthread_mutexattr_init (&attr) != 0)
+    return false;
+  ret = (pthread_mutexattr_settype (&attr, PTHREAD_MUTEX_RECURSIVE) == 0
+	 && pthread_mutex_init (&ld_bfd_mutex, &attr) == 0);
+  pthread_mutexattr_destroy (&attr);
+  return ret && bfd_thread_init (ld_bfd_lock, ld_bfd_unlock, &ld_bfd_mutex);
+}
+
+/* The work shared by the threads of ld_parallel_run.  */
+
+struct parallel_work
+{
+  pthread_mutex_t lock;
+  void (*func) (void *, size_t);
+  void *data;
+  size_t next;
+  size_t count;
+  /* Set when a thread has stopped on a fatal error.  */
+  bool fatal;
+  /* The thread that called ld_parallel_run, and the threads it
+     started.  */
+  pthread_t main_thread;
+  pthread_t *threads;
+  size_t started;
+};
+
+/* The work of the current ld_parallel_run, if it started any
+   threads.  */
+
+static struct parallel_work *active_work;
+
+/* Call WORK->func for each index not yet claimed by another thread.  */
+
+static void
+parallel_work_run (struct parallel_work *work)
+{
+  for (;;)
+    {
+      size_t i;
+
+      pthread_mutex_lock (&work->lock);
+      i = work->next;
+      if (i < work->count)
+	work->next = i + 1;
+      pthread_mutex_unlock (&work->lock);
+      if (i >= work->count)
+	break;
+      work->func (work->data, i);
+    }
+}
+
+static void *
+parallel_work_thread (void *arg)
+{
+  parallel_work_run ((struct parallel_work *) arg);
+  bfd_thread_cleanup ();
+  return NULL;
+}
+
+/* Wait for the threads started for WORK.  */
+
+static void
+parallel_work_join (struct parallel_work *work)
+{
+  while (work->started > 0)
+    pthread_join (work->threads[--work->started], NULL);
+}
+
+/* The parallel_run callback.  The calling thread does its share of
+   the work, along with up to INFO->threads - 1 others.  If a thread
+   cannot be started the work is done by those that were.  */
+
+static void
+ld_parallel_run (struct bfd_link_info *info,
+		 void (*func) (void *, size_t), void *data, size_t count)
+{
+  struct parallel_work work;
+  pthread_t *threads;
+  size_t nthreads, i;
+
+  nthreads = info->threads;
+  if (nthreads > count)
+    nthreads = count;
+
+  work.func = func;
+  work.data = data;
+  work.next = 0;
+  work.count = count;
+  if (nthreads <= 1 || pthread_mutex_init (&work.lock, NULL) != 0)
+    {
+      for (i = 0; i < count; i++)
+	func (data, i);
+      return;
+    }
+
+  threads = xmalloc ((nthreads - 1) * sizeof (*threads));
+  work.fatal = false;
+  work.main_thread = pthread_self ();
+  work.threads = threads;
+  work.started = 0;
+  active_work = &work;
+  for (i = 0; i < nthreads - 1; i++)
+    {
+      if (pthread_create (&threads[i], NULL, parallel_work_thread,
+			  &work) != 0)
+	break;
+      work.started++;
+    }
+
+  parallel_work_run (&work);
+
+  parallel_work_join (&work);
+  active_work = NULL;
+  free (threads);
+  pthread_mutex_destroy (&work.lock);
+  if (work.fatal)
+    xexit (1);
+}
+
+#endif /* ENABLE_THREADS */
+
+/* Exit after a fatal error.  While input files are being relocated
+   by several threads, one started by ld_parallel_run stops only
+   itself, and ld_parallel_run exits once the others have stopped.
+   The main thread waits for them before exiting.  */
+
+void
+ld_fatal_exit (void)
+{
+#ifdef ENABLE_THREADS
+  struct parallel_work *work = active_work;
+
+  if (work != NULL)
+    {
+      pthread_mutex_lock (&work->lock);
+      work->fatal = true;
+      work->next = work->count;
+      pthread_mutex_unlock (&work->lock);
+      if (!pthread_equal (pthread_self (), work->main_thread))
+	{
+	  bfd_thread_cleanup ();
+	  pthread_exit (NULL);
+	}
+      parallel_work_join (work);
+      active_work = NULL;
+    }
+#endif
+  xexit (1);
 }
 
 static void
@@ -399,6 +602,14 @@ main (int argc, char **argv)
   if (config.hash_table_size != 0)
     bfd_hash_set_default_size (config.hash_table_size);
 
+#ifdef ENABLE_THREADS
+  if (link_info.threads > 1 && !ld_thread_init ())
+    {
+      einfo (_("%P: warning: cannot use threads, linking serially\n"));
+      link_info.threads = 0;
+    }
+#endif
+
 #if BFD_SUPPORTS_PLUGINS
   /* Now all the plugin arguments have been gathered, we can load them.  */
   plugin_load_plugins ();
@@ -1454,9 +1665,14 @@ undefined_symbol (struct bfd_link_info *info,
 
 #define MAX_ERRORS_IN_A_ROW 5
 
+  ld_lock_messages ();
+
   if (info->ignore_hash != NULL
       && bfd_hash_lookup (info->ignore_hash, name, false, false) != NULL)
-    return;
+    {
+      ld_unlock_messages ();
+      return;
+    }
 
   if (config.warn_once)
     {
@@ -1556,6 +1772,8 @@ undefined_symbol (struct bfd_link_info *info,
       else if (error)
 	einfo ("%X");
     }
+
+  ld_unlock_messages ();
 }
 
 /* Counter to limit the number of relocation overflow error messages
@@ -1579,8 +1797,14 @@ reloc_overflow (struct bfd_link_info *info,
 		asection *section,
 		bfd_vma address)
 {
+  /* Keep the pieces of the message together.  */
+  ld_lock_messages ();
+
   if (overflow_cutoff_limit == -1)
-    return;
+    {
+      ld_unlock_messages ();
+      return;
+    }
 
   einfo ("%X%H:", abfd, section, address);
 
@@ -1588,6 +1812,7 @@ reloc_overflow (struct bfd_link_info *info,
       && overflow_cutoff_limit-- == 0)
     {
       einfo (_(" additional relocation overflows omitted from the output\n"));
+      ld_unlock_messages ();
       return;
     }
 
@@ -1624,6 +1849,7 @@ reloc_overflow (struct bfd_link_info *info,
   if (addend != 0)
     einfo ("+%v", addend);
   einfo ("\n");
+  ld_unlock_messages ();
 }
 
 /* This is called when a dangerous relocation is made.  */
@@ -36,6 +36,65 @@
 #include "ldlex.h"
 #include "ldmain.h"
 #include "ldfile.h"
+#ifdef ENABLE_THREADS
+#include <pthread.h>
+#endif
+
+/* Input files may be relocated by several threads at once, any of
+   which may report an error.  This lock keeps one message from being
+   interleaved with another, and protects the state kept between
+   messages.  It is recursive because printing a message may print
+   another.  */
+
+#ifdef ENABLE_THREADS
+static pthread_once_t message_lock_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t message_lock;
+
+/* The number of times the thread holding the lock has taken it.  */
+static unsigned int message_lock_depth;
+
+static void
+init_message_lock (void)
+{
+  pthread_mutexattr_t attr;
+
+  pthread_mutexattr_init (&attr);
+  pthread_mutexattr_settype (&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init (&message_lock, &attr);
+  pthread_mutexattr_destroy (&attr);
+}
+#endif
+
+void
+ld_lock_messages (void)
+{
+#ifdef ENABLE_THREADS
+  pthread_once (&message_lock_once, init_message_lock);
+  pthread_mutex_lock (&message_lock);
+  message_lock_depth++;
+#endif
+}
+
+void
+ld_unlock_messages (void)
+{
+#ifdef ENABLE_THREADS
+  message_lock_depth--;
+  pthread_mutex_unlock (&message_lock);
+#endif
+}
+
+/* Release the lock as many times as the calling thread, which holds
+   it, has taken it.  */
+
+static void
+release_messages (void)
+{
+#ifdef ENABLE_THREADS
+  while (message_lock_depth != 0)
+    ld_unlock_messages ();
+#endif
+}
 
 /*
  %% literal %
@@ -99,7 +158,9 @@ vfinfo (FILE *fp, const char *fmt, va_list ap, bool is_warning)
 
   if (is_warning && config.no_warnings)
     return;
-  
+
+  ld_lock_messages ();
+
   for (arg_no = 0; arg_no < sizeof (args) / sizeof (args[0]); arg_no++)
     args[arg_no].type = Bad;
 
@@ -588,7 +649,14 @@ vfinfo (FILE *fp, const char *fmt, va_list ap, bool is_warning)
     config.make_executable = false;
 
   if (fatal)
-    xexit (1);
+    {
+      /* Our callers may hold the lock too.  Release it for good, so
+	 that other threads are not left waiting for it while we exit.  */
+      release_messages ();
+      ld_fatal_exit ();
+    }
+
+  ld_unlock_messages ();
 }
 
 /* Format info message and print on stdout.  */
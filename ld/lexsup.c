@@ -391,6 +391,12 @@ static const struct ld_option ld_options[] =
     '\0', NULL, N_("Do not demangle symbol names"), TWO_DASHES },
   { {"no-keep-memory", no_argument, NULL, OPTION_NO_KEEP_MEMORY},
     '\0', NULL, N_("Use less memory and more disk I/O"), TWO_DASHES },
+  { {"mmap-output", no_argument, NULL, OPTION_MMAP_OUTPUT},
+    '\0', NULL, N_("Relocate sections in the output file mapped into "
+		   "memory"), TWO_DASHES },
+  { {"no-mmap-output", no_argument, NULL, OPTION_NO_MMAP_OUTPUT},
+    '\0', NULL, N_("Write relocated sections to the output file "
+		   "(default)"), TWO_DASHES },
   { {"no-undefined", no_argument, NULL, OPTION_NO_UNDEFINED},
     '\0', NULL, N_("Do not allow unresolved references in object files"),
     TWO_DASHES },
@@ -505,6 +511,12 @@ static const struct ld_option ld_options[] =
     '\0', NULL, N_("Display target specific options"), TWO_DASHES },
   { {"task-link", required_argument, NULL, OPTION_TASK_LINK},
     '\0', N_("SYMBOL"), N_("Do task level linking"), TWO_DASHES },
+  { {"threads", optional_argument, NULL, OPTION_THREADS},
+    '\0', N_("[=COUNT]"), N_("Relocate input files using COUNT threads"),
+    TWO_DASHES },
+  { {"no-threads", no_argument, NULL, OPTION_NO_THREADS},
+    '\0', NULL, N_("Relocate input files one at a time (default)"),
+    TWO_DASHES },
   { {"traditional-format", no_argument, NULL, OPTION_TRADITIONAL_FORMAT},
     '\0', NULL, N_("Use same format as native linker"), TWO_DASHES },
   { {"section-start", required_argument, NULL, OPTION_SECTION_START},
@@ -1098,6 +1110,12 @@ parse_args (unsigned argc, char **argv)
 	case OPTION_NO_KEEP_MEMORY:
 	  link_info.keep_memory = false;
 	  break;
+	case OPTION_MMAP_OUTPUT:
+	  link_info.mmap_output = true;
+	  break;
+	case OPTION_NO_MMAP_OUTPUT:
+	  link_info.mmap_output = false;
+	  break;
 	case OPTION_NO_UNDEFINED:
 	  link_info.unresolved_syms_in_objects = RM_DIAGNOSE;
 	  break;
@@ -1762,6 +1780,34 @@ parse_args (unsigned argc, char **argv)
 	    config.hash_table_size = 1021;
 	  break;
 
+	case OPTION_THREADS:
+#ifdef ENABLE_THREADS
+	  if (optarg != NULL)
+	    {
+	      char *end;
+	      unsigned long count = strtoul (optarg, &end, 0);
+	      if (*end != '\0' || count == 0 || count > 1024)
+		einfo (_("%F%P: invalid thread count: %s\n"), optarg);
+	      link_info.threads = count;
+	    }
+	  else
+	    {
+	      long count = 0;
+#ifdef _SC_NPROCESSORS_ONLN
+	      count = sysconf (_SC_NPROCESSORS_ONLN);
+#endif
+	      link_info.threads = count > 0 ? count : 1;
+	    }
+#else
+	  einfo (_("%P: warning: --threads ignored, "
+		   "the linker was built without thread support\n"));
+#endif
+	  break;
+
+	case OPTION_NO_THREADS:
+	  link_info.threads = 0;
+	  break;
+
 	case OPTION_MAX_CACHE_SIZE:
 	  {
 	    char *end;
@@ -0,0 +1,34 @@
+	.text
+	.global _start
+	.global start
+	.global __start
+_start:
+start:
+__start:
+	.dc.a	0
+
+# Enough strings and constants, mostly the same in each file, for the
+# merged sections of all the files to be hashed in more than one batch.
+
+	.macro	merged_string
+	.asciz	"merged string \@ from the merge-threads tests"
+	.endm
+
+	.macro	merged_constant
+	.dc.l	\@ * 0x10001
+	.dc.l	\@
+	.endm
+
+	.section .rodata.str1.1,"aMS",%progbits,1
+	.rept	32000
+	merged_string
+	.endr
+	.asciz	"merge-threads-1"
+	.asciz	"from the merge-threads tests"
+	.asciz	"tests"
+
+	.section .rodata.cst8,"aM",%progbits,8
+	.balign	8
+	.rept	2000
+	merged_constant
+	.endr
@@ -0,0 +1,13 @@
+	.text
+	.global _start
+	.global start
+	.global __start
+_start:
+start:
+__start:
+	.dc.a	func
+	.dc.a	var
+
+	.data
+	.dc.a	_start
+	.dc.a	var
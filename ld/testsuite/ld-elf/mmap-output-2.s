@@ -0,0 +1,14 @@
+	.text
+	.global func
+func:
+	.dc.a	var
+	.dc.a	_start
+
+	.section .rodata,"a"
+	.asciz	"mmap output"
+
+	.data
+	.global var
+var:
+	.dc.a	func
+	.long	1
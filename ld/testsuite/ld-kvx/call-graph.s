@@ -0,0 +1,43 @@
+# Test function ordering from a weighted call graph
+
+	.text
+	.global _start
+_start:
+	call hot_a
+	;;
+	ret
+	;;
+
+	.section .text.cold1, "ax"
+	.global cold1
+	.type cold1, @function
+cold1:
+	call hot_c
+	;;
+	ret
+	;;
+
+	.section .text.hot_c, "ax"
+	.global hot_c
+	.type hot_c, @function
+hot_c:
+	ret
+	;;
+
+	.section .text.hot_b, "ax"
+	.global hot_b
+	.type hot_b, @function
+hot_b:
+	call hot_c
+	;;
+	ret
+	;;
+
+	.section .text.hot_a, "ax"
+	.global hot_a
+	.type hot_a, @function
+hot_a:
+	call hot_b
+	;;
+	ret
+	;;
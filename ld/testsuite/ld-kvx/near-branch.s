@@ -0,0 +1,30 @@
+	.global _start
+	.global far_fn
+	.global near_fn
+
+# near-branch.ld places .near right after .text, at just under the
+# maximum forward branch distance from the call to near_fn.  The stub
+# needed by the call to far_fn grows .text, which pushes near_fn out of
+# range of the call to it.
+
+	.text
+	.type _start, @function
+_start:
+	call	far_fn
+	;;
+	call	near_fn
+	;;
+	ret
+	;;
+
+	.section .far, "xa"
+	.type far_fn, @function
+far_fn:
+	ret
+	;;
+
+	.section .near, "xa"
+	.type near_fn, @function
+near_fn:
+	ret
+	;;
@@ -0,0 +1,18 @@
+	.global _start
+	.global foo
+	.weak baz
+
+	.text
+	.type _start, @function
+_start:
+	ld $r0 = @got(foo)[$r14]
+	;;
+	ld $r1 = @got(baz)[$r14]
+	;;
+	ret
+	;;
+
+	.data
+	.type foo, @object
+foo:
+	.8byte 0
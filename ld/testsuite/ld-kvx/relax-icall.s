@@ -0,0 +1,37 @@
+	.global _start
+	.global bar
+
+# We will place the section .text at 0x1000.
+
+	.text
+	.type _start, @function
+_start:
+	make $r0 = foo
+	;;
+	icall $r0
+	;;
+	make $r1 = bar
+	;;
+	igoto $r1
+	;;
+	make $r2 = foo
+	;;
+	goto 1f
+	;;
+	make $r2 = _start
+	;;
+1:
+	icall $r2
+	;;
+	.type foo, @function
+foo:
+	ret
+	;;
+
+# We will place the section .foo at 0x20001000.
+
+	.section .foo, "xa"
+	.type bar, @function
+bar:
+	ret
+	;;
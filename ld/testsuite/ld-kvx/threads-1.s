@@ -0,0 +1,22 @@
+	.global _start
+
+	.text
+	.type _start, @function
+_start:
+	call	func2
+	;;
+	call	func3
+	;;
+	make	$r0 = data2
+	;;
+	make	$r1 = local1
+	;;
+	goto	func3
+	;;
+
+	.data
+	.p2align 3
+local1:
+	.8byte	func2
+	.8byte	data3 + 8
+	.4byte	data2
@@ -0,0 +1,26 @@
+	.global func2
+	.global data2
+
+	.text
+	.type func2, @function
+func2:
+	call	func3
+	;;
+	make	$r0 = local2
+	;;
+	make	$r1 = data3
+	;;
+	ret
+	;;
+
+	.section .rodata
+	.p2align 3
+local2:
+	.8byte	func3
+	.8byte	local2
+
+	.data
+	.p2align 3
+data2:
+	.8byte	_start
+	.4byte	func3
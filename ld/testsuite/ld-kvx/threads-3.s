@@ -0,0 +1,19 @@
+	.global func3
+	.global data3
+
+	.text
+	.type func3, @function
+func3:
+	make	$r0 = data2
+	;;
+	cb.dnez	$r0 ? func2
+	;;
+	ret
+	;;
+
+	.data
+	.p2align 3
+data3:
+	.8byte	func2
+	.8byte	data2 + 4
+	.4byte	data3
@@ -0,0 +1,19 @@
+	.global _start
+	.global far_fn
+
+# The conditional branch reaches only 256K bytes away, and .far is
+# placed further than that.
+
+	.text
+	.type _start, @function
+_start:
+	cb.dnez	$r0 ? far_fn
+	;;
+	ret
+	;;
+
+	.section .far, "xa"
+	.type far_fn, @function
+far_fn:
+	ret
+	;;
@@ -0,0 +1,18 @@
+	.text
+	.globl	_start
+	.type	_start, @function
+_start:
+	call	func2
+	call	func3
+	leaq	data2(%rip), %rax
+	movl	$data3, %eax
+	movq	local1(%rip), %rax
+	ret
+	.size	_start, .-_start
+
+	.data
+	.p2align 3
+local1:
+	.quad	func2
+	.quad	data3 + 8
+	.long	_start - .
@@ -0,0 +1,22 @@
+	.text
+	.globl	func2
+	.type	func2, @function
+func2:
+	call	func3
+	leaq	local2(%rip), %rax
+	movq	data3(%rip), %rax
+	ret
+	.size	func2, .-func2
+
+	.section .rodata
+	.p2align 3
+local2:
+	.quad	func3
+	.quad	local2
+
+	.data
+	.p2align 3
+	.globl	data2
+data2:
+	.quad	_start
+	.long	func3 - .
@@ -0,0 +1,16 @@
+	.text
+	.globl	func3
+	.type	func3, @function
+func3:
+	leaq	data2(%rip), %rax
+	movl	data3+8(%rip), %edx
+	jmp	func2
+	.size	func3, .-func3
+
+	.data
+	.p2align 3
+	.globl	data3
+data3:
+	.quad	func2
+	.quad	data2 + 4
+	.long	data3 - .
@@ -120,6 +120,8 @@ struct raw_insn
   uint32_t syllables[KVX_MAXSYLLABLES];
   short length;
   short read_size;
+  /* The execution unit the instruction issues to.  */
+  short exu;
 };
 
 static uint32_t kvx_bundle_words[KVX_MAXBUNDLEWORDS];
@@ -140,6 +142,10 @@ struct issued_insn
 static int opt_pretty = 0;
 /* Option for not emiting a new line between all bundles.  */
 static int opt_compact_assembly = 0;
+/* Option for checking the decode index against a full opcode table scan.  */
+static int opt_check_decode_index = 0;
+/* Option for checking kvx_decode_bundles against print_insn_kvx.  */
+static int opt_check_decode_bundles = 0;
 /* Option for displaying the conditional syntax.  */
 
 void
@@ -164,6 +170,18 @@ parse_kvx_dis_option (const char *option)
       return;
     }
 
+  if (startswith (option, "check-decode-index"))
+    {
+      opt_check_decode_index = 1;
+      return;
+    }
+
+  if (startswith (option, "check-decode-bundles"))
+    {
+      opt_check_decode_bundles = 1;
+      return;
+    }
+
   /* Invalid option.  */
   opcodes_error_handler (_("unrecognised disassembler option: %s"), option);
 }
@@ -198,6 +216,24 @@ parse_kvx_dis_options (const char *options)
     }
 }
 
+/* Number of first syllable bits used to select a decode index bucket.  */
+#define KVX_DECODE_KEY_BITS 12
+
+/* Index of the decodable entries of an opcode table, bucketed by the value
+   of the KVX_DECODE_KEY_BITS most discriminating bits of their first
+   syllable.  An opcode that does not constrain some of these bits appears
+   in every bucket it may match.  Within a bucket, opcodes keep their
+   opcode table order so that decoding finds the same entry as a full
+   table scan.  */
+struct kvx_decode_index
+{
+  /* Per-byte lookup tables gathering the key bits of a syllable.  */
+  uint16_t key_lut[4][256];
+  /* Candidates for key K are ENTRIES[BUCKETS[K]] .. ENTRIES[BUCKETS[K+1]-1].  */
+  unsigned *buckets;
+  struct kvx_opc **entries;
+};
+
 struct kvx_dis_env
 {
   int kvx_arch_size;
@@ -207,10 +243,12 @@ struct kvx_dis_env
   int *kvx_dec_registers;
   int *kvx_regfiles;
   unsigned int kvx_max_dec_registers;
+  struct kvx_decode_index decode_index;
+  unsigned long mach;
   int initialized_p;
 };
 
-static struct kvx_dis_env env = {
+static struct kvx_dis_env dis_env = {
   .kvx_arch_size = 0,
   .opc_table = NULL,
   .kvx_registers = NULL,
@@ -218,62 +256,197 @@ static struct kvx_dis_env env = {
   .kvx_dec_registers = NULL,
   .kvx_regfiles = NULL,
   .initialized_p = 0,
-  .kvx_max_dec_registers = 0
+  .kvx_max_dec_registers = 0,
+  .mach = 0
 };
 
+/* Return whether OPC may be the result of decoding for the architecture
+   size of ENV.  */
+
+static inline int
+kvx_opc_decodable_p (const struct kvx_dis_env *env,
+		     const struct kvx_opc *opc)
+{
+  unsigned kvx_opcode_keep_flags = env->kvx_arch_size == 32 ?
+				    KVX_OPCODE_FLAG_MODE32 :
+				    KVX_OPCODE_FLAG_MODE64;
+  unsigned kvx_opcode_skip_flags = KVX_OPCODE_FLAG_RISCV;
+
+  return ((opc->codewords[0].flags & kvx_opcode_keep_flags)
+	  && !(opc->codewords[0].flags & kvx_opcode_skip_flags));
+}
+
+/* Return the decode index key of the first syllable SYLLABLE.  */
+
+static inline unsigned
+kvx_decode_key (const struct kvx_dis_env *env, uint32_t syllable)
+{
+  const struct kvx_decode_index *index = &env->decode_index;
+
+  return (index->key_lut[0][syllable & 0xff]
+	  | index->key_lut[1][(syllable >> 8) & 0xff]
+	  | index->key_lut[2][(syllable >> 16) & 0xff]
+	  | index->key_lut[3][syllable >> 24]);
+}
+
+/* Append OPC to ENTRIES[POS[KEY]++] for each decode index key KEY that a
+   first syllable matching OPC may have, where KEY_BITS[] lists the syllable
+   bit of each key bit.  When ENTRIES is NULL, only advance POS[].  */
+
 static void
-kvx_dis_init (struct disassemble_info *info)
+kvx_decode_index_add (struct kvx_opc *opc, const int *key_bits,
+		      unsigned *pos, struct kvx_opc **entries)
+{
+  unsigned fixed = 0, free_bits = 0;
+
+  for (int k = 0; k < KVX_DECODE_KEY_BITS; k++)
+    {
+      uint32_t bit = (uint32_t) 1 << key_bits[k];
+      if (!(opc->codewords[0].mask & bit))
+	free_bits |= 1u << k;
+      else if (opc->codewords[0].opcode & bit)
+	fixed |= 1u << k;
+    }
+
+  /* Enumerate the subsets of FREE_BITS.  */
+  unsigned sub = 0;
+  do
+    {
+      unsigned key = fixed | sub;
+      if (entries)
+	entries[pos[key]] = opc;
+      pos[key]++;
+      sub = (sub - free_bits) & free_bits;
+    }
+  while (sub != 0);
+}
+
+/* Build the decode index of the opcode table of ENV.  */
+
+static void
+kvx_build_decode_index (struct kvx_dis_env *env)
 {
-  env.kvx_arch_size = 32;
-  switch (info->mach)
+  struct kvx_decode_index *index = &env->decode_index;
+  const unsigned nb_keys = 1u << KVX_DECODE_KEY_BITS;
+  int bit_count[32] = { 0 };
+  int key_bits[KVX_DECODE_KEY_BITS];
+  unsigned *fill_pos;
+
+  free (index->buckets);
+  free (index->entries);
+  memset (index->key_lut, 0, sizeof (index->key_lut));
+
+  /* Select as key the first syllable bits most often fixed by opcodes.  */
+  for (struct kvx_opc *opc = env->opc_table;
+       opc->as_op && (((char) opc->as_op[0]) != 0); opc++)
+    if (kvx_opc_decodable_p (env, opc))
+      for (int b = 0; b < 32; b++)
+	if (opc->codewords[0].mask & ((uint32_t) 1 << b))
+	  bit_count[b]++;
+
+  for (int k = 0; k < KVX_DECODE_KEY_BITS; k++)
+    {
+      int best = -1;
+      for (int b = 31; b >= 0; b--)
+	if (bit_count[b] >= 0 && (best < 0 || bit_count[b] > bit_count[best]))
+	  best = b;
+      key_bits[k] = best;
+      bit_count[best] = -1;
+      for (int v = 0; v < 256; v++)
+	if (v & (1 << (best % 8)))
+	  index->key_lut[best / 8][v] |= 1u << k;
+    }
+
+  /* Count the candidates of each key, then fill the buckets in opcode
+     table order.  */
+  index->buckets = xcalloc (nb_keys + 1, sizeof (*index->buckets));
+  for (struct kvx_opc *opc = env->opc_table;
+       opc->as_op && (((char) opc->as_op[0]) != 0); opc++)
+    if (kvx_opc_decodable_p (env, opc))
+      kvx_decode_index_add (opc, key_bits, index->buckets + 1, NULL);
+
+  for (unsigned key = 0; key < nb_keys; key++)
+    index->buckets[key + 1] += index->buckets[key];
+
+  index->entries = xmalloc ((index->buckets[nb_keys] + 1)
+			    * sizeof (*index->entries));
+  fill_pos = xmalloc (nb_keys * sizeof (*fill_pos));
+  memcpy (fill_pos, index->buckets, nb_keys * sizeof (*fill_pos));
+  for (struct kvx_opc *opc = env->opc_table;
+       opc->as_op && (((char) opc->as_op[0]) != 0); opc++)
+    if (kvx_opc_decodable_p (env, opc))
+      kvx_decode_index_add (opc, key_bits, fill_pos, index->entries);
+  free (fill_pos);
+}
+
+static void kvx_check_decode_index (const struct kvx_dis_env *env);
+
+static void
+kvx_dis_init_mach (struct kvx_dis_env *env, unsigned long mach)
+{
+  env->kvx_arch_size = 32;
+  switch (mach)
     {
     case bfd_mach_kv3_1_64:
-      env.kvx_arch_size = 64;
+      env->kvx_arch_size = 64;
       /* fallthrough */
     case bfd_mach_kv3_1_usr:
     case bfd_mach_kv3_1:
     default:
-      env.opc_table = kv3_v1_optab;
-      env.kvx_regfiles = kv3_v1_regfiles;
-      env.kvx_registers = kv3_v1_registers;
-      env.kvx_modifiers = kv3_v1_modifiers;
-      env.kvx_dec_registers = kv3_v1_dec_registers;
-      env.kvx_max_dec_registers = kv3_v1_regfiles[KV3_V1_REGFILE_DEC_REGISTERS];
+      env->opc_table = kv3_v1_optab;
+      env->kvx_regfiles = kv3_v1_regfiles;
+      env->kvx_registers = kv3_v1_registers;
+      env->kvx_modifiers = kv3_v1_modifiers;
+      env->kvx_dec_registers = kv3_v1_dec_registers;
+      env->kvx_max_dec_registers = kv3_v1_regfiles[KV3_V1_REGFILE_DEC_REGISTERS];
       break;
     case bfd_mach_kv3_2_64:
-      env.kvx_arch_size = 64;
+      env->kvx_arch_size = 64;
       /* fallthrough */
     case bfd_mach_kv3_2_usr:
     case bfd_mach_kv3_2:
-      env.opc_table = kv3_v2_optab;
-      env.kvx_regfiles = kv3_v2_regfiles;
-      env.kvx_registers = kv3_v2_registers;
-      env.kvx_modifiers = kv3_v2_modifiers;
-      env.kvx_dec_registers = kv3_v2_dec_registers;
-      env.kvx_max_dec_registers = kv3_v2_regfiles[KV3_V2_REGFILE_DEC_REGISTERS];
+      env->opc_table = kv3_v2_optab;
+      env->kvx_regfiles = kv3_v2_regfiles;
+      env->kvx_registers = kv3_v2_registers;
+      env->kvx_modifiers = kv3_v2_modifiers;
+      env->kvx_dec_registers = kv3_v2_dec_registers;
+      env->kvx_max_dec_registers = kv3_v2_regfiles[KV3_V2_REGFILE_DEC_REGISTERS];
       break;
     case bfd_mach_kv4_1_64:
-      env.kvx_arch_size = 64;
+      env->kvx_arch_size = 64;
       /* fallthrough */
     case bfd_mach_kv4_1_usr:
     case bfd_mach_kv4_1:
-      env.opc_table = kv4_v1_optab;
-      env.kvx_regfiles = kv4_v1_regfiles;
-      env.kvx_registers = kv4_v1_registers;
-      env.kvx_modifiers = kv4_v1_modifiers;
-      env.kvx_dec_registers = kv4_v1_dec_registers;
-      env.kvx_max_dec_registers = kv4_v1_regfiles[KV4_V1_REGFILE_DEC_REGISTERS];
+      env->opc_table = kv4_v1_optab;
+      env->kvx_regfiles = kv4_v1_regfiles;
+      env->kvx_registers = kv4_v1_registers;
+      env->kvx_modifiers = kv4_v1_modifiers;
+      env->kvx_dec_registers = kv4_v1_dec_registers;
+      env->kvx_max_dec_registers = kv4_v1_regfiles[KV4_V1_REGFILE_DEC_REGISTERS];
       break;
     }
 
+  kvx_build_decode_index (env);
+  if (opt_check_decode_index)
+    kvx_check_decode_index (env);
+
+  env->mach = mach;
+  env->initialized_p = 1;
+}
+
+static void
+kvx_dis_init (struct disassemble_info *info)
+{
   if (info->disassembler_options)
     parse_kvx_dis_options (info->disassembler_options);
 
-  env.initialized_p = 1;
+  kvx_dis_init_mach (&dis_env, info->mach);
 }
 
 static int
-kv3_steer_bundle_insns (int word_cnt, int *_insn_cnt)
+kv3_steer_bundle_insns (const uint32_t *bundle_words,
+			struct raw_insn *bundle_insns, int word_cnt,
+			int *_insn_cnt)
 {
   /* Issue lanes taken.  */
   int bcu_taken = 0;
@@ -292,7 +465,7 @@ kv3_steer_bundle_insns (int word_cnt, int *_insn_cnt)
   int index = 0;
   for (; index < word_cnt; index++)
     {
-      uint32_t syllable = kvx_bundle_words[index];
+      uint32_t syllable = bundle_words[index];
       switch (kvx_steering (syllable))
 	{
 	case Steering_BCU:
@@ -394,7 +567,7 @@ kv3_steer_bundle_insns (int word_cnt, int *_insn_cnt)
 	break;
     }
 
-  if (kvx_has_parallel_bit (kvx_bundle_words[index]))
+  if (kvx_has_parallel_bit (bundle_words[index]))
     return FAIL("Bundle exceeds maximum size");
 
   /* Fill KVX_BUNDLE_INSNS and count read syllables.  */
@@ -406,21 +579,22 @@ kv3_steer_bundle_insns (int word_cnt, int *_insn_cnt)
 	  int syllable_idx = 0;
 
 	  /* First copy the opcode.  */
-	  kvx_bundle_insns[insn_idx].syllables[syllable_idx++] =
+	  bundle_insns[insn_idx].syllables[syllable_idx++] =
 	      issued_insns[exu].opcode;
-	  kvx_bundle_insns[insn_idx].length = 1;
+	  bundle_insns[insn_idx].length = 1;
 
 	  /* Copy up to two immediate extension words.  */
 	  for (int j = 0; j < 2; j++)
 	    if (issued_insns[exu].immx_valid[j])
 	      {
-		kvx_bundle_insns[insn_idx].syllables[syllable_idx++] =
+		bundle_insns[insn_idx].syllables[syllable_idx++] =
 		    issued_insns[exu].immx_words[j];
-		kvx_bundle_insns[insn_idx].length++;
+		bundle_insns[insn_idx].length++;
 	      }
 	
-	  kvx_bundle_insns[insn_idx].read_size =
-	      kvx_bundle_insns[insn_idx].length * 4;
+	  bundle_insns[insn_idx].read_size =
+	      bundle_insns[insn_idx].length * 4;
+	  bundle_insns[insn_idx].exu = exu;
 
 	  insn_idx++;
 	}
@@ -431,7 +605,9 @@ kv3_steer_bundle_insns (int word_cnt, int *_insn_cnt)
 }
 
 static int
-kv4_steer_bundle_insns (int word_cnt, int *_insn_cnt)
+kv4_steer_bundle_insns (const uint32_t *bundle_words,
+			struct raw_insn *bundle_insns, int word_cnt,
+			int *_insn_cnt)
 {
   /* Issue lanes in use.  */
   int bcu_inuse = 0;
@@ -448,7 +624,7 @@ kv4_steer_bundle_insns (int word_cnt, int *_insn_cnt)
   int index = 0;
   for (; index < word_cnt; index++)
     {
-      uint32_t syllable = kvx_bundle_words[index];
+      uint32_t syllable = bundle_words[index];
       switch (kvx_steering (syllable))
 	{
 	case Steering_BCU:
@@ -577,7 +753,7 @@ kv4_steer_bundle_insns (int word_cnt, int *_insn_cnt)
 
     }
 
-  if (kvx_has_parallel_bit (kvx_bundle_words[index]))
+  if (kvx_has_parallel_bit (bundle_words[index]))
     return FAIL("Bundle exceeds maximum size");
 
   /* Fill KVX_BUNDLE_INSNS and count read syllables.  */
@@ -589,21 +765,22 @@ kv4_steer_bundle_insns (int word_cnt, int *_insn_cnt)
 	  int syllable_idx = 0;
 
 	  /* First copy the opcode.  */
-	  kvx_bundle_insns[insn_idx].syllables[syllable_idx++] =
+	  bundle_insns[insn_idx].syllables[syllable_idx++] =
 	      issued_insns[exu].opcode;
-	  kvx_bundle_insns[insn_idx].length = 1;
+	  bundle_insns[insn_idx].length = 1;
 
 	  /* Copy up to two immediate extension words.  */
 	  for (int j = 0; j < 2; j++)
 	    if (issued_insns[exu].immx_valid[j])
 	      {
-		kvx_bundle_insns[insn_idx].syllables[syllable_idx++] =
+		bundle_insns[insn_idx].syllables[syllable_idx++] =
 		    issued_insns[exu].immx_words[j];
-		kvx_bundle_insns[insn_idx].length++;
+		bundle_insns[insn_idx].length++;
 	      }
 
-	  kvx_bundle_insns[insn_idx].read_size =
-	      kvx_bundle_insns[insn_idx].length * 4;
+	  bundle_insns[insn_idx].read_size =
+	      bundle_insns[insn_idx].length * 4;
+	  bundle_insns[insn_idx].exu = exu;
 
 	  insn_idx++;
 	}
@@ -614,10 +791,11 @@ kv4_steer_bundle_insns (int word_cnt, int *_insn_cnt)
 }
 
 static int
-kvx_steer_bundle_insns (struct disassemble_info *info,
-		       int word_cnt, int *_insn_cnt)
+kvx_steer_bundle_insns (unsigned long mach, const uint32_t *bundle_words,
+			struct raw_insn *bundle_insns, int word_cnt,
+			int *_insn_cnt)
 {
-  switch (info->mach)
+  switch (mach)
     {
     case bfd_mach_kv3_1_64:
     case bfd_mach_kv3_1_usr:
@@ -626,526 +804,613 @@ kvx_steer_bundle_insns (struct disassemble_info *info,
     case bfd_mach_kv3_2_usr:
     case bfd_mach_kv3_2:
     default:
-      return kv3_steer_bundle_insns (word_cnt, _insn_cnt);
+      return kv3_steer_bundle_insns (bundle_words, bundle_insns, word_cnt,
+				     _insn_cnt);
       break;
     case bfd_mach_kv4_1_64:
     case bfd_mach_kv4_1_usr:
     case bfd_mach_kv4_1:
-      return kv4_steer_bundle_insns (word_cnt, _insn_cnt);
+      return kv4_steer_bundle_insns (bundle_words, bundle_insns, word_cnt,
+				     _insn_cnt);
       break;
     }
   return FAIL("Unknown machine architecture.");
 }
 
-struct decoded_insn
-{
-  /* The entry in the opc_table.  */
-  struct kvx_opc *opc;
-  /* The number of operands.  */
-  int nb_ops;
-  /* The operand type.  */
-  struct
-  {
-    enum
-    {
-      CAT_REGISTER,
-      CAT_MODIFIER,
-      CAT_IMMEDIATE,
-    } type;
-    /* The operand value.  */
-    uint64_t val;
-    /* If it is an immediate, its sign.  */
-    int sign;
-    /* If it is an immediate, is it pc relative.  */
-    int pcrel;
-    /* The bit width of the operand.  */
-    int width;
-    /* If it is a modifier, the modifier category.
-       An index in the modifier table.  */
-    int mod_idx;
-  } operands[KVX_MAXOPERANDS];
-};
+/* Return whether the syllables of RAW_INSN match the opcode OPC.  */
 
-static int
-decode_insn (bfd_vma memaddr, struct raw_insn *raw_insn, struct decoded_insn *res)
+static inline int
+kvx_opc_match_p (const struct kvx_opc *opc, const struct raw_insn *raw_insn)
 {
+  if (opc->wordcount != raw_insn->length)
+    return 0;
 
-  unsigned kvx_opcode_keep_flags = env.kvx_arch_size == 32 ?
-				    KVX_OPCODE_FLAG_MODE32 :
-				    KVX_OPCODE_FLAG_MODE64;
-  unsigned kvx_opcode_skip_flags = KVX_OPCODE_FLAG_RISCV;
+  for (int i = 0; i < opc->wordcount; i++)
+    if ((opc->codewords[i].mask & raw_insn->syllables[i]) !=
+	opc->codewords[i].opcode)
+      return 0;
 
-  int found = 0;
-  int idx = 0;
-  for (struct kvx_opc *opc = env.opc_table;
-       opc->as_op && (((char) opc->as_op[0]) != 0); opc++)
-    {
-      if (!(opc->codewords[0].flags & kvx_opcode_keep_flags)
-	  || (opc->codewords[0].flags & kvx_opcode_skip_flags))
-	continue;
+  return 1;
+}
 
-      if (opc->wordcount != raw_insn->length)
-	continue;
+/* Decode the operands of RAW_INSN as an instance of OPC into RES.
+   Return 0 if some operand does not decode to a valid modifier, in which
+   case the search must continue with the next candidate opcode.  */
 
-      int opcode_match = 1;
-      for (int i = 0; i < opc->wordcount; i++)
-	if ((opc->codewords[i].mask & raw_insn->syllables[i]) !=
-	    opc->codewords[i].opcode)
-	  opcode_match = 0;
+static int
+decode_insn_operands (const struct kvx_dis_env *env, bfd_vma memaddr,
+		      struct raw_insn *raw_insn, struct kvx_opc *opc,
+		      struct kvx_decoded_insn *res)
+{
+  int idx = 0;
 
-      if (opcode_match)
-	{
-	  res->opc = opc;
+  res->opc = opc;
+  res->nb_ops = 0;
 
-	  for (int i = 0; opc->format[i]; i++)
-	    {
-	      struct kvx_bitfield *bf = opc->format[i]->bfield;
-	      int bf_nb = opc->format[i]->bitfields;
-	      int width = opc->format[i]->width;
-	      int type = opc->format[i]->type;
-	      const char *type_name = opc->format[i]->tname;
-	      int flags = opc->format[i]->flags;
-	      int shift = opc->format[i]->shift;
-	      int bias = opc->format[i]->bias;
-	      uint64_t value = 0;
-
-	      for (int bf_idx = 0; bf_idx < bf_nb; bf_idx++)
-		{
-		  int insn_idx = (int) bf[bf_idx].to_offset / 32;
-		  int to_offset = bf[bf_idx].to_offset % 32;
-		  uint64_t encoded_value =
-		    raw_insn->syllables[insn_idx] >> to_offset;
-		  encoded_value &= (1LL << bf[bf_idx].size) - 1;
-		  value |= encoded_value << bf[bf_idx].from_offset;
-		}
-	      if (flags & KVX_OPERAND_SIGNED)
-		{
-		  uint64_t signbit = 1LL << (width - 1);
-		  value = (value ^ signbit) - signbit;
-		}
-	      value = (value << shift) + bias;
+  for (int i = 0; opc->format[i]; i++)
+    {
+      struct kvx_bitfield *bf = opc->format[i]->bfield;
+      int bf_nb = opc->format[i]->bitfields;
+      int width = opc->format[i]->width;
+      int type = opc->format[i]->type;
+      const char *type_name = opc->format[i]->tname;
+      int flags = opc->format[i]->flags;
+      int shift = opc->format[i]->shift;
+      int bias = opc->format[i]->bias;
+      uint64_t value = 0;
+
+      for (int bf_idx = 0; bf_idx < bf_nb; bf_idx++)
+	{
+	  int insn_idx = (int) bf[bf_idx].to_offset / 32;
+	  int to_offset = bf[bf_idx].to_offset % 32;
+	  uint64_t encoded_value =
+	    raw_insn->syllables[insn_idx] >> to_offset;
+	  encoded_value &= (1LL << bf[bf_idx].size) - 1;
+	  value |= encoded_value << bf[bf_idx].from_offset;
+	}
+      if (flags & KVX_OPERAND_SIGNED)
+	{
+	  uint64_t signbit = 1LL << (width - 1);
+	  value = (value ^ signbit) - signbit;
+	}
+      value = (value << shift) + bias;
 
 #define KVX_PRINT_REG(regfile,value) \
-    if(env.kvx_regfiles[regfile]+value < env.kvx_max_dec_registers) { \
-	res->operands[idx].val = env.kvx_dec_registers[env.kvx_regfiles[regfile]+value]; \
-	res->operands[idx].type = CAT_REGISTER; \
+    if(env->kvx_regfiles[regfile]+value < env->kvx_max_dec_registers) { \
+	res->operands[idx].val = env->kvx_dec_registers[env->kvx_regfiles[regfile]+value]; \
+	res->operands[idx].type = KVX_CAT_REGISTER; \
 	idx++; \
     } else { \
 	res->operands[idx].val = ~0; \
-	res->operands[idx].type = CAT_REGISTER; \
+	res->operands[idx].type = KVX_CAT_REGISTER; \
 	idx++; \
     }
 
-	      if (env.opc_table == kv3_v1_optab)
-		{
-		  switch (type)
-		    {
-		    case RegClass_kv3_v1_singleReg:
-		      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_GPR, value)
-		      break;
-		    case RegClass_kv3_v1_pairedReg:
-		      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_PGR, value)
-		      break;
-		    case RegClass_kv3_v1_quadReg:
-		      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_QGR, value)
-		      break;
-		    case RegClass_kv3_v1_systemReg:
-		    case RegClass_kv3_v1_aloneReg:
-		    case RegClass_kv3_v1_onlyraReg:
-		    case RegClass_kv3_v1_onlygetReg:
-		    case RegClass_kv3_v1_onlysetReg:
-		    case RegClass_kv3_v1_onlyfxReg:
-		    case RegClass_kv3_v1_onlyswapReg:
-		      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_SFR, value)
-		      break;
-		    case RegClass_kv3_v1_xworddReg0M4:
-		    case RegClass_kv3_v1_xworddReg1M4:
-		    case RegClass_kv3_v1_xworddReg2M4:
-		    case RegClass_kv3_v1_xworddReg3M4:
-		      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_XCR, value)
-		      break;
-		    case RegClass_kv3_v1_xwordqRegE:
-		    case RegClass_kv3_v1_xwordqRegO:
-		    case RegClass_kv3_v1_xwordqReg0M4:
-		    case RegClass_kv3_v1_xwordqReg1M4:
-		    case RegClass_kv3_v1_xwordqReg2M4:
-		    case RegClass_kv3_v1_xwordqReg3M4:
-		      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_XBR, value)
-		      break;
-		    case RegClass_kv3_v1_xwordoReg:
-		    case RegClass_kv3_v1_xwordoRegE:
-		    case RegClass_kv3_v1_xwordoRegO:
-		      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_XVR, value)
-		      break;
-		    case RegClass_kv3_v1_xwordxReg:
-		      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_XTR, value)
-		      break;
-		    case RegClass_kv3_v1_xwordvReg:
-		      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_XMR, value)
-		      break;
-		    case Immediate_kv3_v1_sysnumber:
-		    case Immediate_kv3_v1_signed10:
-		    case Immediate_kv3_v1_signed16:
-		    case Immediate_kv3_v1_signed27:
-		    case Immediate_kv3_v1_wrapped32:
-		    case Immediate_kv3_v1_signed37:
-		    case Immediate_kv3_v1_signed43:
-		    case Immediate_kv3_v1_signed54:
-		    case Immediate_kv3_v1_wrapped64:
-		    case Immediate_kv3_v1_unsigned6:
-		      res->operands[idx].val = value;
-		      res->operands[idx].sign = flags & KVX_OPERAND_SIGNED;
-		      res->operands[idx].width = width;
-		      res->operands[idx].type = CAT_IMMEDIATE;
-		      res->operands[idx].pcrel = 0;
-		      idx++;
-		      break;
-		    case Immediate_kv3_v1_pcrel17:
-		    case Immediate_kv3_v1_pcrel27:
-		      res->operands[idx].val = value + memaddr;
-		      res->operands[idx].sign = flags & KVX_OPERAND_SIGNED;
-		      res->operands[idx].width = width;
-		      res->operands[idx].type = CAT_IMMEDIATE;
-		      res->operands[idx].pcrel = 1;
-		      idx++;
-		      break;
-		    case Modifier_kv3_v1_column:
-		    case Modifier_kv3_v1_comparison:
-		    case Modifier_kv3_v1_doscale:
-		    case Modifier_kv3_v1_exunum:
-		    case Modifier_kv3_v1_floatcomp:
-		    case Modifier_kv3_v1_qindex:
-		    case Modifier_kv3_v1_rectify:
-		    case Modifier_kv3_v1_rounding:
-		    case Modifier_kv3_v1_roundint:
-		    case Modifier_kv3_v1_saturate:
-		    case Modifier_kv3_v1_scalarcond:
-		    case Modifier_kv3_v1_silent:
-		    case Modifier_kv3_v1_simdcond:
-		    case Modifier_kv3_v1_speculate:
-		    case Modifier_kv3_v1_splat32:
-		    case Modifier_kv3_v1_variant:
-		      {
-			int sz = 0;
-			int mod_idx = type - Modifier_kv3_v1_column;
-			for (sz = 0; env.kvx_modifiers[mod_idx][sz]; ++sz);
-			const char *mod = value < (unsigned) sz
-			  ? env.kvx_modifiers[mod_idx][value] : NULL;
-			if (!mod) goto retry;
-			res->operands[idx].val = value;
-			res->operands[idx].type = CAT_MODIFIER;
-			res->operands[idx].mod_idx = mod_idx;
-			idx++;
-		      }
-		      break;
-		    default:
-		      fprintf (stderr, "error: unexpected operand type (%s)\n",
-			       type_name);
-		      exit (-1);
-		    };
-		}
-	      else if (env.opc_table == kv3_v2_optab)
-		{
-		  switch (type)
-		    {
-		    case RegClass_kv3_v2_singleReg:
-		      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_GPR, value)
-		      break;
-		    case RegClass_kv3_v2_pairedReg:
-		      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_PGR, value)
-		      break;
-		    case RegClass_kv3_v2_quadReg:
-		      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_QGR, value)
-		      break;
-		    case RegClass_kv3_v2_systemReg:
-		    case RegClass_kv3_v2_aloneReg:
-		    case RegClass_kv3_v2_onlyraReg:
-		    case RegClass_kv3_v2_onlygetReg:
-		    case RegClass_kv3_v2_onlysetReg:
-		    case RegClass_kv3_v2_onlyfxReg:
-		    case RegClass_kv3_v2_onlyswapReg:
-		      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_SFR, value)
-		      break;
-		    case RegClass_kv3_v2_xworddReg:
-		    case RegClass_kv3_v2_xworddReg0M4:
-		    case RegClass_kv3_v2_xworddReg1M4:
-		    case RegClass_kv3_v2_xworddReg2M4:
-		    case RegClass_kv3_v2_xworddReg3M4:
-		      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_XCR, value)
-		      break;
-		    case RegClass_kv3_v2_xwordqReg:
-		    case RegClass_kv3_v2_xwordqRegE:
-		    case RegClass_kv3_v2_xwordqRegO:
-		      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_XBR, value)
-		      break;
-		    case RegClass_kv3_v2_xwordoReg:
-		      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_XVR, value)
-		      break;
-		    case RegClass_kv3_v2_xwordxReg:
-		      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_XTR, value)
-		      break;
-		    case RegClass_kv3_v2_xwordvReg:
-		      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_XMR, value)
-		      break;
-		    case RegClass_kv3_v2_buffer2Reg:
-		      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_X2R, value)
-		      break;
-		    case RegClass_kv3_v2_buffer4Reg:
-		      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_X4R, value)
-		      break;
-		    case RegClass_kv3_v2_buffer8Reg:
-		      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_X8R, value)
-		      break;
-		    case RegClass_kv3_v2_buffer16Reg:
-		      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_X16R, value)
-		      break;
-		    case RegClass_kv3_v2_buffer32Reg:
-		      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_X32R, value)
-		      break;
-		    case RegClass_kv3_v2_buffer64Reg:
-		      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_X64R, value)
-		      break;
-		    case Immediate_kv3_v2_brknumber:
-		    case Immediate_kv3_v2_sysnumber:
-		    case Immediate_kv3_v2_signed10:
-		    case Immediate_kv3_v2_signed16:
-		    case Immediate_kv3_v2_signed27:
-		    case Immediate_kv3_v2_wrapped32:
-		    case Immediate_kv3_v2_signed37:
-		    case Immediate_kv3_v2_signed43:
-		    case Immediate_kv3_v2_signed54:
-		    case Immediate_kv3_v2_wrapped64:
-		    case Immediate_kv3_v2_unsigned6:
-		      res->operands[idx].val = value;
-		      res->operands[idx].sign = flags & KVX_OPERAND_SIGNED;
-		      res->operands[idx].width = width;
-		      res->operands[idx].type = CAT_IMMEDIATE;
-		      res->operands[idx].pcrel = 0;
-		      idx++;
-		      break;
-		    case Immediate_kv3_v2_pcrel27:
-		    case Immediate_kv3_v2_pcrel17:
-		      res->operands[idx].val = value + memaddr;
-		      res->operands[idx].sign = flags & KVX_OPERAND_SIGNED;
-		      res->operands[idx].width = width;
-		      res->operands[idx].type = CAT_IMMEDIATE;
-		      res->operands[idx].pcrel = 1;
-		      idx++;
-		      break;
-		    case Modifier_kv3_v2_accesses:
-		    case Modifier_kv3_v2_boolcas:
-		    case Modifier_kv3_v2_cachelev:
-		    case Modifier_kv3_v2_channel:
-		    case Modifier_kv3_v2_coherency:
-		    case Modifier_kv3_v2_comparison:
-		    case Modifier_kv3_v2_conjugate:
-		    case Modifier_kv3_v2_doscale:
-		    case Modifier_kv3_v2_exunum:
-		    case Modifier_kv3_v2_floatcomp:
-		    case Modifier_kv3_v2_hindex:
-		    case Modifier_kv3_v2_lsomask:
-		    case Modifier_kv3_v2_lsumask:
-		    case Modifier_kv3_v2_qindex:
-		    case Modifier_kv3_v2_rounding:
-		    case Modifier_kv3_v2_scalarcond:
-		    case Modifier_kv3_v2_shuffleV:
-		    case Modifier_kv3_v2_shuffleX:
-		    case Modifier_kv3_v2_silent:
-		    case Modifier_kv3_v2_simdcond:
-		    case Modifier_kv3_v2_speculate:
-		    case Modifier_kv3_v2_splat32:
-		    case Modifier_kv3_v2_transpose:
-		    case Modifier_kv3_v2_variant:
-		      {
-			int sz = 0;
-			int mod_idx = type - Modifier_kv3_v2_accesses;
-			for (sz = 0; env.kvx_modifiers[mod_idx][sz];
-			     ++sz);
-			const char *mod = value < (unsigned) sz
-			  ? env.kvx_modifiers[mod_idx][value] : NULL;
-			if (!mod) goto retry;
-			res->operands[idx].val = value;
-			res->operands[idx].type = CAT_MODIFIER;
-			res->operands[idx].mod_idx = mod_idx;
-			idx++;
-		      };
-		      break;
-		    default:
-		      fprintf (stderr, "error: unexpected operand type (%s)\n",
-			       type_name);
-		      exit (-1);
-		    };
-		}
-	      else if (env.opc_table == kv4_v1_optab)
-		{
-		  switch (type)
-		    {
-		    case RegClass_kv4_v1_singleReg:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_GPR, value)
-		      break;
-		    case RegClass_kv4_v1_pairedReg:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_PGR, value)
-		      break;
-		    case RegClass_kv4_v1_quadReg:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_QGR, value)
-		      break;
-		    case RegClass_kv4_v1_systemReg:
-		    case RegClass_kv4_v1_aloneReg:
-		    case RegClass_kv4_v1_onlyraReg:
-		    case RegClass_kv4_v1_onlygetReg:
-		    case RegClass_kv4_v1_onlysetReg:
-		    case RegClass_kv4_v1_onlyfxReg:
-		    case RegClass_kv4_v1_onlyswapReg:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_SFR, value)
-		      break;
-		    case RegClass_kv4_v1_xworddReg:
-		    case RegClass_kv4_v1_xworddReg0M4:
-		    case RegClass_kv4_v1_xworddReg1M4:
-		    case RegClass_kv4_v1_xworddReg2M4:
-		    case RegClass_kv4_v1_xworddReg3M4:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_XCR, value)
-		      break;
-		    case RegClass_kv4_v1_xwordqReg:
-		    case RegClass_kv4_v1_xwordqRegE:
-		    case RegClass_kv4_v1_xwordqRegO:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_XBR, value)
-		      break;
-		    case RegClass_kv4_v1_xwordoReg:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_XVR, value)
-		      break;
-		    case RegClass_kv4_v1_xwordxReg:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_XTR, value)
-		      break;
-		    case RegClass_kv4_v1_xwordvReg:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_XMR, value)
-		      break;
-		    case RegClass_kv4_v1_buffer2Reg:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_X2R, value)
-		      break;
-		    case RegClass_kv4_v1_buffer4Reg:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_X4R, value)
-		      break;
-		    case RegClass_kv4_v1_buffer8Reg:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_X8R, value)
-		      break;
-		    case RegClass_kv4_v1_buffer16Reg:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_X16R, value)
-		      break;
-		    case RegClass_kv4_v1_buffer32Reg:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_X32R, value)
-		      break;
-		    case RegClass_kv4_v1_buffer64Reg:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_X64R, value)
-		      break;
-		    case RegClass_kv4_v1_mainReg:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_FIRST_RV_BIR, value)
-		      break;
-		    case RegClass_kv4_v1_floatReg:
-		      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_RV_FPR, value)
-		      break;
-		    case Immediate_kv4_v1_brknumber:
-		    case Immediate_kv4_v1_sysnumber:
-		    case Immediate_kv4_v1_signed10:
-		    case Immediate_kv4_v1_signed12:
-		    case Immediate_kv4_v1_signed16:
-		    case Immediate_kv4_v1_signed20:
-		    case Immediate_kv4_v1_signed27:
-		    case Immediate_kv4_v1_wrapped32:
-		    case Immediate_kv4_v1_signed37:
-		    case Immediate_kv4_v1_signed43:
-		    case Immediate_kv4_v1_signed54:
-		    case Immediate_kv4_v1_wrapped64:
-		    case Immediate_kv4_v1_unsigned6:
-		      res->operands[idx].val = value;
-		      res->operands[idx].sign = flags & KVX_OPERAND_SIGNED;
-		      res->operands[idx].width = width;
-		      res->operands[idx].type = CAT_IMMEDIATE;
-		      res->operands[idx].pcrel = 0;
-		      idx++;
-		      break;
-		    case Immediate_kv4_v1_pcrel11:
-		    case Immediate_kv4_v1_pcrel12:
-		    case Immediate_kv4_v1_pcrel17:
-		    case Immediate_kv4_v1_pcrel20:
-		    case Immediate_kv4_v1_pcrel27:
-		    case Immediate_kv4_v1_pcrel38:
-		      res->operands[idx].val = value + memaddr;
-		      res->operands[idx].sign = flags & KVX_OPERAND_SIGNED;
-		      res->operands[idx].width = width;
-		      res->operands[idx].type = CAT_IMMEDIATE;
-		      res->operands[idx].pcrel = 1;
-		      idx++;
-		      break;
-		    case Modifier_kv4_v1_accesses:
-		    case Modifier_kv4_v1_boolcas:
-		    case Modifier_kv4_v1_cachelev:
-		    case Modifier_kv4_v1_channel:
-		    case Modifier_kv4_v1_coherency:
-		    case Modifier_kv4_v1_conjugate:
-		    case Modifier_kv4_v1_realimag:
-		    case Modifier_kv4_v1_doscale:
-		    case Modifier_kv4_v1_exunum:
-		    case Modifier_kv4_v1_floatcomp:
-		    case Modifier_kv4_v1_hindex:
-		    case Modifier_kv4_v1_qindex:
-		    case Modifier_kv4_v1_floatmode:
-		    case Modifier_kv4_v1_ccbcomp:
-		    case Modifier_kv4_v1_intcomp:
-		    case Modifier_kv4_v1_bcucond:
-		    case Modifier_kv4_v1_shuffleV:
-		    case Modifier_kv4_v1_shuffleX:
-		    case Modifier_kv4_v1_lanecond:
-		    case Modifier_kv4_v1_speculate:
-		    case Modifier_kv4_v1_splat32:
-		    case Modifier_kv4_v1_variant:
-		    case Modifier_kv4_v1_lanetodo:
-		    case Modifier_kv4_v1_lanesize:
-		    case Modifier_kv4_v1_signextw:
-		      {
-			int sz = 0;
-			int mod_idx = type - Modifier_kv4_v1_accesses;
-			for (sz = 0; env.kvx_modifiers[mod_idx][sz]; ++sz);
-			const char *mod = value < (unsigned) sz
-			  ? env.kvx_modifiers[mod_idx][value] : NULL;
-			if (!mod) goto retry;
-			res->operands[idx].val = value;
-			res->operands[idx].type = CAT_MODIFIER;
-			res->operands[idx].mod_idx = mod_idx;
-			idx++;
-		      }
-		      break;
-		    default:
-		      fprintf (stderr, "error: unexpected operand type (%s)\n",
-			       type_name);
-		      exit (-1);
-		    };
-		}
+      if (env->opc_table == kv3_v1_optab)
+	{
+	  switch (type)
+	    {
+	    case RegClass_kv3_v1_singleReg:
+	      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_GPR, value)
+	      break;
+	    case RegClass_kv3_v1_pairedReg:
+	      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_PGR, value)
+	      break;
+	    case RegClass_kv3_v1_quadReg:
+	      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_QGR, value)
+	      break;
+	    case RegClass_kv3_v1_systemReg:
+	    case RegClass_kv3_v1_aloneReg:
+	    case RegClass_kv3_v1_onlyraReg:
+	    case RegClass_kv3_v1_onlygetReg:
+	    case RegClass_kv3_v1_onlysetReg:
+	    case RegClass_kv3_v1_onlyfxReg:
+	    case RegClass_kv3_v1_onlyswapReg:
+	      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_SFR, value)
+	      break;
+	    case RegClass_kv3_v1_xworddReg0M4:
+	    case RegClass_kv3_v1_xworddReg1M4:
+	    case RegClass_kv3_v1_xworddReg2M4:
+	    case RegClass_kv3_v1_xworddReg3M4:
+	      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_XCR, value)
+	      break;
+	    case RegClass_kv3_v1_xwordqRegE:
+	    case RegClass_kv3_v1_xwordqRegO:
+	    case RegClass_kv3_v1_xwordqReg0M4:
+	    case RegClass_kv3_v1_xwordqReg1M4:
+	    case RegClass_kv3_v1_xwordqReg2M4:
+	    case RegClass_kv3_v1_xwordqReg3M4:
+	      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_XBR, value)
+	      break;
+	    case RegClass_kv3_v1_xwordoReg:
+	    case RegClass_kv3_v1_xwordoRegE:
+	    case RegClass_kv3_v1_xwordoRegO:
+	      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_XVR, value)
+	      break;
+	    case RegClass_kv3_v1_xwordxReg:
+	      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_XTR, value)
+	      break;
+	    case RegClass_kv3_v1_xwordvReg:
+	      KVX_PRINT_REG (KV3_V1_REGFILE_DEC_XMR, value)
+	      break;
+	    case Immediate_kv3_v1_sysnumber:
+	    case Immediate_kv3_v1_signed10:
+	    case Immediate_kv3_v1_signed16:
+	    case Immediate_kv3_v1_signed27:
+	    case Immediate_kv3_v1_wrapped32:
+	    case Immediate_kv3_v1_signed37:
+	    case Immediate_kv3_v1_signed43:
+	    case Immediate_kv3_v1_signed54:
+	    case Immediate_kv3_v1_wrapped64:
+	    case Immediate_kv3_v1_unsigned6:
+	      res->operands[idx].val = value;
+	      res->operands[idx].sign = flags & KVX_OPERAND_SIGNED;
+	      res->operands[idx].width = width;
+	      res->operands[idx].type = KVX_CAT_IMMEDIATE;
+	      res->operands[idx].pcrel = 0;
+	      idx++;
+	      break;
+	    case Immediate_kv3_v1_pcrel17:
+	    case Immediate_kv3_v1_pcrel27:
+	      res->operands[idx].val = value + memaddr;
+	      res->operands[idx].sign = flags & KVX_OPERAND_SIGNED;
+	      res->operands[idx].width = width;
+	      res->operands[idx].type = KVX_CAT_IMMEDIATE;
+	      res->operands[idx].pcrel = 1;
+	      idx++;
+	      break;
+	    case Modifier_kv3_v1_column:
+	    case Modifier_kv3_v1_comparison:
+	    case Modifier_kv3_v1_doscale:
+	    case Modifier_kv3_v1_exunum:
+	    case Modifier_kv3_v1_floatcomp:
+	    case Modifier_kv3_v1_qindex:
+	    case Modifier_kv3_v1_rectify:
+	    case Modifier_kv3_v1_rounding:
+	    case Modifier_kv3_v1_roundint:
+	    case Modifier_kv3_v1_saturate:
+	    case Modifier_kv3_v1_scalarcond:
+	    case Modifier_kv3_v1_silent:
+	    case Modifier_kv3_v1_simdcond:
+	    case Modifier_kv3_v1_speculate:
+	    case Modifier_kv3_v1_splat32:
+	    case Modifier_kv3_v1_variant:
+	      {
+		int sz = 0;
+		int mod_idx = type - Modifier_kv3_v1_column;
+		for (sz = 0; env->kvx_modifiers[mod_idx][sz]; ++sz);
+		const char *mod = value < (unsigned) sz
+		  ? env->kvx_modifiers[mod_idx][value] : NULL;
+		if (!mod)
+		  return 0;
+		res->operands[idx].val = value;
+		res->operands[idx].type = KVX_CAT_MODIFIER;
+		res->operands[idx].mod_idx = mod_idx;
+		idx++;
+	      }
+	      break;
+	    default:
+	      fprintf (stderr, "error: unexpected operand type (%s)\n",
+		       type_name);
+	      exit (-1);
+	    };
+	}
+      else if (env->opc_table == kv3_v2_optab)
+	{
+	  switch (type)
+	    {
+	    case RegClass_kv3_v2_singleReg:
+	      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_GPR, value)
+	      break;
+	    case RegClass_kv3_v2_pairedReg:
+	      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_PGR, value)
+	      break;
+	    case RegClass_kv3_v2_quadReg:
+	      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_QGR, value)
+	      break;
+	    case RegClass_kv3_v2_systemReg:
+	    case RegClass_kv3_v2_aloneReg:
+	    case RegClass_kv3_v2_onlyraReg:
+	    case RegClass_kv3_v2_onlygetReg:
+	    case RegClass_kv3_v2_onlysetReg:
+	    case RegClass_kv3_v2_onlyfxReg:
+	    case RegClass_kv3_v2_onlyswapReg:
+	      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_SFR, value)
+	      break;
+	    case RegClass_kv3_v2_xworddReg:
+	    case RegClass_kv3_v2_xworddReg0M4:
+	    case RegClass_kv3_v2_xworddReg1M4:
+	    case RegClass_kv3_v2_xworddReg2M4:
+	    case RegClass_kv3_v2_xworddReg3M4:
+	      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_XCR, value)
+	      break;
+	    case RegClass_kv3_v2_xwordqReg:
+	    case RegClass_kv3_v2_xwordqRegE:
+	    case RegClass_kv3_v2_xwordqRegO:
+	      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_XBR, value)
+	      break;
+	    case RegClass_kv3_v2_xwordoReg:
+	      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_XVR, value)
+	      break;
+	    case RegClass_kv3_v2_xwordxReg:
+	      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_XTR, value)
+	      break;
+	    case RegClass_kv3_v2_xwordvReg:
+	      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_XMR, value)
+	      break;
+	    case RegClass_kv3_v2_buffer2Reg:
+	      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_X2R, value)
+	      break;
+	    case RegClass_kv3_v2_buffer4Reg:
+	      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_X4R, value)
+	      break;
+	    case RegClass_kv3_v2_buffer8Reg:
+	      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_X8R, value)
+	      break;
+	    case RegClass_kv3_v2_buffer16Reg:
+	      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_X16R, value)
+	      break;
+	    case RegClass_kv3_v2_buffer32Reg:
+	      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_X32R, value)
+	      break;
+	    case RegClass_kv3_v2_buffer64Reg:
+	      KVX_PRINT_REG (KV3_V2_REGFILE_DEC_X64R, value)
+	      break;
+	    case Immediate_kv3_v2_brknumber:
+	    case Immediate_kv3_v2_sysnumber:
+	    case Immediate_kv3_v2_signed10:
+	    case Immediate_kv3_v2_signed16:
+	    case Immediate_kv3_v2_signed27:
+	    case Immediate_kv3_v2_wrapped32:
+	    case Immediate_kv3_v2_signed37:
+	    case Immediate_kv3_v2_signed43:
+	    case Immediate_kv3_v2_signed54:
+	    case Immediate_kv3_v2_wrapped64:
+	    case Immediate_kv3_v2_unsigned6:
+	      res->operands[idx].val = value;
+	      res->operands[idx].sign = flags & KVX_OPERAND_SIGNED;
+	      res->operands[idx].width = width;
+	      res->operands[idx].type = KVX_CAT_IMMEDIATE;
+	      res->operands[idx].pcrel = 0;
+	      idx++;
+	      break;
+	    case Immediate_kv3_v2_pcrel27:
+	    case Immediate_kv3_v2_pcrel17:
+	      res->operands[idx].val = value + memaddr;
+	      res->operands[idx].sign = flags & KVX_OPERAND_SIGNED;
+	      res->operands[idx].width = width;
+	      res->operands[idx].type = KVX_CAT_IMMEDIATE;
+	      res->operands[idx].pcrel = 1;
+	      idx++;
+	      break;
+	    case Modifier_kv3_v2_accesses:
+	    case Modifier_kv3_v2_boolcas:
+	    case Modifier_kv3_v2_cachelev:
+	    case Modifier_kv3_v2_channel:
+	    case Modifier_kv3_v2_coherency:
+	    case Modifier_kv3_v2_comparison:
+	    case Modifier_kv3_v2_conjugate:
+	    case Modifier_kv3_v2_doscale:
+	    case Modifier_kv3_v2_exunum:
+	    case Modifier_kv3_v2_floatcomp:
+	    case Modifier_kv3_v2_hindex:
+	    case Modifier_kv3_v2_lsomask:
+	    case Modifier_kv3_v2_lsumask:
+	    case Modifier_kv3_v2_qindex:
+	    case Modifier_kv3_v2_rounding:
+	    case Modifier_kv3_v2_scalarcond:
+	    case Modifier_kv3_v2_shuffleV:
+	    case Modifier_kv3_v2_shuffleX:
+	    case Modifier_kv3_v2_silent:
+	    case Modifier_kv3_v2_simdcond:
+	    case Modifier_kv3_v2_speculate:
+	    case Modifier_kv3_v2_splat32:
+	    case Modifier_kv3_v2_transpose:
+	    case Modifier_kv3_v2_variant:
+	      {
+		int sz = 0;
+		int mod_idx = type - Modifier_kv3_v2_accesses;
+		for (sz = 0; env->kvx_modifiers[mod_idx][sz];
+		     ++sz);
+		const char *mod = value < (unsigned) sz
+		  ? env->kvx_modifiers[mod_idx][value] : NULL;
+		if (!mod)
+		  return 0;
+		res->operands[idx].val = value;
+		res->operands[idx].type = KVX_CAT_MODIFIER;
+		res->operands[idx].mod_idx = mod_idx;
+		idx++;
+	      };
+	      break;
+	    default:
+	      fprintf (stderr, "error: unexpected operand type (%s)\n",
+		       type_name);
+	      exit (-1);
+	    };
+	}
+      else if (env->opc_table == kv4_v1_optab)
+	{
+	  switch (type)
+	    {
+	    case RegClass_kv4_v1_singleReg:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_GPR, value)
+	      break;
+	    case RegClass_kv4_v1_pairedReg:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_PGR, value)
+	      break;
+	    case RegClass_kv4_v1_quadReg:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_QGR, value)
+	      break;
+	    case RegClass_kv4_v1_systemReg:
+	    case RegClass_kv4_v1_aloneReg:
+	    case RegClass_kv4_v1_onlyraReg:
+	    case RegClass_kv4_v1_onlygetReg:
+	    case RegClass_kv4_v1_onlysetReg:
+	    case RegClass_kv4_v1_onlyfxReg:
+	    case RegClass_kv4_v1_onlyswapReg:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_SFR, value)
+	      break;
+	    case RegClass_kv4_v1_xworddReg:
+	    case RegClass_kv4_v1_xworddReg0M4:
+	    case RegClass_kv4_v1_xworddReg1M4:
+	    case RegClass_kv4_v1_xworddReg2M4:
+	    case RegClass_kv4_v1_xworddReg3M4:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_XCR, value)
+	      break;
+	    case RegClass_kv4_v1_xwordqReg:
+	    case RegClass_kv4_v1_xwordqRegE:
+	    case RegClass_kv4_v1_xwordqRegO:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_XBR, value)
+	      break;
+	    case RegClass_kv4_v1_xwordoReg:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_XVR, value)
+	      break;
+	    case RegClass_kv4_v1_xwordxReg:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_XTR, value)
+	      break;
+	    case RegClass_kv4_v1_xwordvReg:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_XMR, value)
+	      break;
+	    case RegClass_kv4_v1_buffer2Reg:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_X2R, value)
+	      break;
+	    case RegClass_kv4_v1_buffer4Reg:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_X4R, value)
+	      break;
+	    case RegClass_kv4_v1_buffer8Reg:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_X8R, value)
+	      break;
+	    case RegClass_kv4_v1_buffer16Reg:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_X16R, value)
+	      break;
+	    case RegClass_kv4_v1_buffer32Reg:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_X32R, value)
+	      break;
+	    case RegClass_kv4_v1_buffer64Reg:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_X64R, value)
+	      break;
+	    case RegClass_kv4_v1_mainReg:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_FIRST_RV_BIR, value)
+	      break;
+	    case RegClass_kv4_v1_floatReg:
+	      KVX_PRINT_REG (KV4_V1_REGFILE_DEC_RV_FPR, value)
+	      break;
+	    case Immediate_kv4_v1_brknumber:
+	    case Immediate_kv4_v1_sysnumber:
+	    case Immediate_kv4_v1_signed10:
+	    case Immediate_kv4_v1_signed12:
+	    case Immediate_kv4_v1_signed16:
+	    case Immediate_kv4_v1_signed20:
+	    case Immediate_kv4_v1_signed27:
+	    case Immediate_kv4_v1_wrapped32:
+	    case Immediate_kv4_v1_signed37:
+	    case Immediate_kv4_v1_signed43:
+	    case Immediate_kv4_v1_signed54:
+	    case Immediate_kv4_v1_wrapped64:
+	    case Immediate_kv4_v1_unsigned6:
+	      res->operands[idx].val = value;
+	      res->operands[idx].sign = flags & KVX_OPERAND_SIGNED;
+	      res->operands[idx].width = width;
+	      res->operands[idx].type = KVX_CAT_IMMEDIATE;
+	      res->operands[idx].pcrel = 0;
+	      idx++;
+	      break;
+	    case Immediate_kv4_v1_pcrel11:
+	    case Immediate_kv4_v1_pcrel12:
+	    case Immediate_kv4_v1_pcrel17:
+	    case Immediate_kv4_v1_pcrel20:
+	    case Immediate_kv4_v1_pcrel27:
+	    case Immediate_kv4_v1_pcrel38:
+	      res->operands[idx].val = value + memaddr;
+	      res->operands[idx].sign = flags & KVX_OPERAND_SIGNED;
+	      res->operands[idx].width = width;
+	      res->operands[idx].type = KVX_CAT_IMMEDIATE;
+	      res->operands[idx].pcrel = 1;
+	      idx++;
+	      break;
+	    case Modifier_kv4_v1_accesses:
+	    case Modifier_kv4_v1_boolcas:
+	    case Modifier_kv4_v1_cachelev:
+	    case Modifier_kv4_v1_channel:
+	    case Modifier_kv4_v1_coherency:
+	    case Modifier_kv4_v1_conjugate:
+	    case Modifier_kv4_v1_realimag:
+	    case Modifier_kv4_v1_doscale:
+	    case Modifier_kv4_v1_exunum:
+	    case Modifier_kv4_v1_floatcomp:
+	    case Modifier_kv4_v1_hindex:
+	    case Modifier_kv4_v1_qindex:
+	    case Modifier_kv4_v1_floatmode:
+	    case Modifier_kv4_v1_ccbcomp:
+	    case Modifier_kv4_v1_intcomp:
+	    case Modifier_kv4_v1_bcucond:
+	    case Modifier_kv4_v1_shuffleV:
+	    case Modifier_kv4_v1_shuffleX:
+	    case Modifier_kv4_v1_lanecond:
+	    case Modifier_kv4_v1_speculate:
+	    case Modifier_kv4_v1_splat32:
+	    case Modifier_kv4_v1_variant:
+	    case Modifier_kv4_v1_lanetodo:
+	    case Modifier_kv4_v1_lanesize:
+	    case Modifier_kv4_v1_signextw:
+	      {
+		int sz = 0;
+		int mod_idx = type - Modifier_kv4_v1_accesses;
+		for (sz = 0; env->kvx_modifiers[mod_idx][sz]; ++sz);
+		const char *mod = value < (unsigned) sz
+		  ? env->kvx_modifiers[mod_idx][value] : NULL;
+		if (!mod)
+		  return 0;
+		res->operands[idx].val = value;
+		res->operands[idx].type = KVX_CAT_MODIFIER;
+		res->operands[idx].mod_idx = mod_idx;
+		idx++;
+	      }
+	      break;
+	    default:
+	      fprintf (stderr, "error: unexpected operand type (%s)\n",
+		       type_name);
+	      exit (-1);
+	    };
+	}
 
 #undef KVX_PRINT_REG
-	    }
+    }
 
-	  found = 1;
-	  break;
-	retry:;
-	  idx = 0;
-	  continue;
+  res->nb_ops = idx;
+  return 1;
+}
+
+/* Decode RAW_INSN into RES by probing the candidate opcodes of the decode
+   index bucket selected by its first syllable.  */
+
+static int
+decode_insn (const struct kvx_dis_env *env, bfd_vma memaddr,
+	     struct raw_insn *raw_insn, struct kvx_decoded_insn *res)
+{
+  unsigned key = kvx_decode_key (env, raw_insn->syllables[0]);
+
+  for (unsigned i = env->decode_index.buckets[key];
+       i < env->decode_index.buckets[key + 1]; i++)
+    {
+      struct kvx_opc *opc = env->decode_index.entries[i];
+      if (kvx_opc_match_p (opc, raw_insn)
+	  && decode_insn_operands (env, memaddr, raw_insn, opc, res))
+	return 1;
+    }
+
+  res->nb_ops = 0;
+  return 0;
+}
+
+/* Decode RAW_INSN into RES by scanning the whole opcode table.  This is
+   the reference the decode index is checked against.  */
+
+static int
+decode_insn_linear (const struct kvx_dis_env *env, bfd_vma memaddr,
+		    struct raw_insn *raw_insn, struct kvx_decoded_insn *res)
+{
+  for (struct kvx_opc *opc = env->opc_table;
+       opc->as_op && (((char) opc->as_op[0]) != 0); opc++)
+    {
+      if (!kvx_opc_decodable_p (env, opc))
+	continue;
+
+      if (kvx_opc_match_p (opc, raw_insn)
+	  && decode_insn_operands (env, memaddr, raw_insn, opc, res))
+	return 1;
+    }
+
+  res->nb_ops = 0;
+  return 0;
+}
+
+/* Return whether the decoded instructions A and B are the same.  */
+
+static int
+kvx_same_decoded_insn_p (const struct kvx_decoded_insn *a,
+			 const struct kvx_decoded_insn *b)
+{
+  if (a->opc != b->opc || a->nb_ops != b->nb_ops)
+    return 0;
+  for (int i = 0; i < a->nb_ops; i++)
+    if (a->operands[i].type != b->operands[i].type
+	|| a->operands[i].val != b->operands[i].val
+	|| a->operands[i].sign != b->operands[i].sign
+	|| a->operands[i].pcrel != b->operands[i].pcrel
+	|| a->operands[i].width != b->operands[i].width
+	|| a->operands[i].mod_idx != b->operands[i].mod_idx)
+      return 0;
+  return 1;
+}
+
+/* Check that decode_insn and decode_insn_linear agree on every encoding of
+   every decodable opcode, with the bits not fixed by the opcode set to a
+   few fill patterns.  */
+
+static void
+kvx_check_decode_index (const struct kvx_dis_env *env)
+{
+  static const uint32_t fills[] = {
+    0x00000000, 0xffffffff, 0x55555555, 0xaaaaaaaa,
+    0x0f0f0f0f, 0xf0f0f0f0, 0x12345678, 0x9abcdef0,
+  };
+  int nb_errors = 0;
+
+  for (struct kvx_opc *opc = env->opc_table;
+       opc->as_op && (((char) opc->as_op[0]) != 0); opc++)
+    {
+      if (!kvx_opc_decodable_p (env, opc))
+	continue;
+
+      for (size_t f = 0; f < ARRAY_SIZE (fills); f++)
+	{
+	  struct raw_insn raw_insn;
+	  struct kvx_decoded_insn dec, ref;
+	  int found, ref_found, same;
+
+	  memset (&raw_insn, 0, sizeof raw_insn);
+	  raw_insn.length = opc->wordcount;
+	  for (int i = 0; i < opc->wordcount; i++)
+	    raw_insn.syllables[i]
+	      = (opc->codewords[i].opcode
+		 | (fills[(f + i) % ARRAY_SIZE (fills)]
+		    & ~opc->codewords[i].mask));
+
+	  memset (&dec, 0, sizeof dec);
+	  memset (&ref, 0, sizeof ref);
+	  found = decode_insn (env, 0, &raw_insn, &dec);
+	  ref_found = decode_insn_linear (env, 0, &raw_insn, &ref);
+
+	  same = (found == ref_found
+		  && (!found || kvx_same_decoded_insn_p (&dec, &ref)));
+
+	  if (!same && nb_errors++ < 10)
+	    opcodes_error_handler
+	      (_("decode index mismatch for %s (%08x): %s instead of %s"),
+	       opc->as_op, raw_insn.syllables[0],
+	       found ? dec.opc->as_op : "none",
+	       ref_found ? ref.opc->as_op : "none");
 	}
     }
-  res->nb_ops = idx;
-  return found;
 }
 
+static void kvx_check_decode_bundle (unsigned long mach, bfd_vma memaddr,
+				     int word_cnt, int insn_cnt,
+				     int invalid_bundle);
+
 int
 print_insn_kvx (bfd_vma memaddr, struct disassemble_info *info)
 {
   static int insn_idx = 0;
   static int insn_cnt = 0;
+  struct kvx_dis_env *env = &dis_env;
   struct raw_insn *raw_insn;
   int readsofar = 0;
   int found = 0;
   int invalid_bundle = 0;
 
-  if (!env.initialized_p)
+  if (!env->initialized_p)
     kvx_dis_init (info);
 
   /* Clear instruction information field.  */
@@ -1183,7 +1448,12 @@ print_insn_kvx (bfd_vma memaddr, struct disassemble_info *info)
 	}
       while (kvx_has_parallel_bit (kvx_bundle_words[word_cnt - 1])
 	     && word_cnt < KVX_MAXBUNDLEWORDS - 1);
-      invalid_bundle = kvx_steer_bundle_insns (info, word_cnt, &insn_cnt);
+      invalid_bundle = kvx_steer_bundle_insns (info->mach, kvx_bundle_words,
+					       kvx_bundle_insns, word_cnt,
+					       &insn_cnt);
+      if (opt_check_decode_bundles)
+	kvx_check_decode_bundle (info->mach, memaddr, word_cnt, insn_cnt,
+				 invalid_bundle);
     }
 
   assert (insn_idx < KVX_MAXBUNDLEISSUE);
@@ -1199,9 +1469,9 @@ print_insn_kvx (bfd_vma memaddr, struct disassemble_info *info)
       (*info->fprintf_func) (info->stream, "] ");
     }
 
-  struct decoded_insn dec;
+  struct kvx_decoded_insn dec;
   memset (&dec, 0, sizeof dec);
-  if (!invalid_bundle && (found = decode_insn (memaddr, raw_insn, &dec)))
+  if (!invalid_bundle && (found = decode_insn (env, memaddr, raw_insn, &dec)))
     {
       int ch;
       (*info->fprintf_func) (info->stream, "%s", dec.opc->as_op);
@@ -1224,17 +1494,17 @@ print_insn_kvx (bfd_vma memaddr, struct disassemble_info *info)
 
 	  switch (dec.operands[i].type)
 	    {
-	    case CAT_REGISTER:
+	    case KVX_CAT_REGISTER:
 	      (*info->fprintf_func) (info->stream, "%s",
-				     env.kvx_registers[dec.operands[i].val].name);
+				     env->kvx_registers[dec.operands[i].val].name);
 	      break;
-	    case CAT_MODIFIER:
+	    case KVX_CAT_MODIFIER:
 	      {
-		const char *mod = env.kvx_modifiers[dec.operands[i].mod_idx][dec.operands[i].val];
+		const char *mod = env->kvx_modifiers[dec.operands[i].mod_idx][dec.operands[i].val];
 		(*info->fprintf_func) (info->stream, "%s", !mod || !strcmp (mod, ".") ? "" : mod);
 	      }
 	      break;
-	    case CAT_IMMEDIATE:
+	    case KVX_CAT_IMMEDIATE:
 	      {
 		if (dec.operands[i].pcrel)
 		  {
@@ -1314,6 +1584,203 @@ print_insn_kvx (bfd_vma memaddr, struct disassemble_info *info)
   return readsofar;
 }
 
+/* A bundle decoder.  It does not share the environment and bundle
+   buffers of print_insn_kvx, which may be in the middle of a bundle.  */
+
+struct kvx_decoder
+{
+  struct kvx_dis_env env;
+  uint32_t bundle_words[KVX_MAXBUNDLEWORDS];
+  struct raw_insn bundle_insns[KVX_MAXBUNDLEISSUE];
+};
+
+/* Return a new decoder for the KVX machine MACH.  */
+
+struct kvx_decoder *
+kvx_decoder_new (unsigned long mach)
+{
+  struct kvx_decoder *decoder = xcalloc (1, sizeof (*decoder));
+
+  kvx_dis_init_mach (&decoder->env, mach);
+  return decoder;
+}
+
+/* Free DECODER.  */
+
+void
+kvx_decoder_free (struct kvx_decoder *decoder)
+{
+  if (decoder == NULL)
+    return;
+  free (decoder->env.decode_index.buckets);
+  free (decoder->env.decode_index.entries);
+  free (decoder);
+}
+
+/* Decode with DECODER the bundles of the LEN bytes at BUF, whose first
+   byte is at address ADDR.  The instructions of each bundle are stored in
+   issue order in INSNS[], without any text formatting.  Only complete
+   bundles are decoded, while they fit in the MAX_INSNS entries of INSNS[].
+   Set *CONSUMED to the number of bytes of the decoded bundles, so that a
+   stream can be decoded by calling again with the remaining bytes.  An
+   invalid bundle yields a single instruction with a NULL OPC covering its
+   first word.  Return the number of instructions stored, or -1 if the
+   first bundle does not fit in INSNS[], which cannot happen when
+   MAX_INSNS is at least KVX_MAXBUNDLEISSUE.  */
+
+long
+kvx_decode_bundles (struct kvx_decoder *decoder, const bfd_byte *buf,
+		    size_t len, bfd_vma addr, struct kvx_decoded_insn *insns,
+		    size_t max_insns, size_t *consumed)
+{
+  const struct kvx_dis_env *env = &decoder->env;
+  uint32_t *bundle_words = decoder->bundle_words;
+  struct raw_insn *bundle_insns = decoder->bundle_insns;
+  size_t nb_words = len / 4;
+  size_t word_idx = 0;
+  size_t nb_insns = 0;
+
+  while (word_idx < nb_words)
+    {
+      bfd_vma bundle_addr = addr + 4 * word_idx;
+      int word_cnt = 0;
+      int insn_cnt = 0;
+      int invalid_bundle;
+
+      do
+	{
+	  if (word_idx + word_cnt == nb_words)
+	    /* Incomplete bundle, wait for more bytes.  */
+	    goto done;
+	  bundle_words[word_cnt]
+	    = bfd_getl32 (buf + 4 * (word_idx + word_cnt));
+	  word_cnt++;
+	}
+      while (kvx_has_parallel_bit (bundle_words[word_cnt - 1])
+	     && word_cnt < KVX_MAXBUNDLEWORDS - 1);
+
+      invalid_bundle = kvx_steer_bundle_insns (env->mach, bundle_words,
+					       bundle_insns, word_cnt,
+					       &insn_cnt);
+      if (invalid_bundle)
+	insn_cnt = 1;
+
+      if (nb_insns + insn_cnt > max_insns)
+	{
+	  if (nb_insns == 0)
+	    {
+	      *consumed = 0;
+	      return -1;
+	    }
+	  break;
+	}
+
+      if (invalid_bundle)
+	{
+	  struct kvx_decoded_insn *insn = &insns[nb_insns++];
+	  memset (insn, 0, sizeof (*insn));
+	  insn->bundle_addr = bundle_addr;
+	  insn->nb_syllables = 1;
+	  insn->bundle_end = 1;
+	  word_idx++;
+	  continue;
+	}
+
+      for (int i = 0; i < insn_cnt; i++)
+	{
+	  struct raw_insn *raw_insn = &bundle_insns[i];
+	  struct kvx_decoded_insn *insn = &insns[nb_insns++];
+
+	  memset (insn, 0, sizeof (*insn));
+	  if (!decode_insn (env, bundle_addr, raw_insn, insn))
+	    insn->opc = NULL;
+	  insn->bundle_addr = bundle_addr;
+	  insn->nb_syllables = raw_insn->length;
+	  insn->exu = raw_insn->exu;
+	  insn->bundle_end = i == insn_cnt - 1;
+	}
+      word_idx += word_cnt;
+    }
+
+ done:
+  *consumed = 4 * word_idx;
+  return nb_insns;
+}
+
+/* Check that kvx_decode_bundles decodes the WORD_CNT words of the bundle
+   at MEMADDR in KVX_BUNDLE_WORDS[] as print_insn_kvx does, which steered
+   them into INSN_CNT instructions in KVX_BUNDLE_INSNS[] unless
+   INVALID_BUNDLE, and that it refuses to decode the bundle into an array
+   one instruction too short.  */
+
+static void
+kvx_check_decode_bundle (unsigned long mach, bfd_vma memaddr, int word_cnt,
+			 int insn_cnt, int invalid_bundle)
+{
+  static struct kvx_decoder *decoder;
+  bfd_byte buf[4 * KVX_MAXBUNDLEWORDS];
+  struct kvx_decoded_insn insns[KVX_MAXBUNDLEISSUE];
+  size_t consumed, size;
+  long nb_insns;
+
+  if (decoder == NULL || decoder->env.mach != mach)
+    {
+      kvx_decoder_free (decoder);
+      decoder = kvx_decoder_new (mach);
+    }
+
+  /* An invalid bundle decodes as one invalid instruction covering its
+     first word, after which the decoder goes on with the next word.  */
+  if (invalid_bundle)
+    insn_cnt = 1;
+  size = invalid_bundle ? 4 : 4 * word_cnt;
+
+  for (int i = 0; i < word_cnt; i++)
+    bfd_putl32 (kvx_bundle_words[i], buf + 4 * i);
+
+  nb_insns = kvx_decode_bundles (decoder, buf, 4 * word_cnt, memaddr,
+				 insns, insn_cnt - 1, &consumed);
+  if (nb_insns != -1 || consumed != 0)
+    opcodes_error_handler
+      (_("decode bundles mismatch at %#" PRIx64 ": bundle does not fit in "
+	 "%d instructions but %ld decoded"),
+       (uint64_t) memaddr, insn_cnt - 1, nb_insns);
+
+  nb_insns = kvx_decode_bundles (decoder, buf, 4 * word_cnt, memaddr,
+				 insns, insn_cnt, &consumed);
+  if (nb_insns != insn_cnt || consumed != size)
+    {
+      opcodes_error_handler
+	(_("decode bundles mismatch at %#" PRIx64 ": %ld instructions in "
+	   "%lu bytes instead of %d in %lu"),
+	 (uint64_t) memaddr, nb_insns, (unsigned long) consumed, insn_cnt,
+	 (unsigned long) size);
+      return;
+    }
+
+  for (int i = 0; i < insn_cnt; i++)
+    {
+      struct kvx_decoded_insn ref;
+      int found;
+
+      memset (&ref, 0, sizeof ref);
+      found = (!invalid_bundle
+	       && decode_insn (&dis_env, memaddr, &kvx_bundle_insns[i], &ref));
+      if (!found)
+	ref.opc = NULL;
+      if (insns[i].bundle_addr != memaddr
+	  || insns[i].bundle_end != (i == insn_cnt - 1)
+	  || (found
+	      ? !kvx_same_decoded_insn_p (&insns[i], &ref)
+	      : insns[i].opc != NULL))
+	opcodes_error_handler
+	  (_("decode bundles mismatch at %#" PRIx64 ": %s instead of %s"),
+	   (uint64_t) memaddr,
+	   insns[i].opc ? insns[i].opc->as_op : "none",
+	   found ? ref.opc->as_op : "none");
+    }
+}
+
 /* This function searches in the current bundle for the instructions required
    by unwinding. For prologue:
      (1) addd $r12 = $r12, <res_stack>
@@ -1339,6 +1806,7 @@ decode_prologue_epilogue_bundle (bfd_vma memaddr,
 				 struct disassemble_info *info,
 				 struct kvx_prologue_epilogue_bundle *peb)
 {
+  struct kvx_dis_env *env = &dis_env;
   int i, nb_insn, nb_syl;
 
   peb->nb_insn = 0;
@@ -1346,7 +1814,7 @@ decode_prologue_epilogue_bundle (bfd_vma memaddr,
   if (info->arch != bfd_arch_kvx)
     return -1;
 
-  if (!env.initialized_p)
+  if (!env->initialized_p)
     kvx_dis_init (info);
 
   /* Read the bundle.  */
@@ -1363,7 +1831,8 @@ decode_prologue_epilogue_bundle (bfd_vma memaddr,
     }
   while (kvx_has_parallel_bit (kvx_bundle_words[nb_syl - 1])
 	 && nb_syl < KVX_MAXBUNDLEWORDS - 1);
-  if (kvx_steer_bundle_insns (info, nb_syl, &nb_insn))
+  if (kvx_steer_bundle_insns (info->mach, kvx_bundle_words, kvx_bundle_insns,
+			      nb_syl, &nb_insn))
     return -1;
 
   /* Check for extension to right if this is not the end of bundle
@@ -1373,9 +1842,9 @@ decode_prologue_epilogue_bundle (bfd_vma memaddr,
       struct raw_insn *raw_insn = &kvx_bundle_insns[idx_insn];
       int is_add = 0, is_get = 0, is_a_peb_insn = 0, is_copyd = 0;
 
-      struct decoded_insn dec;
+      struct kvx_decoded_insn dec;
       memset (&dec, 0, sizeof dec);
-      if (!decode_insn (memaddr, raw_insn, &dec))
+      if (!decode_insn (env, memaddr, raw_insn, &dec))
 	continue;
 
       const char *op_name = dec.opc->as_op;
@@ -1461,14 +1930,14 @@ decode_prologue_epilogue_bundle (bfd_vma memaddr,
 	  value = (value << shift) + bias;
 
 #define chk_type(core_, val_) \
-      (env.opc_table == core_ ##_optab && type == (val_))
+      (env->opc_table == core_ ##_optab && type == (val_))
 
 	  if (   chk_type (kv3_v1, RegClass_kv3_v1_singleReg)
 	      || chk_type (kv3_v2, RegClass_kv3_v2_singleReg)
 	      || chk_type (kv4_v1, RegClass_kv4_v1_singleReg))
 	    {
-	      if (env.kvx_regfiles[KVX_REGFILE_DEC_GPR] + value
-		  >= env.kvx_max_dec_registers)
+	      if (env->kvx_regfiles[KVX_REGFILE_DEC_GPR] + value
+		  >= env->kvx_max_dec_registers)
 		return -1;
 	      if (is_add && i < 2)
 		{
@@ -1559,10 +2028,10 @@ decode_prologue_epilogue_bundle (bfd_vma memaddr,
 		   || chk_type (kv3_v2, RegClass_kv3_v2_onlyfxReg)
 		   || chk_type (kv4_v1, RegClass_kv4_v1_onlyfxReg))
 	    {
-	      if (env.kvx_regfiles[KVX_REGFILE_DEC_GPR] + value
-		  >= env.kvx_max_dec_registers)
+	      if (env->kvx_regfiles[KVX_REGFILE_DEC_GPR] + value
+		  >= env->kvx_max_dec_registers)
 		return -1;
-	      if (is_get && !strcmp (env.kvx_registers[env.kvx_dec_registers[env.kvx_regfiles[KVX_REGFILE_DEC_SFR] + value]].name, "$ra"))
+	      if (is_get && !strcmp (env->kvx_registers[env->kvx_dec_registers[env->kvx_regfiles[KVX_REGFILE_DEC_SFR] + value]].name, "$ra"))
 		{
 		  crt_peb_insn->insn_type = KVX_PROL_EPIL_INSN_GET_RA;
 		  is_a_peb_insn = 1;
@@ -1727,5 +2196,13 @@ re-ordered instruction.\n"));
   fprintf (stream, _("\n\
   no-compact-assembly  Emit a new line between bundles of instructions.\n"));
 
+  fprintf (stream, _("\n\
+  check-decode-index   Check that the opcode decode index finds the same \
+opcodes as a full table scan.\n"));
+
+  fprintf (stream, _("\n\
+  check-decode-bundles Check that the batch bundle decoder decodes the same \
+instructions.\n"));
+
   fprintf (stream, _("\n"));
 }